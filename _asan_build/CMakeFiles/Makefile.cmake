@@ -0,0 +1,102 @@
+# CMAKE generated file: DO NOT EDIT!
+# Generated by "Unix Makefiles" Generator, CMake Version 3.25
+
+# The generator used is:
+set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
+
+# The top level Makefile was generated from the following files:
+set(CMAKE_MAKEFILE_DEPENDS
+  "CMakeCache.txt"
+  "/root/repo/CMakeLists.txt"
+  "CMakeFiles/3.25.1/CMakeCXXCompiler.cmake"
+  "CMakeFiles/3.25.1/CMakeSystem.cmake"
+  "/root/repo/benchmark/CMakeLists.txt"
+  "/root/repo/example/CMakeLists.txt"
+  "/root/repo/include/sstest/sstest_config.cmake.h.in"
+  "/root/repo/src/CMakeLists.txt"
+  "/root/repo/test/CMakeLists.txt"
+  "/root/repo/tools/CMakeLists.txt"
+  "/usr/share/cmake-3.25/Modules/CMakeCXXInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeCommonLanguageInclude.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeGenericSystem.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeInitializeConfigs.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeLanguageInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInformation.cmake"
+  "/usr/share/cmake-3.25/Modules/CMakeSystemSpecificInitialize.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckCXXSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckIncludeFileCXX.cmake"
+  "/usr/share/cmake-3.25/Modules/CheckLibraryExists.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Compiler/GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageHandleStandardArgs.cmake"
+  "/usr/share/cmake-3.25/Modules/FindPackageMessage.cmake"
+  "/usr/share/cmake-3.25/Modules/FindThreads.cmake"
+  "/usr/share/cmake-3.25/Modules/Internal/CheckSourceCompiles.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU-CXX.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux-GNU.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/Linux.cmake"
+  "/usr/share/cmake-3.25/Modules/Platform/UnixPaths.cmake"
+  )
+
+# The corresponding makefile is:
+set(CMAKE_MAKEFILE_OUTPUTS
+  "Makefile"
+  "CMakeFiles/cmake.check_cache"
+  )
+
+# Byproducts of CMake generate step:
+set(CMAKE_MAKEFILE_PRODUCTS
+  "/root/repo/include/sstest/sstest_config.h"
+  "CMakeFiles/CMakeDirectoryInformation.cmake"
+  "src/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "test/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "example/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "tools/CMakeFiles/CMakeDirectoryInformation.cmake"
+  "benchmark/CMakeFiles/CMakeDirectoryInformation.cmake"
+  )
+
+# Dependency information for all targets:
+set(CMAKE_DEPEND_INFO_FILES
+  "src/CMakeFiles/sstest.dir/DependInfo.cmake"
+  "src/CMakeFiles/sstest_main.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_plugin_v1.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_plugin_v2.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_plugin_duplicate.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_plugin_unresolved.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_plugin.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_exception.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_info.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_test.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_assertion.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_summary.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_registry.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_string.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_compare.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_pool.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_process.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_history.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_watchdog.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_graph.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_coverage.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_cache.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_journal.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_server.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_runner.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_orchestrate_pass.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_orchestrate_fail.dir/DependInfo.cmake"
+  "test/CMakeFiles/test_orchestrate.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_0_blank.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_1_pass.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_2_fail.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_3_basic.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_4_user_type.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_5_fixture.dir/DependInfo.cmake"
+  "example/CMakeFiles/example_6_parameterized.dir/DependInfo.cmake"
+  "example/CMakeFiles/A_tutorial.dir/DependInfo.cmake"
+  "tools/CMakeFiles/sstest_host.dir/DependInfo.cmake"
+  "tools/CMakeFiles/sstest_merge.dir/DependInfo.cmake"
+  "tools/CMakeFiles/sstest_orchestrate.dir/DependInfo.cmake"
+  "tools/CMakeFiles/sstest_request.dir/DependInfo.cmake"
+  "benchmark/CMakeFiles/benchmark_dispatch.dir/DependInfo.cmake"
+  )
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/A_tutorial"
+  "../bin/A_tutorial.pdb"
+  "CMakeFiles/A_tutorial.dir/A_tutorial/A-0_tutorial.cpp.o"
+  "CMakeFiles/A_tutorial.dir/A_tutorial/A-0_tutorial.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/A_tutorial.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_0_blank"
+  "../bin/example_0_blank.pdb"
+  "CMakeFiles/example_0_blank.dir/0_blank/0-0_blank.cpp.o"
+  "CMakeFiles/example_0_blank.dir/0_blank/0-0_blank.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_0_blank.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_1_pass"
+  "../bin/example_1_pass.pdb"
+  "CMakeFiles/example_1_pass.dir/1_pass/1-0_pass.cpp.o"
+  "CMakeFiles/example_1_pass.dir/1_pass/1-0_pass.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_1_pass.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
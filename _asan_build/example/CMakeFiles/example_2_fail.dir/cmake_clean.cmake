@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_2_fail"
+  "../bin/example_2_fail.pdb"
+  "CMakeFiles/example_2_fail.dir/2_fail/2-0_fail.cpp.o"
+  "CMakeFiles/example_2_fail.dir/2_fail/2-0_fail.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_2_fail.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/example/3_basic/3-0_basic.cpp" "example/CMakeFiles/example_3_basic.dir/3_basic/3-0_basic.cpp.o" "gcc" "example/CMakeFiles/example_3_basic.dir/3_basic/3-0_basic.cpp.o.d"
+  "/root/repo/example/3_basic/3-1_basic.cpp" "example/CMakeFiles/example_3_basic.dir/3_basic/3-1_basic.cpp.o" "gcc" "example/CMakeFiles/example_3_basic.dir/3_basic/3-1_basic.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_asan_build/src/CMakeFiles/sstest_main.dir/DependInfo.cmake"
+  "/root/repo/_asan_build/src/CMakeFiles/sstest.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
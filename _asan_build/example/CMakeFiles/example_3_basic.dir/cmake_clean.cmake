@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../bin/example_3_basic"
+  "../bin/example_3_basic.pdb"
+  "CMakeFiles/example_3_basic.dir/3_basic/3-0_basic.cpp.o"
+  "CMakeFiles/example_3_basic.dir/3_basic/3-0_basic.cpp.o.d"
+  "CMakeFiles/example_3_basic.dir/3_basic/3-1_basic.cpp.o"
+  "CMakeFiles/example_3_basic.dir/3_basic/3-1_basic.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_3_basic.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
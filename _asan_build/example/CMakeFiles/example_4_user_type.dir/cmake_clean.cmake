@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_4_user_type"
+  "../bin/example_4_user_type.pdb"
+  "CMakeFiles/example_4_user_type.dir/4_user_type/4-0_user_type.cpp.o"
+  "CMakeFiles/example_4_user_type.dir/4_user_type/4-0_user_type.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_4_user_type.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
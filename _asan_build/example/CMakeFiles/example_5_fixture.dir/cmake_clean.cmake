@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_5_fixture"
+  "../bin/example_5_fixture.pdb"
+  "CMakeFiles/example_5_fixture.dir/5_fixture/5-0_fixture.cpp.o"
+  "CMakeFiles/example_5_fixture.dir/5_fixture/5-0_fixture.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_5_fixture.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/example_6_parameterized"
+  "../bin/example_6_parameterized.pdb"
+  "CMakeFiles/example_6_parameterized.dir/6_parameterized/6-0_parameterized.cpp.o"
+  "CMakeFiles/example_6_parameterized.dir/6_parameterized/6-0_parameterized.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/example_6_parameterized.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,43 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/sstest_affinity.cpp" "src/CMakeFiles/sstest.dir/sstest_affinity.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_affinity.cpp.o.d"
+  "/root/repo/src/sstest_assertion.cpp" "src/CMakeFiles/sstest.dir/sstest_assertion.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_assertion.cpp.o.d"
+  "/root/repo/src/sstest_cache.cpp" "src/CMakeFiles/sstest.dir/sstest_cache.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_cache.cpp.o.d"
+  "/root/repo/src/sstest_console.cpp" "src/CMakeFiles/sstest.dir/sstest_console.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_console.cpp.o.d"
+  "/root/repo/src/sstest_coverage.cpp" "src/CMakeFiles/sstest.dir/sstest_coverage.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_coverage.cpp.o.d"
+  "/root/repo/src/sstest_exception.cpp" "src/CMakeFiles/sstest.dir/sstest_exception.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_exception.cpp.o.d"
+  "/root/repo/src/sstest_float.cpp" "src/CMakeFiles/sstest.dir/sstest_float.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_float.cpp.o.d"
+  "/root/repo/src/sstest_graph.cpp" "src/CMakeFiles/sstest.dir/sstest_graph.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_graph.cpp.o.d"
+  "/root/repo/src/sstest_history.cpp" "src/CMakeFiles/sstest.dir/sstest_history.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_history.cpp.o.d"
+  "/root/repo/src/sstest_info.cpp" "src/CMakeFiles/sstest.dir/sstest_info.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_info.cpp.o.d"
+  "/root/repo/src/sstest_journal.cpp" "src/CMakeFiles/sstest.dir/sstest_journal.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_journal.cpp.o.d"
+  "/root/repo/src/sstest_plugin.cpp" "src/CMakeFiles/sstest.dir/sstest_plugin.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_plugin.cpp.o.d"
+  "/root/repo/src/sstest_pool.cpp" "src/CMakeFiles/sstest.dir/sstest_pool.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_pool.cpp.o.d"
+  "/root/repo/src/sstest_printer.cpp" "src/CMakeFiles/sstest.dir/sstest_printer.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_printer.cpp.o.d"
+  "/root/repo/src/sstest_process.cpp" "src/CMakeFiles/sstest.dir/sstest_process.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_process.cpp.o.d"
+  "/root/repo/src/sstest_registrar.cpp" "src/CMakeFiles/sstest.dir/sstest_registrar.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_registrar.cpp.o.d"
+  "/root/repo/src/sstest_registry.cpp" "src/CMakeFiles/sstest.dir/sstest_registry.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_registry.cpp.o.d"
+  "/root/repo/src/sstest_run.cpp" "src/CMakeFiles/sstest.dir/sstest_run.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_run.cpp.o.d"
+  "/root/repo/src/sstest_runner.cpp" "src/CMakeFiles/sstest.dir/sstest_runner.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_runner.cpp.o.d"
+  "/root/repo/src/sstest_server.cpp" "src/CMakeFiles/sstest.dir/sstest_server.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_server.cpp.o.d"
+  "/root/repo/src/sstest_string.cpp" "src/CMakeFiles/sstest.dir/sstest_string.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_string.cpp.o.d"
+  "/root/repo/src/sstest_summary.cpp" "src/CMakeFiles/sstest.dir/sstest_summary.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_summary.cpp.o.d"
+  "/root/repo/src/sstest_test.cpp" "src/CMakeFiles/sstest.dir/sstest_test.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_test.cpp.o.d"
+  "/root/repo/src/sstest_timer.cpp" "src/CMakeFiles/sstest.dir/sstest_timer.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_timer.cpp.o.d"
+  "/root/repo/src/sstest_watchdog.cpp" "src/CMakeFiles/sstest.dir/sstest_watchdog.cpp.o" "gcc" "src/CMakeFiles/sstest.dir/sstest_watchdog.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
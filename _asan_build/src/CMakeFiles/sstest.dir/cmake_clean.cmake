@@ -0,0 +1,59 @@
+file(REMOVE_RECURSE
+  "../lib/libsstest.a"
+  "../lib/libsstest.pdb"
+  "CMakeFiles/sstest.dir/sstest_affinity.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_affinity.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_assertion.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_assertion.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_cache.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_cache.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_console.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_console.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_coverage.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_coverage.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_exception.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_exception.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_float.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_float.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_graph.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_graph.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_history.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_history.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_info.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_info.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_journal.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_journal.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_plugin.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_plugin.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_pool.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_pool.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_printer.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_printer.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_process.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_process.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_registrar.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_registrar.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_registry.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_registry.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_run.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_run.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_runner.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_runner.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_server.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_server.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_string.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_string.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_summary.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_summary.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_test.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_test.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_timer.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_timer.cpp.o.d"
+  "CMakeFiles/sstest.dir/sstest_watchdog.cpp.o"
+  "CMakeFiles/sstest.dir/sstest_watchdog.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../lib/libsstest_main.a"
+  "../lib/libsstest_main.pdb"
+  "CMakeFiles/sstest_main.dir/sstest_main.cpp.o"
+  "CMakeFiles/sstest_main.dir/sstest_main.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest_main.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
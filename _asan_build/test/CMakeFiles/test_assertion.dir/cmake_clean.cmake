@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_assertion"
+  "../bin/test_assertion.pdb"
+  "CMakeFiles/test_assertion.dir/test_assertion.cpp.o"
+  "CMakeFiles/test_assertion.dir/test_assertion.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_assertion.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_cache"
+  "../bin/test_cache.pdb"
+  "CMakeFiles/test_cache.dir/test_cache.cpp.o"
+  "CMakeFiles/test_cache.dir/test_cache.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_cache.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_compare"
+  "../bin/test_compare.pdb"
+  "CMakeFiles/test_compare.dir/test_compare.cpp.o"
+  "CMakeFiles/test_compare.dir/test_compare.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_compare.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_coverage"
+  "../bin/test_coverage.pdb"
+  "CMakeFiles/test_coverage.dir/test_coverage.cpp.o"
+  "CMakeFiles/test_coverage.dir/test_coverage.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_coverage.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
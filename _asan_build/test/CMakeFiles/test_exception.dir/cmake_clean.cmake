@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_exception"
+  "../bin/test_exception.pdb"
+  "CMakeFiles/test_exception.dir/test_exception.cpp.o"
+  "CMakeFiles/test_exception.dir/test_exception.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_exception.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
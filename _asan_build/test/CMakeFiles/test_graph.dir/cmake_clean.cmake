@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_graph"
+  "../bin/test_graph.pdb"
+  "CMakeFiles/test_graph.dir/test_graph.cpp.o"
+  "CMakeFiles/test_graph.dir/test_graph.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_graph.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_history"
+  "../bin/test_history.pdb"
+  "CMakeFiles/test_history.dir/test_history.cpp.o"
+  "CMakeFiles/test_history.dir/test_history.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_history.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
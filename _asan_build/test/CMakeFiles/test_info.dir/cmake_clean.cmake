@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_info"
+  "../bin/test_info.pdb"
+  "CMakeFiles/test_info.dir/test_info.cpp.o"
+  "CMakeFiles/test_info.dir/test_info.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_info.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
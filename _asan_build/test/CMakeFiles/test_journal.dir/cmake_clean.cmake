@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_journal"
+  "../bin/test_journal.pdb"
+  "CMakeFiles/test_journal.dir/test_journal.cpp.o"
+  "CMakeFiles/test_journal.dir/test_journal.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_journal.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
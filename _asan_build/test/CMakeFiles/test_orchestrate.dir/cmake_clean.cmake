@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_orchestrate"
+  "../bin/test_orchestrate.pdb"
+  "CMakeFiles/test_orchestrate.dir/test_orchestrate.cpp.o"
+  "CMakeFiles/test_orchestrate.dir/test_orchestrate.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_orchestrate.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_orchestrate_fail"
+  "../bin/test_orchestrate_fail.pdb"
+  "CMakeFiles/test_orchestrate_fail.dir/programs/orchestrate_fail.cpp.o"
+  "CMakeFiles/test_orchestrate_fail.dir/programs/orchestrate_fail.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_orchestrate_fail.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_orchestrate_pass"
+  "../bin/test_orchestrate_pass.pdb"
+  "CMakeFiles/test_orchestrate_pass.dir/programs/orchestrate_pass.cpp.o"
+  "CMakeFiles/test_orchestrate_pass.dir/programs/orchestrate_pass.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_orchestrate_pass.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
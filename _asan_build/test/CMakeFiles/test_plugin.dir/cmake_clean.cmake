@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_plugin"
+  "../bin/test_plugin.pdb"
+  "CMakeFiles/test_plugin.dir/test_plugin.cpp.o"
+  "CMakeFiles/test_plugin.dir/test_plugin.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_plugin.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "../lib/libtest_plugin_duplicate.pdb"
+  "../lib/libtest_plugin_duplicate.so"
+  "CMakeFiles/test_plugin_duplicate.dir/plugins/answer_v1.cpp.o"
+  "CMakeFiles/test_plugin_duplicate.dir/plugins/answer_v1.cpp.o.d"
+  "CMakeFiles/test_plugin_duplicate.dir/plugins/duplicate.cpp.o"
+  "CMakeFiles/test_plugin_duplicate.dir/plugins/duplicate.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_plugin_duplicate.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../lib/libtest_plugin_unresolved.pdb"
+  "../lib/libtest_plugin_unresolved.so"
+  "CMakeFiles/test_plugin_unresolved.dir/plugins/unresolved.cpp.o"
+  "CMakeFiles/test_plugin_unresolved.dir/plugins/unresolved.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_plugin_unresolved.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../lib/libtest_plugin_v1.pdb"
+  "../lib/libtest_plugin_v1.so"
+  "CMakeFiles/test_plugin_v1.dir/plugins/answer_v1.cpp.o"
+  "CMakeFiles/test_plugin_v1.dir/plugins/answer_v1.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_plugin_v1.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
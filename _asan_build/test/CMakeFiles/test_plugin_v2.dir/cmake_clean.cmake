@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../lib/libtest_plugin_v2.pdb"
+  "../lib/libtest_plugin_v2.so"
+  "CMakeFiles/test_plugin_v2.dir/plugins/answer_v2.cpp.o"
+  "CMakeFiles/test_plugin_v2.dir/plugins/answer_v2.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_plugin_v2.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
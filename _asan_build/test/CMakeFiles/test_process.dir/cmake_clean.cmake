@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_process"
+  "../bin/test_process.pdb"
+  "CMakeFiles/test_process.dir/test_process.cpp.o"
+  "CMakeFiles/test_process.dir/test_process.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_process.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_registry"
+  "../bin/test_registry.pdb"
+  "CMakeFiles/test_registry.dir/test_registry.cpp.o"
+  "CMakeFiles/test_registry.dir/test_registry.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_registry.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
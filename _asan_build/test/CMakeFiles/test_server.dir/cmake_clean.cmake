@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_server"
+  "../bin/test_server.pdb"
+  "CMakeFiles/test_server.dir/test_server.cpp.o"
+  "CMakeFiles/test_server.dir/test_server.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_server.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_string"
+  "../bin/test_string.pdb"
+  "CMakeFiles/test_string.dir/test_string.cpp.o"
+  "CMakeFiles/test_string.dir/test_string.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_string.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
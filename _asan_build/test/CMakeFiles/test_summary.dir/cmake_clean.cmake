@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_summary"
+  "../bin/test_summary.pdb"
+  "CMakeFiles/test_summary.dir/test_summary.cpp.o"
+  "CMakeFiles/test_summary.dir/test_summary.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_summary.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
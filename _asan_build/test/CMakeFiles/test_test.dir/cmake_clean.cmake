@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_test"
+  "../bin/test_test.pdb"
+  "CMakeFiles/test_test.dir/test_test.cpp.o"
+  "CMakeFiles/test_test.dir/test_test.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/test_watchdog"
+  "../bin/test_watchdog.pdb"
+  "CMakeFiles/test_watchdog.dir/test_watchdog.cpp.o"
+  "CMakeFiles/test_watchdog.dir/test_watchdog.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_watchdog.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
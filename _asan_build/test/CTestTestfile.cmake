@@ -0,0 +1,46 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test
+# Build directory: /root/repo/_asan_build/test
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_plugin "/root/repo/_asan_build/bin/test_plugin")
+set_tests_properties(test_plugin PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;41;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_exception "/root/repo/_asan_build/bin/test_exception")
+set_tests_properties(test_exception PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;149;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_info "/root/repo/_asan_build/bin/test_info")
+set_tests_properties(test_info PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;150;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_test "/root/repo/_asan_build/bin/test_test")
+set_tests_properties(test_test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;151;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_compare "/root/repo/_asan_build/bin/test_compare")
+set_tests_properties(test_compare PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;152;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_assertion "/root/repo/_asan_build/bin/test_assertion")
+set_tests_properties(test_assertion PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;153;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_summary "/root/repo/_asan_build/bin/test_summary")
+set_tests_properties(test_summary PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;154;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_registry "/root/repo/_asan_build/bin/test_registry")
+set_tests_properties(test_registry PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;155;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_string "/root/repo/_asan_build/bin/test_string")
+set_tests_properties(test_string PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;156;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_pool "/root/repo/_asan_build/bin/test_pool")
+set_tests_properties(test_pool PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;157;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_process "/root/repo/_asan_build/bin/test_process")
+set_tests_properties(test_process PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;158;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_history "/root/repo/_asan_build/bin/test_history")
+set_tests_properties(test_history PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;159;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_watchdog "/root/repo/_asan_build/bin/test_watchdog")
+set_tests_properties(test_watchdog PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;160;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_graph "/root/repo/_asan_build/bin/test_graph")
+set_tests_properties(test_graph PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;161;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_coverage "/root/repo/_asan_build/bin/test_coverage")
+set_tests_properties(test_coverage PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;162;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_cache "/root/repo/_asan_build/bin/test_cache")
+set_tests_properties(test_cache PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;163;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_journal "/root/repo/_asan_build/bin/test_journal")
+set_tests_properties(test_journal PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;164;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_server "/root/repo/_asan_build/bin/test_server")
+set_tests_properties(test_server PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;165;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_runner "/root/repo/_asan_build/bin/test_runner")
+set_tests_properties(test_runner PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;166;add_test;/root/repo/test/CMakeLists.txt;0;")
+add_test(test_orchestrate "/root/repo/_asan_build/bin/test_orchestrate")
+set_tests_properties(test_orchestrate PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/CMakeLists.txt;187;add_test;/root/repo/test/CMakeLists.txt;0;")
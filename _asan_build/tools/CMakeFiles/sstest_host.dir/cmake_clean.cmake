@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/sstest_host"
+  "../bin/sstest_host.pdb"
+  "CMakeFiles/sstest_host.dir/sstest_host.cpp.o"
+  "CMakeFiles/sstest_host.dir/sstest_host.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest_host.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/sstest_merge"
+  "../bin/sstest_merge.pdb"
+  "CMakeFiles/sstest_merge.dir/sstest_merge.cpp.o"
+  "CMakeFiles/sstest_merge.dir/sstest_merge.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest_merge.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
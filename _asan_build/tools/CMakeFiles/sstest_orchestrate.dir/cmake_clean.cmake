@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/sstest_orchestrate"
+  "../bin/sstest_orchestrate.pdb"
+  "CMakeFiles/sstest_orchestrate.dir/sstest_orchestrate.cpp.o"
+  "CMakeFiles/sstest_orchestrate.dir/sstest_orchestrate.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest_orchestrate.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
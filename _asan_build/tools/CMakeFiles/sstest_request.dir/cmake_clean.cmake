@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../bin/sstest_request"
+  "../bin/sstest_request.pdb"
+  "CMakeFiles/sstest_request.dir/sstest_request.cpp.o"
+  "CMakeFiles/sstest_request.dir/sstest_request.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sstest_request.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,115 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+/**
+ * dispatch: measure the time the test runner takes per test, by running many tests that do next to nothing.
+ * 
+ * Usage: benchmark_dispatch [--tests N] [ARGS...]
+ * Registers N tests, 100000 by default, in one suite and runs them twice with the sstest options ARGS, e.g. --batch 100 or --jobs 4. 
+ * The first run records the duration of each test in the history file, which the second run plans with, e.g. to choose the tests to 
+ * batch. Prints to stderr the time per test of each whole run, which includes loading and saving the history file, and of its test 
+ * loop alone, from the start of the first test to the end of the last, which is the time dispatching and reporting tests takes. 
+ * The time the tests themselves take is left out of both. Redirect stdout, or the time the terminal takes to print each test is 
+ * measured too.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_include.h"
+#include "sstest/sstest_run.h"
+
+namespace
+{
+
+    typedef std::chrono::steady_clock::rep tick_type;
+
+    std::atomic<tick_type> first_call(0);
+    std::atomic<tick_type> last_call(0);
+
+    // records when the test loop of a run starts and ends, which costs the same here as in the loop timing the tests themselves
+    void tinyTest()
+    {
+        const tick_type now = std::chrono::steady_clock::now().time_since_epoch().count();
+        tick_type none = 0;
+        first_call.compare_exchange_strong(none, now);
+        last_call.store(now);
+    }
+
+    double elapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    size_t ntests = 100000;
+    std::vector<char*> args(argv, argv + argc);
+    if (args.size() > 2 && std::string(args[1]) == "--tests")
+    {
+        ntests = std::strtoul(args[2], nullptr, 10);
+        args.erase(args.begin() + 1, args.begin() + 3);
+    }
+
+    // the registry refers to the names, which must not move
+    std::deque<std::string> names;
+    for (size_t i = 0; i < ntests; i++)
+    {
+        names.push_back("test_" + std::to_string(i));
+        sstest::TestRegistrar(sstest::StringView("dispatch"), sstest::TestFunction(sstest::TestInfo(sstest::StringView(names.back().c_str(), names.back().size())), 
+            sstest::LineInfo(__FILE__, __LINE__), tinyTest));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ntests; i++)
+    {
+        tinyTest();
+    }
+    const double tests_us = elapsedUs(start);
+
+    int code = EXIT_SUCCESS;
+    const char* runs[] = { "first run", "second run" };
+    for (const char* run : runs)
+    {
+        first_call = 0;
+        start = std::chrono::steady_clock::now();
+        code = testing::RunTests(static_cast<int>(args.size()), args.data());
+        const double run_us = elapsedUs(start);
+        const double loop_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(last_call - first_call)).count();
+        std::cerr << run << ": " << (run_us - tests_us) / static_cast<double>(ntests) << " us per test, " 
+            << (loop_us - tests_us) / static_cast<double>(ntests) << " us per test in the test loop" << std::endl;
+    }
+    return code;
+}
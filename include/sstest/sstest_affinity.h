@@ -0,0 +1,175 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#ifndef _SSTEST_AFFINITY_H_
+#define _SSTEST_AFFINITY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_affinity.h
+ * \brief Contains the CPU and NUMA topology used to pin the workers running tests to CPUs
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Sorted indices of CPUs, as numbered by the operating system
+     * 
+     */
+    typedef std::vector<size_t> CpuSet;
+
+    /**
+     * \brief The CPUs of the machine grouped by NUMA node, read from sysfs, and the placement of workers on them.
+     * On machines without NUMA, or without sysfs, every CPU is on node 0
+     * 
+     */
+    class CpuTopology
+    {
+    public:
+
+        /**
+         * \brief CPUs sharing a memory controller, e.g. the cores of one socket
+         * 
+         */
+        struct Node
+        {
+            size_t id;
+            CpuSet cpus;
+        };
+
+        /**
+         * \brief Read the NUMA nodes and the hardware threads of each core from sysfs
+         * 
+         * \param root Directory the path /sys/devices/system is read under, e.g. to read a copy of it
+         */
+        explicit CpuTopology(const std::string& root = "");
+
+        /**
+         * \brief Return the nodes with at least one CPU, by id
+         * 
+         * \return const std::vector<Node>& 
+         */
+        const std::vector<Node>& nodes() const noexcept;
+
+        /**
+         * \brief Return every CPU of every node
+         * 
+         * \return CpuSet 
+         */
+        CpuSet cpus() const;
+
+        /**
+         * \brief Keep only the given CPUs, e.g. the ones this process may run on. Nodes left without CPUs are dropped
+         * 
+         * \param allowed 
+         */
+        void restrict(const CpuSet& allowed);
+
+        /**
+         * \brief Remove the given CPUs, e.g. the ones reserved for benchmarks. Nodes left without CPUs are dropped
+         * 
+         * \param reserved 
+         */
+        void exclude(const CpuSet& reserved);
+
+        /**
+         * \brief Return the CPUs each of nworkers workers should be pinned to. Workers are spread over the nodes in turn, in proportion 
+         * to their number of CPUs, and get the first hardware thread of every core before any second one. With more workers than CPUs, 
+         * workers share CPUs in the same order. Empty if there are no CPUs
+         * 
+         * \param nworkers 
+         * \param per_node If true, each worker gets every CPU of its node instead of one CPU, so the OS may move it within the node only
+         * \return std::vector<CpuSet> 
+         */
+        std::vector<CpuSet> placement(size_t nworkers, bool per_node) const;
+
+        /**
+         * \brief Return the id of the node a CPU is on, or 0 if it isn't on any
+         * 
+         * \param cpu 
+         * \return size_t 
+         */
+        size_t nodeOf(size_t cpu) const noexcept;
+
+        /**
+         * \brief Parse a list of CPUs in the format of sysfs and taskset, e.g. "0-3,8,10-11"
+         * \throw InvalidArgument if the list is malformed
+         * 
+         * \param list 
+         * \return CpuSet 
+         */
+        static CpuSet parseList(const std::string& list);
+
+        /**
+         * \brief Format CPUs as a list in the format of sysfs, with runs of CPUs as ranges, e.g. "0-3,8"
+         * 
+         * \param cpus 
+         * \return std::string 
+         */
+        static std::string formatList(const CpuSet& cpus);
+
+        /**
+         * \brief Return the CPUs the calling thread may run on, or an empty set if not supported
+         * 
+         * \return CpuSet 
+         */
+        static CpuSet affinity();
+
+        /**
+         * \brief Let the calling thread run only on the given CPUs. Threads and processes it starts afterwards inherit them
+         * 
+         * \param cpus 
+         * \return true if the thread was pinned
+         * \return false if not supported, or none of the CPUs can be used
+         */
+        static bool setAffinity(const CpuSet& cpus) noexcept;
+
+        /**
+         * \brief Check if pinning threads to CPUs is supported on this platform
+         * 
+         * \return true 
+         * \return false 
+         */
+        static bool supported() noexcept;
+
+    private:
+
+        std::vector<Node> nodes_;
+        std::vector<size_t> thread_rank; // by CPU, which hardware thread of its core it is, 0 for the first
+    };
+
+}
+
+#endif // _SSTEST_AFFINITY_H_
@@ -0,0 +1,175 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_CACHE_H_
+#define _SSTEST_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_cache.h
+ * \brief Contains the result cache, which lets a test that passed before be reported as CACHED instead of running it again
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Keeps the key of the last passing run of each test, keyed by the test identifier, which can be saved to and loaded from a file.
+     * The key is a hash of the test program, the test identifier and the files the test declared as inputs, so a test is only cached 
+     * while none of them change
+     * 
+     */
+    class ResultCache
+    {
+    public:
+
+        /**
+         * \brief A passing run of a single test
+         * 
+         */
+        struct Entry
+        {
+            Entry() noexcept : key(0), duration_us(0) {}
+
+            uint64_t key; // \sa makeKey()
+            uint64_t duration_us; // how long the test took when it ran
+        };
+
+        ResultCache();
+
+        /**
+         * \brief Read entries from a file, replacing entries with the same identifier. Malformed lines are skipped
+         * 
+         * \param path 
+         * \return true If the file was read
+         * \return false If the file could not be opened, e.g. on the first run
+         */
+        bool load(const std::string& path);
+
+        /**
+         * \brief Write all entries to a file. The file is written to a temporary file first and renamed, so it is never left half written
+         * 
+         * \param path 
+         * \return true If the file was written
+         * \return false Else
+         */
+        bool save(const std::string& path) const;
+
+        /**
+         * \brief Return the entry of a test if it has the given key, or nullptr if the test has no entry or a different key
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param key \sa makeKey()
+         * \return const Entry* 
+         */
+        const Entry* find(const std::string& identifier, uint64_t key) const;
+
+        /**
+         * \brief Record that a test passed with the given key, replacing its previous entry
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param key \sa makeKey()
+         * \param duration_us 
+         */
+        void store(const std::string& identifier, uint64_t key, uint64_t duration_us);
+
+        /**
+         * \brief Remove the entry of a test, e.g. after it failed
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         */
+        void erase(const std::string& identifier);
+
+        /**
+         * \brief Return the number of tests with an entry
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Check if there are no entries
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool empty() const noexcept;
+
+        /**
+         * \brief Remove all entries
+         * 
+         */
+        void clear() noexcept;
+
+        /**
+         * \brief Hash the contents of a file
+         * 
+         * \param path 
+         * \param hash Set to the hash of the contents if the file could be read
+         * \return true If the file could be read
+         * \return false Else
+         */
+        static bool hashFile(const std::string& path, uint64_t& hash);
+
+        /**
+         * \brief Hash the test program and, on Linux, every shared object it has loaded, so a change to a library the tests link against 
+         * or a loaded plugin changes the hash too. Elsewhere only the program itself is hashed
+         * 
+         * \param executable Path of the test program
+         * \param hash Set to the hash if the program could be read
+         * \return true If the program could be read. Shared objects that can't be read, e.g. the vDSO, are left out
+         * \return false Else
+         */
+        static bool hashProgram(const std::string& executable, uint64_t& hash);
+
+        /**
+         * \brief Return the key of a test, from the hash of the test program, the test identifier and the contents of its input files. 
+         * A missing input file gives a different key than any contents, so creating it later changes the key too
+         * 
+         * \param program_hash \sa hashProgram()
+         * \param identifier \sa TestInterface::identifier()
+         * \param inputs Paths of the files the test reads
+         * \return uint64_t 
+         */
+        static uint64_t makeKey(uint64_t program_hash, const std::string& identifier, const std::vector<std::string>& inputs);
+
+    private:
+
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+}
+
+#endif // _SSTEST_CACHE_H_
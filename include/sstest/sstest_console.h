@@ -103,6 +103,14 @@ namespace sstest
          */
         void flush();
 
+        /**
+         * \brief Check if ANSI escape codes are written by this logger
+         * 
+         * \return true If ANSI escape codes are enabled
+         * \return false Else
+         */
+        bool ansiEnabled() const noexcept;
+
         // 4 space/ indentation level (tab hard to control width)
         void tab(size_t ntab = 1) const;
         void time() const;
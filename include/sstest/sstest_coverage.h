@@ -0,0 +1,175 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_COVERAGE_H_
+#define _SSTEST_COVERAGE_H_
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_coverage.h
+ * \brief Contains per test coverage collection, and the test impact index used to run only the tests affected by a change
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Check if per test coverage can be collected, which needs sstest built with SSTEST_COVERAGE, i.e. linked with --coverage.
+     * Only code compiled with --coverage is seen
+     * 
+     * \return true 
+     * \return false 
+     */
+    bool coverageAvailable() noexcept;
+
+    /**
+     * \brief Clear the coverage counters, so coverage collected next only includes code run from now on
+     * 
+     */
+    void resetCoverage() noexcept;
+
+    /**
+     * \brief Return the object files with code that ran since resetCoverage(), named by their source file. 
+     * Counters are written to a temporary directory with __gcov_dump() and read back, so this is slow and should be called once per test
+     * 
+     * \return std::vector<std::string> Paths of the object files without the .gcda extension, e.g. "/build/CMakeFiles/t.dir/test/foo.cpp"
+     * for CMake, or "/build/obj/foo" for an object file compiled directly. Empty if coverage is not available
+     */
+    std::vector<std::string> collectCoverage();
+
+    /**
+     * \brief Records which source files ran for each test, keyed by the test identifier, which can be saved to and loaded from a file. 
+     * Given a list of changed source files, the test runner then only runs the tests affected by the change
+     * 
+     */
+    class TestImpactIndex
+    {
+    public:
+
+        TestImpactIndex();
+
+        /**
+         * \brief Read the index from a file, replacing tests with the same identifier. Malformed lines are skipped
+         * 
+         * \param path 
+         * \return true If the file was read
+         * \return false If the file could not be opened or is not an index
+         */
+        bool load(const std::string& path);
+
+        /**
+         * \brief Write the index to a file. The file is written to a temporary file first and renamed, so it is never left half written
+         * 
+         * \param path 
+         * \return true If the file was written
+         * \return false Else
+         */
+        bool save(const std::string& path) const;
+
+        /**
+         * \brief Set the source files that ran for a test, replacing those recorded before
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param files 
+         */
+        void recordTest(const std::string& identifier, std::vector<std::string> files);
+
+        /**
+         * \brief Return the source files recorded for a test, or nullptr if the test is not in the index
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \return const std::vector<std::string>* 
+         */
+        const std::vector<std::string>* find(const std::string& identifier) const;
+
+        /**
+         * \brief Check if a test may be affected by changes to the given files. Tests not in the index are always affected,
+         * since nothing is known about them
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param changed Paths of changed source files, e.g. relative to the repository root
+         * \return true 
+         * \return false 
+         */
+        bool affected(const std::string& identifier, const std::vector<std::string>& changed) const;
+
+        /**
+         * \brief Check if any test in the index ran code from the file
+         * 
+         * \param file 
+         * \return true 
+         * \return false 
+         */
+        bool covers(const std::string& file) const;
+
+        /**
+         * \brief Check if a recorded file is the same source file as a changed file. The recorded path matches if it ends with all of the
+         * changed path, or, for objects named without the source extension, if the file names match without it
+         * 
+         * \param recorded A path in the index
+         * \param changed 
+         * \return true 
+         * \return false 
+         */
+        static bool sameSource(const std::string& recorded, const std::string& changed);
+
+        /**
+         * \brief Return the number of tests in the index
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Check if there are no tests in the index
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool empty() const noexcept;
+
+        /**
+         * \brief Remove all tests
+         * 
+         */
+        void clear() noexcept;
+
+    private:
+
+        std::unordered_map<std::string, std::vector<std::string>> tests;
+    };
+
+}
+
+#endif // _SSTEST_COVERAGE_H_
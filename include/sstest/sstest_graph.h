@@ -0,0 +1,250 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_GRAPH_H_
+#define _SSTEST_GRAPH_H_
+
+#include <cstddef>
+#include <set>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_graph.h
+ * \brief Contains the graph of dependencies between tests, used by the test runner to start tests only after the tests they depend on passed,
+ * and the resources tests share, used to limit how many tests using a resource run at once
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Directed acyclic graph of dependencies between tests, where each test is identified by its index, e.g. in the list of tests to run.
+     * A test may only start once all of its prerequisites have passed. Tests may also use resources, each of which only a limited number of 
+     * tests may use at once, or be exclusive and run while no other test does
+     * 
+     */
+    class TestGraph
+    {
+    public:
+
+        /**
+         * \brief Create a graph of the given number of tests with no dependencies
+         * 
+         * \param ntests 
+         */
+        explicit TestGraph(size_t ntests = 0);
+
+        /**
+         * \brief Return the number of tests in the graph
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Check if any test depends on another
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool hasDependencies() const noexcept;
+
+        /**
+         * \brief Declare that a test may only start once another test has passed. Declaring the same dependency again has no effect
+         * \throw InvalidArgument if either index is out of range, or a test depends on itself
+         * 
+         * \param dependent 
+         * \param prerequisite 
+         */
+        void addDependency(size_t dependent, size_t prerequisite);
+
+        /**
+         * \brief Return the tests that must pass before the given test may start
+         * 
+         * \param test 
+         * \return const std::vector<size_t>& 
+         */
+        const std::vector<size_t>& prerequisites(size_t test) const;
+
+        /**
+         * \brief Return the tests that depend directly on the given test
+         * 
+         * \param test 
+         * \return const std::vector<size_t>& 
+         */
+        const std::vector<size_t>& dependents(size_t test) const;
+
+        /**
+         * \brief Return every test in an order where each test comes after its prerequisites. 
+         * Of the tests that could come next, the one with the lowest index is taken, so a graph without dependencies keeps its order
+         * \throw InvalidArgument if the dependencies form a cycle
+         * 
+         * \return std::vector<size_t> 
+         */
+        std::vector<size_t> topologicalOrder() const;
+
+        /**
+         * \brief Add a resource which at most the given number of tests may use at once
+         * \throw InvalidArgument if capacity is 0
+         * 
+         * \param capacity 
+         * \return size_t The index of the resource
+         */
+        size_t addResource(size_t capacity);
+
+        /**
+         * \brief Return the number of resources in the graph
+         * 
+         * \return size_t 
+         */
+        size_t numResources() const noexcept;
+
+        /**
+         * \brief Return the number of tests that may use a resource at once
+         * 
+         * \param resource 
+         * \return size_t 
+         */
+        size_t capacity(size_t resource) const;
+
+        /**
+         * \brief Declare that a test uses a resource while it runs. Declaring the same use again has no effect
+         * \throw InvalidArgument if either index is out of range
+         * 
+         * \param test 
+         * \param resource 
+         */
+        void useResource(size_t test, size_t resource);
+
+        /**
+         * \brief Return the resources the given test uses
+         * 
+         * \param test 
+         * \return const std::vector<size_t>& 
+         */
+        const std::vector<size_t>& resources(size_t test) const;
+
+        /**
+         * \brief Declare that a test may only run while no other test runs
+         * \throw InvalidArgument if the index is out of range
+         * 
+         * \param test 
+         */
+        void setExclusive(size_t test);
+
+        /**
+         * \brief Check if a test may only run while no other test runs
+         * 
+         * \param test 
+         * \return true 
+         * \return false 
+         */
+        bool exclusive(size_t test) const;
+
+        /**
+         * \brief Check if any test uses a resource or is exclusive
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool hasResources() const noexcept;
+
+        /**
+         * \brief Return a graph of the tests repeated the given number of times, where test i of repetition k has index k * size() + i. 
+         * Each repetition depends only on itself, and all repetitions share the same resources
+         * 
+         * \param times 
+         * \return TestGraph 
+         */
+        TestGraph repeated(size_t times) const;
+
+    private:
+
+        std::vector<std::vector<size_t>> prerequisites_;
+        std::vector<std::vector<size_t>> dependents_;
+        size_t ndependencies;
+        std::vector<size_t> capacities;
+        std::vector<std::vector<size_t>> resources_;
+        std::vector<bool> exclusive_;
+        size_t nconstrained; // number of resource uses and exclusive tests
+    };
+
+    /**
+     * \brief Tracks which tests of a graph are ready to start while the tests are running. 
+     * A test is ready once its prerequisites have passed and the resources it uses are free. Tests returned as ready hold their resources 
+     * until they finish, so each must be started and then finished. Of the tests waiting only on resources, the ones with the lowest index 
+     * are taken first, but a test that fits is never held back by one that doesn't
+     * \note Not thread safe, calls must be synchronized by the caller
+     * 
+     */
+    class TestScheduler
+    {
+    public:
+
+        /**
+         * \brief Track the given graph, which must outlive the scheduler
+         * 
+         */
+        explicit TestScheduler(const TestGraph&);
+
+        /**
+         * \brief Return the tests that have no prerequisites and may start right away, in order of index. Call once before finish()
+         * 
+         * \return std::vector<size_t> 
+         */
+        std::vector<size_t> start();
+
+        /**
+         * \brief Report that a test has finished
+         * 
+         * \param test A test that was returned as ready
+         * \param passed If false, every test that depends on it, directly or not, will never start
+         * \param ready Tests that may now start are appended, in order of index
+         * \param skipped Tests that will never start because of this test are appended
+         */
+        void finish(size_t test, bool passed, std::vector<size_t>& ready, std::vector<size_t>& skipped);
+
+    private:
+
+        // start the tests of held that fit in the free resources, in order of index
+        void admit(std::vector<size_t>& ready);
+
+        const TestGraph& graph;
+        std::vector<size_t> waiting; // number of prerequisites of each test that have not passed yet
+        std::vector<bool> skipped_;
+        std::set<size_t> held; // tests whose prerequisites passed, waiting for resources
+        std::vector<size_t> in_use; // number of running tests using each resource
+        size_t nrunning;
+        bool exclusive_running;
+    };
+
+}
+
+#endif // _SSTEST_GRAPH_H_
@@ -0,0 +1,180 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_HISTORY_H_
+#define _SSTEST_HISTORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_history.h
+ * \brief Contains the test history, a small database of per-test data kept between runs of a test program
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Records information about each test from previous runs, keyed by the test identifier, which can be saved to and loaded from a file.
+     * The test runner uses the measured duration of each test to schedule the longest tests first, the last result of each test
+     * to rerun failed tests first, and how often each test failed recently to choose the tests to run within a time budget.
+     * 
+     */
+    class TestHistory
+    {
+    public:
+
+        /**
+         * \brief What is known about a single test from previous runs
+         * 
+         */
+        struct Record
+        {
+            Record() noexcept : duration_us(0), failed(false), runs(0), failures(0) {}
+
+            /**
+             * \brief Estimate the probability that the next run of the test fails from its recent runs. A test with no 
+             * recorded runs is estimated to fail half the time
+             * 
+             * \return double In (0, 1)
+             */
+            double failureRate() const noexcept;
+
+            uint64_t duration_us; // smoothed run time of the test in microseconds
+            bool failed; // the test did not pass the last time it ran
+            uint32_t runs; // number of recent runs, older runs are forgotten so the rate follows changes to the test
+            uint32_t failures; // number of the recent runs that did not pass
+        };
+
+        TestHistory();
+
+        /**
+         * \brief Read records from a file, replacing records with the same identifier. Malformed lines are skipped
+         * 
+         * \param path 
+         * \return true If the file was read
+         * \return false If the file could not be opened, e.g. on the first run
+         */
+        bool load(const std::string& path);
+
+        /**
+         * \brief Write all records to a file. The file is written to a temporary file first and renamed, so it is never left half written
+         * 
+         * \param path 
+         * \return true If the file was written
+         * \return false Else
+         */
+        bool save(const std::string& path) const;
+
+        /**
+         * \brief Return the record of a test, or nullptr if there is none
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \return const Record* 
+         */
+        const Record* find(const std::string& identifier) const;
+
+        /**
+         * \brief Record a measured duration of a test. It is averaged with the previous duration, if any, to smooth out noisy runs
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param duration_us 
+         */
+        void recordDuration(const std::string& identifier, uint64_t duration_us);
+
+        /**
+         * \brief Record the result of the latest run of a test, replacing the previous result and counting it towards the failure rate
+         * 
+         * \param identifier \sa TestInterface::identifier()
+         * \param passed 
+         */
+        void recordResult(const std::string& identifier, bool passed);
+
+        /**
+         * \brief Return the number of tests that did not pass the last time they ran
+         * 
+         * \return size_t 
+         */
+        size_t numFailed() const noexcept;
+
+        /**
+         * \brief Return the number of tests with a record
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Check if there are no records
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool empty() const noexcept;
+
+        /**
+         * \brief Remove all records
+         * 
+         */
+        void clear() noexcept;
+
+        /**
+         * \brief Return a path next to path, unique to the calling process and thread, to write a file to before renaming it to path. 
+         * Runs of the same program saving the same file at once then don't write over each other's temporary file
+         * 
+         * \param path 
+         * \return std::string 
+         */
+        static std::string temporaryPath(const std::string& path);
+
+        /**
+         * \brief Write a file with write to a temporaryPath() of path, then replace path with it, so path is never left half written. 
+         * Replaces an existing file on Windows as well, where std::rename() fails if the target exists
+         * 
+         * \param path 
+         * \param write Writes the content of the file to the stream
+         * \return true If the file was written
+         * \return false Else, leaving path as it was
+         */
+        static bool replaceFile(const std::string& path, const std::function<void(std::ostream&)>& write);
+
+    private:
+
+        std::unordered_map<std::string, Record> records;
+    };
+
+}
+
+#endif // _SSTEST_HISTORY_H_
@@ -46,6 +46,12 @@
 #include "sstest_registry.h"
 #include "sstest_registrar.h"
 #include "sstest_summary.h"
+#include "sstest_affinity.h"
+#include "sstest_pool.h"
+#include "sstest_process.h"
+#include "sstest_history.h"
+#include "sstest_watchdog.h"
+#include "sstest_graph.h"
 #include "sstest_runner.h"
 #include "sstest_run.h"
 
@@ -599,6 +605,65 @@
 #define TEST_PARAMETERIZED(...) \
         INTERNAL_SSTEST_TEST_PARAMETERIZED(__VA_ARGS__)
 
+/**
+ * \def TEST_DEPENDS_ON
+ * \brief Declare that a test or suite may only run after other tests or suites have passed
+ * 
+ * No definition or body is required. May be declared in any translation unit, before or after the tests it names.
+ * 
+ * Each parameter is either a test, written as <test suite>::<test name> or <test name> for tests without a suite, or the name of a suite to mean every test in it.
+ * The first parameter is the dependent, the remaining parameters are its prerequisites.
+ * 
+ * If a prerequisite does not pass, its dependents are skipped. Prerequisites of a test that is run are always run, even if they would otherwise be 
+ * left out, e.g. by sharding. Parameterized tests can only be named through their suite.
+ * 
+ * Example: TEST_DEPENDS_ON(index::query, index::build)
+ */
+#define TEST_DEPENDS_ON(dependent, ...) \
+        INTERNAL_SSTEST_DEPENDS_ON(dependent, __VA_ARGS__)
+
+/**
+ * \def TEST_RESOURCES
+ * \brief Declare the resources a test or suite uses, such as a port or a file, so that tests sharing a resource don't run at the same time
+ * 
+ * No definition or body is required. May be declared in any translation unit, before or after the tests it names.
+ * 
+ * The first parameter names a test or suite as in TEST_DEPENDS_ON, the remaining parameters are resource tags. When running in parallel, 
+ * at most as many tests using a tag run at once as its limit allows, 1 unless set by TEST_RESOURCE_LIMITS or --resource-limit. 
+ * Tests tagged exclusive only run while no other test runs.
+ * 
+ * Example: TEST_RESOURCES(server::listen, port-8080)
+ * 
+ * \sa TEST_RESOURCE_LIMITS
+ */
+#define TEST_RESOURCES(name, ...) \
+        INTERNAL_SSTEST_RESOURCES(name, __VA_ARGS__)
+
+/**
+ * \def TEST_RESOURCE_LIMITS
+ * \brief Set how many tests may use a resource at once, given as "tag: limit" pairs
+ * 
+ * Example: TEST_RESOURCE_LIMITS(mem-heavy: 2, port-8080: 1)
+ * 
+ * \sa TEST_RESOURCES
+ */
+#define TEST_RESOURCE_LIMITS(...) \
+        INTERNAL_SSTEST_RESOURCE_LIMITS(__VA_ARGS__)
+
+/**
+ * \def TEST_INPUTS
+ * \brief Declare the files a test or suite reads, so a result cached by --cache-file is only used while they are unchanged
+ * 
+ * No definition or body is required. May be declared in any translation unit, before or after the tests it names.
+ * 
+ * The first parameter names a test or suite as in TEST_DEPENDS_ON, the remaining parameters are paths as string literals, relative to the 
+ * working directory of the test program. Paths may not contain commas.
+ * 
+ * Example: TEST_INPUTS(parser::load, "data/config.json", "data/schema.json")
+ */
+#define TEST_INPUTS(name, ...) \
+        INTERNAL_SSTEST_INPUTS(name, __VA_ARGS__)
+
 
 
 #endif // _SSTEST_INCLUDE_H_
\ No newline at end of file
@@ -0,0 +1,139 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#ifndef _SSTEST_JOURNAL_H_
+#define _SSTEST_JOURNAL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest_config.h"
+#include "sstest_summary.h"
+
+/**
+ * \file sstest_journal.h
+ * \brief Contains the test journal, which keeps the result of each test as soon as it finishes so an interrupted run can be resumed
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Appends test records to a file as tests finish, in the format of writeTestRecords(). Writes go to the file right away, so 
+     * they survive the process dying, and are synced to disk in batches, so they survive the machine going down without syncing after 
+     * every test. A batch is synced once enough records are waiting, or after a short time on a background thread
+     * 
+     */
+    class TestJournal
+    {
+    public:
+
+        static constexpr size_t sync_batch_size = 64; // records written before they are synced right away
+        static constexpr std::chrono::milliseconds::rep sync_interval_ms = 1000; // longest time a written record waits to be synced
+
+        TestJournal() noexcept;
+
+        TestJournal(const TestJournal&) = delete;
+        TestJournal& operator=(const TestJournal&) = delete;
+
+        /**
+         * \brief Syncs and closes the file if open
+         * 
+         */
+        ~TestJournal();
+
+        /**
+         * \brief Read the records of a journal. A line cut off by the process dying while writing it, and anything after it, is ignored
+         * 
+         * \param path 
+         * \param records Set to the records read
+         * \return true If the file was read
+         * \return false If the file could not be opened, or is not a journal
+         */
+        static bool read(const std::string& path, std::vector<TestRecord>& records);
+
+        /**
+         * \brief Start writing to a journal. When resuming, records are appended after the ones read by read(), else the file is started over
+         * \throw Exception if the file can't be written
+         * 
+         * \param path 
+         * \param resume 
+         */
+        void open(const std::string& path, bool resume);
+
+        /**
+         * \brief Append the record of a finished test. Safe to call from multiple threads
+         * \throw Exception if the record can't be written
+         * 
+         * \param record 
+         */
+        void append(const TestRecord& record);
+
+        /**
+         * \brief Sync all written records to disk
+         * 
+         */
+        void sync();
+
+        /**
+         * \brief Sync and close the file, the journal can then be opened again
+         * 
+         */
+        void close();
+
+        /**
+         * \brief Check if the journal is open for writing
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool isOpen() const noexcept;
+
+    private:
+
+        // sync the file with the lock held, which is released while waiting for the disk so appending can go on
+        void syncLocked(std::unique_lock<std::mutex>& lock);
+
+        std::string path;
+        int fd; // -1 when closed
+        size_t unsynced; // records written since the last sync
+        bool closing;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::thread syncer;
+    };
+
+}
+
+#endif // _SSTEST_JOURNAL_H_
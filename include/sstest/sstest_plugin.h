@@ -0,0 +1,120 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#ifndef _SSTEST_PLUGIN_H_
+#define _SSTEST_PLUGIN_H_
+
+#include <cstdint>
+#include <string>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_plugin.h
+ * \brief Contains test plugins, shared libraries of tests loaded into a running program, which can be loaded again once rebuilt
+ * 
+ */
+
+namespace sstest
+{
+    class TestRegistry;
+
+    /**
+     * \brief Loads the tests of a shared library with dlopen, registering them in a registry of their own instead of the one of the 
+     * program, so they can be run with TestRunner::swapRegistry() and unloaded along with their library. The library must use the 
+     * sstest of the program, i.e. not link sstest itself, and the program must export all of sstest, e.g. sstest_host.
+     * POSIX only
+     * 
+     */
+    class TestPlugin
+    {
+    public:
+
+        /**
+         * \brief Load a library and register its tests. The library is loaded from a copy, so it can be rebuilt while loaded, and 
+         * loaded again by another TestPlugin once it has been
+         * \throw Exception if the library can't be loaded
+         * 
+         * \param path 
+         */
+        explicit TestPlugin(const std::string& path);
+
+        TestPlugin(const TestPlugin&) = delete;
+        TestPlugin& operator=(const TestPlugin&) = delete;
+
+        /**
+         * \brief Destroy the tests of the library, then unload it
+         * 
+         */
+        ~TestPlugin();
+
+        /**
+         * \brief Path the library was loaded from
+         * 
+         * \return const std::string& 
+         */
+        const std::string& path() const noexcept;
+
+        /**
+         * \brief The tests registered by the library
+         * 
+         * \return TestRegistry& 
+         */
+        TestRegistry& registry() noexcept;
+
+        /**
+         * \brief Check if the library at path() was replaced or written to since it was loaded, e.g. rebuilt. A missing library, e.g. 
+         * while it is being rebuilt, has not changed
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool changed() const;
+
+    private:
+
+        // identifies a version of the library file
+        struct Stamp
+        {
+            uint64_t device;
+            uint64_t inode;
+            uint64_t size;
+            int64_t modified_ns;
+        };
+
+        static bool stamp(const std::string& path, Stamp& stamp);
+
+        std::string library_path;
+        Stamp loaded;
+        TestRegistry* tests;
+        void* handle;
+    };
+
+}
+
+#endif // _SSTEST_PLUGIN_H_
@@ -0,0 +1,197 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_POOL_H_
+#define _SSTEST_POOL_H_
+
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <vector>
+#include "sstest_config.h"
+#include "sstest_affinity.h"
+
+/**
+ * \file sstest_pool.h
+ * \brief Contains a work stealing thread pool used by the test runner to run tests in parallel
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Fixed size pool of worker threads, where each worker owns a queue of tasks.
+     * A worker takes tasks from the front of its own queue, and when it runs out, steals from the back of another worker's queue.
+     * With adaptWorkers(), only some of the workers take tasks at a time, as many as keep the CPUs busy.
+     * 
+     */
+    class WorkStealingPool
+    {
+    public:
+
+        /**
+         * \brief A task to run on the pool, which is given the index of the worker running it
+         * 
+         */
+        typedef std::function<void(size_t)> task_type;
+
+        /**
+         * \brief Create a pool with the given number of workers. Threads are not started until run()
+         * 
+         * \param nworkers Number of workers, if 0 uses hardwareConcurrency()
+         * \param stealing If false, each worker only runs the tasks submitted to it, so which worker runs a task doesn't depend on timing
+         */
+        explicit WorkStealingPool(size_t nworkers, bool stealing = true);
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        ~WorkStealingPool();
+
+        /**
+         * \brief Return the number of workers in the pool
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Add a task to the back of a worker's queue. May be called before run(), or from a running task
+         * 
+         * \param worker Index of the worker queue to add to, wraps around if >= size()
+         * \param task 
+         */
+        void submit(size_t worker, task_type task);
+
+        /**
+         * \brief Let the pool change how many of its workers take tasks while it runs, to keep the given number of CPUs busy without 
+         * oversubscribing them. Starts with one worker per CPU, then checks the CPU time the process used every 100 ms. While tasks are 
+         * queued and CPUs are left idle, e.g. because tasks block on sockets or files, more workers take tasks. While the CPUs are busy 
+         * with more workers than CPUs, fewer do. A worker that stops taking tasks finishes its task, and its queue is stolen by the others.
+         * Only on POSIX and with stealing, otherwise every worker takes tasks. Call before run()
+         * 
+         * \param ncpus Number of CPUs to keep busy, e.g. hardwareConcurrency()
+         */
+        void adaptWorkers(size_t ncpus);
+
+        /**
+         * \brief Pin each worker thread to CPUs as it starts, see CpuTopology::placement(). Only on Linux. Call before run()
+         * 
+         * \param placement CPUs of worker i at index i, wrapping around if shorter than size(). Empty to not pin
+         */
+        void pinWorkers(std::vector<CpuSet> placement);
+
+        /**
+         * \brief Set a function each worker thread runs once no tasks are left, before run() returns, e.g. to clean up state kept per worker.
+         * If it throws, run() rethrows like for a task. Call before run()
+         * 
+         * \param exit Given the index of the worker
+         */
+        void setWorkerExit(task_type exit);
+
+        /**
+         * \brief Return the most workers that took tasks at once in the last run(), which is size() unless adapting
+         * 
+         * \return size_t 
+         */
+        size_t peakWorkers() const noexcept;
+
+        /**
+         * \brief Start the workers and block until every task, including tasks submitted while running, has finished
+         * \note If a task throws, the remaining tasks are still run and the first exception is rethrown
+         * 
+         */
+        void run();
+
+        /**
+         * \brief Return the number of CPUs this process may use: the hardware threads in its CPU affinity mask, at most the CPU quota of 
+         * its cgroup rounded up, or 1 if it cannot be determined
+         * 
+         * \return size_t 
+         */
+        static size_t hardwareConcurrency() noexcept;
+
+        /**
+         * \brief Return the CPU quota of the cgroup of this process rounded up to whole CPUs, i.e. the smallest quota of it and its parents
+         * with cgroup v2, or of its cpu controller with cgroup v1. 0 if there is no quota or no cgroups, e.g. when not on Linux
+         * 
+         * \param root Directory the paths /proc/self/cgroup and /sys/fs/cgroup are read under, e.g. to read a copy of them
+         * \return size_t 
+         */
+        static size_t cgroupCpuLimit(const std::string& root = "");
+
+    private:
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        void workerLoop(size_t id);
+        void adaptLoop();
+        bool active(size_t id) const noexcept;
+
+        bool pop(size_t id, task_type& task);
+
+        bool steal(size_t id, task_type& task);
+
+        bool hasTasks(size_t id);
+
+        void finishTask();
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        const bool stealing;
+
+        std::atomic<size_t> queued;
+        std::atomic<size_t> pending;
+        size_t adapt_cpus; // 0 if every worker takes tasks
+        std::vector<CpuSet> worker_cpus; // empty if workers are not pinned
+        task_type worker_exit;
+        std::atomic<size_t> nactive; // workers with an index below this take tasks
+        std::atomic<size_t> npeak;
+        bool done; // guarded by idle_mutex, set once every worker has returned
+
+        std::mutex idle_mutex;
+        std::condition_variable idle_cv;
+        std::condition_variable adapt_cv; // wakes the thread adapting the number of active workers, with idle_mutex
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+}
+
+#endif // _SSTEST_POOL_H_
@@ -0,0 +1,204 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_PROCESS_H_
+#define _SSTEST_PROCESS_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "sstest_config.h"
+#include "sstest_affinity.h"
+
+/**
+ * \file sstest_process.h
+ * \brief Contains a pool of forked worker processes used by the test runner to isolate crashing tests
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Pool of worker processes forked from the calling process. Tasks are identified by index and handed out
+     * one at a time over a pipe to whichever worker is idle. Each worker sends a message back to the parent when it finishes a task.
+     * If a worker dies while running a task, the task is reported as crashed and the worker is replaced with a new fork.
+     * \note Only supported on POSIX platforms, see supported()
+     * 
+     */
+    class ProcessPool
+    {
+    public:
+
+        /**
+         * \brief Runs in a worker process: run the task with the given index and return a message for the parent
+         * 
+         */
+        typedef std::function<std::string(size_t)> work_type;
+
+        /**
+         * \brief Runs in the parent process: called with the task index and the message returned by work_type
+         * 
+         */
+        typedef std::function<void(size_t, const std::string&)> finish_type;
+
+        /**
+         * \brief Runs in the parent process: called with the task index and the wait status of the worker that died, see describeStatus()
+         * 
+         */
+        typedef std::function<void(size_t, int)> crash_type;
+
+        /**
+         * \brief Runs in the parent process: set the index of the next task to run and return true, or return false if no task is ready.
+         * Called again for each idle worker whenever a task finishes or crashes, so tasks may become ready as others finish
+         * 
+         */
+        typedef std::function<bool(size_t&)> next_type;
+
+        /**
+         * \brief Runs in each worker process once the parent has no more tasks for it, right before it exits
+         * 
+         */
+        typedef std::function<void()> exit_type;
+
+        /**
+         * \brief Create a pool with the given number of workers. Processes are not forked until run()
+         * 
+         * \param nworkers Number of workers, if 0 uses WorkStealingPool::hardwareConcurrency()
+         */
+        explicit ProcessPool(size_t nworkers);
+
+        ProcessPool(const ProcessPool&) = delete;
+        ProcessPool& operator=(const ProcessPool&) = delete;
+
+        ~ProcessPool();
+
+        /**
+         * \brief Return the number of workers in the pool
+         * 
+         * \return size_t 
+         */
+        size_t size() const noexcept;
+
+        /**
+         * \brief Pin each worker process to CPUs once it is forked, see CpuTopology::placement(). Only on Linux. Call before run()
+         * 
+         * \param placement CPUs of worker i at index i, wrapping around if shorter than size(). Empty to not pin
+         */
+        void pinWorkers(std::vector<CpuSet> placement);
+
+        /**
+         * \brief Set a function each worker process runs before it exits once the parent has no more tasks for it, e.g. to clean up state 
+         * kept per worker. Not run by a worker that crashed, or that is stopped because a task timed out. Call before run()
+         * 
+         * \param exit 
+         */
+        void setWorkerExit(exit_type exit);
+
+        /**
+         * \brief Fork the workers and run tasks 0 to ntasks - 1, blocking until all have finished or crashed
+         * \throw Exception if the platform is not supported, or a process or pipe could not be created
+         * 
+         * \param ntasks 
+         * \param work 
+         * \param finish 
+         * \param crash 
+         */
+        void run(size_t ntasks, work_type work, finish_type finish, crash_type crash);
+
+        /**
+         * \brief Fork the workers and run tasks as they are handed out by next, blocking until no task is running and next has no task ready
+         * \throw Exception if the platform is not supported, or a process or pipe could not be created
+         * 
+         * \param next 
+         * \param work 
+         * \param finish 
+         * \param crash 
+         */
+        void run(next_type next, work_type work, finish_type finish, crash_type crash);
+
+        /**
+         * \brief Stop handing out tasks, so run() returns once the tasks already running have finished. Tasks that were not started
+         * are not reported to any callback. Meant to be called from the finish or crash callback
+         * 
+         */
+        void stop() noexcept;
+
+        /**
+         * \brief Return a description of why a worker died, e.g. "killed by signal 11 (Segmentation fault)"
+         * 
+         * \param status Wait status given to crash_type
+         * \return std::string 
+         */
+        static std::string describeStatus(int status);
+
+        /**
+         * \brief Check if a worker exited normally with the given exit code
+         * 
+         * \param status Wait status given to crash_type
+         * \param code 
+         * \return true 
+         * \return false 
+         */
+        static bool exitedWith(int status, int code) noexcept;
+
+        /**
+         * \brief Check if process pools are supported on this platform
+         * 
+         * \return true 
+         * \return false 
+         */
+        static bool supported() noexcept;
+
+    private:
+
+        struct Worker
+        {
+            int pid;
+            int task_fd; // parent writes task indices
+            int result_fd; // parent reads messages
+            bool busy;
+            size_t task;
+        };
+
+        void spawn(Worker& worker, const work_type& work);
+
+        void assign(Worker& worker, size_t task);
+
+        void retire(Worker& worker);
+
+        std::vector<Worker> workers;
+        std::vector<CpuSet> worker_cpus; // empty if workers are not pinned
+        exit_type worker_exit;
+        bool stopping;
+    };
+
+}
+
+#endif // _SSTEST_PROCESS_H_
@@ -68,6 +68,65 @@ namespace sstest
         TestRegistrar(const StringView& suite_name, const TestFunction&);
     };
 
+    /**
+     * \brief Object for which the constructor declares that a test or suite depends on other tests or suites
+     * \sa TestRegistry::addDependency()
+     * 
+     */
+    class DependencyRegistrar
+    {
+    public:
+        /**
+         * \brief Declare dependencies given as text, such as the stringized arguments of a macro
+         * 
+         * \param dependent Test identifier or suite name. Whitespace is ignored
+         * \param prerequisites Comma separated test identifiers or suite names. Whitespace is ignored
+         */
+        DependencyRegistrar(const char* dependent, const char* prerequisites);
+    };
+
+    /**
+     * \brief Object for which the constructor declares the resources used by a test or suite, or how many tests may use a resource at once
+     * \sa TestRegistry::addResourceTag()
+     * \sa TestRegistry::setResourceLimits()
+     * 
+     */
+    class ResourceRegistrar
+    {
+    public:
+        /**
+         * \brief Declare resources given as text, such as the stringized arguments of a macro
+         * 
+         * \param name Test identifier or suite name. Whitespace is ignored
+         * \param tags Comma separated resource tags. Whitespace is ignored
+         */
+        ResourceRegistrar(const char* name, const char* tags);
+
+        /**
+         * \brief Declare resource limits given as text, as comma separated "tag: limit" pairs
+         * 
+         * \param limits 
+         */
+        explicit ResourceRegistrar(const char* limits);
+    };
+
+    /**
+     * \brief Object for which the constructor declares the files a test or suite reads, which key its cached result
+     * \sa TestRegistry::addTestInput()
+     * 
+     */
+    class InputRegistrar
+    {
+    public:
+        /**
+         * \brief Declare input files given as text, such as the stringized arguments of a macro
+         * 
+         * \param name Test identifier or suite name. Whitespace is ignored
+         * \param paths Comma separated paths, each may be a quoted string. Whitespace around each path is ignored
+         */
+        InputRegistrar(const char* name, const char* paths);
+    };
+
 #include "sstest_info.h"
 #include "sstest_test.h"
 
@@ -146,6 +205,7 @@ namespace sstest
             template <typename T> \
             struct INTERNAL_SSTEST_TEST_NAME(template_class, template_name)<T, typename std::enable_if<::sstest::is_complete_type<T>::value && std::is_class<T>::value>::type> \
                 : public T { \
+                typedef T sstest_suite_type; \
                 void operator()(__VA_ARGS__); \
             }; \
         } \
@@ -170,25 +230,17 @@ namespace sstest
         INTERNAL_SSTEST_SUPPRESS_WARNINGS_BEGIN \
         struct test_class; \
         namespace { \
-            template <typename T, typename X = void> \
-            struct INTERNAL_SSTEST_TEST_NAME(test_class, test_function) { \
-                void operator()(); \
-            }; \
-            \
-            template <typename T> \
-            struct INTERNAL_SSTEST_TEST_NAME(test_class, test_function)<T, typename std::enable_if<::sstest::is_complete_type<T>::value && std::is_class<T>::value>::type> \
-                : public T { \
+            struct INTERNAL_SSTEST_TEST_NAME(test_class, test_function) : public ::sstest::SuiteTest<test_class> { \
                 void operator()(); \
             }; \
             ::sstest::TestRegistrar INTERNAL_SSTEST_UNIQUE_NAME(test_name, __LINE__, __COUNTER__) (#test_class, ::sstest::TestFunction( \
                 ::sstest::TestInfo(#test_class "::" #test_function), \
                 ::sstest::LineInfo(__FILE__, __LINE__), \
-                ::sstest::TestInterface::createTestInvoker(INTERNAL_SSTEST_TEST_NAME(test_class, test_function)<test_class> ()) \
+                ::sstest::TestInterface::createTestInvoker(INTERNAL_SSTEST_TEST_NAME(test_class, test_function)()) \
                 )); \
         } \
         INTERNAL_SSTEST_SUPPRESS_WARNINGS_END \
-        template <> \
-        void INTERNAL_SSTEST_TEST_NAME(test_class, test_function)<test_class> ::operator()()
+        void INTERNAL_SSTEST_TEST_NAME(test_class, test_function)::operator()()
         
 
 #define INTERNAL_SSTEST_TEST_0() \
@@ -221,6 +273,34 @@ namespace sstest
 
 #define INTERNAL_SSTEST_DEFINE_TEST(...) VA_SELECT( INTERNAL_SSTEST_TEST, __VA_ARGS__ )
 
+#define INTERNAL_SSTEST_DEPENDS_ON(dependent, ...) \
+        namespace {  \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_BEGIN \
+            ::sstest::DependencyRegistrar INTERNAL_SSTEST_UNIQUE_NAME(sstest_dependency, __LINE__, __COUNTER__) (#dependent, #__VA_ARGS__); \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_END \
+        }
+
+#define INTERNAL_SSTEST_RESOURCES(name, ...) \
+        namespace {  \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_BEGIN \
+            ::sstest::ResourceRegistrar INTERNAL_SSTEST_UNIQUE_NAME(sstest_resource, __LINE__, __COUNTER__) (#name, #__VA_ARGS__); \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_END \
+        }
+
+#define INTERNAL_SSTEST_RESOURCE_LIMITS(...) \
+        namespace {  \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_BEGIN \
+            ::sstest::ResourceRegistrar INTERNAL_SSTEST_UNIQUE_NAME(sstest_resource_limit, __LINE__, __COUNTER__) (#__VA_ARGS__); \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_END \
+        }
+
+#define INTERNAL_SSTEST_INPUTS(name, ...) \
+        namespace {  \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_BEGIN \
+            ::sstest::InputRegistrar INTERNAL_SSTEST_UNIQUE_NAME(sstest_input, __LINE__, __COUNTER__) (#name, #__VA_ARGS__); \
+            INTERNAL_SSTEST_SUPPRESS_WARNINGS_END \
+        }
+
 #define INTERNAL_SSTEST_TEST_PARAMETERIZED_TEMPLATE(...) INTERNAL_SSTEST_TEST_TEMPLATE_VA( __VA_ARGS__ )
 
 #define INTERNAL_SSTEST_TEST_PARAMETERIZED(...) INTERNAL_SSTEST_USE_TEST_TEMPLATE_VA( __VA_ARGS__ )
@@ -29,7 +29,9 @@
 #ifndef _SSTEST_REGISTRY_H_
 #define _SSTEST_REGISTRY_H_
 
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "sstest_test.h"
 #include "sstest_string.h"
@@ -64,9 +66,125 @@ namespace sstest
 
         std::vector<TestSuite*> getTestCases(bool include_empty = false, sstest_case_comparator cmp = nullptr) noexcept;
 
+        /**
+         * \brief Declare that a test or all tests of a suite may only run after another test or suite has passed. 
+         * Names are resolved when tests are run, as a test identifier first and otherwise as a suite name
+         * \sa TestInterface::identifier()
+         * 
+         * \param dependent 
+         * \param prerequisite 
+         */
+        void addDependency(const StringView& dependent, const StringView& prerequisite);
+
+        /**
+         * \brief Return every declared dependency as pairs of (dependent, prerequisite) names, in order of declaration
+         * 
+         * \return const std::vector<std::pair<std::string, std::string>>& 
+         */
+        const std::vector<std::pair<std::string, std::string>>& getDependencies() const noexcept;
+
+        /**
+         * \brief Declare that a test or all tests of a suite use a resource, such as a port or a file, which only a limited number of tests 
+         * may use at once when running in parallel. The tag "exclusive" means the tests may only run while no other test runs.
+         * Names are resolved like dependencies
+         * \sa addDependency()
+         * \sa setResourceLimit()
+         * 
+         * \param name 
+         * \param tag 
+         */
+        void addResourceTag(const StringView& name, const StringView& tag);
+
+        /**
+         * \brief Return every declared resource tag as pairs of (test or suite name, tag), in order of declaration
+         * 
+         * \return const std::vector<std::pair<std::string, std::string>>& 
+         */
+        const std::vector<std::pair<std::string, std::string>>& getResourceTags() const noexcept;
+
+        /**
+         * \brief Set how many tests may use a resource at once, replacing any limit set before
+         * \throw InvalidArgument if the tag is empty or "exclusive", or the limit is 0
+         * 
+         * \param tag 
+         * \param limit 
+         */
+        void setResourceLimit(const StringView& tag, size_t limit);
+
+        /**
+         * \brief Set resource limits given as text, as comma separated "tag: limit" pairs, e.g. "mem-heavy: 2, port-8080: 1". 
+         * Whitespace is ignored, and "=" may be used instead of ":"
+         * \throw InvalidArgument if the text is malformed
+         * \sa setResourceLimit()
+         * 
+         * \param limits 
+         */
+        void setResourceLimits(const StringView& limits);
+
+        /**
+         * \brief Return how many tests may use a resource at once, which is 1 unless set otherwise
+         * 
+         * \param tag 
+         * \return size_t 
+         */
+        size_t getResourceLimit(const StringView& tag) const;
+
+        /**
+         * \brief Declare that a test or all tests of a suite read a file, so a cached result of the test is only used while the file 
+         * is unchanged. Names are resolved like dependencies
+         * \sa addDependency()
+         * 
+         * \param name 
+         * \param path Path of the file, relative to the working directory of the test program
+         */
+        void addTestInput(const StringView& name, const StringView& path);
+
+        /**
+         * \brief Return every declared input file as pairs of (test or suite name, path), in order of declaration
+         * 
+         * \return const std::vector<std::pair<std::string, std::string>>& 
+         */
+        const std::vector<std::pair<std::string, std::string>>& getTestInputs() const noexcept;
+
+        /**
+         * \brief Keep the errors of registrars, e.g. a test name given twice, instead of throwing them. For a registry filled while a 
+         * shared library is loaded, where an exception leaving a static initializer terminates the program
+         * \sa getRegistrationErrors()
+         * 
+         */
+        void deferRegistrationErrors() noexcept;
+
+        /**
+         * \brief Check if errors of registrars are kept instead of thrown
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool defersRegistrationErrors() const noexcept;
+
+        /**
+         * \brief Keep the error of a registrar, to be reported once registration is done
+         * 
+         * \param error 
+         */
+        void addRegistrationError(const std::string& error);
+
+        /**
+         * \brief Return the errors of registrars kept since deferRegistrationErrors(), in the order they happened
+         * 
+         * \return const std::vector<std::string>& 
+         */
+        const std::vector<std::string>& getRegistrationErrors() const noexcept;
+
     private:
         // map of name of test suite to test functions in each suite
         std::unordered_map<const StringView, TestSuite*> test_map;
+        std::vector<std::pair<std::string, std::string>> dependencies;
+        std::vector<std::pair<std::string, std::string>> resource_tags;
+        std::unordered_map<std::string, size_t> resource_limits;
+        std::vector<std::pair<std::string, std::string>> test_inputs;
+        bool defer_errors;
+        std::vector<std::string> registration_errors;
     };
 
 
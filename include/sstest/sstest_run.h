@@ -51,7 +51,7 @@ namespace testing
 #define SSTEST_FAILURE EXIT_FAILURE
 
     /**
-     * \brief Get exit code from test results
+     * \brief Get exit code from test results. Tests that did not pass only fail the run if they are not quarantined
      * 
      * \param totals 
      * \return int 
@@ -60,9 +60,53 @@ namespace testing
 
     /**
      * \brief Configure the test environment given sstest command line arguments
-     * See implemenmtation of command line parsing for more details TODO
-     * TODO !!! for now, this does nothing
+     * Arguments not recognized by sstest are ignored. Recognized options:
+     * - --jobs, -j N : run tests on N worker threads (0 for one per available CPU, auto to follow the CPU use of the tests, 1 to run serially)
+     * - --isolate : run tests in forked worker processes (--jobs of them), reporting a test that crashes its process as CRASH
+     * - --pin cpu|node : pin each worker thread or process to one CPU, or to the CPUs of one NUMA node, spreading workers over the nodes
+     * - --reserve-cpus LIST : don't run tests on the given CPUs, e.g. 0-1,8, so benchmarks can have them to themselves
+     * - --total-shards N, --shard-index I : run only shard I (0-based) of the tests split into N disjoint shards.
+     *   Defaults to the SSTEST_TOTAL_SHARDS and SSTEST_SHARD_INDEX environment variables if set
+     * - --history-file PATH : file to keep test durations in between runs, used to start the longest tests first. Defaults to the 
+     *   SSTEST_HISTORY_FILE environment variable if set, else the program path with ".history" appended. An empty path keeps no history.
+     *   When sharding, no history is kept unless a file is given, since every shard must see the same history to agree on the split
+     * - --results-file PATH : write the result of each test to a file, which can be combined with the results of other shards by sstest_merge
+     * - --timeout MS : mark a test that runs longer than MS milliseconds as TIMEOUT, printing the stacks of all threads
+     * - --global-timeout MS : abort the run if all tests take longer than MS milliseconds, printing the stacks of all threads
+     * - --time-budget MS : run only the tests most likely to fail, according to the history file, that fit in MS milliseconds, most 
+     *   likely first. Tests left out are counted in TestTotals::test_functions_over_budget
+     * - --on-timeout continue|abort : after a test times out, continue with the remaining tests or abort the run. Defaults to continue 
+     *   with --isolate, else abort, since a test running on a thread can't be stopped
+     * - --fail-fast : stop the run at the first failed test, same as --max-failures 1
+     * - --max-failures N : stop the run once N tests have failed. Tests already running finish, the rest are reported as skipped
+     * - --max-tests N : stop the run once N tests have finished. The tests skipped then don't fail the run
+     * - --max-assertions N : stop the run once N assertions have been checked. The tests skipped then don't fail the run
+     * - --failed-first : run the tests that failed last run, according to the history file, before the other tests
+     * - --last-failed : run only the tests that failed last run, or all tests if none did
+     * - --shuffle : run suites, and tests within each suite, in a random order. The seed is printed before tests run
+     * - --seed N : shuffle with the given seed, to repeat the order and worker assignment of an earlier run. Implies --shuffle
+     * - --repeat N : run each test N times, spread across the workers, and print the pass rate and durations of each test
+     * - --until-fail : stop the run at the first failed run of a test. Repeats each test 1000 times unless --repeat is given
+     * - --retries K : run a test that did not pass up to K more times, right away on an idle worker. A test that passes on a retry is FLAKY
+     * - --batch US : run tests that took less than US microseconds last run in batches, and report the ones passing without output in one line per batch
+     * - --check-reset : after each test on a reused fixture (see testing::reuse_fixture), fail it if Reset() did not restore the fixture 
+     *   to a new copy, compared with operator==, so state would leak into the next test
+     * - --quarantine-file PATH : file listing test identifiers, one per line, whose failures are reported but don't fail the run
+     * - --cache-file PATH : file keeping tests that passed. They are reported CACHED without running while the program and their TEST_INPUTS are unchanged
+     * - --journal PATH : append the result of each test to a file as soon as it finishes, synced to disk in batches
+     * - --resume : run only the tests without a result in the --journal of an interrupted run, and report the journaled results of the others
+     * - --test-list PATH : run only the tests listed in a file, one identifier per line
+     * - --filter PATTERNS : run only the tests whose identifier matches one of the comma separated patterns, where * matches any 
+     *   characters and ? any one character
+     * - --list-tests : print the identifier of every test, one per line after a "# sstest test list" line, instead of running them
+     * - --serve SOCKET : instead of running tests, listen on a Unix domain socket and run the tests of each request sent by 
+     *   sstest::TestServer::request(), with the options of the request after these options. Runs until sstest::TestServer::shutdown()
+     * - --impact-index PATH : file keeping which source files each test ran, for --collect-impact and --changed-files
+     * - --collect-impact : record the source files each test runs in the impact index. Needs sstest built with SSTEST_COVERAGE
+     * - --changed-files PATH : file listing changed source files, one per line. Only tests the impact index says are affected are run
+     * - --resource-limit TAG:N[,TAG:N...] : let at most N tests using resource TAG run at once, replacing TEST_RESOURCE_LIMITS. May be repeated
      * 
+     * \throw ::sstest::InvalidArgument if a recognized option has a missing or malformed value
      * \param argc 
      * \param argv 
      */
@@ -70,7 +114,8 @@ namespace testing
 
     /**
      * \brief Run tests with options specified in command line arguments 
-     * If there are no additional arguments, is equivalent to RunAllTests()
+     * If there are no additional arguments, is equivalent to RunAllTests(). If an option is malformed, prints why with the usage 
+     * to stderr and returns SSTEST_FAILURE without running tests
      * \sa Configure()
      * \sa RunAllTests()
      * 
@@ -29,17 +29,24 @@
 #ifndef _SSTEST_RUNNER_H_
 #define _SSTEST_RUNNER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <functional>
 #include <sstream>
+#include <memory>
+#include <mutex>
 #include "sstest_traits.h"
 #include "sstest_printer.h"
 #include "sstest_test.h"
 #include "sstest_registry.h"
 #include "sstest_assertion.h"
 #include "sstest_summary.h"
+#include "sstest_history.h"
+#include "sstest_coverage.h"
 #include "sstest_console.h"
 #include "sstest_compare.h"
+#include "sstest_affinity.h"
 
 
 // TODO malloc/realloc/free hook to detect leaks
@@ -56,6 +63,9 @@ namespace sstest
 
     class Stopwatch;
     class Registry;
+    class Watchdog;
+    class TestJournal;
+    class TestGraph;
     struct TestSummary;
 
     /**
@@ -67,6 +77,17 @@ namespace sstest
     {
     
     public:
+        /**
+         * \brief What the run does after a test times out
+         * 
+         */
+        enum class TimeoutPolicy
+        {
+            DEFAULT, // ABORT, unless tests run in worker processes, which can be stopped, then CONTINUE
+            CONTINUE, // mark the test TIMEOUT and go on with the remaining tests. Without worker processes, only once the test returns
+            ABORT // stop the run at the first test that times out
+        };
+
                 // struct for storing test runner settings
         struct Configuration
         {
@@ -76,7 +97,42 @@ namespace sstest
                 expand_args_assertion_pass(false),
                 expand_args_assertion_fail(false),
                 max_assertions(0),
-                max_tests(0)
+                max_tests(0),
+                jobs(1),
+                isolate(false),
+                shard_index(0),
+                total_shards(1),
+                history_file(),
+                results_file(),
+                timeout(0),
+                global_timeout(0),
+                time_budget(0),
+                on_timeout(TimeoutPolicy::DEFAULT),
+                max_failures(0),
+                failed_first(false),
+                only_failed(false),
+                shuffle(false),
+                shuffle_seed(0),
+                repeat(1),
+                until_fail(false),
+                retries(0),
+                quarantine_file(),
+                impact_file(),
+                collect_impact(false),
+                changed_files(),
+                cache_file(),
+                executable(),
+                journal_file(),
+                resume(false),
+                test_list(),
+                filter(),
+                list_tests(false),
+                serve_socket(),
+                batch(0),
+                adaptive_jobs(false),
+                pin(),
+                reserved_cpus(),
+                check_reset(false)
             {}
 
             constexpr Configuration(bool show_assertion_pass, bool show_assertion_fail, bool expand_args_assertion_pass, bool expand_args_assertion_fail) 
@@ -85,7 +141,42 @@ namespace sstest
                 expand_args_assertion_pass(expand_args_assertion_pass),
                 expand_args_assertion_fail(expand_args_assertion_fail),
                 max_assertions(0),
-                max_tests(0)
+                max_tests(0),
+                jobs(1),
+                isolate(false),
+                shard_index(0),
+                total_shards(1),
+                history_file(),
+                results_file(),
+                timeout(0),
+                global_timeout(0),
+                time_budget(0),
+                on_timeout(TimeoutPolicy::DEFAULT),
+                max_failures(0),
+                failed_first(false),
+                only_failed(false),
+                shuffle(false),
+                shuffle_seed(0),
+                repeat(1),
+                until_fail(false),
+                retries(0),
+                quarantine_file(),
+                impact_file(),
+                collect_impact(false),
+                changed_files(),
+                cache_file(),
+                executable(),
+                journal_file(),
+                resume(false),
+                test_list(),
+                filter(),
+                list_tests(false),
+                serve_socket(),
+                batch(0),
+                adaptive_jobs(false),
+                pin(),
+                reserved_cpus(),
+                check_reset(false)
             {}
 
             static const Configuration default_settings;
@@ -108,9 +199,43 @@ namespace sstest
             bool show_assertion_fail;
             bool expand_args_assertion_pass;
             bool expand_args_assertion_fail;
-            size_t max_assertions;
-            size_t max_tests;
-            //size_t timeout;
+            size_t max_assertions; // stop the run once this many assertions have been checked, 0 for no limit
+            size_t max_tests; // stop the run once this many tests have finished, 0 for no limit
+            size_t jobs; // number of worker threads to run tests on, 0 to use one per available CPU, or 1 to run serially
+            bool isolate; // run tests in forked worker processes instead of threads, so a crashing test can't take down the run
+            size_t shard_index; // which shard of the tests to run, in [0, total_shards)
+            size_t total_shards; // number of shards to split tests into, 1 to run all tests
+            StringView history_file; // file to keep test durations in between runs, used to run long tests first. Empty to not keep history
+            StringView results_file; // file to write the result of each test to after running, which can be merged with other runs. Empty to not write
+            size_t timeout; // milliseconds a single test may run before it is marked TIMEOUT, 0 for no limit
+            size_t global_timeout; // milliseconds all tests together may run before the run is aborted, 0 for no limit
+            size_t time_budget; // milliseconds the run should take, only the tests most likely to fail that fit in it are run. 0 to run all
+            TimeoutPolicy on_timeout; // whether to stop the run at the first test that times out, or continue with the remaining tests
+            size_t max_failures; // stop the run once this many tests have failed, 0 for no limit. Tests that were not started are skipped
+            bool failed_first; // run tests that failed the last time they ran, according to the history file, before the other tests
+            bool only_failed; // run only tests that failed the last time they ran, or all tests if none did
+            bool shuffle; // run suites and tests in an order permuted by shuffle_seed, and give tests to workers without stealing so the run can be repeated
+            uint32_t shuffle_seed; // seed of the order when shuffling, printed before tests run
+            size_t repeat; // number of times to run each test, each run in parallel with the others. Results are combined per test
+            bool until_fail; // stop repeating tests once any run of a test fails
+            size_t retries; // times to run a test again after it did not pass. A test that passes on a retry is FLAKY
+            StringView quarantine_file; // file listing identifiers of tests whose failures don't fail the run. Empty for none
+            StringView impact_file; // file keeping which source files each test ran, to run only tests affected by changed_files. Empty for none
+            bool collect_impact; // collect the source files each test runs into impact_file, which needs sstest built with SSTEST_COVERAGE
+            StringView changed_files; // file listing changed source files, to run only the tests impact_file says are affected. Empty to run all
+            StringView cache_file; // file keeping tests that passed, which are reported CACHED while the program and their inputs are unchanged. Empty for none
+            StringView executable; // path of the test program, hashed to key cache_file
+            StringView journal_file; // file the result of each test is appended to as soon as it finishes. Empty for none
+            bool resume; // run only the tests without a result in journal_file, and report the results it has for the others
+            StringView test_list; // file listing the identifiers of the tests to run, one per line. Empty to run all
+            StringView filter; // comma separated patterns, where * matches any characters and ? any one, of the identifiers of the tests to run. Empty to run all
+            bool list_tests; // print the identifier of every test instead of running them
+            StringView serve_socket; // Unix domain socket to serve requests to run tests on, instead of running them. Empty to run tests right away
+            size_t batch; // tests expected to take fewer microseconds than this run in batches, and the ones passing without output are reported together. 0 to not batch
+            bool adaptive_jobs; // change the number of workers running tests while running, to keep the available CPUs busy without oversubscribing them
+            StringView pin; // "cpu" to pin each worker to one CPU, or "node" to the CPUs of one NUMA node, see CpuTopology::placement(). Empty to not pin
+            StringView reserved_cpus; // list of CPUs tests must not run on, e.g. "0-1" kept for benchmarks, in the format of CpuTopology::parseList(). Empty for none
+            bool check_reset; // compare each reused fixture with a new copy after Reset(), failing the test if they differ, see ::testing::reuse_fixture
             //detail level 0,1,2,3 etc
             //bool display_percentages
         };
@@ -166,6 +291,46 @@ namespace sstest
         public:
 
             explicit Reporter(const Logger&, const Configuration&, size_t status_width = MAX_STATUS_WIDTH);
+
+            /**
+             * \brief Create a reporter which buffers output for each logger of the target reporter, until commit() is called.
+             * Used to keep output of one test together when tests run in parallel
+             * 
+             * \param target Reporter to write buffered output to
+             */
+            Reporter(const Reporter& target, const Configuration&);
+
+            Reporter(const Reporter&) = delete;
+            Reporter& operator=(const Reporter&) = delete;
+
+            /**
+             * \brief Write all buffered output to the target reporter and clear the buffers. Safe to call from multiple threads
+             * Does nothing if the reporter was not created with a target
+             * 
+             */
+            void commit();
+
+            /**
+             * \brief Write output captured for each logger, such as by a buffered reporter in another process. Safe to call from multiple threads
+             * 
+             * \param output Output for each logger, in the order loggers were added
+             */
+            void writeBuffered(const std::vector<std::string>& output) const;
+
+            /**
+             * \brief Return the buffered output of each logger and clear the buffers
+             * 
+             * \return std::vector<std::string> 
+             */
+            std::vector<std::string> release();
+
+            /**
+             * \brief Check if no output is buffered. Always true for a reporter which writes right away
+             * 
+             * \return true if there is nothing to commit
+             */
+            bool empty() const;
+
             // return logger id
             size_t addLogger(const Logger&);
 
@@ -193,10 +358,13 @@ namespace sstest
         public:
         
             void reportInitialized() const;
+            void reportPlacement(const std::vector<std::string>& lines) const;
             void reportGlobalBegin(const TestSummary&) const;
             void reportGlobalSummary(const TestSummary&, const std::vector<TestSuite*> = std::vector<TestSuite*>()) const;
             void reportGlobalResult(const TestSummary&, const std::string& info = "") const;
             void reportTestBegin(const TestInterface&) const;
+            // report tests of a batch that passed without output, in one line from the first to the last
+            void reportTestBatch(const TestInterface& first, const TestInterface& last, size_t n) const;
             void reportTestResult(const TestInterface&, const std::string& info = "") const;
             //void reportTestTemplateBegin(const TestTemplate&) const;
             //void reportTestTemplateResult(const TestTemplate&) const;
@@ -331,11 +499,40 @@ namespace sstest
 
             static std::string statusBadge(std::string, size_t width, HorizontalAlignment = HorizontalAlignment::CENTER); // fmt as [ ... ] with given wdith >= strlen + 4 for bracket and spaces
 
+            // buffers are declared before loggers so the loggers, which flush on destruction, go first
+            std::vector<std::unique_ptr<std::stringstream>> buffers;
             std::vector<Logger> loggers;
 
             const Configuration& settings;
 
             size_t status_width;
+
+            const Reporter* target;
+            mutable std::mutex mutex;
+        };
+
+        /**
+         * \brief Swaps another registry into the test runner for as long as it lives, then swaps the one it replaced back, even when 
+         * leaving by an exception
+         * \sa swapRegistry()
+         * 
+         */
+        class ScopedRegistry
+        {
+        public:
+
+            /**
+             * \param registry Not null, must outlive the scope
+             */
+            explicit ScopedRegistry(TestRegistry* registry) noexcept;
+
+            ScopedRegistry(const ScopedRegistry&) = delete;
+            ScopedRegistry& operator=(const ScopedRegistry&) = delete;
+
+            ~ScopedRegistry();
+
+        private:
+            TestRegistry* previous;
         };
 
     public:
@@ -373,6 +570,15 @@ namespace sstest
          */
         TestRegistry& registry();
 
+        /**
+         * \brief Register and run tests in another registry, e.g. one keeping the tests of a plugin apart from those of the program
+         * The runner does not own the registry given, the one returned must be swapped back before the registry given is destroyed
+         * 
+         * \param registry Not null
+         * \return TestRegistry* The registry used until now
+         */
+        TestRegistry* swapRegistry(TestRegistry* registry) noexcept;
+
         /**
          * \brief Access the reporter, which is the main way to send controlled output though the test runner
          * 
@@ -395,6 +601,34 @@ namespace sstest
          */
         TestSummary runTests(std::vector<StringView> test_names);
 
+        /**
+         * \brief Write the identifier of every test registered in the test registry, one per line, without running them. 
+         * Tests are listed in the order of runAllTests() when running serially, and can be run by listing them in Configuration::test_list.
+         * The list starts with a line of test_list_header, so it can be told apart from output of the program before it, e.g. the banner
+         * 
+         * \param os 
+         */
+        void listAllTests(std::ostream& os) const;
+
+        static constexpr const char* test_list_header = "# sstest test list";
+
+        /**
+         * \brief Return the result of each test of the last run, which can be saved with writeTestRecords() and combined with other runs
+         * 
+         * \return const std::vector<TestRecord>& 
+         */
+        const std::vector<TestRecord>& getTestRecords() const noexcept;
+
+        /**
+         * \brief Check if the run was asked to stop early, because the failure, test or assertion limit was reached. 
+         * Tests that have not started will be skipped, so a long running test may poll this to finish early
+         * \sa Configuration::max_failures
+         * 
+         * \return true If the remaining tests will be skipped
+         * \return false Else
+         */
+        bool stopRequested() const noexcept;
+
         /**
          * \brief Report an assertion to the test runner. Without calling this, the test runner would have 
          * no knowledge of an assertion result
@@ -406,9 +640,10 @@ namespace sstest
         template <typename... Args>
         const Assertion<Args...>& reportAssertion(const Assertion<Args...>& assertion)
         {
-            reporter_->reportAssertion(assertion);
-            test_summary.addAssertionResult(assertion);
-            if (assertion.failed()) curr_test->fail();
+            reporter().reportAssertion(assertion);
+            currentSummary().addAssertionResult(assertion);
+            if (assertion.failed()) currentTest()->fail();
+            countAssertions(1, configure());
             return assertion;
         }
 
@@ -423,12 +658,91 @@ namespace sstest
         TestRunner();
         ~TestRunner();
 
+        // state owned by each worker thread when running tests in parallel
+        struct WorkerContext;
+
         TestSummary runTestCasesHelper(const std::vector<TestSuite*> tests);
 
+        // tests are grouped by suite. Each test starts only after its prerequisites in the graph have passed, and is skipped if one didn't
+        void runSerialHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config);
+
+        void runParallelHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config);
+
+        void runIsolatedHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config);
+
+        // which tests may run in a batch: tests expected to be quicker than the batch option, which don't depend on, wait for or hold back 
+        // other tests, and whose result isn't known from an earlier run
+        std::vector<bool> batchableTests(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config) const;
+
+        // run quick tests one after another in a worker context, reporting the ones that pass without output together and the rest as usual. 
+        // The first test always runs, the batch ends early once the run was stopped or the tests ran for longer than a batch should. 
+        // Returns the number of tests that ran
+        size_t runBatch(WorkerContext& context, size_t worker, const std::vector<TestInterface*>& tests, const std::vector<size_t>& batch, 
+            const Configuration& config);
+
+        // flatten the suites into the list of tests to run, weighted by their duration in history. Serial runs keep tests of a suite 
+        // together, parallel runs start the heaviest tests first. Given an impact index, only tests affected by the changed files are 
+        // planned. Given a time budget, only the tests most likely to fail per time they take that fit in it are planned, most likely 
+        // first, and over_budget is set to the number of tests left out. The graph is set to the dependencies between the planned tests
+        std::vector<TestInterface*> planTests(const std::vector<TestSuite*>& suites, const Configuration& config, const TestHistory& history, 
+            const TestImpactIndex* impact, const std::vector<std::string>& changed_files, TestGraph& graph, size_t& over_budget) const;
+
+        // record the duration and result of each test that ran
+        static void recordHistory(const std::vector<TestInterface*>& tests, TestHistory& history);
+
+        // count finished tests and checked assertions towards the limits of the run, and request a stop once one is reached. 
+        // Safe to call from multiple threads
+        void countFinishedTest(const TestInterface& test, const Configuration& config) noexcept;
+        void countAssertions(size_t n, const Configuration& config) noexcept;
+
+        // after a test ran, decide whether to run it again because it did not pass and has retries left. A test that passed after 
+        // failing is marked FLAKY. Sets the info to report with the result
+        bool retryTest(TestInterface& test, size_t& attempts, const Configuration& config, std::string& info) const noexcept;
+
+        // set the result and record of each test from its repeated runs, and report them
+        void combineRuns(const std::vector<TestInterface*>& tests, const std::vector<TestInterface*>& runs);
+
+        // report a test whose result was taken from the result cache or the journal of an earlier run
+        void reportEarlierResult(const TestInterface& test, Reporter& reporter);
+
+        // append the record of a finished test to the journal, if any
+        void journalTest(size_t index);
+
+        // mark a test that was not started as skipped, and report it
+        void skipTest(TestInterface& test, size_t index, Reporter& reporter, const std::string& info = "");
+
+        // skip a test that was not started because the run was stopped, counting it in tests_over_limit if stopped at a limit
+        void skipStoppedTest(TestInterface& test, size_t index);
+
+        // called on the watchdog thread when a test or the whole run takes too long
+        void timeoutExpired(size_t slot, const std::string& label, const Configuration& config) noexcept;
+
+        // distinct suites of the given tests, in order of first appearance
+        static std::vector<TestSuite*> suitesOf(const std::vector<TestInterface*>& tests);
+
+        // the summary and current test of the calling thread, which are per worker when running in parallel
+        TestSummary& currentSummary() noexcept;
+        TestInterface*& currentTest() noexcept;
+
+        static thread_local WorkerContext* worker_context;
+
         TestRegistry* registry_;
         TestInterface* curr_test;
+        Watchdog* watchdog; // only while running tests with a timeout
+        TestJournal* journal; // only while running tests with a journal
+        std::vector<CpuSet> worker_cpus; // CPUs each worker is pinned to, only while running tests with --pin
+        std::atomic<bool> stop_requested;
+        std::atomic<bool> stopped_at_limit; // stop_requested by --max-tests or --max-assertions rather than a failure
+        size_t tests_over_limit; // skipped since stopped_at_limit, only counted once workers are done
+        std::atomic<size_t> tests_failed; // towards the limits of the current run
+        std::atomic<size_t> tests_finished;
+        std::atomic<size_t> assertions_checked;
 
         TestSummary test_summary;
+        std::vector<TestRecord> test_records; // in order of the planned tests
+        std::vector<std::vector<std::string>> test_coverage; // files each planned test ran, when collecting the impact index
+        std::vector<bool> earlier_results; // planned tests whose result and record were taken from the cache or journal instead of running
+        std::vector<bool> timed_runs; // planned tests with a duration in the history file, so known to be quick or not
         Configuration settings;
         Reporter* reporter_; // TODO make unique ptr
 
@@ -0,0 +1,126 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#ifndef _SSTEST_SERVER_H_
+#define _SSTEST_SERVER_H_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_server.h
+ * \brief Contains the test server, which keeps a test program resident and runs tests for clients connecting over a Unix domain socket
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Listens on a Unix domain socket and runs one request at a time, so a test program starts, registers its tests and sets up 
+     * its global fixtures once for any number of runs. A request is a list of command line arguments, and its output is streamed back 
+     * to the client as it is written, followed by the exit code of the run. Clients connecting while a request runs wait their turn.
+     * POSIX only
+     * 
+     */
+    class TestServer
+    {
+    public:
+
+        /**
+         * \brief Run the tests given by the arguments of a request, writing all output to the stream, where std::cout and std::cerr 
+         * also go while the handler runs. Exceptions are written to the client as an error, and the run fails
+         * 
+         */
+        using Handler = std::function<int(const std::vector<std::string>& args, std::ostream& os)>;
+
+        /**
+         * \brief Start listening on a socket at the path. A socket left behind by a server that is no longer running is replaced
+         * \throw Exception if the socket can't be created, another server is listening on it, or the path is in use by another file
+         * 
+         * \param path 
+         */
+        explicit TestServer(const std::string& path);
+
+        TestServer(const TestServer&) = delete;
+        TestServer& operator=(const TestServer&) = delete;
+
+        /**
+         * \brief Stop listening and remove the socket
+         * 
+         */
+        ~TestServer();
+
+        /**
+         * \brief Run requests until a client asks the server to shut down
+         * \throw Exception if the socket stops accepting connections
+         * 
+         * \param handler 
+         */
+        void serve(const Handler& handler);
+
+        /**
+         * \brief Send a request to the server listening at the path, writing its output to the stream as it arrives
+         * \throw Exception if the server can't be reached, or the connection is lost before the run finishes, e.g. by a test crashing the server
+         * 
+         * \param path 
+         * \param args Command line arguments of the run
+         * \param os 
+         * \return int Exit code of the run
+         */
+        static int request(const std::string& path, const std::vector<std::string>& args, std::ostream& os);
+
+        /**
+         * \brief Ask the server listening at the path to shut down once the request it is running, if any, finishes
+         * \throw Exception if the server can't be reached
+         * 
+         * \param path 
+         */
+        static void shutdown(const std::string& path);
+
+        /**
+         * \brief Check if a server is listening at the path, e.g. to wait for one that was just started
+         * 
+         * \param path 
+         * \return true 
+         * \return false 
+         */
+        static bool available(const std::string& path);
+
+    private:
+        std::string path;
+        int fd;
+    };
+
+}
+
+#endif // _SSTEST_SERVER_H_
@@ -30,8 +30,14 @@
 #define _SSTEST_SUMMARY_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include "sstest_config.h"
+#include "sstest_test.h"
 
 /**
  * \file sstest_summary.h
@@ -45,6 +51,7 @@ namespace sstest
     template <typename...> class Assertion;
     class TestInterface;
     class TestSuite;
+    struct TestRecord;
 
     /**
      * \brief Data pack struct for tallies and test metrics
@@ -66,11 +73,13 @@ namespace sstest
          * \note If not all tests expected to run have been reported, may still indicate not all passed 
          * 
          * \param pass_vacuous If true, pass in the case where total tests is 0
-         * \param pass_skipped If true, only check number of passed tests matches number of tests that ran (rather than total tests)
+         * \param pass_skipped If true, only check number of passed tests matches number of tests that ran (rather than total tests, less 
+         * those skipped at the limit of the run)
+         * \param pass_quarantined If true, count quarantined tests that did not pass as passed
          * \return true If all tests pass, considering the given parameters
          * \return false Else
          */
-        bool allTestsPassed(bool pass_vacuous = true, bool pass_skipped = false) const noexcept;
+        bool allTestsPassed(bool pass_vacuous = true, bool pass_skipped = false, bool pass_quarantined = false) const noexcept;
 
         /**
          * \brief Check if number of assertions expected to run have passed
@@ -87,7 +96,13 @@ namespace sstest
 
         size_t test_functions_total;
         size_t test_functions_ran;
+        size_t test_functions_skipped; // not started because the run stopped early
         size_t test_functions_passed;
+        size_t test_functions_flaky; // passed only when retried, also counted as passed
+        size_t test_functions_cached; // result taken from the result cache without running, also counted as passed
+        size_t test_functions_quarantined; // ran and did not pass, but are quarantined
+        size_t test_functions_over_budget; // left out of the run to fit the time budget, not counted in the total
+        size_t test_functions_over_limit; // skipped because the run reached --max-tests or --max-assertions, also counted as skipped but don't fail the run
 
         size_t test_suites_total;
         size_t test_suites_ran;
@@ -119,6 +134,26 @@ namespace sstest
          */
         TestSummary(const std::vector<TestSuite*>&) noexcept;
 
+        /**
+         * \brief Initialize a test summary with the test objects that are going to be run, which may be a subset of their suites
+         * Suites are counted once for each distinct suite the test objects belong to
+         * 
+         */
+        TestSummary(const std::vector<TestInterface*>&) noexcept;
+
+        /**
+         * \brief Create a summary from existing totals, such as totals counted in another process
+         * 
+         */
+        explicit TestSummary(const TestTotals&) noexcept;
+
+        /**
+         * \brief Create a summary from the results of individual tests, such as the results of every shard of a run
+         * Tests with the same identifier are counted once, see mergeTestRecords()
+         * 
+         */
+        explicit TestSummary(const std::vector<TestRecord>&);
+
         /**
          * \brief Reset the test summary to a blank test summary
          * 
@@ -127,13 +162,31 @@ namespace sstest
 
        /**
         * \brief Automatically update test totals with each test object in a test suite
-        * \note If the test suite given if empty but ran, it will still be counted towards the summary
+        * \note If the test suite given if empty but ran, it will still be counted towards the summary. 
+        * A suite whose tests were all skipped is not counted as ran
         * \sa TestSuite::ran()
         * 
         * \return Reference to *this
         */
         TestSummary& addTestSuiteResult(const TestSuite&);
 
+        /**
+         * \brief Count tests that were left out of the run to fit its time budget. They are not part of the total, so don't fail the run
+         * 
+         * \param n Number of tests left out
+         * \return Reference to *this
+         */
+        TestSummary& addTestsOverBudget(size_t n) noexcept;
+
+        /**
+         * \brief Count skipped tests that did not start because the run reached its limit of tests or assertions. They were not skipped 
+         * for a failure, so don't fail the run
+         * 
+         * \param n Number of tests skipped at the limit, which must also be counted as skipped
+         * \return Reference to *this
+         */
+        TestSummary& addTestsOverLimit(size_t n) noexcept;
+
         /**
          * \brief Automatically update test totals with an assertion result
          * 
@@ -164,6 +217,131 @@ namespace sstest
 
         TestTotals totals;
     };
+
+    /**
+     * \brief The result of a single test, which can be saved by one run and combined with the results of other runs, 
+     * such as other shards or worker processes
+     * 
+     */
+    struct TestRecord
+    {
+        /**
+         * \brief Create a record of a test that has not run
+         * 
+         */
+        TestRecord() noexcept;
+
+        /**
+         * \brief Create a record from a test object, with the assertion counts of the test
+         * 
+         * \param test 
+         * \param assertions Totals of only the assertions ran by the test, other totals are ignored
+         */
+        TestRecord(const TestInterface& test, const TestTotals& assertions);
+
+        std::string suite; // name of the suite of the test
+        std::string identifier; // \sa TestInterface::identifier()
+        TestResult result;
+        bool quarantined; // \sa TestInterface::quarantined()
+        bool over_limit; // skipped because the run reached --max-tests or --max-assertions, \sa TestTotals::test_functions_over_limit
+        uint64_t duration_us;
+        size_t assertions_total;
+        size_t assertions_ran;
+        size_t assertions_passed;
+    };
+
+    /**
+     * \brief Write test records as text, one test per line
+     * 
+     * \param os 
+     * \param records 
+     */
+    void writeTestRecords(std::ostream& os, const std::vector<TestRecord>& records);
+
+    /**
+     * \brief Write a single test record as one line, to follow records written by writeTestRecords(), e.g. when appending to them
+     * 
+     * \param os 
+     * \param record 
+     */
+    void writeTestRecord(std::ostream& os, const TestRecord& record);
+
+    /**
+     * \brief Read test records written by writeTestRecords()
+     * \throw InvalidArgument if the input is not test records
+     * 
+     * \param is 
+     * \return std::vector<TestRecord> 
+     */
+    std::vector<TestRecord> readTestRecords(std::istream& is);
+
+    /**
+     * \brief Combine records so each test is recorded once. When a test is recorded more than once, e.g. a shard that was run again, 
+     * the last record of it is kept, in the place the test first appeared
+     * 
+     * \param records 
+     * \return std::vector<TestRecord> 
+     */
+    std::vector<TestRecord> mergeTestRecords(const std::vector<TestRecord>& records);
+
+    /**
+     * \brief Read a list of test identifiers, one per line, such as a list of quarantined tests. 
+     * Surrounding whitespace is ignored, as are empty lines and lines starting with #
+     * 
+     * \param is 
+     * \return std::unordered_set<std::string> 
+     */
+    std::unordered_set<std::string> readTestList(std::istream& is);
+
+    /**
+     * \brief Results of running the same test many times, e.g. to find out how often a flaky test fails
+     * 
+     */
+    struct RepeatStats
+    {
+        /**
+         * \brief Create stats of a test that has not run
+         * 
+         */
+        RepeatStats() noexcept;
+
+        /**
+         * \brief Count the result of one run of the test. Runs may be added in any order
+         * 
+         * \param run 1-based number of the run
+         * \param result Runs that did not start (INVALID or SKIP) are not counted
+         * \param duration_us 
+         */
+        void add(size_t run, TestResult result, uint64_t duration_us);
+
+        /**
+         * \brief Return the result of the first run that did not pass, or PASS if every run passed, or SKIP if no run was counted
+         * 
+         * \return TestResult 
+         */
+        TestResult result() const noexcept;
+
+        /**
+         * \brief Return the duration that the given fraction of runs took at most, e.g. 0.5 for the median, in microseconds
+         * 
+         * \param fraction In [0, 1]
+         * \return uint64_t 0 if no run was counted
+         */
+        uint64_t percentile(double fraction) const;
+
+        /**
+         * \brief Describe the stats in one line, e.g. "498/500 runs passed (99.6%), first failed on run 12, ..."
+         * 
+         * \return std::string 
+         */
+        std::string describe() const;
+
+        size_t runs; // number of runs counted
+        size_t passed;
+        size_t first_failure; // number of the first run that did not pass, 0 if all passed
+        TestResult first_failure_result;
+        std::vector<uint64_t> durations_us; // kept sorted
+    };
 }
 
 #endif // _SSTEST_SUMMARY_H_
\ No newline at end of file
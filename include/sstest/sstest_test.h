@@ -29,14 +29,20 @@
 #ifndef _SSTEST_TEST_H_
 #define _SSTEST_TEST_H_
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 #include <memory>
+#include <exception>
+#include <typeindex>
+#include <typeinfo>
 #include "sstest_exception.h"
 #include "sstest_info.h"
 #include "sstest_string.h"
+#include "sstest_traits.h"
 
 /**
  * \file sstest_test.h
@@ -45,6 +51,11 @@
  * 
  */
 
+namespace sstest
+{
+    class TestInterface;
+}
+
 namespace testing
 {
 
@@ -62,6 +73,30 @@ namespace testing
  * 
  */
 #   define SSTEST_TEARDOWN_FUNCTION_NAME TearDown
+#endif
+
+#ifndef SSTEST_SETUP_SUITE_FUNCTION_NAME
+/**
+ * \brief Allow user to compile with custom name for test fixture suite setup function
+ * 
+ */
+#   define SSTEST_SETUP_SUITE_FUNCTION_NAME SetUpSuite
+#endif
+
+#ifndef SSTEST_TEARDOWN_SUITE_FUNCTION_NAME
+/**
+ * \brief Allow user to compile with custom name for test fixture suite tear down function
+ * 
+ */
+#   define SSTEST_TEARDOWN_SUITE_FUNCTION_NAME TearDownSuite
+#endif
+
+#ifndef SSTEST_RESET_FUNCTION_NAME
+/**
+ * \brief Allow user to compile with custom name for the function resetting a reused test fixture
+ * 
+ */
+#   define SSTEST_RESET_FUNCTION_NAME Reset
 #endif
 
     /**
@@ -77,12 +112,66 @@ namespace testing
 
         virtual void SSTEST_SETUP_FUNCTION_NAME() {}
         virtual void SSTEST_TEARDOWN_FUNCTION_NAME() {}
+
+        /**
+         * \brief Called on a copy of the fixture kept for the suite, once per worker thread or process before the first test of the suite it runs.
+         * Meant for expensive setup shared by the tests of the suite, e.g. loading a dataset, which they read with SuiteFixture()
+         * 
+         */
+        virtual void SSTEST_SETUP_SUITE_FUNCTION_NAME() {}
+
+        /**
+         * \brief Called on the copy of the fixture SetUpSuite() ran on, once the worker has run all of its tests
+         * 
+         */
+        virtual void SSTEST_TEARDOWN_SUITE_FUNCTION_NAME() {}
+
+        /**
+         * \brief Called after TearDown() on a fixture reused for the next test, see reuse_fixture, to restore the state it was constructed in
+         * 
+         */
+        virtual void SSTEST_RESET_FUNCTION_NAME() {}
+
         virtual void operator()(Args...) = 0;
         
     protected:
-        Test() {}
+        Test() : sstest_suite_fixture(nullptr), sstest_suite_builder(nullptr) {}
+
+        /**
+         * \brief Return the copy of the fixture that SetUpSuite() ran on for the worker running this test. Shared by the tests of the suite on 
+         * the same worker, so it is read only. For a fixture that overrides neither SetUpSuite() nor TearDownSuite(), the copy is only made 
+         * by the first call
+         * \throw std::bad_cast if Fixture is not the fixture class of the suite or one of its bases
+         * 
+         * \tparam Fixture Fixture class of the suite
+         * \return const Fixture& 
+         */
+        template <typename Fixture>
+        const Fixture& SuiteFixture() const
+        {
+            if (sstest_suite_fixture == nullptr && sstest_suite_builder != nullptr) sstest_suite_fixture = (*sstest_suite_builder)();
+            if (sstest_suite_fixture == nullptr) throw std::bad_cast();
+            return dynamic_cast<const Fixture&>(*sstest_suite_fixture);
+        }
+
+    private:
+        friend class ::sstest::TestInterface;
+
+        mutable const Test* sstest_suite_fixture; // set before SetUp() or by the first SuiteFixture(), nullptr outside of a test
+        const std::function<const Test*()>* sstest_suite_builder; // sets up the suite fixture during a test, nullptr outside of one
     };
 
+    /**
+     * \brief Specialize as std::true_type for a fixture class that is costly to construct but cheap to reset, so each test runs on the object 
+     * it was registered with, or a worker's copy of it, instead of a new copy for every run. After TearDown(), the object's Reset() is 
+     * called, which must put it back in the state it was constructed in
+     * 
+     * \tparam Fixture Fixture class given to TEST(Fixture, name)
+     */
+    template <typename Fixture>
+    struct reuse_fixture : std::false_type
+    {};
+
 
 }
 
@@ -93,6 +182,212 @@ namespace sstest
     class TestSuite;
 
     typedef std::function<void()> sstest_void_function;
+
+    /**
+     * \brief Fixture class whose suite tests of TestType share: the class a test defined with TEST(suite, name) derives from, else TestType
+     * 
+     * \tparam TestType 
+     */
+    template <typename TestType, typename = void>
+    struct suite_fixture_type
+    {
+        typedef TestType type;
+    };
+
+    template <typename TestType>
+    struct suite_fixture_type<TestType, void_t<typename TestType::sstest_suite_type>>
+    {
+        typedef typename TestType::sstest_suite_type type;
+    };
+
+    template <typename T>
+    struct is_fixture_base : std::false_type
+    {};
+
+    template <typename... Args>
+    struct is_fixture_base<::testing::Test<Args...>> : std::true_type
+    {};
+
+    template <typename T>
+    struct member_class
+    {};
+
+    template <typename T, typename C>
+    struct member_class<T C::*>
+    {
+        typedef C type;
+    };
+
+    /**
+     * \brief Check if a fixture class, or one of its bases, overrides SetUpSuite() or TearDownSuite(), so its suite must be set up before 
+     * its tests run rather than only when a test calls SuiteFixture(). One that can't be seen, e.g. declared protected, is overridden
+     * 
+     * \tparam Fixture 
+     */
+    template <typename Fixture, typename = void>
+    struct overrides_suite_hooks : std::true_type
+    {};
+
+    template <typename Fixture>
+    struct overrides_suite_hooks<Fixture, typename std::enable_if<
+        is_fixture_base<typename member_class<decltype(&Fixture::SSTEST_SETUP_SUITE_FUNCTION_NAME)>::type>::value && 
+        is_fixture_base<typename member_class<decltype(&Fixture::SSTEST_TEARDOWN_SUITE_FUNCTION_NAME)>::type>::value>::type>
+        : std::false_type
+    {};
+
+    /**
+     * \brief Base of the class each test defined with TEST(suite, name) declares for its body, which derives from suite if it is a class
+     * 
+     * \tparam T 
+     */
+    template <typename T, typename X = void>
+    struct SuiteTest
+    {};
+
+    template <typename T>
+    struct SuiteTest<T, typename std::enable_if<is_complete_type<T>::value && std::is_class<T>::value>::type> : public T
+    {
+        typedef T sstest_suite_type;
+    };
+
+    /**
+     * \brief The object a test of a reused fixture was registered with, see ::testing::reuse_fixture. The first worker to run the test 
+     * runs it on object and keeps it for the next runs, the others on a copy of prototype
+     * 
+     * \tparam TestType 
+     */
+    template <typename TestType>
+    struct RegisteredTest
+    {
+        enum State
+        {
+            FREE,
+            TAKEN, // kept by a worker
+            SPOILED // Reset() failed on it, so it is not run again
+        };
+
+        explicit RegisteredTest(const TestType& test) : prototype(test), object(test), state(FREE) {}
+
+        const TestType prototype; // never run, so copies of it and --check-reset see the fixture as it was constructed
+        TestType object;
+        std::atomic<int> state;
+    };
+
+    /**
+     * \brief The suite fixtures a worker set up with SetUpSuite(), one per fixture class, kept until the worker tears them all down with 
+     * TearDownSuite() once it has run its tests, and the objects of reused fixtures waiting for their next test, see ::testing::reuse_fixture. 
+     * The test runner gives each worker thread or process its own
+     * 
+     */
+    class SuiteFixtures
+    {
+    public:
+
+        typedef std::function<void()> teardown_type;
+
+        SuiteFixtures() = default;
+        SuiteFixtures(const SuiteFixtures&) = delete;
+        SuiteFixtures& operator=(const SuiteFixtures&) = delete;
+
+        /**
+         * \brief Tear down the fixtures left, ignoring errors
+         * 
+         */
+        ~SuiteFixtures();
+
+        /**
+         * \brief Return the fixture set up for a fixture class, or nullptr if there is none yet
+         * \throw The exception its SetUpSuite() threw, if it failed, so every test of the suite fails the same way
+         * 
+         * \param fixture 
+         * \return std::shared_ptr<void> 
+         */
+        std::shared_ptr<void> find(std::type_index fixture) const;
+
+        /**
+         * \brief Keep a fixture that was set up, and how to tear it down
+         * 
+         * \param fixture 
+         * \param object 
+         * \param teardown 
+         */
+        void insert(std::type_index fixture, std::shared_ptr<void> object, teardown_type teardown);
+
+        /**
+         * \brief Keep the exception a fixture failed to set up with, which find() rethrows
+         * 
+         * \param fixture 
+         * \param error 
+         */
+        void fail(std::type_index fixture, std::exception_ptr error);
+
+        /**
+         * \brief Tear down every fixture, the last one set up first, and forget them
+         * 
+         * \return std::vector<std::string> Description of each teardown that threw
+         */
+        std::vector<std::string> tearDown();
+
+        /**
+         * \brief Take a reused fixture object that was reset after its last test, or return nullptr if there is none
+         * 
+         * \param type Test class the object was made for
+         * \return std::shared_ptr<void> 
+         */
+        std::shared_ptr<void> takeIdle(std::type_index type);
+
+        /**
+         * \brief Keep a reused fixture object that was reset, for the next test of its class
+         * 
+         * \param type 
+         * \param object 
+         */
+        void putIdle(std::type_index type, std::shared_ptr<void> object);
+
+        /**
+         * \brief Check if reused fixture objects are compared with a new copy after Reset(), failing the test that left state behind
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool checkingReset() const noexcept;
+
+        /**
+         * \brief Set whether reused fixture objects are compared with a new copy after Reset()
+         * 
+         * \param check 
+         */
+        void setCheckReset(bool check) noexcept;
+
+        /**
+         * \brief Return the fixtures of the worker running on the calling thread, or nullptr if tests on it are not run by a worker, 
+         * in which case each test sets up and tears down its suite fixture on its own
+         * 
+         * \return SuiteFixtures* 
+         */
+        static SuiteFixtures* current() noexcept;
+
+        /**
+         * \brief Set the fixtures of the worker running on the calling thread
+         * 
+         * \param fixtures nullptr once the worker is done
+         */
+        static void setCurrent(SuiteFixtures* fixtures) noexcept;
+
+    private:
+
+        struct Entry
+        {
+            std::type_index fixture;
+            std::shared_ptr<void> object;
+            teardown_type teardown;
+            std::exception_ptr error;
+        };
+
+        std::vector<Entry> entries;
+        std::vector<std::pair<std::type_index, std::shared_ptr<void>>> idle;
+        bool check_reset = false;
+    };
     typedef std::function<void(TestInterface&)> sstest_callback; //typedef void(*sstest_test_callback)();      
     typedef std::function<bool(const TestInterface*, const TestInterface*)> sstest_comparator;
     typedef std::function<bool(const TestSuite*, const TestSuite*)> sstest_case_comparator;
@@ -103,6 +398,11 @@ namespace sstest
         FAIL = 0,
         SUCCESS = 1,
         THROW = 3,
+        CRASH = 4, // the process running the test died
+        TIMEOUT = 5, // the test ran longer than the configured timeout
+        SKIP = 6, // the test was not started because the run stopped early
+        FLAKY = 7, // the test failed, then passed when it was retried
+        CACHED = 8, // the test was not run, since it passed before with the same program and inputs
         PASS = SUCCESS,
     };
     
@@ -147,15 +447,89 @@ namespace sstest
          */
         template <typename TestType, typename... Args, typename = typename std::enable_if<std::is_base_of<::testing::Test<Args...>, TestType>::value>::type>
         static sstest_void_function createTestInvoker(const TestType& test_param, Args&&... args)
+        {
+            typedef typename suite_fixture_type<TestType>::type Fixture;
+            return createFixtureInvoker<Fixture>(::testing::reuse_fixture<Fixture>(), test_param, std::forward<Args>(args)...);
+        }
+
+    private:
+
+        // the fixtures of the worker running the test, or local ones for a test not run by a worker
+        static SuiteFixtures& workerFixtures(SuiteFixtures& local_fixtures) noexcept
+        {
+            SuiteFixtures* fixtures = SuiteFixtures::current();
+            return (fixtures != nullptr) ? *fixtures : local_fixtures;
+        }
+
+        // each test runs on a new copy of the fixture
+        template <typename Fixture, typename TestType, typename... Args>
+        static sstest_void_function createFixtureInvoker(std::false_type, const TestType& test_param, Args&&... args)
         {
             return sstest_void_function([=]() mutable -> void
             {
+                SuiteFixtures local_fixtures;
+                SuiteFixtures& fixtures = workerFixtures(local_fixtures);
                 TestType test_obj = test_param;
+                runFixture<Fixture>(fixtures, test_obj, test_param, args...);
+            });
+        }
 
+        // each worker keeps an object of the test, reset after each run instead of copied for the next one. Copies of the invoker share 
+        // the registered object
+        template <typename Fixture, typename TestType, typename... Args>
+        static sstest_void_function createFixtureInvoker(std::true_type, const TestType& test_param, Args&&... args)
+        {
+            std::shared_ptr<RegisteredTest<TestType>> registered = std::make_shared<RegisteredTest<TestType>>(test_param);
+            return sstest_void_function([=]() mutable -> void
+            {
+                SuiteFixtures local_fixtures;
+                SuiteFixtures& fixtures = workerFixtures(local_fixtures);
+                invokeReused<Fixture>(fixtures, registered, args...);
+            });
+        }
+
+        // the suite fixture of the worker, set up the first time one of the tests of the suite runs on it
+        template <typename Fixture, typename TestType>
+        static const Fixture* setUpSuite(SuiteFixtures& fixtures, const TestType& test_param)
+        {
+            std::shared_ptr<Fixture> suite_obj = std::static_pointer_cast<Fixture>(fixtures.find(typeid(Fixture)));
+            if (suite_obj) return suite_obj.get();
+
+            std::shared_ptr<TestType> setup_obj = std::make_shared<TestType>(test_param);
+            try
+            {
+                setup_obj->SSTEST_SETUP_SUITE_FUNCTION_NAME();
+            }
+            catch (...)
+            {
+                fixtures.fail(typeid(Fixture), std::current_exception());
+                throw;
+            }
+            suite_obj = setup_obj;
+            fixtures.insert(typeid(Fixture), suite_obj, [setup_obj]() -> void
+            {
+                setup_obj->SSTEST_TEARDOWN_SUITE_FUNCTION_NAME();
+            });
+            return suite_obj.get();
+        }
+
+        // the suite is set up before the test if its fixture has hooks to run, else only once the test asks for it with SuiteFixture()
+        template <typename Fixture, typename TestType, typename... Params>
+        static void runFixture(SuiteFixtures& fixtures, TestType& test_obj, const TestType& test_param, Params&... params)
+        {
+            typedef typename std::remove_const<typename std::remove_pointer<decltype(test_obj.sstest_suite_fixture)>::type>::type TestBase;
+            const std::function<const TestBase*()> set_up_suite = [&]() -> const TestBase*
+            {
+                return setUpSuite<Fixture>(fixtures, test_param);
+            };
+            test_obj.sstest_suite_fixture = overrides_suite_hooks<Fixture>::value ? set_up_suite() : nullptr;
+            test_obj.sstest_suite_builder = &set_up_suite;
+            try
+            {
                 test_obj.SSTEST_SETUP_FUNCTION_NAME();
                 try
                 {
-                    test_obj(args...);
+                    test_obj(params...);
                 }
                 catch (...)
                 {
@@ -163,9 +537,77 @@ namespace sstest
                     throw;
                 }
                 test_obj.SSTEST_TEARDOWN_FUNCTION_NAME();
+            }
+            catch (...)
+            {
+                test_obj.sstest_suite_fixture = nullptr;
+                test_obj.sstest_suite_builder = nullptr;
+                throw;
+            }
+            test_obj.sstest_suite_fixture = nullptr;
+            test_obj.sstest_suite_builder = nullptr;
+        }
+
+        template <typename Fixture, typename TestType, typename... Params>
+        static void invokeReused(SuiteFixtures& fixtures, const std::shared_ptr<RegisteredTest<TestType>>& registered, Params&... params)
+        {
+            std::shared_ptr<TestType> test_obj = takeReused(fixtures, registered);
+
+            // reset whether or not the test passed, so the next run starts from the same state either way
+            std::exception_ptr error;
+            try
+            {
+                runFixture<Fixture>(fixtures, *test_obj, registered->prototype, params...);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            try
+            {
+                test_obj->SSTEST_RESET_FUNCTION_NAME(); // an object that fails to reset is dropped
+            }
+            catch (...)
+            {
+                if (test_obj.get() == &registered->object) registered->state = RegisteredTest<TestType>::SPOILED;
+                if (error) std::rethrow_exception(error); // the test failed first
+                throw;
+            }
+            const bool leaked = fixtures.checkingReset() && !sameFixture<Fixture>(*test_obj, registered->prototype, is_equality_comparable<Fixture>());
+            if (leaked && test_obj.get() == &registered->object) registered->state = RegisteredTest<TestType>::SPOILED;
+            if (!leaked) fixtures.putIdle(typeid(TestType), test_obj);
+            if (error) std::rethrow_exception(error);
+            if (leaked) throw Exception("Reset() did not restore the fixture to how it was constructed, so state of this test would leak into the next");
+        }
+
+        // the object the worker kept from the last run of the test, else the registered object if no other worker has it, else a copy
+        template <typename TestType>
+        static std::shared_ptr<TestType> takeReused(SuiteFixtures& fixtures, const std::shared_ptr<RegisteredTest<TestType>>& registered)
+        {
+            std::shared_ptr<TestType> test_obj = std::static_pointer_cast<TestType>(fixtures.takeIdle(typeid(TestType)));
+            if (test_obj) return test_obj;
+            int state = RegisteredTest<TestType>::FREE;
+            if (!registered->state.compare_exchange_strong(state, RegisteredTest<TestType>::TAKEN)) return std::make_shared<TestType>(registered->prototype);
+            // given back once the worker drops it, unless it was spoiled
+            std::shared_ptr<RegisteredTest<TestType>> owner = registered;
+            return std::shared_ptr<TestType>(&registered->object, [owner](TestType*) -> void
+            {
+                int taken = RegisteredTest<TestType>::TAKEN;
+                owner->state.compare_exchange_strong(taken, RegisteredTest<TestType>::FREE);
             });
         }
 
+        template <typename Fixture>
+        static bool sameFixture(const Fixture& reset, const Fixture& constructed, std::true_type)
+        {
+            return reset == constructed;
+        }
+
+        template <typename Fixture>
+        static bool sameFixture(const Fixture&, const Fixture&, std::false_type)
+        {
+            throw Exception("checking Reset() needs an operator== for the fixture, comparing the state Reset() restores");
+        }
 
     public:
 
@@ -186,6 +628,28 @@ namespace sstest
          */
         StringView name() const noexcept;
 
+        /**
+         * \brief Return the suite the test object was added to, or nullptr if it is not part of a suite
+         * 
+         * \return TestSuite* 
+         */
+        TestSuite* suite() const noexcept;
+
+        /**
+         * \brief Return a string identifying the test across all suites, which is stable between runs of the same program
+         * The name is qualified with the suite name as "suite::name", unless it already is or the suite is the global suite
+         * 
+         * \return std::string 
+         */
+        std::string identifier() const;
+
+        /**
+         * \brief Return where the test was defined
+         * 
+         * \return const LineInfo& 
+         */
+        const LineInfo& lineInfo() const noexcept;
+
         /**
          * \brief Runs the test function given on construction, tracking its result
          * 
@@ -208,14 +672,14 @@ namespace sstest
          * \brief Check if the test held by the object has been run
          * 
          * \return true If the test has ran
-         * \return false Else
+         * \return false Else, including if the test was skipped
          */
         bool ran() const noexcept;
 
         /**
          * \brief Check if the test passed when ran
          * 
-         * \return true If the test passed
+         * \return true If the test passed, including if it passed only when retried (FLAKY) or passed in an earlier run (CACHED)
          * \return false Else, including if the test has not been run yet
          */
         bool passed() const noexcept;
@@ -232,6 +696,54 @@ namespace sstest
          * 
          */
         void fail(bool = true);
+
+        /**
+         * \brief Record the result of a test that was run elsewhere, such as in another process
+         * 
+         * \param duration_us How long the test took to run, in microseconds
+         */
+        void setResult(TestResult, uint64_t duration_us = 0) noexcept;
+
+        /**
+         * \brief Return how long the test took the last time it was run, in microseconds
+         * 
+         * \return uint64_t 
+         */
+        uint64_t duration() const noexcept;
+
+        /**
+         * \brief Return the message of the exception the test threw the last time it was run, empty if it threw none or one that is not a 
+         * std::exception
+         * 
+         * \return const std::string& 
+         */
+        const std::string& thrownMessage() const noexcept;
+
+        /**
+         * \brief Return the expected cost of running the test, which the test runner uses to start long tests first
+         * By default it is the duration of the test from previous runs, in microseconds, or 0 if unknown
+         * 
+         * \return uint64_t 
+         */
+        uint64_t weight() const noexcept;
+
+        /**
+         * \sa weight()
+         */
+        void setWeight(uint64_t) noexcept;
+
+        /**
+         * \brief Check if the test is quarantined, meaning it still runs but not passing doesn't fail the run
+         * 
+         * \return true 
+         * \return false 
+         */
+        bool quarantined() const noexcept;
+
+        /**
+         * \sa quarantined()
+         */
+        void setQuarantined(bool = true) noexcept;
        
     protected:
         /**
@@ -245,6 +757,15 @@ namespace sstest
         LineInfo line_info;
         sstest_void_function invoker; // TODO move this to concrete impl.?
         TestResult result_;
+        uint64_t duration_us;
+        uint64_t weight_;
+        bool quarantined_;
+        std::string thrown_message;
+
+    private:
+        friend class TestSuite;
+
+        TestSuite* suite_;
     };
 
     /**
@@ -267,10 +788,6 @@ namespace sstest
          * \sa TestInterface::clone()
          */
         virtual TestFunction* clone() const override;
-        
-    private:
-
-        int weight; // !!! TODO currently unused
 
     };
 
@@ -300,6 +817,13 @@ namespace sstest
          */
         virtual void run(sstest_callback start_cb = nullptr, sstest_callback finish_cb = nullptr, sstest_comparator cmp = nullptr);
 
+        /**
+         * \brief Recount the suite result from the results of each test object
+         * Use when the tests of the suite were run individually instead of through run(), e.g. in parallel
+         * 
+         */
+        void tally() noexcept;
+
         /**
          * \brief Clear, or empty, the test suite
          * 
@@ -334,6 +858,35 @@ namespace sstest
          */
         size_t numTestsPassed() const noexcept;
 
+        /**
+         * \brief Return the number of tests in the suite that were skipped because the run stopped early
+         * 
+         * \return size_t 
+         */
+        size_t numTestsSkipped() const noexcept;
+
+        /**
+         * \brief Return the number of tests in the suite that passed only when retried
+         * 
+         * \return size_t 
+         */
+        size_t numTestsFlaky() const noexcept;
+
+        /**
+         * \brief Return the number of tests in the suite whose result was taken from the result cache instead of running them
+         * 
+         * \return size_t 
+         */
+        size_t numTestsCached() const noexcept;
+
+        /**
+         * \brief Return the number of tests in the suite that ran and did not pass, but are quarantined
+         * \sa TestInterface::quarantined()
+         * 
+         * \return size_t 
+         */
+        size_t numTestsQuarantined() const noexcept;
+
         /**
          * \brief Return the number of tests in the suite that has finished running
          * Tests that have attempted to run, but failed, or threw a caught exception etc. are included in this count
@@ -390,7 +943,7 @@ namespace sstest
         TestInterface& getTest(const StringView& name) const;
 
         /**
-         * \brief Return a container of pointers to each test in the test case
+         * \brief Return a container of pointers to each test in the test case, in the order they were added unless a comparator is given
          *
          * \param cmp A comparator function which takes compares const TestInterface&. Should return signed integral type < 0 if a test should run first between two test objects
          * \return std::vector<TestInterface*> 
@@ -411,6 +964,7 @@ namespace sstest
     private:
 
         std::unordered_map<const StringView, TestInterface*> test_map;
+        std::vector<TestInterface*> test_order; // the tests of test_map in the order they were added
         TestInfo test_info;
         bool pass;
         bool finished;
@@ -418,6 +972,46 @@ namespace sstest
 
     };
 
+    /**
+     * \brief Split tests into parts of about equal total weight, giving each test in order to the part with the least total weight so far
+     * Given tests sorted heaviest first, this is longest processing time first scheduling. When all weights are equal, tests are dealt 
+     * to parts in turn
+     * \throw InvalidArgument if nparts is 0
+     * \sa TestInterface::weight()
+     * 
+     * \param tests 
+     * \param nparts 
+     * \return std::vector<size_t> The index of the part each test is given to
+     */
+    std::vector<size_t> partitionByWeight(const std::vector<TestInterface*>& tests, size_t nparts);
+
+    /**
+     * \brief Select the tests belonging to one shard, when splitting tests across multiple machines or runs
+     * Tests are ordered heaviest first, then by a platform independent hash of their identifier, and each is given to the shard with the
+     * least total weight so far (longest processing time first). Each test maps to exactly one shard and the selection is the same on 
+     * every machine, as long as every machine sees the same weights. When all weights are equal, shards get the same number of tests (within one)
+     * \sa TestInterface::weight()
+     * \throw InvalidArgument if total_shards is 0 or shard_index is not less than total_shards
+     * 
+     * \param tests Tests to select from, order is preserved in the result
+     * \param shard_index 0-based index of the shard to select
+     * \param total_shards Number of shards the tests are split into
+     * \return std::vector<TestInterface*> 
+     */
+    std::vector<TestInterface*> selectShard(const std::vector<TestInterface*>& tests, size_t shard_index, size_t total_shards);
+
+    /**
+     * \brief Return the tests in an order permuted by a seed, keeping the tests of a suite together.
+     * Suites are ordered by a platform independent hash of their name and the seed, and tests within a suite by a hash of their identifier 
+     * and the seed. The same seed gives the same order on every machine, and the relative order of two tests does not depend on which other 
+     * tests are given, so a run of fewer tests, e.g. a shard, keeps the order of the full run
+     * 
+     * \param tests 
+     * \param seed 
+     * \return std::vector<TestInterface*> 
+     */
+    std::vector<TestInterface*> shuffleTests(const std::vector<TestInterface*>& tests, uint32_t seed);
+
 }
 
 #endif // _SSTEST_TEST_H_
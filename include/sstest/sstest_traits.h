@@ -88,6 +88,15 @@ namespace sstest
         : std::true_type
     {};
 
+    template <typename N, typename = void>
+    struct is_equality_comparable : std::false_type
+    {};
+
+    template <typename N>
+    struct is_equality_comparable <N, void_t<decltype(std::declval<const N&>() == std::declval<const N&>())>>
+        : std::true_type
+    {};
+
     template <typename T, typename = void>
     struct is_complete_type : std::false_type
     {};
@@ -0,0 +1,157 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#ifndef _SSTEST_WATCHDOG_H_
+#define _SSTEST_WATCHDOG_H_
+
+#include <cstddef>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest_config.h"
+
+/**
+ * \file sstest_watchdog.h
+ * \brief Contains a watchdog thread used by the test runner to catch tests that run too long
+ * 
+ */
+
+namespace sstest
+{
+
+    /**
+     * \brief Watches a fixed number of slots, e.g. one per worker thread, on a background thread. Each slot is armed with a timeout before
+     * running a test and disarmed after. If a slot is still armed when its timeout passes, the expire callback is called once for it.
+     * An optional global deadline covers the whole time the watchdog is running.
+     * 
+     */
+    class Watchdog
+    {
+    public:
+
+        typedef std::chrono::steady_clock clock_type;
+
+        /**
+         * \brief Called on the watchdog thread with the slot that expired, or global_slot, and the label the slot was armed with
+         * 
+         */
+        typedef std::function<void(size_t, const std::string&)> expire_type;
+
+        static constexpr size_t global_slot = std::numeric_limits<size_t>::max();
+
+        /**
+         * \brief Create a watchdog over nslots slots. The thread is not started until start()
+         * 
+         * \param nslots 
+         * \param on_expire 
+         */
+        Watchdog(size_t nslots, expire_type on_expire);
+
+        Watchdog(const Watchdog&) = delete;
+        Watchdog& operator=(const Watchdog&) = delete;
+
+        /**
+         * \brief Stops the thread if it is running
+         * 
+         */
+        ~Watchdog();
+
+        /**
+         * \brief Start the watchdog thread
+         * 
+         * \param global_timeout Time from now until the global deadline expires, or 0 for no global deadline
+         */
+        void start(std::chrono::milliseconds global_timeout = std::chrono::milliseconds(0));
+
+        /**
+         * \brief Stop and join the watchdog thread. No callbacks are called after this returns
+         * 
+         */
+        void stop();
+
+        /**
+         * \brief Start timing a slot
+         * 
+         * \param slot 
+         * \param timeout Time from now until the slot expires, or 0 to not time the slot
+         * \param label Passed to the expire callback, e.g. the name of the test running in the slot
+         */
+        void arm(size_t slot, std::chrono::milliseconds timeout, const std::string& label);
+
+        /**
+         * \brief Stop timing a slot
+         * 
+         * \param slot 
+         * \return true If the slot expired since it was armed
+         * \return false Else
+         */
+        bool disarm(size_t slot);
+
+    private:
+
+        struct Slot
+        {
+            Slot() : armed(false), expired(false) {}
+
+            bool armed;
+            bool expired;
+            clock_type::time_point deadline;
+            std::string label;
+        };
+
+        void watchLoop();
+
+        std::vector<Slot> slots;
+        expire_type on_expire;
+        bool has_global_deadline;
+        bool global_expired;
+        clock_type::time_point global_deadline;
+
+        bool running;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    /**
+     * \brief Write the stack of every thread of the process, other than the calling thread, to a file descriptor.
+     * Other threads are interrupted with SSTEST_STACK_DUMP_SIGNAL to record their own stacks
+     * \note Only supported on Linux with glibc. On other platforms only a note is written
+     * 
+     * \param fd e.g. 2 for standard error
+     */
+    void dumpThreadStacks(int fd) noexcept;
+
+}
+
+#endif // _SSTEST_WATCHDOG_H_
@@ -0,0 +1,299 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "sstest/sstest_affinity.h"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include "sstest/sstest_exception.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace sstest
+{
+
+    namespace
+    {
+        // CPU indices past this are taken as a typo rather than allocating a set for them
+        const size_t max_cpus = 1 << 16;
+
+        bool readLine(const std::string& path, std::string& line)
+        {
+            std::ifstream file(path);
+            return static_cast<bool>(std::getline(file, line));
+        }
+
+        // sysfs files that are missing or can't be parsed read as no CPUs
+        CpuSet readList(const std::string& path)
+        {
+            std::string line;
+            if (!readLine(path, line)) return CpuSet();
+            try
+            {
+                return CpuTopology::parseList(line);
+            }
+            catch (const InvalidArgument&)
+            {
+                return CpuSet();
+            }
+        }
+
+        bool contains(const CpuSet& cpus, size_t cpu)
+        {
+            return std::binary_search(cpus.begin(), cpus.end(), cpu);
+        }
+    }
+
+    CpuTopology::CpuTopology(const std::string& root)
+    {
+        const std::string system = root + "/sys/devices/system";
+        for (size_t id : readList(system + "/node/online"))
+        {
+            Node node = { id, readList(system + "/node/node" + std::to_string(id) + "/cpulist") };
+            if (!node.cpus.empty()) nodes_.push_back(std::move(node));
+        }
+        if (nodes_.empty())
+        {
+            // no NUMA support in the kernel, or no sysfs
+            Node node = { 0, readList(system + "/cpu/online") };
+            const size_t ncpus = node.cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : 0;
+            for (size_t cpu = 0; cpu < ncpus; cpu++)
+            {
+                node.cpus.push_back(cpu);
+            }
+            nodes_.push_back(std::move(node));
+        }
+        for (size_t cpu : cpus())
+        {
+            const CpuSet siblings = readList(system + "/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+            const size_t rank = static_cast<size_t>(std::lower_bound(siblings.begin(), siblings.end(), cpu) - siblings.begin());
+            if (thread_rank.size() <= cpu) thread_rank.resize(cpu + 1, 0);
+            thread_rank[cpu] = contains(siblings, cpu) ? rank : 0;
+        }
+    }
+
+    const std::vector<CpuTopology::Node>& CpuTopology::nodes() const noexcept
+    {
+        return nodes_;
+    }
+
+    CpuSet CpuTopology::cpus() const
+    {
+        CpuSet all;
+        for (const Node& node : nodes_)
+        {
+            all.insert(all.end(), node.cpus.begin(), node.cpus.end());
+        }
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    void CpuTopology::restrict(const CpuSet& allowed)
+    {
+        for (Node& node : nodes_)
+        {
+            node.cpus.erase(std::remove_if(node.cpus.begin(), node.cpus.end(), [&allowed](size_t cpu) -> bool
+            {
+                return !contains(allowed, cpu);
+            }), node.cpus.end());
+        }
+        nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(), [](const Node& node) -> bool
+        {
+            return node.cpus.empty();
+        }), nodes_.end());
+    }
+
+    void CpuTopology::exclude(const CpuSet& reserved)
+    {
+        CpuSet allowed;
+        for (size_t cpu : cpus())
+        {
+            if (!contains(reserved, cpu)) allowed.push_back(cpu);
+        }
+        restrict(allowed);
+    }
+
+    std::vector<CpuSet> CpuTopology::placement(size_t nworkers, bool per_node) const
+    {
+        // the CPUs of each node, with the second hardware thread of a core after every first one
+        std::vector<CpuSet> ordered;
+        size_t total = 0;
+        for (const Node& node : nodes_)
+        {
+            CpuSet cpus = node.cpus;
+            std::stable_sort(cpus.begin(), cpus.end(), [this](size_t a, size_t b) -> bool
+            {
+                const size_t rank_a = (a < thread_rank.size()) ? thread_rank[a] : 0;
+                const size_t rank_b = (b < thread_rank.size()) ? thread_rank[b] : 0;
+                return rank_a < rank_b;
+            });
+            total += cpus.size();
+            ordered.push_back(std::move(cpus));
+        }
+
+        // take the next CPU from the node with the smallest share of its CPUs taken so far, so nodes fill up evenly
+        std::vector<size_t> order;
+        std::vector<size_t> node_of;
+        std::vector<size_t> taken(ordered.size(), 0);
+        while (order.size() < total)
+        {
+            size_t next = ordered.size();
+            for (size_t i = 0; i < ordered.size(); i++)
+            {
+                if (taken[i] == ordered[i].size()) continue;
+                if (next == ordered.size() || taken[i] * ordered[next].size() < taken[next] * ordered[i].size()) next = i;
+            }
+            order.push_back(ordered[next][taken[next]++]);
+            node_of.push_back(next);
+        }
+
+        std::vector<CpuSet> workers;
+        if (order.empty()) return workers;
+        for (size_t i = 0; i < nworkers; i++)
+        {
+            const size_t slot = i % order.size();
+            workers.push_back(per_node ? nodes_[node_of[slot]].cpus : CpuSet{ order[slot] });
+        }
+        return workers;
+    }
+
+    size_t CpuTopology::nodeOf(size_t cpu) const noexcept
+    {
+        for (const Node& node : nodes_)
+        {
+            if (contains(node.cpus, cpu)) return node.id;
+        }
+        return 0;
+    }
+
+    CpuSet CpuTopology::parseList(const std::string& list)
+    {
+        const std::string error = "expected a list of CPUs such as 0-3,8, got " + list;
+        auto parseIndex = [&error](const std::string& text) -> size_t
+        {
+            size_t n = 0;
+            for (char c : text)
+            {
+                if (c < '0' || c > '9') throw InvalidArgument(error);
+                n = n * 10 + static_cast<size_t>(c - '0');
+                if (n >= max_cpus) throw InvalidArgument(error);
+            }
+            if (text.empty()) throw InvalidArgument(error);
+            return n;
+        };
+
+        // sysfs ends lists with a newline, and an empty list has no CPUs
+        CpuSet cpus;
+        const size_t end = list.find_last_not_of(" \t\r\n");
+        if (end == std::string::npos) return cpus;
+        const std::string trimmed = list.substr(0, end + 1);
+        for (size_t start = 0; start <= trimmed.size(); )
+        {
+            size_t comma = trimmed.find(',', start);
+            if (comma == std::string::npos) comma = trimmed.size();
+            const std::string range = trimmed.substr(start, comma - start);
+            const size_t dash = range.find('-');
+            const size_t first = parseIndex(range.substr(0, dash));
+            const size_t last = (dash == std::string::npos) ? first : parseIndex(range.substr(dash + 1));
+            if (last < first) throw InvalidArgument(error);
+            for (size_t cpu = first; cpu <= last; cpu++)
+            {
+                cpus.push_back(cpu);
+            }
+            start = comma + 1;
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    std::string CpuTopology::formatList(const CpuSet& cpus)
+    {
+        std::string list;
+        for (size_t i = 0; i < cpus.size(); )
+        {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+            if (!list.empty()) list += ',';
+            list += std::to_string(cpus[i]);
+            if (j > i) list += '-' + std::to_string(cpus[j]);
+            i = j + 1;
+        }
+        return list;
+    }
+
+    CpuSet CpuTopology::affinity()
+    {
+        CpuSet cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+        for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+#endif
+        return cpus;
+    }
+
+    bool CpuTopology::setAffinity(const CpuSet& cpus) noexcept
+    {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        bool any = false;
+        for (size_t cpu : cpus)
+        {
+            if (cpu >= CPU_SETSIZE) continue;
+            CPU_SET(cpu, &set);
+            any = true;
+        }
+        // on Linux this only applies to the calling thread
+        return any && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    bool CpuTopology::supported() noexcept
+    {
+#if defined(__linux__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+}
@@ -0,0 +1,238 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sstest/sstest_history.h"
+#include "sstest/sstest_string.h"
+
+#if defined(__linux__)
+#   include <link.h>
+#endif
+
+namespace
+{
+    // first line of the file, bump the version if the line format changes
+    const char* const CACHE_HEADER = "# sstest cache 1";
+
+    const unsigned int hash_seed = 0x5eed;
+    const size_t hash_chunk_size = 1 << 16;
+
+    // hash more data into a running hash, seeding each chunk with the hash so far
+    uint64_t combine(uint64_t hash, const void* data, size_t len)
+    {
+        const unsigned int seed = static_cast<unsigned int>(hash ^ (hash >> 32));
+        return hash_functions::murmur::murmurHash64A(data, static_cast<int>(len), seed) ^ (hash * 0x9e3779b97f4a7c15ULL);
+    }
+
+    uint64_t combine(uint64_t hash, const std::string& str)
+    {
+        // the length keeps "ab" + "c" apart from "a" + "bc"
+        const uint64_t len = str.size();
+        hash = combine(hash, &len, sizeof(len));
+        return combine(hash, str.data(), str.size());
+    }
+
+    bool parseHex(const std::string& str, uint64_t& value)
+    {
+        if (str.empty() || str.size() > 16) return false;
+        char* end = nullptr;
+        value = static_cast<uint64_t>(std::strtoull(str.c_str(), &end, 16));
+        return end == str.c_str() + str.size();
+    }
+
+    bool parseNumber(const std::string& str, uint64_t& value)
+    {
+        if (str.empty()) return false;
+        char* end = nullptr;
+        value = static_cast<uint64_t>(std::strtoull(str.c_str(), &end, 10));
+        return end == str.c_str() + str.size();
+    }
+
+    std::string toHex(uint64_t value)
+    {
+        const char* digits = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (size_t i = 0; i < 16; i++)
+        {
+            hex[15 - i] = digits[value & 0xf];
+            value >>= 4;
+        }
+        return hex;
+    }
+}
+
+namespace sstest
+{
+
+    ResultCache::ResultCache() {}
+
+    bool ResultCache::load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        if (!std::getline(file, line) || line != CACHE_HEADER) return false;
+
+        // each line is "<key as hex>\t<duration_us>\t<identifier>"
+        while (std::getline(file, line))
+        {
+            const size_t first = line.find('\t');
+            if (first == std::string::npos) continue;
+            const size_t second = line.find('\t', first + 1);
+            if (second == std::string::npos || second + 1 >= line.size()) continue;
+            Entry entry;
+            if (!parseHex(line.substr(0, first), entry.key) || !parseNumber(line.substr(first + 1, second - first - 1), entry.duration_us)) continue;
+            entries[line.substr(second + 1)] = entry;
+        }
+        return true;
+    }
+
+    bool ResultCache::save(const std::string& path) const
+    {
+        return TestHistory::replaceFile(path, [this](std::ostream& file) -> void
+        {
+            file << CACHE_HEADER << '\n';
+            // sorted so the file is the same for the same entries
+            std::vector<const std::pair<const std::string, Entry>*> sorted;
+            for (const auto& kv : entries) sorted.push_back(&kv);
+            std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string, Entry>* lhs, const std::pair<const std::string, Entry>* rhs) -> bool
+            {
+                return lhs->first < rhs->first;
+            });
+            for (const auto* kv : sorted)
+            {
+                file << toHex(kv->second.key) << '\t' << kv->second.duration_us << '\t' << kv->first << '\n';
+            }
+        });
+    }
+
+    const ResultCache::Entry* ResultCache::find(const std::string& identifier, uint64_t key) const
+    {
+        auto it = entries.find(identifier);
+        return (it == entries.end() || it->second.key != key) ? nullptr : &it->second;
+    }
+
+    void ResultCache::store(const std::string& identifier, uint64_t key, uint64_t duration_us)
+    {
+        Entry& entry = entries[identifier];
+        entry.key = key;
+        entry.duration_us = duration_us;
+    }
+
+    void ResultCache::erase(const std::string& identifier)
+    {
+        entries.erase(identifier);
+    }
+
+    size_t ResultCache::size() const noexcept
+    {
+        return entries.size();
+    }
+
+    bool ResultCache::empty() const noexcept
+    {
+        return entries.empty();
+    }
+
+    void ResultCache::clear() noexcept
+    {
+        entries.clear();
+    }
+
+    bool ResultCache::hashFile(const std::string& path, uint64_t& hash)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        uint64_t result = hash_seed;
+        std::vector<char> buffer(hash_chunk_size);
+        while (file)
+        {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            const size_t n = static_cast<size_t>(file.gcount());
+            if (n > 0) result = combine(result, buffer.data(), n);
+        }
+        if (file.bad()) return false;
+        hash = result;
+        return true;
+    }
+
+    bool ResultCache::hashProgram(const std::string& executable, uint64_t& hash)
+    {
+        uint64_t result = 0;
+        if (!hashFile(executable, result)) return false;
+#if defined(__linux__)
+        std::vector<std::string> objects;
+        ::dl_iterate_phdr([](struct dl_phdr_info* info, size_t, void* data) -> int
+        {
+            // the program itself has no name
+            if (info->dlpi_name != nullptr && info->dlpi_name[0] != '\0') static_cast<std::vector<std::string>*>(data)->push_back(info->dlpi_name);
+            return 0;
+        }, &objects);
+        // in a fixed order, since plugins may be loaded in any
+        std::sort(objects.begin(), objects.end());
+        objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+        for (const std::string& object : objects)
+        {
+            uint64_t object_hash = 0;
+            if (!hashFile(object, object_hash)) continue;
+            result = combine(result, object);
+            result = combine(result, &object_hash, sizeof(object_hash));
+        }
+#endif
+        hash = result;
+        return true;
+    }
+
+    uint64_t ResultCache::makeKey(uint64_t program_hash, const std::string& identifier, const std::vector<std::string>& inputs)
+    {
+        uint64_t key = combine(program_hash, identifier);
+        std::vector<std::string> sorted = inputs;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        for (const std::string& input : sorted)
+        {
+            key = combine(key, input);
+            uint64_t hash = 0;
+            const bool found = hashFile(input, hash);
+            const uint64_t marker = found ? 1 : 0;
+            key = combine(key, &marker, sizeof(marker));
+            key = combine(key, &hash, sizeof(hash));
+        }
+        return key;
+    }
+
+}
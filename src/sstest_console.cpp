@@ -102,6 +102,11 @@ namespace sstest
         out.flush();
     }
 
+    bool Logger::ansiEnabled() const noexcept
+    {
+        return ansi_enable;
+    }
+
     void Logger::tab(size_t ntab) const
     {
         out << std::string(ntab * tab_width, ' ');
@@ -0,0 +1,305 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_coverage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_history.h"
+
+#if defined(SSTEST_COVERAGE) && !defined(_WIN32) && !defined(_WIN64)
+#   define SSTEST_HAS_COVERAGE
+#   include <dirent.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+
+// from libgcov, or the profile runtime of clang, linked in by --coverage
+extern "C" void __gcov_reset(void);
+extern "C" void __gcov_dump(void);
+#endif
+
+namespace
+{
+    // first line of the file, bump the version if the line format changes
+    const char* const IMPACT_HEADER = "# sstest impact 1";
+
+    bool isSeparator(char c) noexcept
+    {
+        return c == '/' || c == '\\';
+    }
+
+    // extensions of files compiled to an object of their own
+    bool isSourceExtension(const std::string& extension)
+    {
+        return extension == "c" || extension == "cc" || extension == "cpp" || extension == "cxx" || extension == "c++" || extension == "C";
+    }
+
+#if defined(SSTEST_HAS_COVERAGE)
+
+    const uint32_t gcda_magic = 0x67636461; // "gcda"
+    const uint32_t gcda_arc_counters = 0x01a10000;
+
+    // check if any arc counter in a .gcda file written by __gcov_dump() is not zero. A file that can't be read counts as run, 
+    // so a test is never left out because of it
+    bool gcdaHasCounts(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<uint32_t> words(data.size() / sizeof(uint32_t));
+        if (!words.empty()) std::memcpy(words.data(), data.data(), words.size() * sizeof(uint32_t));
+        if (words.size() < 3 || words[0] != gcda_magic) return true;
+
+        // the version is the compiler version as characters, e.g. "B22*" for GCC 12.2 or "408*" for 4.8. Since GCC 12 the header 
+        // has a checksum, and record lengths are in bytes instead of words
+        const char major_hi = static_cast<char>((words[1] >> 24) & 0xff);
+        const char major_lo = static_cast<char>((words[1] >> 16) & 0xff);
+        const int major = (major_hi >= 'A') ? (major_hi - 'A') * 10 + (major_lo - '0') : (major_hi - '0');
+        const bool byte_lengths = (major >= 12);
+
+        size_t pos = byte_lengths ? 4 : 3;
+        while (pos + 2 <= words.size())
+        {
+            const uint32_t tag = words[pos];
+            const uint32_t length = words[pos + 1];
+            pos += 2;
+            if (static_cast<int32_t>(length) < 0) continue; // counters that are all zero are left out
+            const size_t nwords = byte_lengths ? length / sizeof(uint32_t) : length;
+            if (nwords > words.size() - pos) return true;
+            if (tag == gcda_arc_counters && std::any_of(words.begin() + static_cast<std::ptrdiff_t>(pos), words.begin() + static_cast<std::ptrdiff_t>(pos + nwords), 
+                [](uint32_t word) -> bool { return word != 0; }))
+            {
+                return true;
+            }
+            pos += nwords;
+        }
+        return false;
+    }
+
+    // visit the files below a directory, then the directory itself
+    template <typename Visitor>
+    void walkDirectory(const std::string& dir, Visitor visit)
+    {
+        DIR* handle = opendir(dir.c_str());
+        if (handle != nullptr)
+        {
+            while (const dirent* entry = readdir(handle))
+            {
+                if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) continue;
+                const std::string path = dir + "/" + entry->d_name;
+                struct stat info;
+                if (lstat(path.c_str(), &info) != 0) continue;
+                if (S_ISDIR(info.st_mode)) walkDirectory(path, visit);
+                else visit(path, false);
+            }
+            closedir(handle);
+        }
+        visit(dir, true);
+    }
+
+#endif // defined(SSTEST_HAS_COVERAGE)
+}
+
+namespace sstest
+{
+
+    bool coverageAvailable() noexcept
+    {
+#if defined(SSTEST_HAS_COVERAGE)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void resetCoverage() noexcept
+    {
+#if defined(SSTEST_HAS_COVERAGE)
+        __gcov_reset();
+#endif
+    }
+
+    std::vector<std::string> collectCoverage()
+    {
+        std::vector<std::string> files;
+#if defined(SSTEST_HAS_COVERAGE)
+        const char* tmp = std::getenv("TMPDIR");
+        std::string dir = std::string((tmp != nullptr && *tmp != '\0') ? tmp : "/tmp") + "/sstest_coverage_XXXXXX";
+        if (mkdtemp(&dir[0]) == nullptr) throw Exception("could not create a directory to collect coverage in " + dir);
+
+        // gcov writes the counters of each object to GCOV_PREFIX followed by the path of the object
+        const char* prefix = std::getenv("GCOV_PREFIX");
+        const std::string old_prefix = (prefix != nullptr) ? prefix : "";
+        setenv("GCOV_PREFIX", dir.c_str(), 1);
+        __gcov_dump();
+        if (prefix != nullptr) setenv("GCOV_PREFIX", old_prefix.c_str(), 1);
+        else unsetenv("GCOV_PREFIX");
+
+        const std::string extension = ".gcda";
+        walkDirectory(dir, [&](const std::string& path, bool is_dir) -> void
+        {
+            if (!is_dir && path.size() > dir.size() + extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0
+                && gcdaHasCounts(path))
+            {
+                files.push_back(path.substr(dir.size(), path.size() - dir.size() - extension.size()));
+            }
+            if (is_dir) rmdir(path.c_str());
+            else std::remove(path.c_str());
+        });
+        std::sort(files.begin(), files.end());
+#endif
+        return files;
+    }
+
+    TestImpactIndex::TestImpactIndex() {}
+
+    bool TestImpactIndex::load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        if (!std::getline(file, line) || line != IMPACT_HEADER) return false;
+
+        // each line is "<file>\t<identifier>", with a line for each file a test ran
+        std::unordered_map<std::string, std::vector<std::string>> loaded;
+        while (std::getline(file, line))
+        {
+            const size_t tab = line.find('\t');
+            if (tab == std::string::npos || tab == 0 || tab + 1 >= line.size()) continue;
+            loaded[line.substr(tab + 1)].push_back(line.substr(0, tab));
+        }
+        for (auto& kv : loaded)
+        {
+            tests[kv.first] = std::move(kv.second);
+        }
+        return true;
+    }
+
+    bool TestImpactIndex::save(const std::string& path) const
+    {
+        return TestHistory::replaceFile(path, [this](std::ostream& file) -> void
+        {
+            file << IMPACT_HEADER << '\n';
+            // sorted so the file is the same for the same index, and diffs well
+            std::vector<const std::pair<const std::string, std::vector<std::string>>*> sorted;
+            for (const auto& kv : tests) sorted.push_back(&kv);
+            std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string, std::vector<std::string>>* lhs, const std::pair<const std::string, std::vector<std::string>>* rhs) -> bool
+            {
+                return lhs->first < rhs->first;
+            });
+            for (const auto* kv : sorted)
+            {
+                for (const std::string& source : kv->second)
+                {
+                    file << source << '\t' << kv->first << '\n';
+                }
+            }
+        });
+    }
+
+    void TestImpactIndex::recordTest(const std::string& identifier, std::vector<std::string> files)
+    {
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+        tests[identifier] = std::move(files);
+    }
+
+    const std::vector<std::string>* TestImpactIndex::find(const std::string& identifier) const
+    {
+        auto it = tests.find(identifier);
+        return (it == tests.end()) ? nullptr : &it->second;
+    }
+
+    bool TestImpactIndex::affected(const std::string& identifier, const std::vector<std::string>& changed) const
+    {
+        const std::vector<std::string>* files = find(identifier);
+        if (files == nullptr) return true;
+        return std::any_of(files->begin(), files->end(), [&](const std::string& recorded) -> bool
+        {
+            return std::any_of(changed.begin(), changed.end(), [&](const std::string& file) -> bool { return sameSource(recorded, file); });
+        });
+    }
+
+    bool TestImpactIndex::covers(const std::string& file) const
+    {
+        return std::any_of(tests.begin(), tests.end(), [&](const std::pair<const std::string, std::vector<std::string>>& kv) -> bool
+        {
+            return std::any_of(kv.second.begin(), kv.second.end(), [&](const std::string& recorded) -> bool { return sameSource(recorded, file); });
+        });
+    }
+
+    bool TestImpactIndex::sameSource(const std::string& recorded, const std::string& changed)
+    {
+        size_t begin = 0;
+        while (changed.compare(begin, 2, "./") == 0) begin += 2;
+        const size_t length = changed.size() - begin;
+        if (length == 0 || recorded.empty()) return false;
+
+        // "test/foo.cpp" is the same as "/repo/test/foo.cpp" and "/build/CMakeFiles/t.dir/test/foo.cpp", but not "/repo/test/xfoo.cpp"
+        if (recorded.size() >= length && recorded.compare(recorded.size() - length, length, changed, begin, length) == 0)
+        {
+            if (recorded.size() == length || isSeparator(recorded[recorded.size() - length - 1])) return true;
+        }
+
+        // objects compiled directly are named after the source without its extension, e.g. "/build/obj/foo" for "src/foo.cpp"
+        size_t name = recorded.size();
+        while (name > 0 && !isSeparator(recorded[name - 1])) name--;
+        if (recorded.find('.', name) != std::string::npos) return false;
+        size_t changed_name = changed.size();
+        while (changed_name > begin && !isSeparator(changed[changed_name - 1])) changed_name--;
+        const size_t dot = changed.find_last_of('.');
+        if (dot == std::string::npos || dot <= changed_name || !isSourceExtension(changed.substr(dot + 1))) return false;
+        return recorded.compare(name, std::string::npos, changed, changed_name, dot - changed_name) == 0;
+    }
+
+    size_t TestImpactIndex::size() const noexcept
+    {
+        return tests.size();
+    }
+
+    bool TestImpactIndex::empty() const noexcept
+    {
+        return tests.empty();
+    }
+
+    void TestImpactIndex::clear() noexcept
+    {
+        tests.clear();
+    }
+
+}
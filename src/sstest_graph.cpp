@@ -0,0 +1,273 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+
+namespace sstest
+{
+
+    TestGraph::TestGraph(size_t ntests)
+        : prerequisites_(ntests), dependents_(ntests), ndependencies(0), resources_(ntests), exclusive_(ntests, false), nconstrained(0)
+    {
+
+    }
+
+    size_t TestGraph::size() const noexcept
+    {
+        return prerequisites_.size();
+    }
+
+    bool TestGraph::hasDependencies() const noexcept
+    {
+        return ndependencies > 0;
+    }
+
+    void TestGraph::addDependency(size_t dependent, size_t prerequisite)
+    {
+        if (dependent >= size() || prerequisite >= size()) throw InvalidArgument("test index out of range of the test graph");
+        if (dependent == prerequisite) throw InvalidArgument("a test can't depend on itself");
+
+        std::vector<size_t>& prerequisites = prerequisites_[dependent];
+        if (std::find(prerequisites.begin(), prerequisites.end(), prerequisite) != prerequisites.end()) return;
+        prerequisites.push_back(prerequisite);
+        dependents_[prerequisite].push_back(dependent);
+        ndependencies++;
+    }
+
+    const std::vector<size_t>& TestGraph::prerequisites(size_t test) const
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        return prerequisites_[test];
+    }
+
+    const std::vector<size_t>& TestGraph::dependents(size_t test) const
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        return dependents_[test];
+    }
+
+    std::vector<size_t> TestGraph::topologicalOrder() const
+    {
+        std::vector<size_t> waiting(size());
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+        for (size_t i = 0; i < size(); i++)
+        {
+            waiting[i] = prerequisites_[i].size();
+            if (waiting[i] == 0) ready.push(i);
+        }
+
+        std::vector<size_t> order;
+        order.reserve(size());
+        while (!ready.empty())
+        {
+            const size_t test = ready.top();
+            ready.pop();
+            order.push_back(test);
+            for (size_t dependent : dependents_[test])
+            {
+                if (--waiting[dependent] == 0) ready.push(dependent);
+            }
+        }
+        // tests on a cycle never become ready
+        if (order.size() != size()) throw InvalidArgument("test dependencies form a cycle");
+        return order;
+    }
+
+    size_t TestGraph::addResource(size_t capacity)
+    {
+        if (capacity == 0) throw InvalidArgument("a resource must allow at least 1 test to use it");
+        capacities.push_back(capacity);
+        return capacities.size() - 1;
+    }
+
+    size_t TestGraph::numResources() const noexcept
+    {
+        return capacities.size();
+    }
+
+    size_t TestGraph::capacity(size_t resource) const
+    {
+        if (resource >= numResources()) throw InvalidArgument("resource index out of range of the test graph");
+        return capacities[resource];
+    }
+
+    void TestGraph::useResource(size_t test, size_t resource)
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        if (resource >= numResources()) throw InvalidArgument("resource index out of range of the test graph");
+
+        std::vector<size_t>& resources = resources_[test];
+        if (std::find(resources.begin(), resources.end(), resource) != resources.end()) return;
+        resources.push_back(resource);
+        nconstrained++;
+    }
+
+    const std::vector<size_t>& TestGraph::resources(size_t test) const
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        return resources_[test];
+    }
+
+    void TestGraph::setExclusive(size_t test)
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        if (exclusive_[test]) return;
+        exclusive_[test] = true;
+        nconstrained++;
+    }
+
+    bool TestGraph::exclusive(size_t test) const
+    {
+        if (test >= size()) throw InvalidArgument("test index out of range of the test graph");
+        return exclusive_[test];
+    }
+
+    bool TestGraph::hasResources() const noexcept
+    {
+        return nconstrained > 0;
+    }
+
+    TestGraph TestGraph::repeated(size_t times) const
+    {
+        TestGraph graph(size() * times);
+        graph.capacities = capacities;
+        for (size_t k = 0; k < times; k++)
+        {
+            const size_t offset = k * size();
+            for (size_t i = 0; i < size(); i++)
+            {
+                for (size_t prerequisite : prerequisites_[i])
+                {
+                    graph.addDependency(offset + i, offset + prerequisite);
+                }
+                for (size_t resource : resources_[i])
+                {
+                    graph.useResource(offset + i, resource);
+                }
+                if (exclusive_[i]) graph.setExclusive(offset + i);
+            }
+        }
+        return graph;
+    }
+
+    TestScheduler::TestScheduler(const TestGraph& graph)
+        : graph(graph), waiting(graph.size()), skipped_(graph.size(), false), in_use(graph.numResources(), 0), nrunning(0), exclusive_running(false)
+    {
+        for (size_t i = 0; i < graph.size(); i++)
+        {
+            waiting[i] = graph.prerequisites(i).size();
+        }
+    }
+
+    std::vector<size_t> TestScheduler::start()
+    {
+        for (size_t i = 0; i < graph.size(); i++)
+        {
+            if (waiting[i] == 0) held.insert(i);
+        }
+        std::vector<size_t> ready;
+        admit(ready);
+        return ready;
+    }
+
+    void TestScheduler::finish(size_t test, bool passed, std::vector<size_t>& ready, std::vector<size_t>& skipped)
+    {
+        assert(nrunning > 0);
+        nrunning--;
+        exclusive_running = false; // an exclusive test runs alone
+        for (size_t resource : graph.resources(test))
+        {
+            assert(in_use[resource] > 0);
+            in_use[resource]--;
+        }
+
+        if (passed)
+        {
+            for (size_t dependent : graph.dependents(test))
+            {
+                if (--waiting[dependent] == 0 && !skipped_[dependent]) held.insert(dependent);
+            }
+            admit(ready);
+            return;
+        }
+
+        // none of the dependents have started, since they were waiting on this test
+        const size_t nskipped = skipped.size();
+        std::vector<size_t> stack(graph.dependents(test));
+        while (!stack.empty())
+        {
+            const size_t dependent = stack.back();
+            stack.pop_back();
+            if (skipped_[dependent]) continue;
+            skipped_[dependent] = true;
+            skipped.push_back(dependent);
+            const std::vector<size_t>& next = graph.dependents(dependent);
+            stack.insert(stack.end(), next.begin(), next.end());
+        }
+        std::sort(skipped.begin() + static_cast<std::ptrdiff_t>(nskipped), skipped.end());
+        admit(ready);
+    }
+
+    void TestScheduler::admit(std::vector<size_t>& ready)
+    {
+        auto it = held.begin();
+        while (it != held.end() && !exclusive_running)
+        {
+            const size_t test = *it;
+            const std::vector<size_t>& resources = graph.resources(test);
+            bool fits = graph.exclusive(test) ? (nrunning == 0) : std::all_of(resources.begin(), resources.end(), [&](size_t resource) -> bool 
+            {
+                return in_use[resource] < graph.capacity(resource);
+            });
+            if (!fits)
+            {
+                ++it;
+                continue;
+            }
+            for (size_t resource : resources)
+            {
+                in_use[resource]++;
+            }
+            nrunning++;
+            exclusive_running = graph.exclusive(test);
+            ready.push_back(test);
+            it = held.erase(it);
+        }
+    }
+
+}
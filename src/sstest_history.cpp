@@ -0,0 +1,222 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_history.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+#   include <process.h>
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#   define SSTEST_GETPID ::_getpid
+#   define SSTEST_REPLACE_FILE(from, to) (::MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0)
+#else
+#   include <unistd.h>
+#   define SSTEST_GETPID ::getpid
+#   define SSTEST_REPLACE_FILE(from, to) (std::rename(from, to) == 0)
+#endif
+
+namespace
+{
+    // first line of the file, bump the version if the line format changes
+    const char* const HISTORY_HEADER = "# sstest history 1";
+    const size_t HISTORY_NUMBERS = 4; // fields before the identifier
+
+    // once a test has this many recorded runs, both counts are halved, so recent runs weigh the most
+    const uint32_t RESULT_WINDOW = 32;
+
+    // parse the number at the start of the field, which must end at the given position
+    bool parseField(const std::string& line, size_t begin, size_t end, unsigned long long& value)
+    {
+        if (begin >= end) return false;
+        char* parsed_end = nullptr;
+        value = std::strtoull(line.c_str() + begin, &parsed_end, 10);
+        return parsed_end == line.c_str() + end;
+    }
+}
+
+namespace sstest
+{
+
+    double TestHistory::Record::failureRate() const noexcept
+    {
+        // add one failed and one passed run, so a test that never failed yet still has some chance to
+        return (failures + 1.0) / (runs + 2.0);
+    }
+
+    TestHistory::TestHistory() {}
+
+    bool TestHistory::load(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        std::string line;
+        if (!std::getline(file, line) || line != HISTORY_HEADER) return false; // unknown format, start over
+
+        // each line is "<duration_us>\t<failed>\t<runs>\t<failures>\t<identifier>"
+        while (std::getline(file, line))
+        {
+            unsigned long long fields[HISTORY_NUMBERS] = { 0, 0, 0, 0 };
+            size_t start = 0;
+            bool valid = true;
+            for (size_t i = 0; i < HISTORY_NUMBERS && valid; i++)
+            {
+                const size_t tab = line.find('\t', start);
+                valid = (tab != std::string::npos) && parseField(line, start, tab, fields[i]);
+                start = tab + 1;
+            }
+            if (!valid || fields[1] > 1 || fields[3] > fields[2] || fields[2] > RESULT_WINDOW || start >= line.size()) continue;
+            Record& record = records[line.substr(start)];
+            record.duration_us = static_cast<uint64_t>(fields[0]);
+            record.failed = (fields[1] != 0);
+            record.runs = static_cast<uint32_t>(fields[2]);
+            record.failures = static_cast<uint32_t>(fields[3]);
+        }
+        return true;
+    }
+
+    bool TestHistory::save(const std::string& path) const
+    {
+        return replaceFile(path, [this](std::ostream& file) -> void
+        {
+            file << HISTORY_HEADER << '\n';
+            // sorted so the file is the same for the same records
+            std::vector<const std::pair<const std::string, Record>*> sorted;
+            for (const auto& kv : records) sorted.push_back(&kv);
+            std::sort(sorted.begin(), sorted.end(), [](const std::pair<const std::string, Record>* lhs, const std::pair<const std::string, Record>* rhs) -> bool
+            {
+                return lhs->first < rhs->first;
+            });
+            for (const auto* kv : sorted)
+            {
+                const Record& record = kv->second;
+                file << record.duration_us << '\t' << (record.failed ? 1 : 0) << '\t' << record.runs << '\t' << record.failures << '\t' << kv->first << '\n';
+            }
+        });
+    }
+
+    std::string TestHistory::temporaryPath(const std::string& path)
+    {
+        // the counter keeps apart files a thread saves one after another, should one be left behind
+        static std::atomic<unsigned long> count(0);
+        const size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return path + ".tmp." + std::to_string(SSTEST_GETPID()) + "." + std::to_string(thread) + "." + std::to_string(count++);
+    }
+
+    bool TestHistory::replaceFile(const std::string& path, const std::function<void(std::ostream&)>& write)
+    {
+        const std::string tmp_path = temporaryPath(path);
+        {
+            std::ofstream file(tmp_path, std::ios::trunc);
+            if (!file) return false;
+            write(file);
+            if (!file.flush()) 
+            {
+                file.close();
+                std::remove(tmp_path.c_str());
+                return false;
+            }
+        }
+        if (!SSTEST_REPLACE_FILE(tmp_path.c_str(), path.c_str()))
+        {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const TestHistory::Record* TestHistory::find(const std::string& identifier) const
+    {
+        auto it = records.find(identifier);
+        return (it == records.end()) ? nullptr : &it->second;
+    }
+
+    void TestHistory::recordDuration(const std::string& identifier, uint64_t duration_us)
+    {
+        auto it = records.find(identifier);
+        if (it == records.end())
+        {
+            records[identifier].duration_us = duration_us;
+        }
+        else
+        {
+            it->second.duration_us = (it->second.duration_us + duration_us) / 2;
+        }
+    }
+
+    void TestHistory::recordResult(const std::string& identifier, bool passed)
+    {
+        Record& record = records[identifier];
+        record.failed = !passed;
+        if (record.runs >= RESULT_WINDOW)
+        {
+            record.runs /= 2;
+            record.failures /= 2;
+        }
+        record.runs++;
+        if (!passed) record.failures++;
+    }
+
+    size_t TestHistory::numFailed() const noexcept
+    {
+        size_t count = 0;
+        for (const auto& kv : records)
+        {
+            count += kv.second.failed ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t TestHistory::size() const noexcept
+    {
+        return records.size();
+    }
+
+    bool TestHistory::empty() const noexcept
+    {
+        return records.empty();
+    }
+
+    void TestHistory::clear() noexcept
+    {
+        records.clear();
+    }
+
+}
@@ -0,0 +1,260 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "sstest/sstest_journal.h"
+
+#include <cerrno>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#   include <fcntl.h>
+#   include <io.h>
+#   include <sys/stat.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace
+{
+    using namespace sstest;
+
+#if defined(_WIN32) || defined(_WIN64)
+    int openFile(const std::string& path, bool truncate)
+    {
+        return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY | (truncate ? _O_TRUNC : 0), _S_IREAD | _S_IWRITE);
+    }
+
+    bool writeFile(int fd, const char* data, size_t len)
+    {
+        while (len > 0)
+        {
+            const int n = ::_write(fd, data, static_cast<unsigned int>(len));
+            if (n <= 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void syncFile(int fd) { ::_commit(fd); }
+    bool truncateFile(int fd, size_t len) { return ::_chsize_s(fd, static_cast<long long>(len)) == 0; }
+    bool seekEnd(int fd) { return ::_lseeki64(fd, 0, SEEK_END) >= 0; }
+    void closeFile(int fd) { ::_close(fd); }
+#else
+    int openFile(const std::string& path, bool truncate)
+    {
+        return ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+    }
+
+    bool writeFile(int fd, const char* data, size_t len)
+    {
+        while (len > 0)
+        {
+            const ssize_t n = ::write(fd, data, len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    void syncFile(int fd) { ::fsync(fd); }
+    bool truncateFile(int fd, size_t len) { return ::ftruncate(fd, static_cast<off_t>(len)) == 0; }
+    bool seekEnd(int fd) { return ::lseek(fd, 0, SEEK_END) >= 0; }
+    void closeFile(int fd) { ::close(fd); }
+#endif
+
+    // the first line of records written by writeTestRecords()
+    std::string recordsHeader()
+    {
+        std::ostringstream os;
+        writeTestRecords(os, std::vector<TestRecord>());
+        return os.str();
+    }
+
+    // parse the records of a journal, returning how many bytes of it are whole records, or 0 if it isn't a journal. Lines are 
+    // parsed one at a time, so the records before a line cut off by a crash are kept
+    size_t parseJournal(const std::string& contents, std::vector<TestRecord>& records)
+    {
+        records.clear();
+        const std::string header = recordsHeader();
+        if (contents.compare(0, header.size(), header) != 0) return 0;
+        size_t end = header.size();
+        while (end < contents.size())
+        {
+            const size_t newline = contents.find('\n', end);
+            if (newline == std::string::npos) break; // the last write didn't finish
+            std::istringstream line(header + contents.substr(end, newline + 1 - end));
+            try
+            {
+                const std::vector<TestRecord> parsed = readTestRecords(line);
+                records.insert(records.end(), parsed.begin(), parsed.end());
+            }
+            catch (const InvalidArgument&)
+            {
+                break; // e.g. zeros left where the file grew but the data never reached the disk
+            }
+            end = newline + 1;
+        }
+        return end;
+    }
+
+    bool readFile(const std::string& path, std::string& contents)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !file.bad();
+    }
+}
+
+namespace sstest
+{
+
+    constexpr size_t TestJournal::sync_batch_size;
+    constexpr std::chrono::milliseconds::rep TestJournal::sync_interval_ms;
+
+    TestJournal::TestJournal() noexcept
+        : fd(-1), unsynced(0), closing(false)
+    {
+
+    }
+
+    TestJournal::~TestJournal()
+    {
+        close();
+    }
+
+    bool TestJournal::read(const std::string& path, std::vector<TestRecord>& records)
+    {
+        std::string contents;
+        if (!readFile(path, contents)) return false;
+        return parseJournal(contents, records) > 0;
+    }
+
+    void TestJournal::open(const std::string& path, bool resume)
+    {
+        close();
+        this->path = path;
+
+        // keep only the whole records of the journal, so new records start on a line of their own
+        std::string contents;
+        std::vector<TestRecord> records;
+        const size_t valid = (resume && readFile(path, contents)) ? parseJournal(contents, records) : 0;
+
+        fd = openFile(path, valid == 0);
+        if (fd < 0) throw Exception("could not open journal " + path);
+        bool opened = true;
+        if (valid == 0)
+        {
+            const std::string header = recordsHeader();
+            opened = writeFile(fd, header.data(), header.size());
+        }
+        else if (valid < contents.size())
+        {
+            opened = truncateFile(fd, valid);
+        }
+        opened = opened && seekEnd(fd);
+        if (!opened)
+        {
+            closeFile(fd);
+            fd = -1;
+            throw Exception("could not write journal " + path);
+        }
+        syncFile(fd);
+
+        closing = false;
+        unsynced = 0;
+        syncer = std::thread([this]() -> void
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!closing)
+            {
+                wake.wait_for(lock, std::chrono::milliseconds(sync_interval_ms));
+                if (unsynced > 0) syncLocked(lock);
+            }
+        });
+    }
+
+    void TestJournal::append(const TestRecord& record)
+    {
+        std::ostringstream os;
+        writeTestRecord(os, record);
+        const std::string line = os.str();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (fd < 0) return;
+        // the whole line in one write, so a crash leaves at most a cut off line at the end
+        if (!writeFile(fd, line.data(), line.size())) throw Exception("could not write journal " + path);
+        if (++unsynced >= sync_batch_size) syncLocked(lock);
+    }
+
+    void TestJournal::sync()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (fd >= 0) syncLocked(lock);
+    }
+
+    void TestJournal::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+        }
+        wake.notify_all();
+        if (syncer.joinable()) syncer.join();
+        if (fd < 0) return;
+        syncFile(fd);
+        closeFile(fd);
+        fd = -1;
+    }
+
+    bool TestJournal::isOpen() const noexcept
+    {
+        return fd >= 0;
+    }
+
+    void TestJournal::syncLocked(std::unique_lock<std::mutex>& lock)
+    {
+        const int sync_fd = fd;
+        unsynced = 0;
+        lock.unlock();
+        syncFile(sync_fd);
+        lock.lock();
+    }
+
+}
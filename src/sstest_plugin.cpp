@@ -0,0 +1,185 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "sstest/sstest_plugin.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_registry.h"
+#include "sstest/sstest_runner.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#   define SSTEST_HAS_DLOPEN
+#   include <dlfcn.h>
+#   include <unistd.h>
+#   include <sys/stat.h>
+#   include <sys/types.h>
+#endif
+
+namespace sstest
+{
+
+#if defined(SSTEST_HAS_DLOPEN)
+
+    namespace
+    {
+
+        // a library is loaded from a copy, since a library rebuilt in place would change the code of the loaded one under it, and a 
+        // library loaded again from the same path may be given the old one back, e.g. if its C++ symbols keep it from being unloaded
+        std::string copyLibrary(const std::string& path)
+        {
+            std::ifstream library(path, std::ios::binary);
+            if (!library) throw Exception("could not read test plugin " + path);
+            const std::string contents((std::istreambuf_iterator<char>(library)), std::istreambuf_iterator<char>());
+
+            const char* tmp = std::getenv("TMPDIR");
+            std::string copy = std::string((tmp != nullptr && *tmp != '\0') ? tmp : "/tmp") + "/sstest_plugin.XXXXXX";
+            const int fd = ::mkstemp(&copy[0]);
+            if (fd < 0) throw Exception("could not copy test plugin " + path + " to " + copy + ": " + std::strerror(errno));
+            size_t written = 0;
+            while (written < contents.size())
+            {
+                const ssize_t n = ::write(fd, contents.data() + written, contents.size() - written);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                written += static_cast<size_t>(n);
+            }
+            ::close(fd);
+            if (written < contents.size())
+            {
+                ::unlink(copy.c_str());
+                throw Exception("could not copy test plugin " + path + " to " + copy);
+            }
+            return copy;
+        }
+
+    }
+
+    TestPlugin::TestPlugin(const std::string& path)
+        : library_path(path), loaded(), tests(nullptr), handle(nullptr)
+    {
+        if (!stamp(path, loaded)) throw Exception("could not find test plugin " + path);
+        const std::string copy = copyLibrary(path);
+
+        // tests register themselves when the library is loaded, where a registrar that throws would terminate the program, so their 
+        // errors are kept and thrown once it is
+        std::unique_ptr<TestRegistry> library_tests(new TestRegistry);
+        library_tests->deferRegistrationErrors();
+        {
+            TestRunner::ScopedRegistry scope(library_tests.get());
+            handle = ::dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+        }
+        // the loaded library stays mapped
+        ::unlink(copy.c_str());
+        if (handle == nullptr)
+        {
+            const char* error = ::dlerror();
+            throw Exception("could not load test plugin " + path + ": " + (error != nullptr ? error : "unknown error"));
+        }
+        if (!library_tests->getRegistrationErrors().empty())
+        {
+            const std::string error = library_tests->getRegistrationErrors().front();
+            // tests hold code of the library, so they go before it
+            library_tests.reset();
+            ::dlclose(handle);
+            handle = nullptr;
+            throw Exception("could not register the tests of plugin " + path + ": " + error);
+        }
+        tests = library_tests.release();
+    }
+
+    TestPlugin::~TestPlugin()
+    {
+        // tests hold code of the library, e.g. their invokers, so they go first
+        delete tests;
+        ::dlclose(handle);
+    }
+
+    bool TestPlugin::changed() const
+    {
+        Stamp current;
+        if (!stamp(library_path, current)) return false;
+        return current.device != loaded.device || current.inode != loaded.inode || current.size != loaded.size || current.modified_ns != loaded.modified_ns;
+    }
+
+    bool TestPlugin::stamp(const std::string& path, Stamp& stamp)
+    {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0) return false;
+        stamp.device = static_cast<uint64_t>(st.st_dev);
+        stamp.inode = static_cast<uint64_t>(st.st_ino);
+        stamp.size = static_cast<uint64_t>(st.st_size);
+#   if defined(__APPLE__)
+        stamp.modified_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#   else
+        stamp.modified_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#   endif
+        return true;
+    }
+
+#else // defined(SSTEST_HAS_DLOPEN)
+
+    TestPlugin::TestPlugin(const std::string& path)
+        : library_path(path), loaded(), tests(nullptr), handle(nullptr)
+    {
+        throw Exception("test plugins are not supported on this platform");
+    }
+
+    TestPlugin::~TestPlugin() {}
+
+    bool TestPlugin::changed() const
+    {
+        return false;
+    }
+
+    bool TestPlugin::stamp(const std::string&, Stamp&)
+    {
+        return false;
+    }
+
+#endif // defined(SSTEST_HAS_DLOPEN)
+
+    const std::string& TestPlugin::path() const noexcept
+    {
+        return library_path;
+    }
+
+    TestRegistry& TestPlugin::registry() noexcept
+    {
+        return *tests;
+    }
+
+}
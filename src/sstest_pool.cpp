@@ -0,0 +1,399 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <utility>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#define SSTEST_HAS_RUSAGE
+#include <sys/resource.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace sstest
+{
+
+    namespace
+    {
+        // how often an adapting pool checks how busy the CPUs are
+        const std::chrono::milliseconds adapt_interval(100);
+
+#if defined(SSTEST_HAS_RUSAGE)
+        // CPU time used by every thread of the process so far
+        double processCpuSeconds() noexcept
+        {
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+            return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + 
+                static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        }
+#endif
+
+        // whole CPUs a quota of CPU time per period allows, counted towards the smallest limit so far
+        void limitCpus(long long quota, long long period, size_t& limit) noexcept
+        {
+            if (quota <= 0 || period <= 0) return;
+            const size_t ncpus = static_cast<size_t>((quota + period - 1) / period);
+            if (limit == 0 || ncpus < limit) limit = ncpus;
+        }
+    }
+
+    WorkStealingPool::WorkStealingPool(size_t nworkers, bool stealing)
+        : stealing(stealing), queued(0), pending(0), adapt_cpus(0), nactive(0), npeak(0), done(false)
+    {
+        if (nworkers == 0) nworkers = hardwareConcurrency();
+        for (size_t i = 0; i < nworkers; i++)
+        {
+            queues.emplace_back(new Queue);
+        }
+        nactive = nworkers;
+        npeak = nworkers;
+    }
+
+    WorkStealingPool::~WorkStealingPool() {}
+
+    size_t WorkStealingPool::size() const noexcept
+    {
+        return queues.size();
+    }
+
+    void WorkStealingPool::pinWorkers(std::vector<CpuSet> placement)
+    {
+        worker_cpus = std::move(placement);
+    }
+
+    void WorkStealingPool::setWorkerExit(task_type exit)
+    {
+        worker_exit = std::move(exit);
+    }
+
+    size_t WorkStealingPool::hardwareConcurrency() noexcept
+    {
+        size_t n = std::thread::hardware_concurrency();
+#if defined(__linux__)
+        // e.g. a container given some of the CPUs of the machine, or a process started with taskset
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) n = static_cast<size_t>(CPU_COUNT(&cpus));
+#endif
+        try
+        {
+            const size_t quota = cgroupCpuLimit();
+            if (quota > 0 && (n == 0 || quota < n)) n = quota;
+        }
+        catch (...) {} // the quota is only a hint
+        return (n == 0) ? 1 : n;
+    }
+
+    size_t WorkStealingPool::cgroupCpuLimit(const std::string& root)
+    {
+        size_t limit = 0;
+#if defined(__linux__)
+        // each line is hierarchy-id:controllers:path, where cgroup v2 has id 0 and no controllers
+        std::ifstream cgroups(root + "/proc/self/cgroup");
+        std::string line;
+        std::string unified_path;
+        std::string cpu_path;
+        bool unified = false;
+        bool cpu = false;
+        while (std::getline(cgroups, line))
+        {
+            const size_t first = line.find(':');
+            const size_t second = (first == std::string::npos) ? std::string::npos : line.find(':', first + 1);
+            if (second == std::string::npos) continue;
+            const std::string controllers = line.substr(first + 1, second - first - 1);
+            if (line.compare(0, first, "0") == 0 && controllers.empty())
+            {
+                unified_path = line.substr(second + 1);
+                unified = true;
+            }
+            else if (("," + controllers + ",").find(",cpu,") != std::string::npos)
+            {
+                cpu_path = line.substr(second + 1);
+                cpu = true;
+            }
+        }
+
+        if (cpu)
+        {
+            // in a container the mount may show the cgroup of the process as its root, so the path is only tried first
+            const std::string mounts[] = { root + "/sys/fs/cgroup/cpu,cpuacct", root + "/sys/fs/cgroup/cpu" };
+            bool found = false;
+            for (size_t i = 0; i < 4 && !found; i++)
+            {
+                const std::string dir = mounts[i / 2] + ((i % 2 == 0) ? cpu_path : std::string());
+                long long quota = 0;
+                long long period = 0;
+                std::ifstream quota_file(dir + "/cpu.cfs_quota_us");
+                std::ifstream period_file(dir + "/cpu.cfs_period_us");
+                if (!(quota_file >> quota) || !(period_file >> period)) continue;
+                limitCpus(quota, period, limit);
+                found = true;
+            }
+        }
+
+        if (unified)
+        {
+            // a parent's quota also limits its children, and the path may not exist below the mount, as above
+            std::string path = unified_path;
+            while (true)
+            {
+                std::ifstream file(root + "/sys/fs/cgroup" + ((path == "/") ? std::string() : path) + "/cpu.max");
+                std::string quota;
+                long long period = 0;
+                if ((file >> quota >> period) && quota != "max") limitCpus(std::atoll(quota.c_str()), period, limit);
+                if (path.empty() || path == "/") break;
+                const size_t slash = path.find_last_of('/');
+                path = (slash == 0 || slash == std::string::npos) ? std::string("/") : path.substr(0, slash);
+            }
+        }
+#else
+        (void)root;
+#endif
+        return limit;
+    }
+
+    void WorkStealingPool::adaptWorkers(size_t ncpus)
+    {
+#if defined(SSTEST_HAS_RUSAGE)
+        // without stealing, the tasks of a worker that stopped would never run
+        if (stealing) adapt_cpus = std::max<size_t>(ncpus, 1);
+#else
+        (void)ncpus;
+#endif
+    }
+
+    size_t WorkStealingPool::peakWorkers() const noexcept
+    {
+        return npeak;
+    }
+
+    bool WorkStealingPool::active(size_t id) const noexcept
+    {
+        return id < nactive;
+    }
+
+    void WorkStealingPool::submit(size_t worker, task_type task)
+    {
+        assert(!queues.empty());
+        Queue& queue = *queues[worker % queues.size()];
+        pending++;
+        {
+            // lock so an idle worker can't miss the notification between checking and waiting
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            queued++;
+            if (!stealing)
+            {
+                // the owner checks its own queue before waiting, so it must see the task along with the count
+                std::lock_guard<std::mutex> queue_lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+        }
+        if (stealing)
+        {
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(std::move(task));
+            }
+            // a worker that isn't taking tasks would swallow the notification
+            if (adapt_cpus > 0) idle_cv.notify_all();
+            else idle_cv.notify_one();
+        }
+        else
+        {
+            // only the owner can take the task
+            idle_cv.notify_all();
+        }
+    }
+
+    void WorkStealingPool::run()
+    {
+        nactive = (adapt_cpus == 0) ? queues.size() : std::min(adapt_cpus, queues.size());
+        npeak = nactive.load();
+        done = false;
+        std::vector<std::thread> threads;
+        threads.reserve(queues.size());
+        for (size_t i = 0; i < queues.size(); i++)
+        {
+            threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+        }
+        std::thread adapter;
+        if (adapt_cpus > 0) adapter = std::thread(&WorkStealingPool::adaptLoop, this);
+        for (std::thread& t : threads)
+        {
+            t.join();
+        }
+        if (adapter.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                done = true;
+            }
+            adapt_cv.notify_all();
+            adapter.join();
+        }
+        if (error)
+        {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+    void WorkStealingPool::workerLoop(size_t id)
+    {
+        if (!worker_cpus.empty()) CpuTopology::setAffinity(worker_cpus[id % worker_cpus.size()]); // the worker runs unpinned if it can't be
+        task_type task;
+        while (true)
+        {
+            if (active(id) && (pop(id, task) || (stealing && steal(id, task))))
+            {
+                try
+                {
+                    task(id);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+                task = nullptr;
+                finishTask();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle_cv.wait(lock, [&]() -> bool { return (active(id) && (stealing ? queued > 0 : hasTasks(id))) || pending == 0; });
+            if (queued == 0 && pending == 0) break;
+        }
+
+        if (!worker_exit) return;
+        try
+        {
+            worker_exit(id);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    void WorkStealingPool::adaptLoop()
+    {
+#if defined(SSTEST_HAS_RUSAGE)
+        std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+        double last_cpu = processCpuSeconds();
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        while (!adapt_cv.wait_for(lock, adapt_interval, [this]() -> bool { return done; }))
+        {
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            const double cpu = processCpuSeconds();
+            const double wall = std::chrono::duration<double>(now - last).count();
+            if (wall <= 0) continue;
+            const double busy = (cpu - last_cpu) / wall; // CPUs kept busy since the last check
+            last = now;
+            last_cpu = cpu;
+
+            // workers that leave CPUs idle are waiting on something else, so as many more are added as would fill the idle CPUs, 
+            // at most doubling each time. Busy CPUs shared by more workers than CPUs lose a worker each time
+            const size_t n = nactive;
+            const double ncpus = static_cast<double>(adapt_cpus);
+            size_t target = n;
+            if (busy + 0.5 < ncpus)
+            {
+                if (queued > 0) target = std::min(2 * n, static_cast<size_t>(std::ceil(ncpus * static_cast<double>(n) / std::max(busy, 0.1))));
+            }
+            else if (n > adapt_cpus)
+            {
+                target = n - 1;
+            }
+            target = std::max<size_t>(1, std::min(target, queues.size()));
+            if (target == n) continue;
+            nactive = target;
+            if (target > npeak) npeak = target;
+            if (target > n) idle_cv.notify_all();
+        }
+#endif
+    }
+
+    bool WorkStealingPool::pop(size_t id, task_type& task)
+    {
+        Queue& queue = *queues[id];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        queued--;
+        return true;
+    }
+
+    bool WorkStealingPool::steal(size_t id, task_type& task)
+    {
+        for (size_t i = 1; i < queues.size(); i++)
+        {
+            Queue& victim = *queues[(id + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    bool WorkStealingPool::hasTasks(size_t id)
+    {
+        Queue& queue = *queues[id];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        return !queue.tasks.empty();
+    }
+
+    void WorkStealingPool::finishTask()
+    {
+        if (--pending == 0)
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle_cv.notify_all();
+        }
+    }
+
+}
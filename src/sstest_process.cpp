@@ -0,0 +1,414 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_process.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_pool.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#   define SSTEST_HAS_FORK
+#   include <unistd.h>
+#   include <poll.h>
+#   include <signal.h>
+#   include <sys/types.h>
+#   include <sys/wait.h>
+#endif
+
+namespace sstest
+{
+
+#if defined(SSTEST_HAS_FORK)
+
+    namespace
+    {
+
+        bool readAll(int fd, void* buf, size_t n)
+        {
+            char* p = static_cast<char*>(buf);
+            while (n > 0)
+            {
+                ssize_t r = ::read(fd, p, n);
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) return false;
+                p += r;
+                n -= static_cast<size_t>(r);
+            }
+            return true;
+        }
+
+        bool writeAll(int fd, const void* buf, size_t n)
+        {
+            const char* p = static_cast<const char*>(buf);
+            while (n > 0)
+            {
+                ssize_t w = ::write(fd, p, n);
+                if (w < 0 && errno == EINTR) continue;
+                if (w <= 0) return false;
+                p += w;
+                n -= static_cast<size_t>(w);
+            }
+            return true;
+        }
+
+        bool readMessage(int fd, std::string& msg)
+        {
+            uint64_t len = 0;
+            if (!readAll(fd, &len, sizeof(len))) return false;
+            msg.resize(static_cast<size_t>(len));
+            return len == 0 || readAll(fd, &msg[0], msg.size());
+        }
+
+        bool writeMessage(int fd, const std::string& msg)
+        {
+            uint64_t len = msg.size();
+            return writeAll(fd, &len, sizeof(len)) && writeAll(fd, msg.data(), msg.size());
+        }
+
+        // worker process main loop: run each task index received until the parent closes the pipe
+        void workerMain(int task_fd, int result_fd, const ProcessPool::work_type& work, const ProcessPool::exit_type& exit)
+        {
+            uint64_t task = 0;
+            while (readAll(task_fd, &task, sizeof(task)))
+            {
+                std::string msg;
+                try
+                {
+                    msg = work(static_cast<size_t>(task));
+                }
+                catch (...)
+                {
+                    ::_exit(EXIT_FAILURE);
+                }
+                if (!writeMessage(result_fd, msg)) break;
+            }
+            if (exit)
+            {
+                try
+                {
+                    exit();
+                }
+                catch (...)
+                {
+                    ::_exit(EXIT_FAILURE);
+                }
+            }
+            // skip static destructors and buffered output inherited from the parent
+            ::_exit(EXIT_SUCCESS);
+        }
+
+    }
+
+#endif // defined(SSTEST_HAS_FORK)
+
+    ProcessPool::ProcessPool(size_t nworkers)
+        : workers((nworkers == 0) ? WorkStealingPool::hardwareConcurrency() : nworkers), stopping(false)
+    {
+        for (Worker& worker : workers)
+        {
+            worker.pid = 0;
+            worker.task_fd = -1;
+            worker.result_fd = -1;
+            worker.busy = false;
+            worker.task = 0;
+        }
+    }
+
+    ProcessPool::~ProcessPool()
+    {
+#if defined(SSTEST_HAS_FORK)
+        for (Worker& worker : workers)
+        {
+            if (worker.pid != 0) retire(worker);
+        }
+#endif
+    }
+
+    size_t ProcessPool::size() const noexcept
+    {
+        return workers.size();
+    }
+
+    void ProcessPool::pinWorkers(std::vector<CpuSet> placement)
+    {
+        worker_cpus = std::move(placement);
+    }
+
+    void ProcessPool::setWorkerExit(exit_type exit)
+    {
+        worker_exit = std::move(exit);
+    }
+
+    bool ProcessPool::supported() noexcept
+    {
+#if defined(SSTEST_HAS_FORK)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void ProcessPool::stop() noexcept
+    {
+        stopping = true;
+    }
+
+    void ProcessPool::run(size_t ntasks, work_type work, finish_type finish, crash_type crash)
+    {
+        size_t next = 0;
+        run([&next, ntasks](size_t& task) -> bool
+        {
+            if (next >= ntasks) return false;
+            task = next++;
+            return true;
+        }, work, finish, crash);
+    }
+
+#if defined(SSTEST_HAS_FORK)
+
+    void ProcessPool::run(next_type next, work_type work, finish_type finish, crash_type crash)
+    {
+        // a worker may die with tasks still in its pipe, don't let that kill the parent. The handler is restored and the workers 
+        // retired however the run ends, also when spawn(), poll() or a callback throws
+        class RunScope
+        {
+        public:
+            explicit RunScope(ProcessPool& pool) noexcept
+                : pool(pool)
+            {
+                struct sigaction ignore_pipe;
+                std::memset(&ignore_pipe, 0, sizeof(ignore_pipe));
+                ignore_pipe.sa_handler = SIG_IGN;
+                ::sigaction(SIGPIPE, &ignore_pipe, &old_pipe);
+            }
+
+            RunScope(const RunScope&) = delete;
+            RunScope& operator=(const RunScope&) = delete;
+
+            ~RunScope()
+            {
+                for (Worker& worker : pool.workers)
+                {
+                    if (worker.pid != 0) pool.retire(worker);
+                }
+                ::sigaction(SIGPIPE, &old_pipe, nullptr);
+            }
+
+        private:
+            ProcessPool& pool;
+            struct sigaction old_pipe;
+        };
+        RunScope scope(*this);
+
+        // don't let workers inherit unflushed output
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        stopping = false;
+        // hand a task to each idle worker while there are tasks ready, workers are forked when first needed
+        auto dispatch = [&]() -> void
+        {
+            for (Worker& worker : workers)
+            {
+                if (stopping) return;
+                if (worker.busy) continue;
+                size_t task = 0;
+                if (!next(task)) return;
+                if (worker.pid == 0) spawn(worker, work);
+                assign(worker, task);
+            }
+        };
+        dispatch();
+
+        std::vector<struct pollfd> fds;
+        std::vector<Worker*> polled;
+        while (true)
+        {
+            fds.clear();
+            polled.clear();
+            for (Worker& worker : workers)
+            {
+                if (!worker.busy) continue;
+                struct pollfd pfd;
+                pfd.fd = worker.result_fd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                fds.push_back(pfd);
+                polled.push_back(&worker);
+            }
+            if (fds.empty()) break;
+
+            int nready = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1);
+            if (nready < 0 && errno == EINTR) continue;
+            if (nready < 0) throw Exception(std::string("poll() failed: ") + std::strerror(errno));
+
+            for (size_t i = 0; i < fds.size(); i++)
+            {
+                if (fds[i].revents == 0) continue;
+                Worker& worker = *polled[i];
+                std::string msg;
+                if (readMessage(worker.result_fd, msg))
+                {
+                    worker.busy = false;
+                    finish(worker.task, msg);
+                }
+                else
+                {
+                    size_t task = worker.task;
+                    int status = 0;
+                    ::close(worker.task_fd);
+                    ::close(worker.result_fd);
+                    while (::waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {}
+                    worker.pid = 0;
+                    worker.busy = false;
+                    crash(task, status);
+                }
+            }
+            dispatch();
+        }
+    }
+
+    void ProcessPool::spawn(Worker& worker, const work_type& work)
+    {
+        int task_pipe[2];
+        int result_pipe[2];
+        if (::pipe(task_pipe) != 0) throw Exception(std::string("pipe() failed: ") + std::strerror(errno));
+        if (::pipe(result_pipe) != 0) 
+        {
+            ::close(task_pipe[0]);
+            ::close(task_pipe[1]);
+            throw Exception(std::string("pipe() failed: ") + std::strerror(errno));
+        }
+
+        pid_t pid = ::fork();
+        if (pid < 0)
+        {
+            ::close(task_pipe[0]);
+            ::close(task_pipe[1]);
+            ::close(result_pipe[0]);
+            ::close(result_pipe[1]);
+            throw Exception(std::string("fork() failed: ") + std::strerror(errno));
+        }
+        if (pid == 0)
+        {
+            // other workers must see EOF when the parent closes their pipes, so drop the copies inherited here
+            for (const Worker& other : workers)
+            {
+                if (&other == &worker || other.pid == 0) continue;
+                ::close(other.task_fd);
+                ::close(other.result_fd);
+            }
+            ::close(task_pipe[1]);
+            ::close(result_pipe[0]);
+            // a replacement for a crashed worker takes its place, and its CPUs
+            if (!worker_cpus.empty()) CpuTopology::setAffinity(worker_cpus[static_cast<size_t>(&worker - workers.data()) % worker_cpus.size()]);
+            workerMain(task_pipe[0], result_pipe[1], work, worker_exit);
+        }
+
+        ::close(task_pipe[0]);
+        ::close(result_pipe[1]);
+        worker.pid = static_cast<int>(pid);
+        worker.task_fd = task_pipe[1];
+        worker.result_fd = result_pipe[0];
+        worker.busy = false;
+    }
+
+    void ProcessPool::assign(Worker& worker, size_t task)
+    {
+        uint64_t index = task;
+        worker.task = task;
+        worker.busy = true;
+        // if this fails the worker is dead, which is picked up as a crash when reading its result
+        writeAll(worker.task_fd, &index, sizeof(index));
+    }
+
+    void ProcessPool::retire(Worker& worker)
+    {
+        // closing the task pipe tells the worker to exit
+        ::close(worker.task_fd);
+        ::close(worker.result_fd);
+        int status = 0;
+        while (::waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {}
+        worker.pid = 0;
+        worker.busy = false;
+    }
+
+    std::string ProcessPool::describeStatus(int status)
+    {
+        if (WIFSIGNALED(status))
+        {
+            int sig = WTERMSIG(status);
+            return "killed by signal " + std::to_string(sig) + " (" + ::strsignal(sig) + ")";
+        }
+        if (WIFEXITED(status))
+        {
+            return "exited with code " + std::to_string(WEXITSTATUS(status));
+        }
+        return "stopped with status " + std::to_string(status);
+    }
+
+    bool ProcessPool::exitedWith(int status, int code) noexcept
+    {
+        return WIFEXITED(status) && WEXITSTATUS(status) == code;
+    }
+
+#else // defined(SSTEST_HAS_FORK)
+
+    void ProcessPool::run(next_type, work_type, finish_type, crash_type)
+    {
+        throw Exception("process pools are not supported on this platform");
+    }
+
+    void ProcessPool::spawn(Worker&, const work_type&) {}
+
+    void ProcessPool::assign(Worker&, size_t) {}
+
+    void ProcessPool::retire(Worker&) {}
+
+    std::string ProcessPool::describeStatus(int status)
+    {
+        return "stopped with status " + std::to_string(status);
+    }
+
+    bool ProcessPool::exitedWith(int, int) noexcept
+    {
+        return false;
+    }
+
+#endif // defined(SSTEST_HAS_FORK)
+
+}
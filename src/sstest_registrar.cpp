@@ -26,8 +26,13 @@
 * 
 *******************************************************************************/
 
+#include <cctype>
+#include <exception>
+#include <string>
+
 #include "sstest/sstest_string.h"
 #include "sstest/sstest_test.h"
+#include "sstest/sstest_registry.h"
 #include "sstest/sstest_runner.h"
 
 #include "sstest/sstest_registrar.h"
@@ -35,14 +40,123 @@
 namespace sstest
 {
 
+    namespace
+    {
+        // a registry filled while a library is loaded keeps the error instead, since one leaving a static initializer there 
+        // terminates the program
+        template <typename Register>
+        void registerIn(const Register& add)
+        {
+            TestRegistry& registry = TestRunner::getInstance().registry();
+            try
+            {
+                add(registry);
+            }
+            catch (const std::exception& e)
+            {
+                if (!registry.defersRegistrationErrors()) throw;
+                registry.addRegistrationError(e.what());
+            }
+        }
+
+        std::string withoutSpaces(const std::string& str)
+        {
+            std::string result;
+            for (char c : str)
+            {
+                if (!std::isspace(static_cast<unsigned char>(c))) result += c;
+            }
+            return result;
+        }
+
+        std::string trimmed(const std::string& str)
+        {
+            size_t begin = 0;
+            size_t end = str.size();
+            while (begin < end && std::isspace(static_cast<unsigned char>(str[begin]))) begin++;
+            while (end > begin && std::isspace(static_cast<unsigned char>(str[end - 1]))) end--;
+            return str.substr(begin, end - begin);
+        }
+    }
+
     TestRegistrar::TestRegistrar(const TestFunction& test)
     {
-        TestRunner::getInstance().registry().getDefaultTestCase()->addTest(test);
+        registerIn([&](TestRegistry& registry)
+        {
+            registry.getDefaultTestCase()->addTest(test);
+        });
     }
 
     TestRegistrar::TestRegistrar(const StringView& suite_name, const TestFunction& test)
     {
-        TestRunner::getInstance().registry().getTestCase(suite_name)->addTest(test);
+        registerIn([&](TestRegistry& registry)
+        {
+            registry.getTestCase(suite_name)->addTest(test);
+        });
+    }
+
+    DependencyRegistrar::DependencyRegistrar(const char* dependent, const char* prerequisites)
+    {
+        const std::string dependent_name = withoutSpaces(dependent);
+        const std::string names = prerequisites;
+        registerIn([&](TestRegistry& registry)
+        {
+            size_t start = 0;
+            while (start <= names.size())
+            {
+                size_t comma = names.find(',', start);
+                if (comma == std::string::npos) comma = names.size();
+                const std::string prerequisite = withoutSpaces(names.substr(start, comma - start));
+                registry.addDependency(StringView(dependent_name.c_str(), dependent_name.size()), StringView(prerequisite.c_str(), prerequisite.size()));
+                start = comma + 1;
+            }
+        });
+    }
+
+    ResourceRegistrar::ResourceRegistrar(const char* name, const char* tags)
+    {
+        const std::string test_name = withoutSpaces(name);
+        const std::string names = tags;
+        registerIn([&](TestRegistry& registry)
+        {
+            size_t start = 0;
+            while (start <= names.size())
+            {
+                size_t comma = names.find(',', start);
+                if (comma == std::string::npos) comma = names.size();
+                const std::string tag = withoutSpaces(names.substr(start, comma - start));
+                registry.addResourceTag(StringView(test_name.c_str(), test_name.size()), StringView(tag.c_str(), tag.size()));
+                start = comma + 1;
+            }
+        });
+    }
+
+    ResourceRegistrar::ResourceRegistrar(const char* limits)
+    {
+        registerIn([&](TestRegistry& registry)
+        {
+            registry.setResourceLimits(limits);
+        });
+    }
+
+    InputRegistrar::InputRegistrar(const char* name, const char* paths)
+    {
+        const std::string test_name = withoutSpaces(name);
+        const std::string names = paths;
+        registerIn([&](TestRegistry& registry)
+        {
+            size_t start = 0;
+            while (start <= names.size())
+            {
+                size_t comma = names.find(',', start);
+                if (comma == std::string::npos) comma = names.size();
+                std::string path = trimmed(names.substr(start, comma - start));
+                // stringizing a string literal keeps its quotes
+                if (path.size() >= 2 && path.front() == '"' && path.back() == '"') path = path.substr(1, path.size() - 2);
+                registry.addTestInput(StringView(test_name.c_str(), test_name.size()), StringView(path.c_str(), path.size()));
+                start = comma + 1;
+            }
+        });
     }
 
 }
\ No newline at end of file
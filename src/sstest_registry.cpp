@@ -27,7 +27,11 @@
 *******************************************************************************/
 
 #include <cassert>
+#include <cctype>
+#include <cstdlib>
 #include <algorithm>
+#include <string>
+#include <utility>
 
 #include "sstest/sstest_registry.h"
 
@@ -35,6 +39,7 @@ namespace sstest
 {
 
     TestRegistry::TestRegistry()
+        : defer_errors(false)
     {
         test_map[""] = new TestSuite(TestInfo(""));
         assert(test_map.find("") != test_map.end());
@@ -54,6 +59,11 @@ namespace sstest
             t.second = nullptr;
         }
         test_map.clear();
+        dependencies.clear();
+        resource_tags.clear();
+        resource_limits.clear();
+        test_inputs.clear();
+        registration_errors.clear();
     }
 
     TestSuite* TestRegistry::getDefaultTestCase() noexcept
@@ -102,5 +112,96 @@ namespace sstest
         return tests;
     }
 
+    void TestRegistry::addDependency(const StringView& dependent, const StringView& prerequisite)
+    {
+        if (dependent.empty() || prerequisite.empty()) throw InvalidArgument("test dependency names can't be empty");
+        dependencies.push_back(std::make_pair(std::string(dependent), std::string(prerequisite)));
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& TestRegistry::getDependencies() const noexcept
+    {
+        return dependencies;
+    }
+
+    void TestRegistry::addResourceTag(const StringView& name, const StringView& tag)
+    {
+        if (name.empty() || tag.empty()) throw InvalidArgument("test and resource names can't be empty");
+        resource_tags.push_back(std::make_pair(std::string(name), std::string(tag)));
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& TestRegistry::getResourceTags() const noexcept
+    {
+        return resource_tags;
+    }
+
+    void TestRegistry::addTestInput(const StringView& name, const StringView& path)
+    {
+        if (name.empty() || path.empty()) throw InvalidArgument("test and input file names can't be empty");
+        test_inputs.push_back(std::make_pair(std::string(name), std::string(path)));
+    }
+
+    const std::vector<std::pair<std::string, std::string>>& TestRegistry::getTestInputs() const noexcept
+    {
+        return test_inputs;
+    }
+
+    void TestRegistry::deferRegistrationErrors() noexcept
+    {
+        defer_errors = true;
+    }
+
+    bool TestRegistry::defersRegistrationErrors() const noexcept
+    {
+        return defer_errors;
+    }
+
+    void TestRegistry::addRegistrationError(const std::string& error)
+    {
+        registration_errors.push_back(error);
+    }
+
+    const std::vector<std::string>& TestRegistry::getRegistrationErrors() const noexcept
+    {
+        return registration_errors;
+    }
+
+    void TestRegistry::setResourceLimit(const StringView& tag, size_t limit)
+    {
+        if (tag.empty()) throw InvalidArgument("resource names can't be empty");
+        if (tag == "exclusive") throw InvalidArgument("exclusive tests always run alone, it can't be given a limit");
+        if (limit == 0) throw InvalidArgument("resource " + std::string(tag) + " must allow at least 1 test to use it");
+        resource_limits[std::string(tag)] = limit;
+    }
+
+    void TestRegistry::setResourceLimits(const StringView& limits)
+    {
+        std::string text;
+        for (char c : std::string(limits))
+        {
+            if (!std::isspace(static_cast<unsigned char>(c))) text += c;
+        }
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t comma = text.find(',', start);
+            if (comma == std::string::npos) comma = text.size();
+            const std::string limit = text.substr(start, comma - start);
+            const size_t sep = limit.find_first_of(":=");
+            if (sep == std::string::npos || sep + 1 >= limit.size() || limit.find_first_not_of("0123456789", sep + 1) != std::string::npos)
+            {
+                throw InvalidArgument("expected a resource limit as tag:count, got " + limit);
+            }
+            const std::string tag = limit.substr(0, sep);
+            setResourceLimit(StringView(tag.c_str(), tag.size()), static_cast<size_t>(std::strtoull(limit.c_str() + sep + 1, nullptr, 10)));
+            start = comma + 1;
+        }
+    }
+
+    size_t TestRegistry::getResourceLimit(const StringView& tag) const
+    {
+        auto it = resource_limits.find(std::string(tag));
+        return (it == resource_limits.end()) ? 1 : it->second;
+    }
+
 
 }
\ No newline at end of file
@@ -29,39 +29,437 @@
 #include "sstest/sstest_run.h"
 
 #include <vector>
+#include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
 #include <utility>
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <fstream>
+#include "sstest/sstest_affinity.h"
 #include "sstest/sstest_string.h"
 #include "sstest/sstest_runner.h"
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_coverage.h"
+#include "sstest/sstest_server.h"
 
 
+namespace
+{
+
+    // match an option given as "--name value", "--name=value" or "-n value" at argv[i]. On match, advance i past the value
+    bool matchOption(int argc, char** argv, int& i, const char* name, const char* short_name, const char*& value)
+    {
+        const std::string arg = argv[i];
+        const std::string long_name = name;
+        if (arg.compare(0, long_name.size() + 1, long_name + "=") == 0)
+        {
+            value = argv[i] + long_name.size() + 1;
+            return true;
+        }
+        if (arg != long_name && (short_name == nullptr || arg != short_name)) return false;
+        if (i + 1 >= argc) throw ::sstest::InvalidArgument("missing value for option " + arg);
+        value = argv[++i];
+        return true;
+    }
+
+    bool matchFlag(char** argv, int i, const char* name)
+    {
+        return std::string(argv[i]) == name;
+    }
+
+    size_t parseCount(const char* name, const char* value)
+    {
+        char* end = nullptr;
+        unsigned long long n = std::strtoull(value, &end, 10);
+        if (end == value || *end != '\0' || value[0] == '-') 
+        {
+            throw ::sstest::InvalidArgument(std::string("expected a non-negative integer for option ") + name + ", got " + value);
+        }
+        return static_cast<size_t>(n);
+    }
+
+    void printUsage(std::ostream& os, const char* program)
+    {
+        os << "usage: " << ((program != nullptr && program[0] != '\0') ? program : "test_program") << " [OPTIONS]\n"
+            "  running:     --jobs, -j N|auto  --isolate  --pin cpu|node  --reserve-cpus LIST  --batch US  --check-reset\n"
+            "  selecting:   --filter PATTERNS  --test-list PATH  --total-shards N  --shard-index I  --failed-first  --last-failed\n"
+            "               --time-budget MS  --impact-index PATH  --collect-impact  --changed-files PATH  --list-tests\n"
+            "  stopping:    --timeout MS  --global-timeout MS  --on-timeout continue|abort  --fail-fast  --max-failures N\n"
+            "               --max-tests N  --max-assertions N\n"
+            "  repeating:   --shuffle  --seed N  --repeat N  --until-fail  --retries K\n"
+            "  files:       --history-file PATH  --results-file PATH  --quarantine-file PATH  --cache-file PATH  --journal PATH  --resume\n"
+            "  other:       --resource-limit TAG:N[,TAG:N...]  --serve SOCKET" << std::endl;
+    }
+
+    // runs of each test with --until-fail, unless given by --repeat
+    constexpr size_t default_until_fail_repeat = 1000;
+
+    // the configuration only holds views of file paths
+    std::string history_file;
+    std::string results_file;
+    std::string quarantine_file;
+    std::string impact_file;
+    std::string changed_files;
+    std::string cache_file;
+    std::string journal_file;
+    std::string test_list;
+    std::string test_filter;
+    std::string serve_socket;
+    std::string pin_mode;
+    std::string reserved_cpus;
+    std::string executable;
+
+    // the program may be configured more than once, e.g. for each request served, which must not see the files of the one before
+    void clearOptions()
+    {
+        history_file.clear();
+        results_file.clear();
+        quarantine_file.clear();
+        impact_file.clear();
+        changed_files.clear();
+        cache_file.clear();
+        journal_file.clear();
+        test_list.clear();
+        test_filter.clear();
+        serve_socket.clear();
+        pin_mode.clear();
+        reserved_cpus.clear();
+    }
+
+    // run each request with the options given to the server followed by the options of the request, keeping tests and fixtures 
+    // registered and set up by the program between runs
+    int serveTests(int argc, char** argv)
+    {
+        using namespace ::sstest;
+
+        std::vector<std::string> server_args;
+        for (int i = 0; i < argc; i++)
+        {
+            const char* value = nullptr;
+            if (i > 0 && matchOption(argc, argv, i, "--serve", nullptr, value)) continue;
+            server_args.push_back(argv[i]);
+        }
+        TestRunner& runner = TestRunner::getInstance();
+        const TestRunner::Configuration server_config = runner.configure();
+        const std::string socket = serve_socket;
+        TestServer server(socket);
+        std::cout << "Serving tests on " << socket << std::endl;
+
+        server.serve([&](const std::vector<std::string>& args, std::ostream&) -> int
+        {
+            std::vector<std::string> request_args = server_args;
+            request_args.insert(request_args.end(), args.begin(), args.end());
+            std::vector<char*> request_argv;
+            for (std::string& arg : request_args)
+            {
+                request_argv.push_back(&arg[0]);
+            }
+            request_argv.push_back(nullptr);
+
+            runner.configure(&server_config);
+            ::testing::Configure(static_cast<int>(request_args.size()), request_argv.data());
+            if (!runner.configure().serve_socket.empty()) throw InvalidArgument("--serve can't be given in a request");
+            if (runner.configure().list_tests)
+            {
+                runner.listAllTests(std::cout);
+                return SSTEST_SUCCESS;
+            }
+            return ::testing::ExitCode(runner.runAllTests().getTotals());
+        });
+        return SSTEST_SUCCESS;
+    }
+
+}
+
 namespace testing
 {
     
     int ExitCode(const ::sstest::TestTotals& totals)
     {
-        return totals.allTestsPassed() ? SSTEST_SUCCESS : SSTEST_FAILURE;
+        // quarantined tests still run and are reported, but don't fail the run
+        return totals.allTestsPassed(true, false, true) ? SSTEST_SUCCESS : SSTEST_FAILURE;
     }
 
     void Configure(int argc, char** argv)
     {
         using namespace ::sstest;
 
-        // TODO parse args to TestRunner::Configuration
-        // For now, it does nothing.
-        (void)argc;
-        (void)argv;
+        TestRunner::Configuration& config = TestRunner::getInstance().configure();
+        clearOptions();
+
+        // sharding may come from the environment, e.g. set by a CI job matrix. flags take precedence
+        if (const char* env = std::getenv("SSTEST_TOTAL_SHARDS")) config.total_shards = parseCount("SSTEST_TOTAL_SHARDS", env);
+        if (const char* env = std::getenv("SSTEST_SHARD_INDEX")) config.shard_index = parseCount("SSTEST_SHARD_INDEX", env);
+
+        // keep history next to the test program by default, so each program has its own
+        bool history_given = false;
+        bool seed_given = false;
+        bool repeat_given = false;
+        history_file = (argc > 0 && argv[0] != nullptr) ? std::string(argv[0]) + ".history" : std::string();
+        if (const char* env = std::getenv("SSTEST_HISTORY_FILE")) 
+        {
+            history_file = env;
+            history_given = true;
+        }
+
+        for (int i = 1; i < argc; i++)
+        {
+            const char* value = nullptr;
+            if (matchOption(argc, argv, i, "--jobs", "-j", value))
+            {
+                // the number of workers running tests follows their CPU use, up to a few per CPU
+                config.adaptive_jobs = (std::string(value) == "auto");
+                config.jobs = config.adaptive_jobs ? 0 : parseCount("--jobs", value);
+            }
+            else if (matchFlag(argv, i, "--isolate"))
+            {
+                config.isolate = true;
+            }
+            else if (matchOption(argc, argv, i, "--total-shards", nullptr, value))
+            {
+                config.total_shards = parseCount("--total-shards", value);
+            }
+            else if (matchOption(argc, argv, i, "--shard-index", nullptr, value))
+            {
+                config.shard_index = parseCount("--shard-index", value);
+            }
+            else if (matchOption(argc, argv, i, "--history-file", nullptr, value))
+            {
+                history_file = value;
+                history_given = true;
+            }
+            else if (matchOption(argc, argv, i, "--results-file", nullptr, value))
+            {
+                results_file = value;
+            }
+            else if (matchOption(argc, argv, i, "--timeout", nullptr, value))
+            {
+                config.timeout = parseCount("--timeout", value);
+            }
+            else if (matchOption(argc, argv, i, "--global-timeout", nullptr, value))
+            {
+                config.global_timeout = parseCount("--global-timeout", value);
+            }
+            else if (matchOption(argc, argv, i, "--time-budget", nullptr, value))
+            {
+                config.time_budget = parseCount("--time-budget", value);
+            }
+            else if (matchOption(argc, argv, i, "--on-timeout", nullptr, value))
+            {
+                const std::string policy = value;
+                if (policy != "continue" && policy != "abort") 
+                {
+                    throw InvalidArgument("expected continue or abort for option --on-timeout, got " + policy);
+                }
+                config.on_timeout = (policy == "abort") ? TestRunner::TimeoutPolicy::ABORT : TestRunner::TimeoutPolicy::CONTINUE;
+            }
+            else if (matchFlag(argv, i, "--fail-fast"))
+            {
+                config.max_failures = 1;
+            }
+            else if (matchOption(argc, argv, i, "--max-failures", nullptr, value))
+            {
+                config.max_failures = parseCount("--max-failures", value);
+            }
+            else if (matchOption(argc, argv, i, "--max-tests", nullptr, value))
+            {
+                config.max_tests = parseCount("--max-tests", value);
+            }
+            else if (matchOption(argc, argv, i, "--max-assertions", nullptr, value))
+            {
+                config.max_assertions = parseCount("--max-assertions", value);
+            }
+            else if (matchFlag(argv, i, "--failed-first"))
+            {
+                config.failed_first = true;
+            }
+            else if (matchFlag(argv, i, "--last-failed"))
+            {
+                config.only_failed = true;
+            }
+            else if (matchFlag(argv, i, "--shuffle"))
+            {
+                config.shuffle = true;
+            }
+            else if (matchOption(argc, argv, i, "--seed", nullptr, value))
+            {
+                const size_t seed = parseCount("--seed", value);
+                if (seed > std::numeric_limits<uint32_t>::max()) throw InvalidArgument(std::string("seed out of range: ") + value);
+                config.shuffle = true;
+                config.shuffle_seed = static_cast<uint32_t>(seed);
+                seed_given = true;
+            }
+            else if (matchOption(argc, argv, i, "--repeat", nullptr, value))
+            {
+                config.repeat = parseCount("--repeat", value);
+                repeat_given = true;
+            }
+            else if (matchFlag(argv, i, "--until-fail"))
+            {
+                config.until_fail = true;
+            }
+            else if (matchOption(argc, argv, i, "--retries", nullptr, value))
+            {
+                config.retries = parseCount("--retries", value);
+            }
+            else if (matchOption(argc, argv, i, "--pin", nullptr, value))
+            {
+                pin_mode = value;
+                if (pin_mode != "cpu" && pin_mode != "node") throw InvalidArgument("expected cpu or node for option --pin, got " + pin_mode);
+            }
+            else if (matchOption(argc, argv, i, "--reserve-cpus", nullptr, value))
+            {
+                // parsed here so a bad list is reported before any test runs
+                reserved_cpus = CpuTopology::formatList(CpuTopology::parseList(value));
+            }
+            else if (matchOption(argc, argv, i, "--batch", nullptr, value))
+            {
+                config.batch = parseCount("--batch", value);
+            }
+            else if (matchFlag(argv, i, "--check-reset"))
+            {
+                config.check_reset = true;
+            }
+            else if (matchOption(argc, argv, i, "--quarantine-file", nullptr, value))
+            {
+                quarantine_file = value;
+            }
+            else if (matchOption(argc, argv, i, "--cache-file", nullptr, value))
+            {
+                cache_file = value;
+            }
+            else if (matchOption(argc, argv, i, "--journal", nullptr, value))
+            {
+                journal_file = value;
+            }
+            else if (matchFlag(argv, i, "--resume"))
+            {
+                config.resume = true;
+            }
+            else if (matchOption(argc, argv, i, "--test-list", nullptr, value))
+            {
+                test_list = value;
+            }
+            else if (matchOption(argc, argv, i, "--filter", nullptr, value))
+            {
+                test_filter = value;
+            }
+            else if (matchFlag(argv, i, "--list-tests"))
+            {
+                config.list_tests = true;
+            }
+            else if (matchOption(argc, argv, i, "--serve", nullptr, value))
+            {
+                serve_socket = value;
+                if (serve_socket.empty()) throw InvalidArgument("expected a socket path for option --serve");
+            }
+            else if (matchOption(argc, argv, i, "--impact-index", nullptr, value))
+            {
+                impact_file = value;
+            }
+            else if (matchFlag(argv, i, "--collect-impact"))
+            {
+                config.collect_impact = true;
+            }
+            else if (matchOption(argc, argv, i, "--changed-files", nullptr, value))
+            {
+                changed_files = value;
+            }
+            else if (matchOption(argc, argv, i, "--resource-limit", nullptr, value))
+            {
+                // limits belong to the registry along with the resources tests declare, given here they replace limits set in code
+                TestRunner::getInstance().registry().setResourceLimits(value);
+            }
+            // other arguments are left for the user
+        }
+
+        if (config.total_shards == 0) throw InvalidArgument("total shards must be at least 1");
+        if (config.repeat == 0) throw InvalidArgument("tests must be repeated at least 1 time");
+        if (config.until_fail && !repeat_given) config.repeat = default_until_fail_repeat;
+        if (config.shard_index >= config.total_shards)
+        {
+            throw InvalidArgument("shard index " + std::to_string(config.shard_index) + " out of range for " + std::to_string(config.total_shards) + " shards");
+        }
+        if ((config.collect_impact || !changed_files.empty()) && impact_file.empty())
+        {
+            throw InvalidArgument(std::string(config.collect_impact ? "--collect-impact" : "--changed-files") + " needs an index given with --impact-index");
+        }
+        if (config.collect_impact && !coverageAvailable())
+        {
+            throw InvalidArgument("--collect-impact needs sstest built with SSTEST_COVERAGE, and the code under test compiled with --coverage");
+        }
+        // coverage counters are per process, so tests sharing a process must run one at a time
+        if (config.collect_impact && !config.isolate && config.jobs != 1)
+        {
+            throw InvalidArgument("--collect-impact can only run tests in parallel with --isolate");
+        }
+        if (config.resume && journal_file.empty()) throw InvalidArgument("--resume needs a journal given with --journal");
+        if (!reserved_cpus.empty())
+        {
+            const CpuSet reserved = CpuTopology::parseList(reserved_cpus);
+            const CpuSet allowed = CpuTopology::affinity(); // empty where pinning is not supported, which the run reports
+            const bool any_left = std::any_of(allowed.begin(), allowed.end(), [&reserved](size_t cpu) -> bool
+            {
+                return std::find(reserved.begin(), reserved.end(), cpu) == reserved.end();
+            });
+            if (!allowed.empty() && !any_left)
+            {
+                throw InvalidArgument("--reserve-cpus " + reserved_cpus + " leaves no CPU to run tests on, of CPUs " + CpuTopology::formatList(allowed));
+            }
+        }
+        // shards split tests by their history, so each machine keeping its own would make shards disagree
+        if (config.total_shards > 1 && !history_given) history_file.clear();
+        // tests are chosen by their durations and failures in history
+        if (config.time_budget > 0 && history_file.empty())
+        {
+            throw InvalidArgument("--time-budget needs a history file" + std::string(config.total_shards > 1 ? ", which must be given with --history-file when sharding" : ""));
+        }
+        config.history_file = StringView(history_file.c_str(), history_file.size());
+        config.results_file = StringView(results_file.c_str(), results_file.size());
+        config.quarantine_file = StringView(quarantine_file.c_str(), quarantine_file.size());
+        config.impact_file = StringView(impact_file.c_str(), impact_file.size());
+        config.changed_files = StringView(changed_files.c_str(), changed_files.size());
+        config.cache_file = StringView(cache_file.c_str(), cache_file.size());
+        config.journal_file = StringView(journal_file.c_str(), journal_file.size());
+        config.test_list = StringView(test_list.c_str(), test_list.size());
+        config.filter = StringView(test_filter.c_str(), test_filter.size());
+        config.serve_socket = StringView(serve_socket.c_str(), serve_socket.size());
+        config.pin = StringView(pin_mode.c_str(), pin_mode.size());
+        config.reserved_cpus = StringView(reserved_cpus.c_str(), reserved_cpus.size());
+        // argv[0] may not be a path, e.g. when found through PATH, so prefer asking the system where possible
+        executable = std::ifstream("/proc/self/exe").good() ? std::string("/proc/self/exe") : ((argc > 0 && argv[0] != nullptr) ? std::string(argv[0]) : std::string());
+        config.executable = StringView(executable.c_str(), executable.size());
+        // a new order every run unless repeating one, the seed is printed so it can be
+        if (config.shuffle && !seed_given) config.shuffle_seed = static_cast<uint32_t>(std::random_device()());
     }
 
     int RunTests(int argc, char** argv)
     {
         using namespace ::sstest;
         
-        Configure(argc, argv);
+        try
+        {
+            Configure(argc, argv);
+        }
+        catch (const InvalidArgument& e)
+        {
+            std::cerr << "error: " << e.what() << std::endl;
+            printUsage(std::cerr, (argc > 0) ? argv[0] : nullptr);
+            return SSTEST_FAILURE;
+        }
 
+        if (!TestRunner::getInstance().configure().serve_socket.empty()) return serveTests(argc, argv);
+        if (TestRunner::getInstance().configure().list_tests)
+        {
+            TestRunner::getInstance().listAllTests(std::cout);
+            return SSTEST_SUCCESS;
+        }
         return ExitCode(TestRunner::getInstance().runAllTests().getTotals());
     }
 
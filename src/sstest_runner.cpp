@@ -36,6 +36,18 @@
 #include <string>
 #include <chrono>
 #include <ratio>// for ratios
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include "sstest/sstest_timer.h"
 #include "sstest/sstest_traits.h"
@@ -48,10 +60,387 @@
 #include "sstest/sstest_console.h"
 #include "sstest/sstest_config.h"
 #include "sstest/sstest_utility.h"
+#include "sstest/sstest_pool.h"
+#include "sstest/sstest_process.h"
+#include "sstest/sstest_watchdog.h"
+#include "sstest/sstest_graph.h"
+#include "sstest/sstest_cache.h"
+#include "sstest/sstest_journal.h"
+#include "sstest/sstest_affinity.h"
 
 namespace sstest
 {
 
+    namespace
+    {
+        // fixed width encoding for messages sent from worker processes
+        void putNumber(std::string& msg, uint64_t n)
+        {
+            msg.append(reinterpret_cast<const char*>(&n), sizeof(n));
+        }
+
+        uint64_t getNumber(const std::string& msg, size_t& pos)
+        {
+            uint64_t n = 0;
+            if (pos + sizeof(n) > msg.size()) throw Exception("internal: truncated message from worker process");
+            std::memcpy(&n, msg.data() + pos, sizeof(n));
+            pos += sizeof(n);
+            return n;
+        }
+
+        // exit code of a worker process whose test timed out
+        const int timeout_exit_code = 124;
+        // exit code of a worker process stopped by the global timeout
+        const int global_timeout_exit_code = 123;
+
+        // reason given for skipping the dependents of a test
+        std::string prerequisiteFailed(const TestInterface& prerequisite)
+        {
+            return " (prerequisite " + prerequisite.identifier() + " did not pass)";
+        }
+
+        // the tests each test depends on directly
+        typedef std::unordered_map<const TestInterface*, std::vector<const TestInterface*>> TestPrerequisites;
+
+        // resolves names used to declare dependencies and resources to the tests they mean, a name is a test identifier or else a suite name
+        class TestNames
+        {
+        public:
+            explicit TestNames(const std::vector<TestInterface*>& tests)
+            {
+                for (const TestInterface* test : tests)
+                {
+                    by_identifier[test->identifier()].push_back(test);
+                    if (test->suite() != nullptr && !test->suite()->name().empty()) by_suite[std::string(test->suite()->name())].push_back(test);
+                }
+            }
+
+            const std::vector<const TestInterface*>& resolve(const std::string& name, const std::string& purpose) const
+            {
+                auto it = by_identifier.find(name);
+                if (it != by_identifier.end()) return it->second;
+                it = by_suite.find(name);
+                if (it != by_suite.end()) return it->second;
+                throw InvalidArgument("no test or suite named " + name + " to " + purpose);
+            }
+
+        private:
+            std::unordered_map<std::string, std::vector<const TestInterface*>> by_identifier;
+            std::unordered_map<std::string, std::vector<const TestInterface*>> by_suite;
+        };
+
+        // resolve declared dependencies between names to the tests they mean
+        TestPrerequisites resolveDependencies(const std::vector<std::pair<std::string, std::string>>& dependencies, const std::vector<TestInterface*>& tests)
+        {
+            TestPrerequisites prerequisites;
+            if (dependencies.empty()) return prerequisites;
+
+            const TestNames names(tests);
+            for (const std::pair<std::string, std::string>& dependency : dependencies)
+            {
+                for (const TestInterface* dependent : names.resolve(dependency.first, "depend on"))
+                {
+                    for (const TestInterface* prerequisite : names.resolve(dependency.second, "depend on"))
+                    {
+                        // e.g. a suite depending on a test in the same suite
+                        if (prerequisite == dependent) continue;
+                        std::vector<const TestInterface*>& list = prerequisites[dependent];
+                        if (std::find(list.begin(), list.end(), prerequisite) == list.end()) list.push_back(prerequisite);
+                    }
+                }
+            }
+            return prerequisites;
+        }
+
+        // the resource tags, or input files, of each test
+        typedef std::unordered_map<const TestInterface*, std::vector<std::string>> TestResources;
+
+        // resolve declared resource tags, or input files, of names to the tests they mean
+        TestResources resolveResources(const std::vector<std::pair<std::string, std::string>>& tags, const std::vector<TestInterface*>& tests, 
+            const std::string& what = "resource")
+        {
+            TestResources resources;
+            if (tags.empty()) return resources;
+
+            const TestNames names(tests);
+            for (const std::pair<std::string, std::string>& tag : tags)
+            {
+                for (const TestInterface* test : names.resolve(tag.first, "give " + what + " " + tag.second))
+                {
+                    std::vector<std::string>& list = resources[test];
+                    if (std::find(list.begin(), list.end(), tag.second) == list.end()) list.push_back(tag.second);
+                }
+            }
+            return resources;
+        }
+
+        // headers have no object file of their own, so coverage never includes them
+        bool isHeader(const std::string& file)
+        {
+            const size_t dot = file.find_last_of('.');
+            if (dot == std::string::npos) return false;
+            const std::string extension = file.substr(dot + 1);
+            return extension == "h" || extension == "hh" || extension == "hpp" || extension == "hxx" || extension == "inl" || extension == "ipp" || extension == "tpp";
+        }
+
+        // match a pattern where * matches any characters and ? matches any one character
+        bool matchPattern(const char* pattern, const char* pattern_end, const char* str, const char* str_end)
+        {
+            const char* star = nullptr; // last * seen, to backtrack to when the rest doesn't match
+            const char* star_str = nullptr;
+            while (str != str_end)
+            {
+                if (pattern != pattern_end && (*pattern == '?' || *pattern == *str))
+                {
+                    pattern++;
+                    str++;
+                }
+                else if (pattern != pattern_end && *pattern == '*')
+                {
+                    star = pattern++;
+                    star_str = str;
+                }
+                else if (star != nullptr)
+                {
+                    pattern = star + 1;
+                    str = ++star_str;
+                }
+                else return false;
+            }
+            while (pattern != pattern_end && *pattern == '*') pattern++;
+            return pattern == pattern_end;
+        }
+
+        // a filter is patterns separated by commas, a test matching any of them is run
+        bool matchesFilter(const std::string& filter, const std::string& identifier)
+        {
+            size_t start = 0;
+            while (start <= filter.size())
+            {
+                size_t end = filter.find(',', start);
+                if (end == std::string::npos) end = filter.size();
+                if (end > start && matchPattern(filter.data() + start, filter.data() + end, identifier.data(), identifier.data() + identifier.size())) return true;
+                start = end + 1;
+            }
+            return false;
+        }
+
+        bool failedLastRun(const TestHistory& history, const TestInterface* test)
+        {
+            const TestHistory::Record* record = history.find(test->identifier());
+            return record != nullptr && record->failed;
+        }
+
+        // expected failures found per microsecond of running the test, which tests run within a time budget are chosen and ordered by
+        double failuresPerMicrosecond(const TestHistory& history, const TestInterface* test)
+        {
+            const TestHistory::Record* record = history.find(test->identifier());
+            const double rate = (record == nullptr) ? TestHistory::Record().failureRate() : record->failureRate();
+            return rate / static_cast<double>(std::max<uint64_t>(test->weight(), 1));
+        }
+
+        // choose the tests that find the most failures per microsecond until the budget is spent, a greedy solution to the knapsack 
+        // problem. A test is only chosen along with its prerequisites, whose time counts towards it, and a test that takes longer 
+        // than a worker has is never chosen. The chosen tests keep their order
+        std::vector<TestInterface*> selectWithinBudget(const std::vector<TestInterface*>& tests, const TestPrerequisites& prerequisites, 
+            const TestHistory& history, uint64_t budget_us, size_t nworkers)
+        {
+            std::vector<TestInterface*> by_value(tests);
+            std::stable_sort(by_value.begin(), by_value.end(), [&history](const TestInterface* lhs, const TestInterface* rhs) -> bool
+            {
+                return failuresPerMicrosecond(history, lhs) > failuresPerMicrosecond(history, rhs);
+            });
+
+            // work is assumed to spread evenly across the workers
+            const uint64_t capacity_us = (budget_us > std::numeric_limits<uint64_t>::max() / nworkers) ? std::numeric_limits<uint64_t>::max() : budget_us * nworkers;
+            uint64_t spent_us = 0;
+            std::unordered_set<const TestInterface*> chosen;
+            for (const TestInterface* test : by_value)
+            {
+                if (chosen.count(test) > 0) continue; // chosen as a prerequisite
+                std::vector<const TestInterface*> closure;
+                std::unordered_set<const TestInterface*> seen;
+                std::vector<const TestInterface*> unvisited(1, test);
+                seen.insert(test);
+                uint64_t cost_us = 0;
+                uint64_t longest_us = 0;
+                while (!unvisited.empty())
+                {
+                    const TestInterface* next = unvisited.back();
+                    unvisited.pop_back();
+                    closure.push_back(next);
+                    cost_us += next->weight();
+                    longest_us = std::max(longest_us, next->weight());
+                    auto it = prerequisites.find(next);
+                    if (it == prerequisites.end()) continue;
+                    for (const TestInterface* prerequisite : it->second)
+                    {
+                        if (chosen.count(prerequisite) == 0 && seen.insert(prerequisite).second) unvisited.push_back(prerequisite);
+                    }
+                }
+                if (longest_us > budget_us || cost_us > capacity_us - spent_us) continue;
+                spent_us += cost_us;
+                chosen.insert(closure.begin(), closure.end());
+            }
+
+            std::vector<TestInterface*> selected;
+            for (TestInterface* test : tests)
+            {
+                if (chosen.count(test) > 0) selected.push_back(test);
+            }
+            return selected;
+        }
+
+        // describe which timeout the watchdog caught, then print the stack of every thread. Written at once so worker processes don't interleave
+        void printTimeout(size_t slot, const std::string& label, const TestRunner::Configuration& config, bool abort)
+        {
+            std::string msg = "[ TIMEOUT ] ";
+            if (slot == Watchdog::global_slot) msg += "tests ran longer than the global timeout of " + std::to_string(config.global_timeout) + " ms";
+            else msg += (label.empty() ? std::string("<anonymous>") : label) + " ran longer than " + std::to_string(config.timeout) + " ms";
+            msg += abort ? ", aborting" : "";
+            msg += ". Stacks of all threads:\n";
+            std::cerr << msg << std::flush;
+            dumpThreadStacks(2);
+        }
+
+        // a test running on a thread can't be stopped, so unless asked to wait for it, the run is aborted rather than held up by a test that hangs
+        bool abortsOnTimeout(const TestRunner::Configuration& config) noexcept
+        {
+            if (config.on_timeout == TestRunner::TimeoutPolicy::DEFAULT) return !config.isolate;
+            return config.on_timeout == TestRunner::TimeoutPolicy::ABORT;
+        }
+
+        // most worker threads of a parallel run. A run adapting to the CPU use of its tests may add workers while theirs block, 
+        // unless shuffled, since which worker runs a shuffled test must not depend on timing
+        const size_t max_workers_per_cpu = 4;
+
+        size_t maxThreadWorkers(const TestRunner::Configuration& config)
+        {
+            if (config.adaptive_jobs && !config.shuffle) return max_workers_per_cpu * WorkStealingPool::hardwareConcurrency();
+            return (config.jobs == 0) ? WorkStealingPool::hardwareConcurrency() : config.jobs;
+        }
+
+        // lets the calling thread run on the CPUs it could before a run that reserved or pinned CPUs
+        class AffinityRestorer
+        {
+        public:
+            explicit AffinityRestorer(bool active) : saved(active ? CpuTopology::affinity() : CpuSet()) {}
+            ~AffinityRestorer()
+            {
+                if (!saved.empty()) CpuTopology::setAffinity(saved);
+            }
+
+        private:
+            CpuSet saved;
+        };
+
+        // keep the calling thread, and so the workers it starts, off the reserved CPUs, then pick the CPUs of each worker with --pin. 
+        // Returns the lines describing the placement for the run header
+        std::vector<std::string> placeWorkers(const TestRunner::Configuration& config, size_t repeat, std::vector<CpuSet>& worker_cpus)
+        {
+            std::vector<std::string> lines;
+            worker_cpus.clear();
+            if (config.pin.empty() && config.reserved_cpus.empty()) return lines;
+            if (!CpuTopology::supported())
+            {
+                lines.push_back("Pinning workers to CPUs is not supported on this platform, running tests on any CPU");
+                return lines;
+            }
+
+            CpuTopology topology;
+            const CpuSet allowed = CpuTopology::affinity();
+            if (!allowed.empty()) topology.restrict(allowed);
+            const std::string reserved = config.reserved_cpus;
+            if (!reserved.empty())
+            {
+                topology.exclude(CpuTopology::parseList(reserved));
+                // Configure() rejects this, but the configuration may have been set from code
+                if (topology.nodes().empty())
+                {
+                    lines.push_back("--reserve-cpus " + reserved + " leaves no CPU to run tests on, running tests on any CPU without pinning");
+                    return lines;
+                }
+                CpuTopology::setAffinity(topology.cpus());
+            }
+            const std::string leaving_out = reserved.empty() ? std::string() : ", leaving out reserved CPUs " + reserved;
+            if (config.pin.empty())
+            {
+                lines.push_back("Running tests on CPUs " + CpuTopology::formatList(topology.cpus()) + leaving_out);
+                return lines;
+            }
+
+            // counted once the reserved CPUs are left out, so --jobs 0 gets one worker per CPU left
+            size_t nworkers = 1;
+            if (config.isolate) nworkers = (config.jobs == 0) ? WorkStealingPool::hardwareConcurrency() : config.jobs;
+            else if (config.jobs != 1 || repeat != 1) nworkers = maxThreadWorkers(config);
+            const bool per_node = (std::string(config.pin) == "node");
+            worker_cpus = topology.placement(nworkers, per_node);
+
+            const std::string workers_text = std::string(config.isolate ? " worker process" : " worker thread") + ((nworkers == 1) ? "" : (config.isolate ? "es" : "s"));
+            lines.push_back("Pinned " + std::to_string(nworkers) + workers_text + (per_node ? " to the CPUs of a NUMA node each" : " to one CPU each") + 
+                leaving_out);
+            for (const CpuTopology::Node& node : topology.nodes())
+            {
+                CpuSet workers;
+                CpuSet cpus;
+                for (size_t i = 0; i < worker_cpus.size(); i++)
+                {
+                    if (topology.nodeOf(worker_cpus[i].front()) != node.id) continue;
+                    workers.push_back(i);
+                    cpus.insert(cpus.end(), worker_cpus[i].begin(), worker_cpus[i].end());
+                }
+                if (workers.empty()) continue;
+                std::sort(cpus.begin(), cpus.end());
+                cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+                lines.push_back("  node " + std::to_string(node.id) + ": workers " + CpuTopology::formatList(workers) + " on CPUs " + 
+                    CpuTopology::formatList(cpus));
+            }
+            return lines;
+        }
+
+        // a batch of quick tests stops growing once it is expected to take this long, and ends once it ran this long, so progress is 
+        // still reported regularly
+        const uint64_t max_batch_us = 10000;
+        const uint64_t min_batch_us = 1000;
+        const size_t max_batch_size = 1000;
+
+        // how large a batch of quick tests may grow
+        struct BatchLimits
+        {
+            uint64_t duration_us;
+            size_t size;
+        };
+
+        // batches are large enough that reporting them takes little time next to running them, while each worker still gets several, 
+        // which idle workers can steal
+        BatchLimits batchLimits(const std::vector<TestInterface*>& tests, const std::vector<bool>& batchable, size_t nworkers)
+        {
+            uint64_t total_us = 0;
+            size_t nbatchable = 0;
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                if (!batchable[i]) continue;
+                total_us += tests[i]->weight();
+                nbatchable++;
+            }
+            const size_t nbatches = 4 * std::max<size_t>(nworkers, 1);
+            BatchLimits limits;
+            limits.duration_us = std::min(max_batch_us, std::max(min_batch_us, total_us / nbatches));
+            limits.size = std::min(max_batch_size, std::max<size_t>(nbatchable / nbatches, 1));
+            return limits;
+        }
+
+        // assertion totals counted between two snapshots of a summary
+        TestTotals assertionsSince(const TestTotals& before, const TestTotals& after) noexcept
+        {
+            TestTotals totals;
+            totals.assertions_total = after.assertions_total - before.assertions_total;
+            totals.assertions_ran = after.assertions_ran - before.assertions_ran;
+            totals.assertions_passed = after.assertions_passed - before.assertions_passed;
+            return totals;
+        }
+    }
+
     void TestRunner::Reporter::StreamObject::clear()
     {
         ss.clear();
@@ -64,11 +453,58 @@ namespace sstest
     }
 
     TestRunner::Reporter::Reporter(const Logger& logger, const TestRunner::Configuration& settings, size_t status_width)
-        : settings(settings), status_width(status_width)
+        : settings(settings), status_width(status_width), target(nullptr)
     {
         addLogger(logger);
     }
 
+    TestRunner::Reporter::Reporter(const Reporter& target, const TestRunner::Configuration& settings)
+        : settings(settings), status_width(target.status_width), target(&target)
+    {
+        for (const Logger& logger : target.loggers)
+        {
+            buffers.emplace_back(new std::stringstream);
+            loggers.push_back(Logger(*buffers.back(), logger.ansiEnabled()));
+        }
+    }
+
+    void TestRunner::Reporter::commit()
+    {
+        if (target == nullptr) return;
+
+        target->writeBuffered(release());
+    }
+
+    void TestRunner::Reporter::writeBuffered(const std::vector<std::string>& output) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < output.size() && i < loggers.size(); i++)
+        {
+            Logger logger = loggers[i];
+            logger << output[i];
+        }
+    }
+
+    std::vector<std::string> TestRunner::Reporter::release()
+    {
+        std::vector<std::string> output;
+        for (const std::unique_ptr<std::stringstream>& buffer : buffers)
+        {
+            output.push_back(buffer->str());
+            buffer->str("");
+        }
+        return output;
+    }
+
+    bool TestRunner::Reporter::empty() const
+    {
+        for (const std::unique_ptr<std::stringstream>& buffer : buffers)
+        {
+            if (buffer->tellp() > 0) return false;
+        }
+        return true;
+    }
+
     size_t TestRunner::Reporter::addLogger(const Logger& logger)
     {
         size_t n = loggers.size();
@@ -101,6 +537,19 @@ namespace sstest
         });
     }
 
+    void TestRunner::Reporter::reportPlacement(const std::vector<std::string>& lines) const
+    {
+        // closes the box of the version banner again, so it reads as part of the run header
+        forEachLogger([&](Logger& logger) -> void
+        {
+            for (const std::string& line : lines)
+            {
+                logger << line << '\n';
+            }
+            logger << std::string(80, '~') << std::endl;
+        });
+    }
+
     void TestRunner::Reporter::reportGlobalBegin(const TestSummary& summary) const
     {
         std::string start_text;
@@ -116,6 +565,10 @@ namespace sstest
         {
             start_text = "START";
             header = std::string("Running ") + std::to_string(ntest_functions) + " tests in " + std::to_string(ntest_suites) + " test suites"; // TODO
+            if (settings.total_shards > 1)
+            {
+                header += " (shard " + std::to_string(settings.shard_index) + "/" + std::to_string(settings.total_shards) + ")";
+            }
         }
         forEachLogger([&](Logger& logger) -> void
         {
@@ -136,9 +589,11 @@ namespace sstest
         const size_t ntest_suites = summary.getTotals().test_suites_total;
         header = std::string("Summary: ") + std::to_string(ntest_functions) + " tests in " + std::to_string(ntest_suites) + " test suites";
 
-        // filter by result
-        const std::vector<TestSuite*> suites_passed = filter(suites, [](const TestSuite* suite) -> bool { return suite->passed(); });
-        const std::vector<TestSuite*> suites_failed = filter(suites, [](const TestSuite* suite) -> bool { return !suite->passed(); });
+        // filter by result, suites where no test ran because the run stopped early are listed as skipped
+        auto skipped = [](const TestSuite* suite) -> bool { return suite->numTestsRan() == 0 && suite->numTestsSkipped() > 0; };
+        const std::vector<TestSuite*> suites_passed = filter(suites, [&](const TestSuite* suite) -> bool { return !skipped(suite) && suite->passed(); });
+        const std::vector<TestSuite*> suites_failed = filter(suites, [&](const TestSuite* suite) -> bool { return !skipped(suite) && !suite->passed(); });
+        const std::vector<TestSuite*> suites_skipped = filter(suites, skipped);
 
         forEachLogger([&](Logger& logger) -> void 
         {
@@ -162,6 +617,13 @@ namespace sstest
                 logger.writeLine("Failed: ");
                 listTestCaseResults(logger, suites_failed);
             }
+            if (!suites_skipped.empty())
+            {
+                if (!suites_passed.empty() || !suites_failed.empty()) logger.writeLine();
+                printStatus(logger, std::string(status_width, '-'), Logger::ANSITextColor::ANSI_YELLOW, HorizontalAlignment::CENTER);
+                logger.writeLine("Skipped: ");
+                listTestCaseResults(logger, suites_skipped);
+            }
         });
     }
 
@@ -171,6 +633,7 @@ namespace sstest
         Logger::ANSITextColor result_clr = summary.getTotals().allTestsPassed() ? 
             Logger::ANSITextColor::ANSI_GREEN : 
             Logger::ANSITextColor::ANSI_RED; // do yellwo for partial
+        if (!summary.getTotals().allTestsPassed() && summary.getTotals().allTestsPassed(true, false, true)) result_clr = Logger::ANSITextColor::ANSI_YELLOW;
         std::string footer;
         TestTotals totals = summary.getTotals();
         size_t ntests = totals.test_functions_total;
@@ -184,6 +647,12 @@ namespace sstest
             footer = std::to_string(totals.test_suites_passed) + "/" + std::to_string(totals.test_suites_ran) +
                 " test suites passed, " + std::to_string(totals.test_suites_total - totals.test_suites_ran) + " skipped" + " (" +
                 std::to_string(totals.assertions_passed) + "/" + std::to_string(totals.assertions_ran) + " assertions passed)";
+            if (totals.test_functions_skipped > 0) footer += ", " + std::to_string(totals.test_functions_skipped) + " tests skipped";
+            if (totals.test_functions_over_limit > 0) footer += " (" + std::to_string(totals.test_functions_over_limit) + " at the limit of the run)";
+            if (totals.test_functions_flaky > 0) footer += ", " + std::to_string(totals.test_functions_flaky) + " tests flaky";
+            if (totals.test_functions_cached > 0) footer += ", " + std::to_string(totals.test_functions_cached) + " tests cached";
+            if (totals.test_functions_quarantined > 0) footer += ", " + std::to_string(totals.test_functions_quarantined) + " quarantined tests failed";
+            if (totals.test_functions_over_budget > 0) footer += ", " + std::to_string(totals.test_functions_over_budget) + " tests over time budget";
         }
         forEachLogger([&](Logger& logger) -> void
         {
@@ -206,6 +675,19 @@ namespace sstest
         });
     }
 
+    void TestRunner::Reporter::reportTestBatch(const TestInterface& first, const TestInterface& last, size_t n) const
+    {
+        if (n == 1) return reportTestResult(first);
+        forEachLogger([&](Logger& logger) -> void
+        {
+            printStatus(logger, "OK", Logger::ANSITextColor::ANSI_GREEN, HorizontalAlignment::RIGHT);
+            first.name() ? logger.write(first.name()) : logger.write("<anonymous>");
+            logger.write(" ... ");
+            last.name() ? logger.write(last.name()) : logger.write("<anonymous>");
+            logger.writeLine(" (" + std::to_string(n) + " tests)");
+        });
+    }
+
     void TestRunner::Reporter::reportTestResult(const TestInterface& test, const std::string& info) const
     {
         forEachLogger([&](Logger& logger) -> void
@@ -216,18 +698,34 @@ namespace sstest
                 printStatus(logger, "OK", Logger::ANSITextColor::ANSI_GREEN, HorizontalAlignment::RIGHT);
                 break;
             case TestResult::THROW:
-                logger.writeLine("test body threw exception TODO"); // TODO
+                logger.writeLine(test.thrownMessage().empty() ? std::string("test body threw an exception") : "test body threw: " + test.thrownMessage());
                 printStatus(logger, "FAIL", Logger::ANSITextColor::ANSI_RED, HorizontalAlignment::RIGHT);
                 break;
             case TestResult::FAIL:
                 printStatus(logger, "FAIL", Logger::ANSITextColor::ANSI_RED, HorizontalAlignment::RIGHT);
                 break;
+            case TestResult::CRASH:
+                printStatus(logger, "CRASH", Logger::ANSITextColor::ANSI_RED, HorizontalAlignment::RIGHT);
+                break;
+            case TestResult::TIMEOUT:
+                printStatus(logger, "TIMEOUT", Logger::ANSITextColor::ANSI_RED, HorizontalAlignment::RIGHT);
+                break;
+            case TestResult::SKIP:
+                printStatus(logger, "SKIP", Logger::ANSITextColor::ANSI_YELLOW, HorizontalAlignment::RIGHT);
+                break;
+            case TestResult::FLAKY:
+                printStatus(logger, "FLAKY", Logger::ANSITextColor::ANSI_YELLOW, HorizontalAlignment::RIGHT);
+                break;
+            case TestResult::CACHED:
+                printStatus(logger, "CACHED", Logger::ANSITextColor::ANSI_GREEN, HorizontalAlignment::RIGHT);
+                break;
             case TestResult::INVALID:
             default:
                 throw Exception("internal: Invalid test result given to reportTestResult()");
                 break;
             }
             logger.write(test.name()); // TODO write time taken.
+            if (test.ran() && !test.passed() && test.quarantined()) logger.write(" (quarantined)", Logger::ANSITextColor::ANSI_YELLOW);
             logger.writeLine(info);
 
         });
@@ -278,7 +776,8 @@ namespace sstest
         Logger::ANSITextColor result_clr;
         for (const TestSuite* suite : suites)
         {
-            if (suite->passed()) { result_text = "PASSED"; result_clr = Logger::ANSITextColor::ANSI_GREEN; }
+            if (suite->numTestsRan() == 0 && suite->numTestsSkipped() > 0) { result_text = "SKIPPED"; result_clr = Logger::ANSITextColor::ANSI_YELLOW; }
+            else if (suite->passed()) { result_text = "PASSED"; result_clr = Logger::ANSITextColor::ANSI_GREEN; }
             else { result_text = "FAILED"; result_clr = Logger::ANSITextColor::ANSI_RED; }
             printStatus(logger, result_text, result_clr, HorizontalAlignment::CENTER);
             logger.write(suite->name() ? suite->name() : "<global>");
@@ -344,9 +843,34 @@ namespace sstest
         *this = TestRunner::Configuration::default_settings;
     }
 
+    struct TestRunner::WorkerContext
+    {
+        WorkerContext(const Reporter& target, const Configuration& config)
+            : curr_test(nullptr), settings(config), reporter(target, settings)
+        {
+            suite_fixtures.setCheckReset(config.check_reset);
+        }
+
+        TestInterface* curr_test;
+        TestSummary summary;
+        Configuration settings;
+        Reporter reporter;
+        SuiteFixtures suite_fixtures; // set up by the tests this worker ran, torn down once it is done
+    };
+
+    thread_local TestRunner::WorkerContext* TestRunner::worker_context = nullptr;
+
     TestRunner::TestRunner()
         : registry_(new TestRegistry), 
         curr_test(nullptr), 
+        watchdog(nullptr),
+        journal(nullptr),
+        stop_requested(false),
+        stopped_at_limit(false),
+        tests_over_limit(0),
+        tests_failed(0),
+        tests_finished(0),
+        assertions_checked(0),
         settings(TestRunner::Configuration::default_settings),
         reporter_(new TestRunner::Reporter(Logger(std::cout, true), settings)) 
     { 
@@ -366,10 +890,21 @@ namespace sstest
         delete reporter_;
     }
 
+    const std::vector<TestRecord>& TestRunner::getTestRecords() const noexcept
+    {
+        return test_records;
+    }
+
+    bool TestRunner::stopRequested() const noexcept
+    {
+        return stop_requested.load();
+    }
+
     TestRunner::Configuration& TestRunner::configure(const TestRunner::Configuration* new_settings) noexcept
     {
-        if (new_settings != nullptr) settings = *new_settings;
-        return settings;
+        Configuration& active = (worker_context != nullptr) ? worker_context->settings : settings;
+        if (new_settings != nullptr) active = *new_settings;
+        return active;
     }
 
     TestRegistry& TestRunner::registry()
@@ -377,12 +912,40 @@ namespace sstest
         return *registry_;
     }
 
+    TestRegistry* TestRunner::swapRegistry(TestRegistry* registry) noexcept
+    {
+        assert(registry != nullptr);
+        std::swap(registry, registry_);
+        return registry;
+    }
+
+    TestRunner::ScopedRegistry::ScopedRegistry(TestRegistry* registry) noexcept
+        : previous(TestRunner::getInstance().swapRegistry(registry))
+    {
+    }
+
+    TestRunner::ScopedRegistry::~ScopedRegistry()
+    {
+        TestRunner::getInstance().swapRegistry(previous);
+    }
+
     TestRunner::Reporter& TestRunner::reporter()
     {
+        if (worker_context != nullptr) return worker_context->reporter;
         assert(reporter_);
         return *reporter_;
     }
 
+    TestSummary& TestRunner::currentSummary() noexcept
+    {
+        return (worker_context != nullptr) ? worker_context->summary : test_summary;
+    }
+
+    TestInterface*& TestRunner::currentTest() noexcept
+    {
+        return (worker_context != nullptr) ? worker_context->curr_test : curr_test;
+    }
+
     TestSummary TestRunner::runAllTests()
     {
         std::vector<TestSuite*> test_list = registry_->getTestCases(false, [](const TestSuite* lhs, const TestSuite* rhs) -> bool {
@@ -391,6 +954,25 @@ namespace sstest
         return runTestCasesHelper(test_list);
     }
     
+    constexpr const char* TestRunner::test_list_header;
+
+    void TestRunner::listAllTests(std::ostream& os) const
+    {
+        std::vector<TestSuite*> suites = registry_->getTestCases(false, [](const TestSuite* lhs, const TestSuite* rhs) -> bool {
+            return lhs->name() < rhs->name();
+        });
+        // a comment to readTestList(), so the list can be given back as a test list
+        os << test_list_header << '\n';
+        for (const TestSuite* suite : suites)
+        {
+            for (const TestInterface* test : suite->getTests())
+            {
+                os << test->identifier() << '\n';
+            }
+        }
+        os.flush();
+    }
+
     TestSummary TestRunner::runTests(std::vector<StringView> names)
     {
         std::vector<TestSuite*> test_list;
@@ -404,52 +986,1279 @@ namespace sstest
 
     void TestRunner::explicitFailure()
     {
-        reporter_->reportExplicitFailure();
-        curr_test->fail();
+        reporter().reportExplicitFailure();
+        currentTest()->fail();
     }
 
     // TODO limit max n tests to max int. (very reasonable)
 
-    TestSummary TestRunner::runTestCasesHelper(const std::vector<TestSuite*> suites)
+    TestSummary TestRunner::runTestCasesHelper(const std::vector<TestSuite*> all_suites)
     {
-        test_summary = TestSummary(suites);
-        reporter_->reportGlobalBegin(test_summary);
-
         Configuration config = this->settings; // save config, which can be modified per test
-        Stopwatch timer;
-        timer.start();
-        for (TestSuite* suite : suites)
+        const std::string history_file = config.history_file;
+        TestHistory history;
+        if (!history_file.empty()) history.load(history_file);
+
+        // the impact index keeps the files each test ran, to run only the tests affected by a change
+        const std::string impact_file = config.impact_file;
+        TestImpactIndex impact;
+        if (!impact_file.empty()) impact.load(impact_file);
+        std::vector<std::string> changed_files;
+        std::string impact_message;
+        const std::string changed_files_file = config.changed_files;
+        if (!changed_files_file.empty())
         {
-            assert(suite != nullptr);
-            reporter_->reportTestCaseBegin(*suite);
-            timer.lap();
-            
-            suite->run(
-                [&](TestInterface& test) -> void 
-                { 
-                    curr_test = &test;  
-                    reporter_->reportTestBegin(test); 
-                    this->settings = config; // reset to original pre test
-                },
-                [&](TestInterface& test) -> void 
-                { 
-                    curr_test = nullptr; 
-                    reporter_->reportTestResult(test); /*test_summary.addTestResult(test);*/ 
+            std::ifstream file(changed_files_file);
+            if (!file) throw Exception("could not read changed files from " + changed_files_file);
+            const std::unordered_set<std::string> changed = readTestList(file);
+            changed_files.assign(changed.begin(), changed.end());
+            std::sort(changed_files.begin(), changed_files.end());
+            if (impact.empty()) impact_message = "No tests in impact index " + impact_file + ", running all tests\n";
+            for (const std::string& changed_file : changed_files)
+            {
+                if (!impact_message.empty()) break;
+                // a header may be used by any test, since coverage is only known per object file
+                if (isHeader(changed_file) && !impact.covers(changed_file)) impact_message = "Changed header " + changed_file + " may affect any test, running all tests\n";
+            }
+        }
+        const bool select_impact = !changed_files_file.empty() && impact_message.empty();
+
+        TestGraph graph;
+        size_t over_budget = 0;
+        const std::vector<TestInterface*> tests = planTests(all_suites, config, history, select_impact ? &impact : nullptr, changed_files, graph, over_budget);
+        const std::vector<TestSuite*> suites = suitesOf(tests);
+
+        // tests are keyed by the program and the files they read, so a cached result is only used while neither changed
+        const std::string cache_file = config.cache_file;
+        ResultCache cache;
+        std::vector<uint64_t> cache_keys;
+        if (!cache_file.empty())
+        {
+            const std::string program = config.executable;
+            uint64_t program_hash = 0;
+            if (!ResultCache::hashProgram(program, program_hash)) throw Exception("could not read test program " + program + " to key the result cache");
+            cache.load(cache_file); // a missing or unreadable cache only means every test runs
+
+            std::vector<TestInterface*> all_tests;
+            for (TestSuite* suite : all_suites)
+            {
+                const std::vector<TestInterface*> suite_tests = suite->getTests();
+                all_tests.insert(all_tests.end(), suite_tests.begin(), suite_tests.end());
+            }
+            const TestResources inputs = resolveResources(registry_->getTestInputs(), all_tests, "input file");
+            for (const TestInterface* test : tests)
+            {
+                auto it = inputs.find(test);
+                cache_keys.push_back(ResultCache::makeKey(program_hash, test->identifier(), (it == inputs.end()) ? std::vector<std::string>() : it->second));
+            }
+        }
+
+        // quarantined tests still run, but their failures are counted apart. Marked before repeated tests are copied
+        const std::string quarantine_file = config.quarantine_file;
+        if (!quarantine_file.empty())
+        {
+            std::ifstream file(quarantine_file);
+            if (!file) throw Exception("could not read quarantine file " + quarantine_file);
+            const std::unordered_set<std::string> quarantined = readTestList(file);
+            for (TestInterface* test : tests)
+            {
+                test->setQuarantined(quarantined.count(test->identifier()) > 0);
+            }
+        }
+
+        // each run of a repeated test is a copy of it, run k of test i is at k * tests.size() + i so every test gets going early
+        const size_t repeat = std::max<size_t>(config.repeat, 1);
+        std::vector<std::unique_ptr<TestInterface>> copies;
+        std::vector<TestInterface*> runs = tests;
+        TestGraph repeated_graph;
+        if (repeat > 1)
+        {
+            runs.clear();
+            for (size_t k = 0; k < repeat; k++)
+            {
+                for (const TestInterface* test : tests)
+                {
+                    copies.emplace_back(test->clone());
+                    runs.push_back(copies.back().get());
                 }
-            );
-            std::chrono::milliseconds::rep ms = timer.lap<std::chrono::milliseconds>().count();
-            curr_test = nullptr;
-            reporter_->reportTestCaseResult(*suite, std::string("(") + std::to_string(ms) + " ms)");
-            test_summary.addTestSuiteResult(*suite);
+            }
+            repeated_graph = graph.repeated(repeat);
         }
+        const TestGraph& run_graph = (repeat > 1) ? repeated_graph : graph;
 
-        std::chrono::milliseconds::rep total_ms = timer.stop<std::chrono::milliseconds>().count();
+        test_summary = TestSummary(tests);
+        test_summary.addTestsOverBudget(over_budget);
+        test_records.assign(runs.size(), TestRecord());
+        test_coverage.assign(config.collect_impact ? runs.size() : 0, std::vector<std::string>());
+        for (TestInterface* test : tests)
+        {
+            test->setResult(TestResult::INVALID); // so tests that don't start this run can be told apart
+        }
+        for (TestInterface* run : runs)
+        {
+            run->setResult(TestResult::INVALID);
+        }
+        earlier_results.assign(runs.size(), false);
+        timed_runs.assign(runs.size(), false);
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            timed_runs[i] = (history.find(runs[i]->identifier()) != nullptr);
+        }
 
-        reporter_->reportGlobalSummary(test_summary, suites); // if (SUMMARIZE_TESTS) for each printf [FAILED/PASSED] name
-        reporter_->reportGlobalResult(test_summary, "total time: " + std::to_string(total_ms) + " ms");
-        
-        test_summary.getTotals().validate();
-        return test_summary;
+        // tests with a result in the journal of an interrupted run take it instead of running again
+        const std::string journal_file = config.journal_file;
+        size_t nresumed = 0;
+        bool resumed = false;
+        if (config.resume)
+        {
+            std::vector<TestRecord> journaled;
+            resumed = TestJournal::read(journal_file, journaled);
+            // each run of a repeated test is journaled, and takes the place of the first run of the test without a result
+            std::unordered_map<std::string, std::vector<const TestRecord*>> by_identifier;
+            for (const TestRecord& record : journaled)
+            {
+                by_identifier[record.identifier].push_back(&record);
+            }
+            std::unordered_map<std::string, size_t> next_record;
+            TestTotals assertions;
+            for (size_t i = 0; i < runs.size(); i++)
+            {
+                auto it = by_identifier.find(runs[i]->identifier());
+                if (it == by_identifier.end()) continue;
+                size_t& next = next_record[it->first];
+                if (next >= it->second.size()) continue;
+                const TestRecord& record = *it->second[next++];
+                runs[i]->setResult(record.result, record.duration_us);
+                test_records[i] = record;
+                test_records[i].quarantined = runs[i]->quarantined(); // the quarantine file may have changed since
+                earlier_results[i] = true;
+                assertions.assertions_total += record.assertions_total;
+                assertions.assertions_ran += record.assertions_ran;
+                assertions.assertions_passed += record.assertions_passed;
+                nresumed++;
+            }
+            // assertions of the tests that ran are counted as they are checked
+            test_summary = test_summary + TestSummary(assertions);
+        }
+
+        // repeated tests are meant to run, so they don't use the cache
+        size_t ncached = 0;
+        if (!cache_file.empty() && repeat == 1)
+        {
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                const ResultCache::Entry* entry = cache.find(tests[i]->identifier(), cache_keys[i]);
+                if (entry == nullptr || earlier_results[i]) continue;
+                tests[i]->setResult(TestResult::CACHED, entry->duration_us);
+                test_records[i] = TestRecord(*tests[i], TestTotals());
+                earlier_results[i] = true;
+                ncached++;
+            }
+        }
+
+        TestJournal run_journal;
+        journal = nullptr;
+        if (!journal_file.empty())
+        {
+            run_journal.open(journal_file, config.resume);
+            journal = &run_journal;
+        }
+        stop_requested = false;
+        stopped_at_limit = false;
+        tests_over_limit = 0;
+        tests_failed = 0;
+        tests_finished = 0;
+        assertions_checked = 0;
+        // CPUs are reserved before the watchdog and the workers are started, which inherit the CPUs left
+        const AffinityRestorer restore_affinity(!config.pin.empty() || !config.reserved_cpus.empty());
+        const std::vector<std::string> placement = placeWorkers(config, repeat, worker_cpus);
+        if (!placement.empty()) reporter_->reportPlacement(placement);
+        reporter_->reportGlobalBegin(test_summary);
+        if (config.shuffle)
+        {
+            reporter_->message("Shuffling tests with seed " + std::to_string(config.shuffle_seed) + ", run with --seed " + std::to_string(config.shuffle_seed) + " to repeat this order\n");
+        }
+        if (config.failed_first || config.only_failed)
+        {
+            const size_t nfailed = static_cast<size_t>(std::count_if(tests.begin(), tests.end(), [&history](const TestInterface* test) -> bool
+            {
+                return failedLastRun(history, test);
+            }));
+            if (nfailed == 0) reporter_->message(config.only_failed ? "No tests failed last run, running all tests\n" : "No tests failed last run\n");
+            else if (config.only_failed) reporter_->message("Running only the " + std::to_string(nfailed) + " tests that failed last run\n");
+            else reporter_->message("Running the " + std::to_string(nfailed) + " tests that failed last run first\n");
+        }
+        if (config.resume)
+        {
+            if (!resumed) reporter_->message("No journal to resume from at " + journal_file + ", running all tests\n");
+            else reporter_->message("Resuming from journal " + journal_file + ", " + std::to_string(nresumed) + " tests finished before\n");
+        }
+        if (ncached > 0)
+        {
+            reporter_->message("Using cached results of " + std::to_string(ncached) + " tests, which passed before with the same program and inputs\n");
+        }
+        if (select_impact)
+        {
+            reporter_->message("Running the " + std::to_string(tests.size()) + " tests affected by " + std::to_string(changed_files.size()) + " changed files\n");
+        }
+        else if (!impact_message.empty())
+        {
+            reporter_->message(impact_message);
+        }
+        if (config.time_budget > 0)
+        {
+            const std::string budget = std::to_string(config.time_budget) + " ms";
+            if (history.empty()) reporter_->message("No test durations in history to fit the time budget of " + budget + ", running all tests\n");
+            else if (over_budget == 0) reporter_->message("All tests fit the time budget of " + budget + "\n");
+            else reporter_->message("Running the " + std::to_string(tests.size()) + " tests most likely to fail within the time budget of " + budget + 
+                ", leaving out " + std::to_string(over_budget) + " tests\n");
+        }
+
+        // one slot per thread running tests. Worker processes watch their own tests, so only the global timeout is watched here
+        const size_t nslots = config.isolate ? 0 : maxThreadWorkers(config);
+        Watchdog run_watchdog(nslots, [this, &config](size_t slot, const std::string& label) -> void
+        {
+            timeoutExpired(slot, label, config);
+        });
+        watchdog = nullptr;
+        if (config.timeout > 0 && !config.isolate && config.on_timeout == TimeoutPolicy::CONTINUE)
+        {
+            reporter_->message("Tests that time out can't be stopped without --isolate, so the run waits for them to return or for the global timeout, "
+                "give --on-timeout abort or --isolate to not be held up by a test that hangs\n");
+        }
+        if (config.timeout > 0 || config.global_timeout > 0)
+        {
+            // worker processes stop at the global timeout themselves and the test they ran is reported from here, 
+            // so this one only steps in a second later, if they didn't
+            std::chrono::milliseconds global_timeout(config.global_timeout);
+            if (config.isolate && config.global_timeout > 0) global_timeout += std::chrono::seconds(1);
+            run_watchdog.start(global_timeout);
+            watchdog = &run_watchdog;
+        }
+
+        Stopwatch timer;
+        timer.start();
+        if (config.isolate)
+        {
+            runIsolatedHelper(runs, run_graph, config);
+        }
+        else if (config.jobs == 1 && repeat == 1)
+        {
+            if (!worker_cpus.empty()) CpuTopology::setAffinity(worker_cpus.front());
+            runSerialHelper(tests, graph, config);
+        }
+        else
+        {
+            // runs of a repeated test are not grouped by suite, so they go through a pool even when run serially
+            runParallelHelper(runs, run_graph, config);
+        }
+        this->settings = config;
+        worker_cpus.clear();
+        watchdog = nullptr;
+        run_watchdog.stop();
+        journal = nullptr;
+        run_journal.close();
+
+        // workers leave the tests they didn't start once the run was stopped
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            if (runs[i]->result() != TestResult::INVALID) continue;
+            // repeated tests are reported once with all of their runs
+            if (repeat > 1) runs[i]->setResult(TestResult::SKIP);
+            else skipStoppedTest(*runs[i], i);
+        }
+        if (repeat > 1 && !tests.empty()) combineRuns(tests, runs);
+        // a repeated test is left out if none of its runs started
+        if (repeat > 1 && stopped_at_limit)
+        {
+            tests_over_limit = 0;
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                if (tests[i]->result() != TestResult::SKIP) continue;
+                test_records[i].over_limit = true;
+                tests_over_limit++;
+            }
+        }
+        // a limit is not a failure, so the tests it left out don't fail the run
+        test_summary.addTestsOverLimit(tests_over_limit);
+        // counted once all tests are done, since tests of a suite may be split up by dependencies or run in any order
+        for (TestSuite* suite : suites)
+        {
+            suite->tally();
+            test_summary.addTestSuiteResult(*suite);
+        }
+
+        std::chrono::milliseconds::rep total_ms = timer.stop<std::chrono::milliseconds>().count();
+
+        if (!history_file.empty())
+        {
+            recordHistory(tests, history);
+            history.save(history_file); // history only affects scheduling, so a read only location is not an error
+        }
+
+        if (!cache_file.empty())
+        {
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                // only tests that passed outright are cached, cached tests keep their entry and tests that didn't run keep theirs
+                if (tests[i]->result() == TestResult::PASS) cache.store(tests[i]->identifier(), cache_keys[i], tests[i]->duration());
+                else if (tests[i]->ran() && tests[i]->result() != TestResult::CACHED) cache.erase(tests[i]->identifier());
+            }
+            cache.save(cache_file); // like the history, the cache only saves time, so a read only location is not an error
+        }
+
+        if (config.collect_impact)
+        {
+            for (size_t i = 0; i < runs.size(); i++)
+            {
+                // tests that crashed or didn't run have no coverage, and keep what was collected before
+                if (test_coverage[i].empty()) continue;
+                std::vector<std::string> files = test_coverage[i];
+                files.push_back(std::string(runs[i]->lineInfo().file_name)); // changing the test itself affects it
+                impact.recordTest(runs[i]->identifier(), std::move(files));
+            }
+            if (!impact.save(impact_file)) throw Exception("could not write impact index to " + impact_file);
+            test_coverage.clear();
+        }
+
+        const std::string results_file = config.results_file;
+        if (!results_file.empty())
+        {
+            std::ofstream file(results_file, std::ios::trunc);
+            writeTestRecords(file, test_records);
+            if (!file.flush()) throw Exception("could not write test results to " + results_file);
+        }
+
+        reporter_->reportGlobalSummary(test_summary, suites); // if (SUMMARIZE_TESTS) for each printf [FAILED/PASSED] name
+        reporter_->reportGlobalResult(test_summary, "total time: " + std::to_string(total_ms) + " ms");
+        
+        test_summary.getTotals().validate();
+        return test_summary;
+    }
+
+    void TestRunner::runSerialHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config)
+    {
+        const std::vector<bool> batchable = batchableTests(tests, graph, config);
+        const BatchLimits limits = batchLimits(tests, batchable, 1);
+        WorkerContext batch_context(*reporter_, config);
+        // the calling thread is the only worker, whose suite fixtures are shared by the tests run on their own and in batches
+        SuiteFixtures::setCurrent(&batch_context.suite_fixtures);
+
+        Stopwatch timer;
+        timer.start();
+        size_t i = 0;
+        while (i < tests.size())
+        {
+            TestSuite* suite = tests[i]->suite();
+            assert(suite != nullptr);
+            if (stop_requested)
+            {
+                // don't begin suites once the run was stopped
+                for (; i < tests.size() && tests[i]->suite() == suite; i++)
+                {
+                    skipStoppedTest(*tests[i], i);
+                }
+                continue;
+            }
+            reporter_->reportTestCaseBegin(*suite);
+            timer.lap();
+            
+            for (; i < tests.size() && tests[i]->suite() == suite; i++)
+            {
+                TestInterface& test = *tests[i];
+                if (stop_requested)
+                {
+                    skipStoppedTest(test, i);
+                    continue;
+                }
+                // tests are in dependency order, so prerequisites are done
+                const std::vector<size_t>& prerequisites = graph.prerequisites(i);
+                auto failed = std::find_if(prerequisites.begin(), prerequisites.end(), [&](size_t p) -> bool { return !tests[p]->passed(); });
+                if (failed != prerequisites.end())
+                {
+                    skipTest(test, i, *reporter_, prerequisiteFailed(*tests[*failed]));
+                    continue;
+                }
+                if (earlier_results[i])
+                {
+                    reportEarlierResult(test, *reporter_);
+                    countFinishedTest(test, config);
+                    continue;
+                }
+                if (batchable[i])
+                {
+                    // quick tests of the suite that follow each other run in a batch, counted as if run by a worker
+                    std::vector<size_t> batch;
+                    uint64_t batch_us = 0;
+                    for (size_t j = i; j < tests.size() && tests[j]->suite() == suite && batchable[j] && batch.size() < limits.size 
+                        && batch_us < limits.duration_us; j++)
+                    {
+                        batch.push_back(j);
+                        batch_us += tests[j]->weight();
+                    }
+                    worker_context = &batch_context;
+                    const size_t nran = runBatch(batch_context, 0, tests, batch, config);
+                    batch_context.reporter.commit();
+                    worker_context = nullptr;
+                    test_summary = test_summary + batch_context.summary;
+                    batch_context.summary = TestSummary();
+                    i += nran - 1;
+                    continue;
+                }
+                size_t attempts = 0;
+                bool retry = false;
+                do
+                {
+                    const TestTotals before = test_summary.getTotals();
+                    curr_test = &test;
+                    reporter_->reportTestBegin(test);
+                    this->settings = config; // reset to original pre test
+                    if (watchdog != nullptr) watchdog->arm(0, std::chrono::milliseconds(config.timeout), test.identifier());
+                    if (config.collect_impact) resetCoverage();
+                    test.run();
+                    if (watchdog != nullptr && watchdog->disarm(0)) test.setResult(TestResult::TIMEOUT, test.duration());
+                    if (config.collect_impact) test_coverage[i] = collectCoverage();
+                    curr_test = nullptr;
+                    std::string info;
+                    retry = retryTest(test, attempts, config, info);
+                    reporter_->reportTestResult(test, info);
+                    test_records[i] = TestRecord(test, assertionsSince(before, test_summary.getTotals()));
+                } while (retry);
+                journalTest(i);
+                countFinishedTest(test, config);
+            }
+            suite->tally();
+
+            std::chrono::milliseconds::rep ms = timer.lap<std::chrono::milliseconds>().count();
+            reporter_->reportTestCaseResult(*suite, std::string("(") + std::to_string(ms) + " ms)");
+        }
+        for (const std::string& error : batch_context.suite_fixtures.tearDown())
+        {
+            reporter_->message(error);
+        }
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    void TestRunner::runParallelHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config)
+    {
+        // a shuffled run must be repeatable, so each test stays on the worker it is given
+        WorkStealingPool pool(maxThreadWorkers(config), !config.shuffle);
+        pool.pinWorkers(worker_cpus);
+        const bool adapting = config.adaptive_jobs && !config.shuffle;
+        const size_t ncpus = WorkStealingPool::hardwareConcurrency();
+        if (adapting)
+        {
+            pool.adaptWorkers(ncpus);
+            reporter_->message("Adapting the number of workers to the CPU use of the tests, starting with " + std::to_string(ncpus) + 
+                " for " + std::to_string(ncpus) + " CPUs, up to " + std::to_string(pool.size()) + "\n");
+        }
+
+        std::vector<std::unique_ptr<WorkerContext>> contexts;
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            contexts.emplace_back(new WorkerContext(*reporter_, config));
+        }
+
+        TestScheduler scheduler(graph);
+        std::mutex scheduler_mutex;
+        std::vector<size_t> attempts(tests.size(), 0); // retries of a test are run one after another, so each is only touched by one worker
+        const std::vector<bool> batchable = batchableTests(tests, graph, config);
+        const BatchLimits limits = batchLimits(tests, batchable, pool.size());
+
+        // each ready test goes to the given worker
+        std::function<void(const std::vector<size_t>&, const std::vector<size_t>&)> submit_ready;
+
+        std::function<void(size_t, size_t)> submit_test = [&](size_t worker, size_t i) -> void
+        {
+            TestInterface* test = tests[i];
+            pool.submit(worker, [&, test, i](size_t id) -> void
+            {
+                if (stop_requested) return; // skipped once all workers are done
+                WorkerContext& context = *contexts[id];
+                worker_context = &context;
+                SuiteFixtures::setCurrent(&context.suite_fixtures);
+                if (earlier_results[i])
+                {
+                    reportEarlierResult(*test, context.reporter);
+                }
+                else
+                {
+                    const TestTotals before = context.summary.getTotals();
+                    context.settings = config; // reset to original pre test
+                    context.curr_test = test;
+                    context.reporter.reportTestBegin(*test);
+                    if (watchdog != nullptr) watchdog->arm(id, std::chrono::milliseconds(config.timeout), test->identifier());
+                    if (config.collect_impact) resetCoverage(); // only with a single worker, counters are shared by all threads
+                    test->run();
+                    if (watchdog != nullptr && watchdog->disarm(id)) test->setResult(TestResult::TIMEOUT, test->duration());
+                    if (config.collect_impact) test_coverage[i] = collectCoverage();
+                    context.curr_test = nullptr;
+                    std::string info;
+                    const bool retry = retryTest(*test, attempts[i], config, info);
+                    context.reporter.reportTestResult(*test, info);
+                    test_records[i] = TestRecord(*test, assertionsSince(before, context.summary.getTotals())); // each test has its own slot
+                    if (retry)
+                    {
+                        // the test keeps its resources, and goes to the back of this worker's queue where an idle worker can steal it
+                        context.reporter.commit();
+                        worker_context = nullptr;
+                        submit_test(id, i);
+                        return;
+                    }
+                    journalTest(i);
+                }
+
+                std::vector<size_t> ready, skipped;
+                {
+                    std::lock_guard<std::mutex> lock(scheduler_mutex);
+                    scheduler.finish(i, test->passed(), ready, skipped);
+                }
+                for (size_t s : skipped)
+                {
+                    skipTest(*tests[s], s, context.reporter, prerequisiteFailed(*test));
+                }
+                context.reporter.commit();
+                worker_context = nullptr;
+                countFinishedTest(*test, config);
+                // dependents that were waiting on this test go to this worker, other workers will steal them if idle
+                submit_ready(ready, std::vector<size_t>(ready.size(), id));
+            });
+        };
+
+        std::function<void(size_t, const std::vector<size_t>&)> submit_batch = [&](size_t worker, const std::vector<size_t>& batch) -> void
+        {
+            pool.submit(worker, [&, batch](size_t id) -> void
+            {
+                if (stop_requested) return;
+                WorkerContext& context = *contexts[id];
+                worker_context = &context;
+                SuiteFixtures::setCurrent(&context.suite_fixtures);
+                const size_t nran = runBatch(context, id, tests, batch, config);
+                std::vector<size_t> ready, skipped;
+                {
+                    std::lock_guard<std::mutex> lock(scheduler_mutex);
+                    for (size_t n = 0; n < nran; n++)
+                    {
+                        scheduler.finish(batch[n], tests[batch[n]]->passed(), ready, skipped);
+                    }
+                }
+                assert(skipped.empty()); // batched tests have no dependents
+                context.reporter.commit();
+                worker_context = nullptr;
+                // the tests a batch ended before go to the back of this worker's queue, where idle workers can steal them
+                if (nran < batch.size() && !stop_requested) submit_batch(id, std::vector<size_t>(batch.begin() + nran, batch.end()));
+                submit_ready(ready, std::vector<size_t>(ready.size(), id));
+            });
+        };
+
+        // quick tests given to the same worker are grouped into batches, other tests are submitted on their own
+        submit_ready = [&](const std::vector<size_t>& ready, const std::vector<size_t>& workers) -> void
+        {
+            std::vector<std::vector<size_t>> batches(pool.size());
+            std::vector<uint64_t> batch_us(pool.size(), 0);
+            for (size_t k = 0; k < ready.size(); k++)
+            {
+                const size_t i = ready[k];
+                const size_t worker = workers[k];
+                if (!batchable[i])
+                {
+                    submit_test(worker, i);
+                    continue;
+                }
+                batches[worker].push_back(i);
+                batch_us[worker] += tests[i]->weight();
+                if (batches[worker].size() >= limits.size || batch_us[worker] >= limits.duration_us)
+                {
+                    submit_batch(worker, batches[worker]);
+                    batches[worker].clear();
+                    batch_us[worker] = 0;
+                }
+            }
+            for (size_t worker = 0; worker < batches.size(); worker++)
+            {
+                if (!batches[worker].empty()) submit_batch(worker, batches[worker]);
+            }
+        };
+
+        // tests are sorted heaviest first, give each to the least loaded worker. Idle workers will steal the rest.
+        // Shuffled tests are dealt to workers in turn, since weights change between runs
+        const std::vector<size_t> ready = scheduler.start();
+        std::vector<TestInterface*> ready_tests;
+        for (size_t r : ready)
+        {
+            ready_tests.push_back(tests[r]);
+        }
+        // workers that start taking tasks later steal theirs
+        std::vector<size_t> workers = partitionByWeight(ready_tests, adapting ? std::min(ncpus, pool.size()) : pool.size());
+        if (config.shuffle)
+        {
+            for (size_t k = 0; k < workers.size(); k++)
+            {
+                workers[k] = k % pool.size();
+            }
+        }
+        submit_ready(ready, workers);
+        // each worker tears down its suite fixtures on its own thread, like it set them up
+        pool.setWorkerExit([&](size_t id) -> void
+        {
+            WorkerContext& context = *contexts[id];
+            for (const std::string& error : context.suite_fixtures.tearDown())
+            {
+                context.reporter.message(error);
+            }
+            context.reporter.commit();
+            SuiteFixtures::setCurrent(nullptr);
+        });
+        pool.run();
+        if (adapting) reporter_->message("Ran tests on up to " + std::to_string(pool.peakWorkers()) + " workers at once\n");
+
+        for (const std::unique_ptr<WorkerContext>& context : contexts)
+        {
+            test_summary = test_summary + context->summary;
+        }
+    }
+
+    std::vector<bool> TestRunner::batchableTests(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config) const
+    {
+        std::vector<bool> batchable(tests.size(), false);
+        // coverage is collected around each test on its own
+        if (config.batch == 0 || config.collect_impact) return batchable;
+        for (size_t i = 0; i < tests.size(); i++)
+        {
+            // a test without history may take any time, and would lose its RUN line if it hangs
+            batchable[i] = timed_runs[i] && tests[i]->weight() < config.batch && !earlier_results[i] && graph.prerequisites(i).empty() 
+                && graph.dependents(i).empty() && graph.resources(i).empty() && !graph.exclusive(i);
+        }
+        return batchable;
+    }
+
+    size_t TestRunner::runBatch(WorkerContext& context, size_t worker, const std::vector<TestInterface*>& tests, const std::vector<size_t>& batch, 
+        const Configuration& config)
+    {
+        assert(!batch.empty() && worker_context == &context && context.reporter.empty());
+        // the tests that passed quietly since the last test reported on its own
+        const TestInterface* first = nullptr;
+        const TestInterface* last = nullptr;
+        size_t nquiet = 0;
+        uint64_t elapsed_us = 0;
+        size_t n = 0;
+        // a shuffled run must be repeatable, so its batches don't end early depending on how long tests took
+        for (; n < batch.size() && (n == 0 || (!stop_requested && (config.shuffle || elapsed_us < max_batch_us))); n++)
+        {
+            const size_t i = batch[n];
+            TestInterface& test = *tests[i];
+            size_t attempts = 0;
+            bool quiet = true;
+            bool retry = false;
+            do
+            {
+                const TestTotals before = context.summary.getTotals();
+                if (!quiet) context.reporter.reportTestBegin(test);
+                context.settings = config; // reset to original pre test
+                context.curr_test = &test;
+                if (watchdog != nullptr) watchdog->arm(worker, std::chrono::milliseconds(config.timeout), test.identifier());
+                test.run();
+                if (watchdog != nullptr && watchdog->disarm(worker)) test.setResult(TestResult::TIMEOUT, test.duration());
+                context.curr_test = nullptr;
+                elapsed_us += test.duration();
+                std::string info;
+                retry = retryTest(test, attempts, config, info);
+                test_records[i] = TestRecord(test, assertionsSince(before, context.summary.getTotals()));
+                if (quiet && test.result() == TestResult::PASS && context.reporter.empty())
+                {
+                    if (nquiet++ == 0) first = &test;
+                    last = &test;
+                    break;
+                }
+                if (quiet)
+                {
+                    // reported on its own after the quiet tests before it, as if it had not run in a batch
+                    quiet = false;
+                    const std::vector<std::string> output = context.reporter.release();
+                    if (nquiet > 0) context.reporter.reportTestBatch(*first, *last, nquiet);
+                    nquiet = 0;
+                    context.reporter.reportTestBegin(test);
+                    context.reporter.writeBuffered(output);
+                }
+                context.reporter.reportTestResult(test, info);
+                context.reporter.commit(); // so the output of the next test can be told apart
+            } while (retry);
+            journalTest(i);
+            countFinishedTest(test, config);
+        }
+        if (nquiet > 0) context.reporter.reportTestBatch(*first, *last, nquiet);
+        return n;
+    }
+
+    void TestRunner::runIsolatedHelper(const std::vector<TestInterface*>& tests, const TestGraph& graph, const Configuration& config)
+    {
+        ProcessPool pool(config.jobs);
+        pool.pinWorkers(worker_cpus);
+
+        // each worker process gets its own copy when forked
+        WorkerContext context(*reporter_, config);
+        // no test is reported once a worker is out of tests, so errors go straight to stderr
+        pool.setWorkerExit([&context]() -> void
+        {
+            for (const std::string& error : context.suite_fixtures.tearDown())
+            {
+                std::cerr << error << std::endl;
+            }
+        });
+
+        const bool watched = (config.timeout > 0 || config.global_timeout > 0);
+        const Watchdog::clock_type::time_point global_deadline = Watchdog::clock_type::now() + std::chrono::milliseconds(config.global_timeout);
+
+        // tests are handed out heaviest first as their prerequisites pass
+        TestScheduler scheduler(graph);
+        std::vector<size_t> attempts(tests.size(), 0);
+        std::vector<Watchdog::clock_type::time_point> started(tests.size()); // when each test was last handed to a worker
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+        for (size_t r : scheduler.start())
+        {
+            ready.push(r);
+        }
+        auto finished = [&](size_t index) -> void
+        {
+            std::vector<size_t> now_ready, skipped;
+            scheduler.finish(index, tests[index]->passed(), now_ready, skipped);
+            for (size_t r : now_ready)
+            {
+                ready.push(r);
+            }
+            for (size_t s : skipped)
+            {
+                skipTest(*tests[s], s, *reporter_, prerequisiteFailed(*tests[index]));
+            }
+        };
+
+        pool.run(
+            [&](size_t& index) -> bool
+            {
+                // tests with an earlier result don't need a worker, and may let their dependents run
+                while (!ready.empty() && earlier_results[ready.top()])
+                {
+                    const size_t earlier = ready.top();
+                    ready.pop();
+                    reportEarlierResult(*tests[earlier], *reporter_);
+                    finished(earlier);
+                    countFinishedTest(*tests[earlier], config);
+                }
+                if (ready.empty()) return false;
+                index = ready.top();
+                ready.pop();
+                started[index] = Watchdog::clock_type::now();
+                return true;
+            },
+            [&](size_t index) -> std::string
+            {
+                // threads don't survive fork, so each worker process starts its own watchdog. A hung test can't be stopped, 
+                // so the worker exits and the parent reports the timeout from its exit code
+                static Watchdog* worker_watchdog = nullptr;
+                if (watched && worker_watchdog == nullptr)
+                {
+                    worker_watchdog = new Watchdog(1, [&](size_t slot, const std::string&) -> void
+                    {
+                        // only this process has the stacks, the TIMEOUT line is the parent's. An idle worker has nothing to show
+                        const TestInterface* running = context.curr_test;
+                        if (running != nullptr)
+                        {
+                            const std::string name = running->identifier().empty() ? std::string("<anonymous>") : running->identifier();
+                            std::cerr << ("Stacks of all threads of the worker process running " + name + ":\n") << std::flush;
+                            dumpThreadStacks(2);
+                        }
+                        std::_Exit((slot == Watchdog::global_slot) ? global_timeout_exit_code : timeout_exit_code);
+                    });
+                    std::chrono::milliseconds remaining(0);
+                    if (config.global_timeout > 0)
+                    {
+                        // at least 1 ms, since 0 means no deadline
+                        remaining = std::max(std::chrono::milliseconds(1), 
+                            std::chrono::duration_cast<std::chrono::milliseconds>(global_deadline - Watchdog::clock_type::now()));
+                    }
+                    worker_watchdog->start(remaining);
+                }
+
+                TestInterface& test = *tests[index];
+                worker_context = &context;
+                SuiteFixtures::setCurrent(&context.suite_fixtures);
+                context.settings = config; // reset to original pre test
+                context.summary.reset();
+                context.curr_test = &test;
+                context.reporter.reportTestBegin(test);
+                if (worker_watchdog != nullptr) worker_watchdog->arm(0, std::chrono::milliseconds(config.timeout), test.identifier());
+                if (config.collect_impact) resetCoverage();
+                test.run();
+                if (worker_watchdog != nullptr && worker_watchdog->disarm(0)) test.setResult(TestResult::TIMEOUT, test.duration());
+                const std::vector<std::string> files = config.collect_impact ? collectCoverage() : std::vector<std::string>();
+                context.curr_test = nullptr;
+                context.reporter.reportTestResult(test);
+                worker_context = nullptr;
+
+                const TestTotals totals = context.summary.getTotals();
+                std::string msg;
+                putNumber(msg, static_cast<uint64_t>(static_cast<int64_t>(test.result())));
+                putNumber(msg, test.duration());
+                putNumber(msg, totals.assertions_total);
+                putNumber(msg, totals.assertions_ran);
+                putNumber(msg, totals.assertions_passed);
+                putNumber(msg, files.size());
+                for (const std::string& file : files)
+                {
+                    putNumber(msg, file.size());
+                    msg += file;
+                }
+                for (const std::string& output : context.reporter.release())
+                {
+                    putNumber(msg, output.size());
+                    msg += output;
+                }
+                return msg;
+            },
+            [&](size_t index, const std::string& msg) -> void
+            {
+                size_t pos = 0;
+                TestTotals totals;
+                const TestResult result = static_cast<TestResult>(static_cast<int64_t>(getNumber(msg, pos)));
+                tests[index]->setResult(result, getNumber(msg, pos));
+                totals.assertions_total = static_cast<size_t>(getNumber(msg, pos));
+                totals.assertions_ran = static_cast<size_t>(getNumber(msg, pos));
+                totals.assertions_passed = static_cast<size_t>(getNumber(msg, pos));
+                const size_t nfiles = static_cast<size_t>(getNumber(msg, pos));
+                std::vector<std::string> files;
+                for (size_t f = 0; f < nfiles; f++)
+                {
+                    size_t len = static_cast<size_t>(getNumber(msg, pos));
+                    files.push_back(msg.substr(pos, len));
+                    pos += len;
+                }
+                if (config.collect_impact) test_coverage[index] = std::move(files);
+                std::vector<std::string> output;
+                while (pos < msg.size())
+                {
+                    size_t len = static_cast<size_t>(getNumber(msg, pos));
+                    output.push_back(msg.substr(pos, len));
+                    pos += len;
+                }
+                test_summary = test_summary + TestSummary(totals);
+                test_records[index] = TestRecord(*tests[index], totals);
+                reporter_->writeBuffered(output);
+                // assertions were checked in the worker, so count them here
+                countAssertions(totals.assertions_ran, config);
+                // the worker doesn't know about earlier attempts, so retries and flaky passes are reported again here
+                std::string info;
+                const bool retry = retryTest(*tests[index], attempts[index], config, info);
+                if (!info.empty()) reporter_->reportTestResult(*tests[index], info);
+                if (retry)
+                {
+                    ready.push(index); // still holds its resources, and is next since it was handed out before any waiting test
+                    return;
+                }
+                journalTest(index);
+                finished(index);
+                countFinishedTest(*tests[index], config);
+                if (stop_requested) pool.stop();
+            },
+            [&](size_t index, int status) -> void
+            {
+                TestInterface& test = *tests[index];
+                const bool global_timed_out = ProcessPool::exitedWith(status, global_timeout_exit_code);
+                const bool timed_out = global_timed_out || ProcessPool::exitedWith(status, timeout_exit_code);
+                const uint64_t elapsed_us = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Watchdog::clock_type::now() - started[index]).count());
+                if (timed_out) test.setResult(TestResult::TIMEOUT, elapsed_us);
+                else test.setResult(TestResult::CRASH);
+                test_records[index] = TestRecord(test, TestTotals());
+                reporter_->reportTestBegin(test);
+                std::string info;
+                // the run is over once the global timeout passed, so there is nothing to retry
+                const bool retry = !global_timed_out && retryTest(test, attempts[index], config, info);
+                const std::string elapsed = std::to_string(elapsed_us / 1000) + " ms";
+                if (global_timed_out) reporter_->reportTestResult(test, " (stopped after " + elapsed + " by the global timeout of " + std::to_string(config.global_timeout) + " ms)");
+                else if (timed_out) reporter_->reportTestResult(test, " (ran " + elapsed + ", longer than " + std::to_string(config.timeout) + " ms)" + info);
+                else reporter_->reportTestResult(test, " (" + ProcessPool::describeStatus(status) + ")" + info);
+                if (retry)
+                {
+                    ready.push(index);
+                    return;
+                }
+                journalTest(index);
+                finished(index);
+                countFinishedTest(test, config);
+                if (stop_requested || global_timed_out || (timed_out && abortsOnTimeout(config))) pool.stop();
+            }
+        );
+    }
+
+    std::vector<TestInterface*> TestRunner::planTests(const std::vector<TestSuite*>& suites, const Configuration& config, const TestHistory& history, 
+        const TestImpactIndex* impact, const std::vector<std::string>& changed_files, TestGraph& graph, size_t& over_budget) const
+    {
+        std::vector<TestInterface*> all_tests;
+        for (TestSuite* suite : suites)
+        {
+            assert(suite != nullptr);
+            std::vector<TestInterface*> suite_tests = suite->getTests();
+            all_tests.insert(all_tests.end(), suite_tests.begin(), suite_tests.end());
+        }
+
+        if (!history.empty())
+        {
+            // tests not seen before are assumed to take an average time
+            uint64_t total_weight = 0;
+            size_t nknown = 0;
+            for (TestInterface* test : all_tests)
+            {
+                const TestHistory::Record* record = history.find(test->identifier());
+                if (record == nullptr) continue;
+                test->setWeight(record->duration_us);
+                total_weight += record->duration_us;
+                nknown++;
+            }
+            const uint64_t mean_weight = (nknown == 0) ? 0 : total_weight / nknown;
+            for (TestInterface* test : all_tests)
+            {
+                if (history.find(test->identifier()) == nullptr) test->setWeight(mean_weight);
+            }
+        }
+
+        std::vector<TestInterface*> tests = selectShard(all_tests, config.shard_index, config.total_shards);
+
+        // e.g. a part of a test program given to this process by sstest_orchestrate
+        const std::string test_list_file = config.test_list;
+        if (!test_list_file.empty())
+        {
+            std::ifstream file(test_list_file);
+            if (!file) throw Exception("could not read test list " + test_list_file);
+            std::unordered_set<std::string> listed = readTestList(file);
+            tests.erase(std::remove_if(tests.begin(), tests.end(), [&](const TestInterface* test) -> bool { return listed.count(test->identifier()) == 0; }), tests.end());
+            for (const TestInterface* test : all_tests)
+            {
+                listed.erase(test->identifier());
+            }
+            if (!listed.empty()) throw InvalidArgument("no test named " + *listed.begin() + " in test list " + test_list_file);
+        }
+
+        const std::string filter = config.filter;
+        if (!filter.empty())
+        {
+            tests.erase(std::remove_if(tests.begin(), tests.end(), [&](const TestInterface* test) -> bool { return !matchesFilter(filter, test->identifier()); }), tests.end());
+        }
+
+        auto failed = [&history](const TestInterface* test) -> bool { return failedLastRun(history, test); };
+        if (config.only_failed && std::any_of(tests.begin(), tests.end(), failed))
+        {
+            tests.erase(std::remove_if(tests.begin(), tests.end(), [&](const TestInterface* test) -> bool { return !failed(test); }), tests.end());
+        }
+
+        // tests not in the index are new, so they are affected too
+        if (impact != nullptr)
+        {
+            tests.erase(std::remove_if(tests.begin(), tests.end(), [&](const TestInterface* test) -> bool 
+            { 
+                return !impact->affected(test->identifier(), changed_files); 
+            }), tests.end());
+        }
+
+        const TestPrerequisites prerequisites = resolveDependencies(registry_->getDependencies(), all_tests);
+        const bool serial = !config.isolate && config.jobs == 1;
+        // without history every test is as likely to fail and takes as long, so there is nothing to choose by
+        const bool budgeted = config.time_budget > 0 && !history.empty();
+        over_budget = 0;
+        if (budgeted)
+        {
+            const size_t nworkers = serial ? 1 : ((config.jobs == 0) ? WorkStealingPool::hardwareConcurrency() : config.jobs);
+            const size_t nplanned = tests.size();
+            tests = selectWithinBudget(tests, prerequisites, history, static_cast<uint64_t>(config.time_budget) * 1000, nworkers);
+            over_budget = nplanned - tests.size();
+        }
+
+        // prerequisites of a test are run with it, even if they were left out above
+        if (!prerequisites.empty())
+        {
+            std::unordered_set<const TestInterface*> planned(tests.begin(), tests.end());
+            std::vector<const TestInterface*> unvisited(tests.begin(), tests.end());
+            while (!unvisited.empty())
+            {
+                auto it = prerequisites.find(unvisited.back());
+                unvisited.pop_back();
+                if (it == prerequisites.end()) continue;
+                for (const TestInterface* prerequisite : it->second)
+                {
+                    if (planned.insert(prerequisite).second) unvisited.push_back(prerequisite);
+                }
+            }
+            if (planned.size() != tests.size())
+            {
+                tests.clear();
+                for (TestInterface* test : all_tests)
+                {
+                    if (planned.count(test) > 0) tests.push_back(test);
+                }
+            }
+        }
+
+        if (config.shuffle)
+        {
+            // in place of longest first, which would make the order depend on the history
+            tests = shuffleTests(tests, config.shuffle_seed);
+        }
+        else if (budgeted)
+        {
+            // the tests most likely to find a failure soonest go first, in case the budget runs out. Serial runs keep the tests of a 
+            // suite together, ordering suites by their best test
+            std::unordered_map<const TestInterface*, double> value;
+            std::unordered_map<const TestSuite*, double> suite_value;
+            for (const TestInterface* test : tests)
+            {
+                value[test] = failuresPerMicrosecond(history, test);
+                double& best = suite_value[test->suite()];
+                best = std::max(best, value[test]);
+            }
+            std::unordered_map<const TestSuite*, size_t> suite_order;
+            for (const TestInterface* test : tests)
+            {
+                suite_order.insert(std::make_pair(test->suite(), suite_order.size()));
+            }
+            std::stable_sort(tests.begin(), tests.end(), [&](const TestInterface* lhs, const TestInterface* rhs) -> bool
+            {
+                if (serial && lhs->suite() != rhs->suite())
+                {
+                    const double lhs_value = suite_value[lhs->suite()];
+                    const double rhs_value = suite_value[rhs->suite()];
+                    if (lhs_value != rhs_value) return lhs_value > rhs_value;
+                    return suite_order[lhs->suite()] < suite_order[rhs->suite()];
+                }
+                return value[lhs] > value[rhs];
+            });
+        }
+        else if (!serial)
+        {
+            // longest processing time first, so a long test doesn't start last and hold up the whole run
+            std::stable_sort(tests.begin(), tests.end(), [](const TestInterface* lhs, const TestInterface* rhs) -> bool
+            {
+                return lhs->weight() > rhs->weight();
+            });
+        }
+
+        if (config.failed_first)
+        {
+            if (serial)
+            {
+                // keep the tests of a suite together, suites with failed tests go first and their failed tests first within them
+                std::unordered_set<const TestSuite*> failed_suites;
+                for (const TestInterface* test : tests)
+                {
+                    if (failed(test)) failed_suites.insert(test->suite());
+                }
+                std::stable_partition(tests.begin(), tests.end(), [&](const TestInterface* test) -> bool { return failed_suites.count(test->suite()) > 0; });
+                auto first = tests.begin();
+                while (first != tests.end())
+                {
+                    const TestSuite* suite = (*first)->suite();
+                    auto last = std::find_if(first, tests.end(), [suite](const TestInterface* test) -> bool { return test->suite() != suite; });
+                    std::stable_partition(first, last, failed);
+                    first = last;
+                }
+            }
+            else
+            {
+                std::stable_partition(tests.begin(), tests.end(), failed);
+            }
+        }
+
+        // serial runs never share resources, but declaring them for an unknown test is still an error
+        const TestResources resources = resolveResources(registry_->getResourceTags(), all_tests);
+
+        auto build_graph = [&]() -> void
+        {
+            std::unordered_map<const TestInterface*, size_t> index;
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                index[tests[i]] = i;
+            }
+            graph = TestGraph(tests.size());
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                auto it = prerequisites.find(tests[i]);
+                if (it == prerequisites.end()) continue;
+                for (const TestInterface* prerequisite : it->second)
+                {
+                    graph.addDependency(i, index.at(prerequisite));
+                }
+            }
+
+            std::unordered_map<std::string, size_t> resource_index;
+            for (size_t i = 0; i < tests.size(); i++)
+            {
+                auto it = resources.find(tests[i]);
+                if (it == resources.end()) continue;
+                for (const std::string& tag : it->second)
+                {
+                    if (tag == "exclusive")
+                    {
+                        graph.setExclusive(i);
+                        continue;
+                    }
+                    auto resource = resource_index.find(tag);
+                    if (resource == resource_index.end())
+                    {
+                        resource = resource_index.emplace(tag, graph.addResource(registry_->getResourceLimit(StringView(tag.c_str(), tag.size())))).first;
+                    }
+                    graph.useResource(i, resource->second);
+                }
+            }
+        };
+        build_graph();
+        if (graph.hasDependencies())
+        {
+            const std::vector<size_t> order = graph.topologicalOrder(); // throws on a cycle
+            if (serial)
+            {
+                // serial runs go in dependency order, otherwise the planned order is kept as much as possible
+                std::vector<TestInterface*> ordered;
+                ordered.reserve(tests.size());
+                for (size_t i : order)
+                {
+                    ordered.push_back(tests[i]);
+                }
+                tests.swap(ordered);
+                build_graph();
+            }
+        }
+        return tests;
+    }
+
+    void TestRunner::recordHistory(const std::vector<TestInterface*>& tests, TestHistory& history)
+    {
+        for (const TestInterface* test : tests)
+        {
+            if (!test->ran()) continue;
+            // flaky tests count as failed, so they are run first and kept by --last-failed until they pass outright
+            history.recordResult(test->identifier(), test->result() == TestResult::PASS || test->result() == TestResult::CACHED);
+            // a crashed test didn't finish, so its duration says nothing, and a cached test wasn't measured
+            if (test->result() == TestResult::CRASH || test->result() == TestResult::CACHED) continue;
+            history.recordDuration(test->identifier(), test->duration());
+        }
+    }
+
+    bool TestRunner::retryTest(TestInterface& test, size_t& attempts, const Configuration& config, std::string& info) const noexcept
+    {
+        const std::string of = " of " + std::to_string(config.retries + 1);
+        if (test.passed())
+        {
+            if (attempts == 0) return false;
+            test.setResult(TestResult::FLAKY, test.duration());
+            info = " (passed on attempt " + std::to_string(attempts + 1) + of + ")";
+            return false;
+        }
+        if (config.retries == 0 || test.result() == TestResult::SKIP) return false;
+        if (attempts >= config.retries || stop_requested)
+        {
+            if (attempts > 0) info = " (attempt " + std::to_string(attempts + 1) + of + ")";
+            return false;
+        }
+        attempts++;
+        info = " (attempt " + std::to_string(attempts) + of + ", retrying)";
+        return true;
+    }
+
+    void TestRunner::combineRuns(const std::vector<TestInterface*>& tests, const std::vector<TestInterface*>& runs)
+    {
+        assert(!tests.empty() && runs.size() % tests.size() == 0);
+        reporter_->message("Results of " + std::to_string(runs.size() / tests.size()) + " runs of each test:\n");
+        std::vector<TestRecord> records(tests.size());
+        for (size_t i = 0; i < tests.size(); i++)
+        {
+            RepeatStats stats;
+            TestTotals assertions;
+            for (size_t k = 0; k * tests.size() + i < runs.size(); k++)
+            {
+                const size_t index = k * tests.size() + i;
+                stats.add(k + 1, runs[index]->result(), runs[index]->duration());
+                assertions.assertions_total += test_records[index].assertions_total;
+                assertions.assertions_ran += test_records[index].assertions_ran;
+                assertions.assertions_passed += test_records[index].assertions_passed;
+            }
+            // the median stands for the test in the history, so one slow run doesn't change how it is scheduled
+            tests[i]->setResult(stats.result(), stats.percentile(0.5));
+            records[i] = TestRecord(*tests[i], assertions);
+            reporter_->reportTestResult(*tests[i], " (" + stats.describe() + ")");
+        }
+        test_records.swap(records);
+    }
+
+    void TestRunner::countFinishedTest(const TestInterface& test, const Configuration& config) noexcept
+    {
+        const size_t nfinished = ++tests_finished;
+        const size_t nfailed = test.passed() ? tests_failed.load() : ++tests_failed;
+        if (config.max_tests > 0 && nfinished >= config.max_tests)
+        {
+            stopped_at_limit = true;
+            stop_requested = true;
+        }
+        if ((config.max_failures > 0 && nfailed >= config.max_failures) || (config.until_fail && !test.passed()))
+        {
+            stop_requested = true;
+        }
+    }
+
+    void TestRunner::countAssertions(size_t n, const Configuration& config) noexcept
+    {
+        if (config.max_assertions == 0 || n == 0) return;
+        if ((assertions_checked += n) >= config.max_assertions)
+        {
+            stopped_at_limit = true;
+            stop_requested = true;
+        }
+    }
+
+    void TestRunner::reportEarlierResult(const TestInterface& test, Reporter& reporter)
+    {
+        reporter.reportTestResult(test, (test.result() == TestResult::CACHED) ? std::string() : std::string(" (resumed)"));
+    }
+
+    void TestRunner::journalTest(size_t index)
+    {
+        if (journal != nullptr) journal->append(test_records[index]);
+    }
+
+    void TestRunner::skipTest(TestInterface& test, size_t index, Reporter& reporter, const std::string& info)
+    {
+        test.setResult(TestResult::SKIP);
+        test_records[index] = TestRecord(test, TestTotals());
+        reporter.reportTestResult(test, info);
+    }
+
+    void TestRunner::skipStoppedTest(TestInterface& test, size_t index)
+    {
+        skipTest(test, index, *reporter_);
+        if (!stopped_at_limit) return;
+        test_records[index].over_limit = true;
+        tests_over_limit++;
+    }
+
+    void TestRunner::timeoutExpired(size_t slot, const std::string& label, const Configuration& config) noexcept
+    {
+        // the test can't be interrupted, so when aborting, the process exits from here with the test still running
+        const bool abort = (slot == Watchdog::global_slot) || abortsOnTimeout(config);
+        printTimeout(slot, label, config, abort);
+        if (abort)
+        {
+            std::cout.flush();
+            std::cerr.flush();
+            std::_Exit(EXIT_FAILURE);
+        }
+    }
+
+    std::vector<TestSuite*> TestRunner::suitesOf(const std::vector<TestInterface*>& tests)
+    {
+        std::vector<TestSuite*> suites;
+        std::unordered_set<TestSuite*> seen;
+        for (TestInterface* test : tests)
+        {
+            if (seen.insert(test->suite()).second) suites.push_back(test->suite());
+        }
+        return suites;
     }
     
 }
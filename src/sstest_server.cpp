@@ -0,0 +1,463 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "sstest/sstest_server.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#   define SSTEST_HAS_SOCKETS
+#   include <fcntl.h>
+#   include <signal.h>
+#   include <unistd.h>
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/types.h>
+#   include <sys/un.h>
+#endif
+
+namespace sstest
+{
+
+#if defined(SSTEST_HAS_SOCKETS)
+
+    namespace
+    {
+
+        // a request is its kind, the number of arguments, then each argument as its size and bytes. All numbers are 8 bytes, little endian
+        const uint64_t request_run = 0;
+        const uint64_t request_shutdown = 1;
+
+        // the response is frames of output, each its size and bytes, then the exit code
+        const uint64_t frame_output = 0;
+        const uint64_t frame_exit = 1;
+
+        // bound the size of a request, so a stray connection can't make the server allocate without limit
+        const uint64_t max_request_args = 1 << 16;
+        const uint64_t max_arg_size = 1 << 20;
+
+        // output is sent once this much is waiting, even if not flushed
+        const size_t frame_size = 4096;
+
+#   if defined(MSG_NOSIGNAL)
+        const int send_flags = MSG_NOSIGNAL;
+#   else
+        const int send_flags = 0;
+#   endif
+
+        bool sendAll(int fd, const char* data, size_t len)
+        {
+            while (len > 0)
+            {
+                const ssize_t n = ::send(fd, data, len, send_flags);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        bool recvAll(int fd, char* data, size_t len)
+        {
+            while (len > 0)
+            {
+                const ssize_t n = ::recv(fd, data, len, 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                data += n;
+                len -= static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        void putNumber(std::string& buf, uint64_t n)
+        {
+            for (int i = 0; i < 8; i++)
+            {
+                buf += static_cast<char>((n >> (8 * i)) & 0xff);
+            }
+        }
+
+        bool getNumber(int fd, uint64_t& n)
+        {
+            unsigned char bytes[8];
+            if (!recvAll(fd, reinterpret_cast<char*>(bytes), sizeof(bytes))) return false;
+            n = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                n |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+            }
+            return true;
+        }
+
+        bool makeAddress(const std::string& path, sockaddr_un& addr)
+        {
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            return true;
+        }
+
+        // workers forked by a run must not keep the connection, or the listening socket, open
+        int openSocket()
+        {
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0) ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            return fd;
+        }
+
+        // return -1 if no server is listening at the path
+        int connectTo(const std::string& path)
+        {
+            sockaddr_un addr;
+            if (!makeAddress(path, addr)) return -1;
+            const int fd = openSocket();
+            if (fd < 0) return -1;
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+            {
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        bool readRequest(int fd, uint64_t& kind, std::vector<std::string>& args)
+        {
+            uint64_t nargs = 0;
+            if (!getNumber(fd, kind) || !getNumber(fd, nargs) || nargs > max_request_args) return false;
+            args.resize(static_cast<size_t>(nargs));
+            for (std::string& arg : args)
+            {
+                uint64_t size = 0;
+                if (!getNumber(fd, size) || size > max_arg_size) return false;
+                arg.resize(static_cast<size_t>(size));
+                if (size > 0 && !recvAll(fd, &arg[0], arg.size())) return false;
+            }
+            return kind == request_run || kind == request_shutdown;
+        }
+
+        // send a request and copy the output of the server to the stream, returning the exit code
+        int exchange(const std::string& path, uint64_t kind, const std::vector<std::string>& args, std::ostream& os)
+        {
+            const int fd = connectTo(path);
+            if (fd < 0) throw Exception("could not connect to a test server on " + path);
+
+            std::string request;
+            putNumber(request, kind);
+            putNumber(request, args.size());
+            for (const std::string& arg : args)
+            {
+                putNumber(request, arg.size());
+                request += arg;
+            }
+            if (sendAll(fd, request.data(), request.size()))
+            {
+                char buf[frame_size];
+                uint64_t frame = 0;
+                uint64_t value = 0;
+                while (getNumber(fd, frame) && getNumber(fd, value))
+                {
+                    if (frame == frame_exit)
+                    {
+                        ::close(fd);
+                        return static_cast<int>(static_cast<int64_t>(value));
+                    }
+                    if (frame != frame_output) break;
+                    bool received = true;
+                    while (value > 0 && received)
+                    {
+                        const size_t n = (value < sizeof(buf)) ? static_cast<size_t>(value) : sizeof(buf);
+                        received = recvAll(fd, buf, n);
+                        if (received) os.write(buf, static_cast<std::streamsize>(n));
+                        value -= n;
+                    }
+                    if (!received) break;
+                    os.flush();
+                }
+            }
+            ::close(fd);
+            throw Exception("lost the connection to the test server on " + path + " before the run finished");
+        }
+
+        // sends output to the client in frames as it is flushed. Unbuffered, so every write takes the lock, since tests running at once 
+        // may write to std::cout while it writes here
+        class FrameBuffer : public std::streambuf
+        {
+        public:
+            explicit FrameBuffer(int fd) 
+                : fd(fd), connected(true) 
+            {}
+
+            // send the output left and the exit code, after which the client hangs up
+            void finish(int code)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                sendPending();
+                std::string frame;
+                putNumber(frame, frame_exit);
+                putNumber(frame, static_cast<uint64_t>(static_cast<int64_t>(code)));
+                if (connected) connected = sendAll(fd, frame.data(), frame.size());
+            }
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+                std::lock_guard<std::mutex> lock(mutex);
+                pending += traits_type::to_char_type(c);
+                if (pending.size() >= frame_size) sendPending();
+                return c;
+            }
+
+            std::streamsize xsputn(const char* s, std::streamsize n) override
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.append(s, static_cast<size_t>(n));
+                if (pending.size() >= frame_size) sendPending();
+                return n;
+            }
+
+            int sync() override
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                sendPending();
+                return 0;
+            }
+
+        private:
+            // a client that hung up doesn't stop the run, the rest of its output is dropped
+            void sendPending()
+            {
+                if (pending.empty()) return;
+                std::string frame;
+                putNumber(frame, frame_output);
+                putNumber(frame, pending.size());
+                frame += pending;
+                pending.clear();
+                if (connected) connected = sendAll(fd, frame.data(), frame.size());
+            }
+
+            int fd;
+            bool connected;
+            std::string pending;
+            std::mutex mutex;
+        };
+
+        // send std::cout and std::cerr, which the runner reports to, to the client while in scope
+        class RedirectOutput
+        {
+        public:
+            explicit RedirectOutput(std::ostream& os)
+            {
+                std::cout.flush();
+                std::cerr.flush();
+                out = std::cout.rdbuf(os.rdbuf());
+                err = std::cerr.rdbuf(os.rdbuf());
+            }
+
+            ~RedirectOutput()
+            {
+                std::cout.flush();
+                std::cerr.flush();
+                std::cout.rdbuf(out);
+                std::cerr.rdbuf(err);
+            }
+
+            RedirectOutput(const RedirectOutput&) = delete;
+            RedirectOutput& operator=(const RedirectOutput&) = delete;
+
+        private:
+            std::streambuf* out;
+            std::streambuf* err;
+        };
+
+        // a client hanging up must not kill the server where sends can't be kept from raising SIGPIPE
+        struct IgnorePipeSignal
+        {
+            IgnorePipeSignal()
+            {
+                struct sigaction ignore_pipe;
+                std::memset(&ignore_pipe, 0, sizeof(ignore_pipe));
+                ignore_pipe.sa_handler = SIG_IGN;
+                ::sigemptyset(&ignore_pipe.sa_mask);
+                ::sigaction(SIGPIPE, &ignore_pipe, &old_pipe);
+            }
+
+            ~IgnorePipeSignal()
+            {
+                ::sigaction(SIGPIPE, &old_pipe, nullptr);
+            }
+
+            struct sigaction old_pipe;
+        };
+
+    }
+
+    TestServer::TestServer(const std::string& path)
+        : path(path), fd(-1)
+    {
+        sockaddr_un addr;
+        if (!makeAddress(path, addr)) throw Exception("invalid socket path for test server: " + path);
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0)
+        {
+            if (!S_ISSOCK(st.st_mode)) throw Exception("can't serve tests on " + path + ", which is not a socket");
+            if (available(path)) throw Exception("a test server is already listening on " + path);
+            ::unlink(path.c_str());
+        }
+
+        fd = openSocket();
+        if (fd < 0) throw Exception("could not create a socket for test server " + path + ": " + std::strerror(errno));
+        if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            fd = -1;
+            throw Exception("could not listen on " + path + ": " + std::strerror(error));
+        }
+    }
+
+    TestServer::~TestServer()
+    {
+        if (fd < 0) return;
+        ::close(fd);
+        ::unlink(path.c_str());
+    }
+
+    void TestServer::serve(const Handler& handler)
+    {
+        IgnorePipeSignal ignore_pipe;
+        for (;;)
+        {
+            const int conn = ::accept(fd, nullptr, nullptr);
+            if (conn < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                throw Exception("test server on " + path + " stopped accepting connections: " + std::strerror(errno));
+            }
+            ::fcntl(conn, F_SETFD, FD_CLOEXEC);
+
+            // e.g. a client checking if the server is available
+            uint64_t kind = 0;
+            std::vector<std::string> args;
+            if (!readRequest(conn, kind, args))
+            {
+                ::close(conn);
+                continue;
+            }
+
+            FrameBuffer buffer(conn);
+            if (kind == request_shutdown)
+            {
+                buffer.finish(EXIT_SUCCESS);
+                ::close(conn);
+                return;
+            }
+            std::ostream os(&buffer);
+            int code = EXIT_FAILURE;
+            try
+            {
+                RedirectOutput redirect(os);
+                code = handler(args, os);
+            }
+            catch (const std::exception& e)
+            {
+                os << "error: " << e.what() << std::endl;
+            }
+            os.flush();
+            buffer.finish(code);
+            ::close(conn);
+        }
+    }
+
+    int TestServer::request(const std::string& path, const std::vector<std::string>& args, std::ostream& os)
+    {
+        return exchange(path, request_run, args, os);
+    }
+
+    void TestServer::shutdown(const std::string& path)
+    {
+        std::ostream discard(nullptr);
+        exchange(path, request_shutdown, std::vector<std::string>(), discard);
+    }
+
+    bool TestServer::available(const std::string& path)
+    {
+        const int fd = connectTo(path);
+        if (fd < 0) return false;
+        ::close(fd);
+        return true;
+    }
+
+#else // defined(SSTEST_HAS_SOCKETS)
+
+    TestServer::TestServer(const std::string& path)
+        : path(path), fd(-1)
+    {
+        throw Exception("test servers are not supported on this platform");
+    }
+
+    TestServer::~TestServer() {}
+
+    void TestServer::serve(const Handler&)
+    {
+        throw Exception("test servers are not supported on this platform");
+    }
+
+    int TestServer::request(const std::string&, const std::vector<std::string>&, std::ostream&)
+    {
+        throw Exception("test servers are not supported on this platform");
+    }
+
+    void TestServer::shutdown(const std::string&)
+    {
+        throw Exception("test servers are not supported on this platform");
+    }
+
+    bool TestServer::available(const std::string&)
+    {
+        return false;
+    }
+
+#endif // defined(SSTEST_HAS_SOCKETS)
+
+}
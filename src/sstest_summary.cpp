@@ -28,9 +28,17 @@
 
 #include "sstest/sstest_summary.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdlib>
+#include <iomanip>
 #include <limits>
+#include <sstream>
+#include <string>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include <cassert>
 
 #include "sstest/sstest_exception.h"
@@ -45,16 +53,21 @@ namespace sstest
         TestTotals ret;
         ret.test_functions_total = this->test_functions_total + rhs.test_functions_total;
         ret.test_functions_ran = this->test_functions_ran + rhs.test_functions_ran;
-        //ret.test_functions_skipped = this->test_functions_skipped + rhs.test_functions_skipped;
+        ret.test_functions_skipped = this->test_functions_skipped + rhs.test_functions_skipped;
         ret.test_functions_passed = this->test_functions_passed + rhs.test_functions_passed;
-        ret.test_suites_total = this->test_functions_total + rhs.test_functions_total;
-        ret.test_suites_ran = this->test_functions_ran + rhs.test_functions_ran;
-        //ret.test_cases_skipped = this->test_functions_skipped + rhs.test_functions_skipped;
-        ret.test_suites_passed = this->test_functions_passed + rhs.test_functions_passed;
+        ret.test_functions_flaky = this->test_functions_flaky + rhs.test_functions_flaky;
+        ret.test_functions_cached = this->test_functions_cached + rhs.test_functions_cached;
+        ret.test_functions_quarantined = this->test_functions_quarantined + rhs.test_functions_quarantined;
+        ret.test_functions_over_budget = this->test_functions_over_budget + rhs.test_functions_over_budget;
+        ret.test_functions_over_limit = this->test_functions_over_limit + rhs.test_functions_over_limit;
+        ret.test_suites_total = this->test_suites_total + rhs.test_suites_total;
+        ret.test_suites_ran = this->test_suites_ran + rhs.test_suites_ran;
+        //ret.test_cases_skipped = this->test_suites_skipped + rhs.test_suites_skipped;
+        ret.test_suites_passed = this->test_suites_passed + rhs.test_suites_passed;
         ret.assertions_total = this->assertions_total + rhs.assertions_total;
-        ret.assertions_ran = this->assertions_total + rhs.assertions_total;
-        //ret.assertions_skipped = this->assertions_total + rhs.assertions_total;
-        ret.assertions_passed = this->assertions_total + rhs.assertions_total;
+        ret.assertions_ran = this->assertions_ran + rhs.assertions_ran;
+        //ret.assertions_skipped = this->assertions_skipped + rhs.assertions_skipped;
+        ret.assertions_passed = this->assertions_passed + rhs.assertions_passed;
         // TODO add more if needed
         return ret;
     }
@@ -62,8 +75,13 @@ namespace sstest
     TestTotals::TestTotals() noexcept
         : test_functions_total(0), 
         test_functions_ran(0), 
-        //test_functions_skipped(0), 
+        test_functions_skipped(0), 
         test_functions_passed(0),
+        test_functions_flaky(0),
+        test_functions_cached(0),
+        test_functions_quarantined(0),
+        test_functions_over_budget(0),
+        test_functions_over_limit(0),
         test_suites_total(0), 
         test_suites_ran(0), 
         //test_cases_skipped(0), 
@@ -81,7 +99,13 @@ namespace sstest
         return 
             (lhs.test_functions_total   ==  rhs.test_functions_total)   &&
             (lhs.test_functions_ran     ==  rhs.test_functions_ran)     &&
+            (lhs.test_functions_skipped ==  rhs.test_functions_skipped) &&
             (lhs.test_functions_passed  ==  rhs.test_functions_passed)  &&
+            (lhs.test_functions_flaky   ==  rhs.test_functions_flaky)   &&
+            (lhs.test_functions_cached  ==  rhs.test_functions_cached)  &&
+            (lhs.test_functions_quarantined == rhs.test_functions_quarantined) &&
+            (lhs.test_functions_over_budget == rhs.test_functions_over_budget) &&
+            (lhs.test_functions_over_limit == rhs.test_functions_over_limit) &&
             (lhs.test_suites_total      ==  rhs.test_suites_total)      &&
             (lhs.test_suites_ran        ==  rhs.test_suites_ran)        &&
             (lhs.test_suites_passed     ==  rhs.test_suites_passed)     &&
@@ -90,11 +114,12 @@ namespace sstest
             (lhs.assertions_passed      ==  rhs.assertions_passed);
     }
 
-    bool TestTotals::allTestsPassed(bool pass_vacuous, bool pass_skipped) const noexcept
+    bool TestTotals::allTestsPassed(bool pass_vacuous, bool pass_skipped, bool pass_quarantined) const noexcept
     {
         if (test_functions_ran == 0) return pass_vacuous;
-        size_t total_counted = pass_skipped ? test_functions_ran : test_functions_total;
-        return (total_counted == test_functions_passed);
+        // tests skipped at the limit of the run were not skipped for a failure
+        size_t total_counted = pass_skipped ? test_functions_ran : test_functions_total - test_functions_over_limit;
+        return (total_counted == test_functions_passed + (pass_quarantined ? test_functions_quarantined : 0));
     }
 
     bool TestTotals::allAssertionsPassed(bool pass_vacuous, bool pass_skipped) const noexcept
@@ -111,6 +136,10 @@ namespace sstest
             (test_functions_total   >=  test_functions_ran)     &&
             (test_functions_total   >=  test_functions_passed)  &&
             (test_functions_ran     >=  test_functions_passed)  && 
+            (test_functions_total   >=  test_functions_ran + test_functions_skipped) &&
+            (test_functions_skipped >=  test_functions_over_limit) &&
+            (test_functions_passed  >=  test_functions_flaky + test_functions_cached) &&
+            (test_functions_ran     >=  test_functions_passed + test_functions_quarantined) &&
             (test_suites_total      >=  test_suites_ran)        &&
             (test_suites_total      >=  test_suites_passed)     &&
             (test_suites_ran        >=  test_suites_passed)     &&
@@ -138,6 +167,56 @@ namespace sstest
         }
     }
 
+    TestSummary::TestSummary(const std::vector<TestInterface*>& tests) noexcept
+    {
+        std::unordered_set<const TestSuite*> suites;
+        for (const TestInterface* test : tests)
+        {
+            suites.insert(test->suite());
+        }
+        this->totals.test_suites_total = suites.size();
+        this->totals.test_functions_total = tests.size();
+    }
+
+    TestSummary::TestSummary(const TestTotals& totals) noexcept
+        : totals(totals)
+    {
+
+    }
+
+    TestSummary::TestSummary(const std::vector<TestRecord>& all_records)
+    {
+        const std::vector<TestRecord> records = mergeTestRecords(all_records);
+        std::unordered_set<std::string> suites;
+        std::unordered_map<std::string, bool> suites_ran; // suite name to if all tests ran in it passed
+        for (const TestRecord& record : records)
+        {
+            suites.insert(record.suite);
+            totals.test_functions_total++;
+            totals.assertions_total += record.assertions_total;
+            totals.assertions_ran += record.assertions_ran;
+            totals.assertions_passed += record.assertions_passed;
+            if (record.result == TestResult::SKIP) totals.test_functions_skipped++;
+            if (record.result == TestResult::SKIP && record.over_limit) totals.test_functions_over_limit++;
+            if (record.result == TestResult::INVALID || record.result == TestResult::SKIP) continue;
+
+            const bool passed = (record.result == TestResult::PASS || record.result == TestResult::FLAKY || record.result == TestResult::CACHED);
+            totals.test_functions_ran++;
+            totals.test_functions_passed += passed ? 1 : 0;
+            totals.test_functions_flaky += (record.result == TestResult::FLAKY) ? 1 : 0;
+            totals.test_functions_cached += (record.result == TestResult::CACHED) ? 1 : 0;
+            totals.test_functions_quarantined += (!passed && record.quarantined) ? 1 : 0;
+            auto inserted = suites_ran.insert(std::make_pair(record.suite, passed));
+            if (!inserted.second) inserted.first->second = inserted.first->second && passed;
+        }
+        totals.test_suites_total = suites.size();
+        totals.test_suites_ran = suites_ran.size();
+        for (const auto& kv : suites_ran)
+        {
+            totals.test_suites_passed += kv.second ? 1 : 0;
+        }
+    }
+
     void TestSummary::reset() noexcept
     {
         totals.reset();
@@ -157,12 +236,233 @@ namespace sstest
 
     TestSummary& TestSummary::addTestSuiteResult(const TestSuite& suite)
     {
-        totals.test_suites_passed += suite.passed() ? 1 : 0;
-        totals.test_suites_ran += 1;
+        const size_t nskipped = suite.numTestsSkipped();
+        if (suite.numTestsRan() > 0 || nskipped == 0)
+        {
+            totals.test_suites_passed += suite.passed() ? 1 : 0;
+            totals.test_suites_ran += 1;
+        }
 
         totals.test_functions_passed += suite.numTestsPassed();
         totals.test_functions_ran += suite.numTestsRan();//size();
+        totals.test_functions_skipped += nskipped;
+        totals.test_functions_flaky += suite.numTestsFlaky();
+        totals.test_functions_cached += suite.numTestsCached();
+        totals.test_functions_quarantined += suite.numTestsQuarantined();
+        return *this;
+    }
+
+    TestSummary& TestSummary::addTestsOverBudget(size_t n) noexcept
+    {
+        totals.test_functions_over_budget += n;
         return *this;
     }
-    
+
+    TestSummary& TestSummary::addTestsOverLimit(size_t n) noexcept
+    {
+        totals.test_functions_over_limit += n;
+        return *this;
+    }
+
+
+    ////////////////// TEST RECORD /////////////////////
+
+    namespace
+    {
+        // first line of written records, bump the version if the line format changes
+        const char* const RECORDS_HEADER = "# sstest results 1";
+
+        const char* resultName(TestResult result) noexcept
+        {
+            switch (result)
+            {
+            case TestResult::FAIL: return "FAIL";
+            case TestResult::PASS: return "PASS";
+            case TestResult::THROW: return "THROW";
+            case TestResult::CRASH: return "CRASH";
+            case TestResult::TIMEOUT: return "TIMEOUT";
+            case TestResult::SKIP: return "SKIP";
+            case TestResult::FLAKY: return "FLAKY";
+            case TestResult::CACHED: return "CACHED";
+            case TestResult::INVALID: break;
+            }
+            return "INVALID";
+        }
+
+        TestResult parseResult(const std::string& name)
+        {
+            const TestResult results[] = { TestResult::INVALID, TestResult::FAIL, TestResult::PASS, TestResult::THROW, TestResult::CRASH, TestResult::TIMEOUT, TestResult::SKIP, TestResult::FLAKY, TestResult::CACHED };
+            for (TestResult result : results)
+            {
+                if (name == resultName(result)) return result;
+            }
+            throw InvalidArgument("unknown test result " + name);
+        }
+
+        uint64_t parseNumber(const std::string& field)
+        {
+            char* end = nullptr;
+            const unsigned long long n = std::strtoull(field.c_str(), &end, 10);
+            if (field.empty() || field[0] == '-' || *end != '\0') throw InvalidArgument("expected a number in test record, got " + field);
+            return static_cast<uint64_t>(n);
+        }
+    }
+
+    TestRecord::TestRecord() noexcept
+        : result(TestResult::INVALID), quarantined(false), over_limit(false), duration_us(0), assertions_total(0), assertions_ran(0), assertions_passed(0)
+    {
+
+    }
+
+    TestRecord::TestRecord(const TestInterface& test, const TestTotals& assertions)
+        : suite((test.suite() == nullptr) ? std::string() : std::string(test.suite()->name())), 
+        identifier(test.identifier()), 
+        result(test.result()), 
+        quarantined(test.quarantined()),
+        over_limit(false),
+        duration_us(test.duration()),
+        assertions_total(assertions.assertions_total), 
+        assertions_ran(assertions.assertions_ran), 
+        assertions_passed(assertions.assertions_passed)
+    {
+
+    }
+
+    void writeTestRecords(std::ostream& os, const std::vector<TestRecord>& records)
+    {
+        os << RECORDS_HEADER << '\n';
+        for (const TestRecord& record : records)
+        {
+            writeTestRecord(os, record);
+        }
+    }
+
+    void writeTestRecord(std::ostream& os, const TestRecord& record)
+    {
+        // each line is "<result>\t<duration_us>\t<assertions_total>\t<assertions_ran>\t<assertions_passed>\t<quarantined (0|1)>\t<over_limit (0|1)>\t<suite>\t<identifier>"
+        os << resultName(record.result) << '\t' << record.duration_us << '\t' 
+            << record.assertions_total << '\t' << record.assertions_ran << '\t' << record.assertions_passed << '\t'
+            << (record.quarantined ? 1 : 0) << '\t' << (record.over_limit ? 1 : 0) << '\t' << record.suite << '\t' << record.identifier << '\n';
+    }
+
+    std::vector<TestRecord> readTestRecords(std::istream& is)
+    {
+        std::string line;
+        if (!std::getline(is, line) || line != RECORDS_HEADER) throw InvalidArgument("not sstest test results");
+        const int nfields = 9;
+
+        std::vector<TestRecord> records;
+        while (std::getline(is, line))
+        {
+            if (line.empty()) continue;
+            std::vector<std::string> fields;
+            size_t start = 0;
+            // the identifier is last and taken whole
+            for (int i = 0; i < nfields - 1; i++)
+            {
+                const size_t tab = line.find('\t', start);
+                if (tab == std::string::npos) throw InvalidArgument("malformed test record: " + line);
+                fields.push_back(line.substr(start, tab - start));
+                start = tab + 1;
+            }
+            fields.push_back(line.substr(start));
+
+            TestRecord record;
+            record.result = parseResult(fields[0]);
+            record.duration_us = parseNumber(fields[1]);
+            record.assertions_total = static_cast<size_t>(parseNumber(fields[2]));
+            record.assertions_ran = static_cast<size_t>(parseNumber(fields[3]));
+            record.assertions_passed = static_cast<size_t>(parseNumber(fields[4]));
+            if (fields[5] != "0" && fields[5] != "1") throw InvalidArgument("malformed test record: " + line);
+            record.quarantined = (fields[5] == "1");
+            if (fields[6] != "0" && fields[6] != "1") throw InvalidArgument("malformed test record: " + line);
+            record.over_limit = (fields[6] == "1");
+            record.suite = fields[nfields - 2];
+            record.identifier = fields[nfields - 1]; // empty for the anonymous test
+            records.push_back(record);
+        }
+        return records;
+    }
+
+    std::vector<TestRecord> mergeTestRecords(const std::vector<TestRecord>& records)
+    {
+        std::vector<TestRecord> merged;
+        std::unordered_map<std::string, size_t> index; // identifier to position in merged
+        for (const TestRecord& record : records)
+        {
+            auto inserted = index.insert(std::make_pair(record.identifier, merged.size()));
+            if (inserted.second) merged.push_back(record);
+            else merged[inserted.first->second] = record;
+        }
+        return merged;
+    }
+
+    std::unordered_set<std::string> readTestList(std::istream& is)
+    {
+        std::unordered_set<std::string> identifiers;
+        std::string line;
+        while (std::getline(is, line))
+        {
+            const size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') continue;
+            const size_t last = line.find_last_not_of(" \t\r");
+            identifiers.insert(line.substr(first, last - first + 1));
+        }
+        return identifiers;
+    }
+
+    RepeatStats::RepeatStats() noexcept
+        : runs(0), passed(0), first_failure(0), first_failure_result(TestResult::INVALID)
+    {
+
+    }
+
+    void RepeatStats::add(size_t run, TestResult result, uint64_t duration_us)
+    {
+        if (result == TestResult::INVALID || result == TestResult::SKIP) return;
+        runs++;
+        if (result == TestResult::PASS) passed++;
+        else if (first_failure == 0 || run < first_failure)
+        {
+            first_failure = run;
+            first_failure_result = result;
+        }
+        durations_us.insert(std::upper_bound(durations_us.begin(), durations_us.end(), duration_us), duration_us);
+    }
+
+    TestResult RepeatStats::result() const noexcept
+    {
+        if (runs == 0) return TestResult::SKIP;
+        return (first_failure == 0) ? TestResult::PASS : first_failure_result;
+    }
+
+    uint64_t RepeatStats::percentile(double fraction) const
+    {
+        if (fraction < 0 || fraction > 1) throw InvalidArgument("percentile must be between 0 and 1");
+        if (durations_us.empty()) return 0;
+        // nearest rank
+        size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(durations_us.size())));
+        return durations_us[(rank == 0) ? 0 : rank - 1];
+    }
+
+    std::string RepeatStats::describe() const
+    {
+        auto ms = [](uint64_t us) -> std::string
+        {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(1) << static_cast<double>(us) / 1000.0;
+            return ss.str();
+        };
+        std::ostringstream ss;
+        ss << passed << "/" << runs << " runs passed";
+        if (runs > 0) ss << " (" << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(passed) / static_cast<double>(runs) << "%)";
+        if (first_failure != 0) ss << ", first failed on run " << first_failure;
+        if (runs > 0)
+        {
+            ss << ", min/median/p90/max " << ms(durations_us.front()) << "/" << ms(percentile(0.5)) << "/" << ms(percentile(0.9)) 
+                << "/" << ms(durations_us.back()) << " ms";
+        }
+        return ss.str();
+    }
+
 }
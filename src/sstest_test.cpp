@@ -29,22 +29,126 @@
 #include "sstest/sstest_test.h"
 
 #include <cassert>
+#include <exception>
+#include <memory>
+#include <typeindex>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <functional>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
 
 #include "sstest/sstest_exception.h"
 #include "sstest/sstest_string.h"
+#include "sstest/sstest_timer.h"
 
 namespace sstest
 {
 
+    ////////// SUITE FIXTURES /////////////////
+
+    namespace
+    {
+        thread_local SuiteFixtures* current_fixtures = nullptr;
+    }
+
+    SuiteFixtures::~SuiteFixtures()
+    {
+        tearDown();
+        if (current_fixtures == this) current_fixtures = nullptr;
+    }
+
+    std::shared_ptr<void> SuiteFixtures::find(std::type_index fixture) const
+    {
+        for (const Entry& entry : entries)
+        {
+            if (entry.fixture != fixture) continue;
+            if (entry.error) std::rethrow_exception(entry.error);
+            return entry.object;
+        }
+        return nullptr;
+    }
+
+    void SuiteFixtures::insert(std::type_index fixture, std::shared_ptr<void> object, teardown_type teardown)
+    {
+        entries.push_back(Entry{ fixture, std::move(object), std::move(teardown), nullptr });
+    }
+
+    void SuiteFixtures::fail(std::type_index fixture, std::exception_ptr error)
+    {
+        entries.push_back(Entry{ fixture, nullptr, nullptr, error });
+    }
+
+    std::vector<std::string> SuiteFixtures::tearDown()
+    {
+        std::vector<std::string> errors;
+        // reused fixture objects go first, as tests did before the suite fixtures are torn down
+        idle.clear();
+        // later fixtures may have been set up using earlier ones
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+        {
+            if (!it->teardown) continue;
+            try
+            {
+                it->teardown();
+            }
+            catch (const std::exception& e)
+            {
+                errors.push_back(std::string("TearDownSuite() threw: ") + e.what());
+            }
+            catch (...)
+            {
+                errors.push_back("TearDownSuite() threw an unknown exception");
+            }
+        }
+        entries.clear();
+        return errors;
+    }
+
+    std::shared_ptr<void> SuiteFixtures::takeIdle(std::type_index type)
+    {
+        for (auto it = idle.begin(); it != idle.end(); ++it)
+        {
+            if (it->first != type) continue;
+            std::shared_ptr<void> object = std::move(it->second);
+            idle.erase(it);
+            return object;
+        }
+        return nullptr;
+    }
+
+    void SuiteFixtures::putIdle(std::type_index type, std::shared_ptr<void> object)
+    {
+        idle.emplace_back(type, std::move(object));
+    }
+
+    bool SuiteFixtures::checkingReset() const noexcept
+    {
+        return check_reset;
+    }
+
+    void SuiteFixtures::setCheckReset(bool check) noexcept
+    {
+        check_reset = check;
+    }
+
+    SuiteFixtures* SuiteFixtures::current() noexcept
+    {
+        return current_fixtures;
+    }
+
+    void SuiteFixtures::setCurrent(SuiteFixtures* fixtures) noexcept
+    {
+        current_fixtures = fixtures;
+    }
+
     ////////// TEST INTERFACE /////////////////
 
     TestInterface::TestInterface(TestInfo tinfo, LineInfo linfo, sstest_void_function test_callback) noexcept
-        : test_info(tinfo), line_info(linfo), invoker(test_callback), result_(TestResult::INVALID)
+        : test_info(tinfo), line_info(linfo), invoker(test_callback), result_(TestResult::INVALID), duration_us(0), weight_(0), quarantined_(false), suite_(nullptr)
     {
 
     }
@@ -56,10 +160,23 @@ namespace sstest
         return test_info.name;
     }
 
-    // StringView TestInterface::identifier() const noexcept
-    // {
-    //     return test_info.name;//std::string(test_info.name.data());
-    // }
+    TestSuite* TestInterface::suite() const noexcept
+    {
+        return suite_;
+    }
+
+    std::string TestInterface::identifier() const
+    {
+        std::string id = test_info.name;
+        if (suite_ == nullptr || suite_->name().empty()) return id;
+        const std::string prefix = std::string(suite_->name()) + "::";
+        return (id.compare(0, prefix.size(), prefix) == 0) ? id : prefix + id;
+    }
+
+    const LineInfo& TestInterface::lineInfo() const noexcept
+    {
+        return line_info;
+    }
 
     void TestInterface::operator()()
     {
@@ -68,14 +185,14 @@ namespace sstest
 
     bool TestInterface::ran() const noexcept
     {
-        return result_ != TestResult::INVALID;
+        return result_ != TestResult::INVALID && result_ != TestResult::SKIP;
     }
 
     bool TestInterface::passed() const noexcept
     {
         // TODO const message
         //if (!ran()) throw SSException("Call to passed() although test hasn't ran");
-        return result_ == TestResult::PASS;
+        return result_ == TestResult::PASS || result_ == TestResult::FLAKY || result_ == TestResult::CACHED;
     }
 
     TestResult TestInterface::result() const noexcept
@@ -88,20 +205,59 @@ namespace sstest
         result_ = (fail) ? TestResult::FAIL : result_;
     }
 
+    void TestInterface::setResult(TestResult result, uint64_t duration_us) noexcept
+    {
+        result_ = result;
+        this->duration_us = duration_us;
+    }
+
+    uint64_t TestInterface::duration() const noexcept
+    {
+        return duration_us;
+    }
+
+    const std::string& TestInterface::thrownMessage() const noexcept
+    {
+        return thrown_message;
+    }
+
+    uint64_t TestInterface::weight() const noexcept
+    {
+        return weight_;
+    }
+
+    void TestInterface::setWeight(uint64_t weight) noexcept
+    {
+        weight_ = weight;
+    }
+
+    bool TestInterface::quarantined() const noexcept
+    {
+        return quarantined_;
+    }
+
+    void TestInterface::setQuarantined(bool quarantined) noexcept
+    {
+        quarantined_ = quarantined;
+    }
+
     TestInterface& TestInterface::runTestHelper(TestInterface& test)
     {
+        Stopwatch timer;
+        timer.start();
         try
         {
             test.invoker();
         }
         catch (const std::exception& e) {
-            (void)e;
             test.result_ = TestResult::THROW;
+            test.thrown_message = e.what();
         }
         catch (...)
         {
             test.result_ = TestResult::THROW;
         }
+        test.duration_us = static_cast<uint64_t>(timer.stop<std::chrono::microseconds>().count());
         return test;
     }
 
@@ -110,15 +266,15 @@ namespace sstest
     /////////////// TEST FUNCTION ///////////////////////////////
 
     TestFunction::TestFunction(TestInfo tinfo, LineInfo linfo, sstest_void_function test_func)
-        : TestInterface(tinfo, linfo, test_func), weight(1)
+        : TestInterface(tinfo, linfo, test_func)
     {
         if (!invoker) throw InvalidArgument("Test function was null");
     }
 
     void TestFunction::run()
     {
-        (void)weight;// TODO for -Wunusred-private-field
         result_ = TestResult::PASS;
+        thrown_message.clear();
         runTestHelper(*this); // TODO catch
         //finished = true;
     }
@@ -177,6 +333,20 @@ namespace sstest
         finished = true;
     }
 
+    void TestSuite::tally() noexcept
+    {
+        num_ran = 0;
+        pass = true;
+        for (const TestInterface* test : test_order)
+        {
+            assert(test != nullptr);
+            if (!test->ran()) continue;
+            pass = pass && test->passed();
+            num_ran++;
+        }
+        finished = true;
+    }
+
     // TestSuite* TestSuite::clone() const
     // {
     //     return new TestSuite(*this);
@@ -191,6 +361,7 @@ namespace sstest
             kv.second = nullptr;
         }
         test_map.clear();
+        test_order.clear();
         num_ran = 0;
         pass = false;
         finished = false;
@@ -209,10 +380,54 @@ namespace sstest
     size_t TestSuite::numTestsPassed() const noexcept
     {
         size_t count = 0;
-        for (auto &kv : test_map)
+        for (const TestInterface* test : test_order)
         {
-            assert(kv.second != nullptr);
-            count += kv.second->passed() ? 1 : 0;
+            assert(test != nullptr);
+            count += test->passed() ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t TestSuite::numTestsSkipped() const noexcept
+    {
+        size_t count = 0;
+        for (const TestInterface* test : test_order)
+        {
+            assert(test != nullptr);
+            count += (test->result() == TestResult::SKIP) ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t TestSuite::numTestsFlaky() const noexcept
+    {
+        size_t count = 0;
+        for (const TestInterface* test : test_order)
+        {
+            assert(test != nullptr);
+            count += (test->result() == TestResult::FLAKY) ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t TestSuite::numTestsCached() const noexcept
+    {
+        size_t count = 0;
+        for (const TestInterface* test : test_order)
+        {
+            assert(test != nullptr);
+            count += (test->result() == TestResult::CACHED) ? 1 : 0;
+        }
+        return count;
+    }
+
+    size_t TestSuite::numTestsQuarantined() const noexcept
+    {
+        size_t count = 0;
+        for (const TestInterface* test : test_order)
+        {
+            assert(test != nullptr);
+            count += (test->ran() && !test->passed() && test->quarantined()) ? 1 : 0;
         }
         return count;
     }
@@ -238,7 +453,10 @@ namespace sstest
         if (it == test_map.end())
         {
             // copy new
-            test_map[test.name()] = test.clone();//new TestInterface(test);
+            TestInterface* copy = test.clone();//new TestInterface(test);
+            copy->suite_ = this;
+            test_map[test.name()] = copy;
+            test_order.push_back(copy);
         }
         else
         {
@@ -262,13 +480,8 @@ namespace sstest
 
     std::vector<TestInterface*> TestSuite::getTests(sstest_comparator cmp) const
     {
-
-        std::vector<TestInterface*> tests;
-        tests.reserve(test_map.size());
-        for (auto kv : test_map)
-        {
-            tests.push_back(kv.second);
-        }
+        // tests are in the order they were added unless sorted, e.g. in order of declaration within a file
+        std::vector<TestInterface*> tests(test_order);
         if (cmp) 
         {
             std::sort(tests.begin(), tests.end(), cmp);
@@ -285,4 +498,122 @@ namespace sstest
         return test;
     }
 
+    std::vector<size_t> partitionByWeight(const std::vector<TestInterface*>& tests, size_t nparts)
+    {
+        if (nparts == 0) throw InvalidArgument("number of parts must be at least 1");
+
+        std::vector<uint64_t> loads(nparts, 0);
+        std::vector<size_t> counts(nparts, 0);
+        std::vector<size_t> parts;
+        parts.reserve(tests.size());
+        for (TestInterface* test : tests)
+        {
+            assert(test != nullptr);
+            // lightest part, breaking ties by fewest tests then lowest index
+            size_t lightest = 0;
+            for (size_t part = 1; part < nparts; part++)
+            {
+                if (loads[part] < loads[lightest] || (loads[part] == loads[lightest] && counts[part] < counts[lightest])) lightest = part;
+            }
+            loads[lightest] += test->weight();
+            counts[lightest]++;
+            parts.push_back(lightest);
+        }
+        return parts;
+    }
+
+    std::vector<TestInterface*> selectShard(const std::vector<TestInterface*>& tests, size_t shard_index, size_t total_shards)
+    {
+        if (total_shards == 0) throw InvalidArgument("total shards must be at least 1");
+        if (shard_index >= total_shards) 
+        {
+            throw InvalidArgument("shard index " + std::to_string(shard_index) + " is out of range for " + std::to_string(total_shards) + " shards");
+        }
+        if (total_shards == 1) return tests;
+
+        // fixed seed, the hash must be the same on every machine
+        constexpr unsigned int shard_seed = 0x5eed;
+        struct ShardKey
+        {
+            uint64_t weight;
+            uint32_t hash;
+            std::string id;
+            size_t index;
+        };
+        std::vector<ShardKey> order;
+        order.reserve(tests.size());
+        for (size_t i = 0; i < tests.size(); i++)
+        {
+            assert(tests[i] != nullptr);
+            std::string id = tests[i]->identifier();
+            int len = static_cast<int>(std::min(static_cast<size_t>(std::numeric_limits<int>::max()), id.size()));
+            uint32_t hash = hash_functions::murmur::murmurHashNeutral32(id.data(), len, shard_seed);
+            order.push_back(ShardKey{ tests[i]->weight(), hash, std::move(id), i });
+        }
+        std::sort(order.begin(), order.end(), [](const ShardKey& lhs, const ShardKey& rhs) -> bool
+        {
+            if (lhs.weight != rhs.weight) return lhs.weight > rhs.weight;
+            if (lhs.hash != rhs.hash) return lhs.hash < rhs.hash;
+            return lhs.id < rhs.id;
+        });
+
+        std::vector<TestInterface*> sorted;
+        sorted.reserve(order.size());
+        for (const ShardKey& key : order) sorted.push_back(tests[key.index]);
+        const std::vector<size_t> parts = partitionByWeight(sorted, total_shards);
+
+        std::vector<bool> selected(tests.size(), false);
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (parts[i] == shard_index) selected[order[i].index] = true;
+        }
+
+        std::vector<TestInterface*> shard;
+        for (size_t i = 0; i < tests.size(); i++)
+        {
+            if (selected[i]) shard.push_back(tests[i]);
+        }
+        return shard;
+    }
+
+    std::vector<TestInterface*> shuffleTests(const std::vector<TestInterface*>& tests, uint32_t seed)
+    {
+        auto hash = [seed](const std::string& str) -> uint32_t
+        {
+            int len = static_cast<int>(std::min(static_cast<size_t>(std::numeric_limits<int>::max()), str.size()));
+            return hash_functions::murmur::murmurHashNeutral32(str.data(), len, seed);
+        };
+        struct ShuffleKey
+        {
+            uint32_t suite_hash;
+            std::string suite;
+            uint32_t hash;
+            std::string id;
+            TestInterface* test;
+        };
+        std::vector<ShuffleKey> order;
+        order.reserve(tests.size());
+        for (TestInterface* test : tests)
+        {
+            assert(test != nullptr);
+            std::string suite = (test->suite() == nullptr) ? std::string() : std::string(test->suite()->name());
+            std::string id = test->identifier();
+            const uint32_t suite_hash = hash(suite);
+            const uint32_t id_hash = hash(id);
+            order.push_back(ShuffleKey{ suite_hash, std::move(suite), id_hash, std::move(id), test });
+        }
+        std::sort(order.begin(), order.end(), [](const ShuffleKey& lhs, const ShuffleKey& rhs) -> bool
+        {
+            if (lhs.suite_hash != rhs.suite_hash) return lhs.suite_hash < rhs.suite_hash;
+            if (lhs.suite != rhs.suite) return lhs.suite < rhs.suite;
+            if (lhs.hash != rhs.hash) return lhs.hash < rhs.hash;
+            return lhs.id < rhs.id;
+        });
+
+        std::vector<TestInterface*> shuffled;
+        shuffled.reserve(order.size());
+        for (const ShuffleKey& key : order) shuffled.push_back(key.test);
+        return shuffled;
+    }
+
 }
@@ -0,0 +1,255 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "sstest/sstest_watchdog.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#   define SSTEST_HAS_STACK_DUMP
+#   include <atomic>
+#   include <csignal>
+#   include <dirent.h>
+#   include <execinfo.h>
+#   include <signal.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#elif !defined(_WIN32) && !defined(_WIN64)
+#   include <unistd.h>
+#endif
+
+#if defined(SSTEST_HAS_STACK_DUMP) && !defined(SSTEST_STACK_DUMP_SIGNAL)
+/**
+ * \brief Signal sent to each thread to make it write its own stack, define to use a signal other than SIGUSR2
+ * 
+ */
+#   define SSTEST_STACK_DUMP_SIGNAL SIGUSR2
+#endif
+
+namespace sstest
+{
+
+    constexpr size_t Watchdog::global_slot;
+
+    Watchdog::Watchdog(size_t nslots, expire_type on_expire)
+        : slots(nslots), on_expire(std::move(on_expire)), has_global_deadline(false), global_expired(false), running(false)
+    {
+
+    }
+
+    Watchdog::~Watchdog()
+    {
+        stop();
+    }
+
+    void Watchdog::start(std::chrono::milliseconds global_timeout)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) return;
+        has_global_deadline = (global_timeout.count() > 0);
+        global_expired = false;
+        global_deadline = clock_type::now() + global_timeout;
+        running = true;
+        thread = std::thread(&Watchdog::watchLoop, this);
+    }
+
+    void Watchdog::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) return;
+            running = false;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+
+    void Watchdog::arm(size_t slot, std::chrono::milliseconds timeout, const std::string& label)
+    {
+        assert(slot < slots.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Slot& s = slots[slot];
+            s.armed = (timeout.count() > 0);
+            s.expired = false;
+            s.deadline = clock_type::now() + timeout;
+            s.label = label;
+        }
+        cv.notify_all();
+    }
+
+    bool Watchdog::disarm(size_t slot)
+    {
+        assert(slot < slots.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot& s = slots[slot];
+        s.armed = false;
+        return s.expired;
+    }
+
+    void Watchdog::watchLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+        {
+            const clock_type::time_point now = clock_type::now();
+            clock_type::time_point next = clock_type::time_point::max();
+
+            // callbacks may take a while (e.g. dumping stacks), so run them without the lock
+            std::vector<std::pair<size_t, std::string>> expired;
+            if (has_global_deadline && !global_expired)
+            {
+                if (now >= global_deadline) 
+                {
+                    global_expired = true;
+                    expired.push_back(std::make_pair(global_slot, std::string()));
+                }
+                else next = global_deadline;
+            }
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                Slot& s = slots[i];
+                if (!s.armed || s.expired) continue;
+                if (now >= s.deadline)
+                {
+                    s.expired = true;
+                    expired.push_back(std::make_pair(i, s.label));
+                }
+                else if (s.deadline < next) next = s.deadline;
+            }
+
+            if (!expired.empty())
+            {
+                lock.unlock();
+                for (const std::pair<size_t, std::string>& slot : expired)
+                {
+                    if (on_expire) on_expire(slot.first, slot.second);
+                }
+                lock.lock();
+                continue;
+            }
+
+            if (next == clock_type::time_point::max()) cv.wait(lock);
+            else cv.wait_until(lock, next);
+        }
+    }
+
+#if defined(SSTEST_HAS_STACK_DUMP)
+
+    namespace
+    {
+        std::atomic<int> dump_fd(-1); // -1 when not dumping
+        std::atomic<bool> dump_done(false);
+
+        void writeString(int fd, const char* str) noexcept
+        {
+            size_t n = std::strlen(str);
+            while (n > 0)
+            {
+                ssize_t w = ::write(fd, str, n);
+                if (w < 0 && errno == EINTR) continue;
+                if (w <= 0) return;
+                str += w;
+                n -= static_cast<size_t>(w);
+            }
+        }
+
+        void dumpSignalHandler(int)
+        {
+            // a late signal from a thread that didn't answer in time is ignored
+            const int fd = dump_fd.load();
+            if (fd < 0 || dump_done) return;
+            const int saved_errno = errno;
+            void* frames[64];
+            const int nframes = ::backtrace(frames, 64);
+            ::backtrace_symbols_fd(frames, nframes, fd);
+            dump_done = true;
+            errno = saved_errno;
+        }
+    }
+
+    void dumpThreadStacks(int fd) noexcept
+    {
+        // first call of backtrace() may allocate while loading libgcc, don't let that happen in a signal handler
+        void* warmup[1];
+        ::backtrace(warmup, 1);
+
+        // the handler stays installed afterwards, since a thread that had the signal blocked may still get it later
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = dumpSignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (::sigaction(SSTEST_STACK_DUMP_SIGNAL, &action, nullptr) != 0) return;
+        dump_done = true;
+        dump_fd = fd;
+
+        const pid_t pid = ::getpid();
+        const pid_t self = static_cast<pid_t>(::syscall(SYS_gettid));
+        DIR* dir = ::opendir("/proc/self/task");
+        if (dir != nullptr)
+        {
+            while (struct dirent* entry = ::readdir(dir))
+            {
+                if (entry->d_name[0] == '.') continue;
+                const pid_t tid = static_cast<pid_t>(std::atoi(entry->d_name));
+                if (tid == self) continue;
+
+                writeString(fd, (std::string("thread ") + entry->d_name + ":\n").c_str());
+                dump_done = false;
+                if (::syscall(SYS_tgkill, pid, tid, SSTEST_STACK_DUMP_SIGNAL) != 0) continue;
+                // the thread may have the signal blocked, don't wait forever
+                for (int i = 0; i < 200 && !dump_done; i++) ::usleep(1000);
+                if (!dump_done) writeString(fd, "    <no response>\n");
+            }
+            ::closedir(dir);
+        }
+        dump_fd = -1;
+    }
+
+#else // defined(SSTEST_HAS_STACK_DUMP)
+
+    void dumpThreadStacks(int fd) noexcept
+    {
+#if !defined(_WIN32) && !defined(_WIN64)
+        const char msg[] = "stack dumps are not supported on this platform\n";
+        ssize_t w = ::write(fd, msg, sizeof(msg) - 1);
+        (void)w;
+#else
+        (void)fd;
+#endif
+    }
+
+#endif // defined(SSTEST_HAS_STACK_DUMP)
+
+}
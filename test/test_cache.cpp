@@ -0,0 +1,170 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sstest/sstest_cache.h"
+
+/**
+ * This class test ResultCache functionality
+ */
+
+using namespace sstest;
+
+static const char* const cache_path = "test_cache.tmp.cache";
+static const char* const input_path = "test_cache.tmp.input";
+
+CTEST_DEFINE_TEST(test_cache_store_find)
+{
+    ResultCache cache;
+    CTEST_ASSERT(cache.empty());
+    CTEST_ASSERT(cache.find("suite::test", 1) == nullptr);
+
+    cache.store("suite::test", 1, 100);
+    CTEST_ASSERT(cache.size() == 1);
+    CTEST_ASSERT(cache.find("suite::test", 1) != nullptr);
+    CTEST_ASSERT(cache.find("suite::test", 1)->duration_us == 100);
+    // a different key means the program or inputs changed
+    CTEST_ASSERT(cache.find("suite::test", 2) == nullptr);
+
+    cache.store("suite::test", 2, 200);
+    CTEST_ASSERT(cache.size() == 1);
+    CTEST_ASSERT(cache.find("suite::test", 1) == nullptr);
+    CTEST_ASSERT(cache.find("suite::test", 2)->duration_us == 200);
+
+    cache.erase("suite::test");
+    CTEST_ASSERT(cache.empty());
+    cache.store("suite::test", 3, 300);
+    cache.clear();
+    CTEST_ASSERT(cache.empty());
+}
+
+CTEST_DEFINE_TEST(test_cache_save_load)
+{
+    ResultCache cache;
+    cache.store("suite::test", 0xfedcba9876543210ULL, 100);
+    cache.store("suite::other test ( 1, 2 )", 0, 12345678901ULL);
+    CTEST_ASSERT(cache.save(cache_path));
+
+    ResultCache loaded;
+    CTEST_ASSERT(loaded.load(cache_path));
+    CTEST_ASSERT(loaded.size() == 2);
+    CTEST_ASSERT(loaded.find("suite::test", 0xfedcba9876543210ULL)->duration_us == 100);
+    CTEST_ASSERT(loaded.find("suite::other test ( 1, 2 )", 0)->duration_us == 12345678901ULL);
+
+    // malformed lines are skipped, and an unknown format is ignored entirely
+    {
+        std::ofstream file(cache_path);
+        file << "# sstest cache 1\n";
+        file << "00000000000000ff\t100\tsuite::good\n";
+        file << "not hex\t100\tsuite::bad_key\n";
+        file << "ff\tnot a number\tsuite::bad_duration\n";
+        file << "ff\t100\n";
+        file << "00000000000000000ff\t100\tsuite::long_key\n";
+        file << "\n";
+    }
+    ResultCache malformed;
+    CTEST_ASSERT(malformed.load(cache_path));
+    CTEST_ASSERT(malformed.size() == 1);
+    CTEST_ASSERT(malformed.find("suite::good", 0xff) != nullptr);
+    {
+        std::ofstream file(cache_path);
+        file << "00000000000000ff\t100\tsuite::good\n";
+    }
+    ResultCache unknown;
+    CTEST_ASSERT(!unknown.load(cache_path));
+    CTEST_ASSERT(unknown.empty());
+
+    std::remove(cache_path);
+    ResultCache missing;
+    CTEST_ASSERT(!missing.load(cache_path));
+}
+
+CTEST_DEFINE_TEST(test_cache_key)
+{
+    std::remove(input_path);
+    uint64_t hash = 0;
+    CTEST_ASSERT(!ResultCache::hashFile(input_path, hash));
+
+    const uint64_t program = 42;
+    const uint64_t no_inputs = ResultCache::makeKey(program, "suite::test", {});
+    CTEST_ASSERT(no_inputs == ResultCache::makeKey(program, "suite::test", {}));
+    CTEST_ASSERT(no_inputs != ResultCache::makeKey(program + 1, "suite::test", {}));
+    CTEST_ASSERT(no_inputs != ResultCache::makeKey(program, "suite::other", {}));
+
+    // a missing input is part of the key, so creating it changes the key
+    const uint64_t missing = ResultCache::makeKey(program, "suite::test", { input_path });
+    CTEST_ASSERT(missing != no_inputs);
+    {
+        std::ofstream file(input_path);
+        file << "contents";
+    }
+    CTEST_ASSERT(ResultCache::hashFile(input_path, hash));
+    const uint64_t created = ResultCache::makeKey(program, "suite::test", { input_path });
+    CTEST_ASSERT(created != missing);
+    CTEST_ASSERT(created == ResultCache::makeKey(program, "suite::test", { input_path, input_path }));
+    {
+        std::ofstream file(input_path);
+        file << "contents changed";
+    }
+    uint64_t changed_hash = 0;
+    CTEST_ASSERT(ResultCache::hashFile(input_path, changed_hash));
+    CTEST_ASSERT(changed_hash != hash);
+    CTEST_ASSERT(ResultCache::makeKey(program, "suite::test", { input_path }) != created);
+
+    std::remove(input_path);
+}
+
+CTEST_DEFINE_TEST(test_cache_program_hash)
+{
+    uint64_t hash = 0;
+    CTEST_ASSERT(!ResultCache::hashProgram(input_path, hash));
+#if defined(__linux__)
+    uint64_t program = 0;
+    uint64_t file = 0;
+    CTEST_ASSERT(ResultCache::hashProgram("/proc/self/exe", program));
+    CTEST_ASSERT(ResultCache::hashFile("/proc/self/exe", file));
+    // the C++ runtime this test links against is part of the hash too
+    CTEST_ASSERT(program != file);
+    CTEST_ASSERT(ResultCache::hashProgram("/proc/self/exe", hash));
+    CTEST_ASSERT(hash == program);
+#endif
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_cache_store_find);
+    CTEST_RUN_TEST(test_cache_save_load);
+    CTEST_RUN_TEST(test_cache_key);
+    CTEST_RUN_TEST(test_cache_program_hash);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sstest/sstest_coverage.h"
+
+/**
+ * This class test TestImpactIndex functionality
+ */
+
+using namespace sstest;
+
+static const char* const index_path = "test_coverage.tmp.impact";
+
+CTEST_DEFINE_TEST(test_impact_same_source)
+{
+    // CMake names objects after the source path below the target directory
+    CTEST_ASSERT(TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/foo.cpp", "src/foo.cpp"));
+    CTEST_ASSERT(TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/foo.cpp", "./src/foo.cpp"));
+    CTEST_ASSERT(TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/foo.cpp", "foo.cpp"));
+    CTEST_ASSERT(TestImpactIndex::sameSource("src/foo.cpp", "src/foo.cpp"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/xfoo.cpp", "src/foo.cpp"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/foo.cpp", "other/foo.cpp"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/CMakeFiles/t.dir/src/foo.cpp", "src/foo.h"));
+
+    // objects compiled directly are named without the source extension
+    CTEST_ASSERT(TestImpactIndex::sameSource("/build/obj/foo", "src/foo.cpp"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/obj/foo", "src/foobar.cpp"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/obj/foo", "src/foo"));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/obj/foo", "src/foo.h"));
+
+    // test files are recorded as written in the source
+    CTEST_ASSERT(TestImpactIndex::sameSource("C:\\repo\\test\\foo.cpp", "test/foo.cpp") == false);
+    CTEST_ASSERT(TestImpactIndex::sameSource("C:\\repo\\test\\foo.cpp", "foo.cpp"));
+
+    CTEST_ASSERT(!TestImpactIndex::sameSource("/build/obj/foo", ""));
+    CTEST_ASSERT(!TestImpactIndex::sameSource("", "src/foo.cpp"));
+}
+
+CTEST_DEFINE_TEST(test_impact_affected)
+{
+    TestImpactIndex index;
+    CTEST_ASSERT(index.empty());
+    index.recordTest("suite::a", { "/build/obj/foo", "test/test_a.cpp" });
+    index.recordTest("suite::b", { "/build/obj/bar", "/build/obj/foo", "/build/obj/foo", "test/test_b.cpp" });
+    CTEST_ASSERT(index.size() == 2);
+    CTEST_ASSERT(index.find("suite::b")->size() == 3); // duplicates removed
+    CTEST_ASSERT(index.find("suite::c") == nullptr);
+
+    CTEST_ASSERT(index.affected("suite::a", { "src/foo.cpp" }));
+    CTEST_ASSERT(index.affected("suite::b", { "src/foo.cpp" }));
+    CTEST_ASSERT(!index.affected("suite::a", { "src/bar.cpp" }));
+    CTEST_ASSERT(index.affected("suite::b", { "src/bar.cpp" }));
+    CTEST_ASSERT(index.affected("suite::a", { "test/test_a.cpp" }));
+    CTEST_ASSERT(!index.affected("suite::b", { "test/test_a.cpp", "README.md" }));
+    CTEST_ASSERT(!index.affected("suite::a", {}));
+    // nothing is known about new tests
+    CTEST_ASSERT(index.affected("suite::c", { "README.md" }));
+
+    CTEST_ASSERT(index.covers("src/bar.cpp"));
+    CTEST_ASSERT(!index.covers("src/bar.h"));
+
+    // recording a test again replaces its files
+    index.recordTest("suite::b", { "test/test_b.cpp" });
+    CTEST_ASSERT(!index.affected("suite::b", { "src/bar.cpp" }));
+
+    index.clear();
+    CTEST_ASSERT(index.empty());
+}
+
+CTEST_DEFINE_TEST(test_impact_save_load)
+{
+    TestImpactIndex index;
+    index.recordTest("suite::a", { "/build/obj/foo", "test/test a.cpp" });
+    index.recordTest("suite::other test ( 1, 2 )", { "/build/obj/bar" });
+    CTEST_ASSERT(index.save(index_path));
+
+    TestImpactIndex loaded;
+    CTEST_ASSERT(loaded.load(index_path));
+    CTEST_ASSERT(loaded.size() == 2);
+    CTEST_ASSERT(*loaded.find("suite::a") == *index.find("suite::a"));
+    CTEST_ASSERT(*loaded.find("suite::other test ( 1, 2 )") == *index.find("suite::other test ( 1, 2 )"));
+
+    // malformed lines are skipped, and an unknown format is ignored entirely
+    {
+        std::ofstream file(index_path);
+        file << "# sstest impact 1\n";
+        file << "/build/obj/foo\tsuite::good\n";
+        file << "no tab\n";
+        file << "\tsuite::no_file\n";
+        file << "/build/obj/foo\t\n";
+        file << "\n";
+    }
+    TestImpactIndex malformed;
+    CTEST_ASSERT(malformed.load(index_path));
+    CTEST_ASSERT(malformed.size() == 1);
+    CTEST_ASSERT(malformed.find("suite::good") != nullptr);
+    {
+        std::ofstream file(index_path);
+        file << "/build/obj/foo\tsuite::good\n";
+    }
+    TestImpactIndex unknown;
+    CTEST_ASSERT(!unknown.load(index_path));
+    CTEST_ASSERT(unknown.empty());
+
+    std::remove(index_path);
+    TestImpactIndex missing;
+    CTEST_ASSERT(!missing.load(index_path));
+}
+
+CTEST_DEFINE_TEST(test_coverage_unavailable)
+{
+    // without coverage, collecting finds nothing rather than failing
+    if (coverageAvailable()) return;
+    resetCoverage();
+    CTEST_ASSERT(collectCoverage().empty());
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_impact_same_source);
+    CTEST_RUN_TEST(test_impact_affected);
+    CTEST_RUN_TEST(test_impact_save_load);
+    CTEST_RUN_TEST(test_coverage_unavailable);
+
+    return EXIT_SUCCESS;
+}
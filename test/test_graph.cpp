@@ -0,0 +1,230 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <stdexcept>
+#include <vector>
+#include "sstest/sstest_graph.h"
+
+/**
+ * This class test TestGraph and TestScheduler functionality
+ */
+
+using namespace sstest;
+
+CTEST_DEFINE_TEST(test_graph_dependencies)
+{
+    TestGraph graph(3);
+    CTEST_ASSERT(graph.size() == 3);
+    CTEST_ASSERT(!graph.hasDependencies());
+
+    graph.addDependency(2, 0);
+    graph.addDependency(2, 1);
+    graph.addDependency(2, 0); // same dependency again
+    CTEST_ASSERT(graph.hasDependencies());
+    CTEST_ASSERT(graph.prerequisites(2) == std::vector<size_t>({ 0, 1 }));
+    CTEST_ASSERT(graph.dependents(0) == std::vector<size_t>({ 2 }));
+    CTEST_ASSERT(graph.prerequisites(0).empty());
+
+    bool thrown = false;
+    try { graph.addDependency(1, 1); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+
+    thrown = false;
+    try { graph.addDependency(3, 0); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(test_graph_topological_order)
+{
+    // without dependencies the order is kept
+    TestGraph graph(5);
+    CTEST_ASSERT(graph.topologicalOrder() == std::vector<size_t>({ 0, 1, 2, 3, 4 }));
+
+    // 0 after 3, 1 after 4 and 0
+    graph.addDependency(0, 3);
+    graph.addDependency(1, 4);
+    graph.addDependency(1, 0);
+    CTEST_ASSERT(graph.topologicalOrder() == std::vector<size_t>({ 2, 3, 0, 4, 1 }));
+
+    graph.addDependency(3, 1);
+    bool thrown = false;
+    try { graph.topologicalOrder(); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(test_scheduler_pass)
+{
+    // 0 -> 2, 1 -> 2, 2 -> 3
+    TestGraph graph(4);
+    graph.addDependency(2, 0);
+    graph.addDependency(2, 1);
+    graph.addDependency(3, 2);
+    TestScheduler scheduler(graph);
+    CTEST_ASSERT(scheduler.start() == std::vector<size_t>({ 0, 1 }));
+
+    std::vector<size_t> ready, skipped;
+    scheduler.finish(1, true, ready, skipped);
+    CTEST_ASSERT(ready.empty());
+    scheduler.finish(0, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 2 }));
+    ready.clear();
+    scheduler.finish(2, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 3 }));
+    CTEST_ASSERT(skipped.empty());
+}
+
+CTEST_DEFINE_TEST(test_scheduler_fail)
+{
+    // 0 -> 2, 1 -> 2, 2 -> 3, 1 -> 4
+    TestGraph graph(5);
+    graph.addDependency(2, 0);
+    graph.addDependency(2, 1);
+    graph.addDependency(3, 2);
+    graph.addDependency(4, 1);
+    TestScheduler scheduler(graph);
+    CTEST_ASSERT(scheduler.start() == std::vector<size_t>({ 0, 1 }));
+
+    // everything depending on 0 is skipped, directly or not
+    std::vector<size_t> ready, skipped;
+    scheduler.finish(0, false, ready, skipped);
+    CTEST_ASSERT(ready.empty());
+    CTEST_ASSERT(skipped == std::vector<size_t>({ 2, 3 }));
+
+    // a skipped test doesn't become ready when its other prerequisite passes
+    skipped.clear();
+    scheduler.finish(1, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 4 }));
+    CTEST_ASSERT(skipped.empty());
+}
+
+CTEST_DEFINE_TEST(test_scheduler_resources)
+{
+    // 0, 1 and 2 use a resource 2 tests may use at once, 3 uses one only 1 test may use, 4 uses both
+    TestGraph graph(5);
+    const size_t mem = graph.addResource(2);
+    const size_t port = graph.addResource(1);
+    CTEST_ASSERT(graph.numResources() == 2);
+    CTEST_ASSERT(!graph.hasResources());
+    graph.useResource(0, mem);
+    graph.useResource(1, mem);
+    graph.useResource(2, mem);
+    graph.useResource(3, port);
+    graph.useResource(4, port);
+    graph.useResource(4, mem);
+    CTEST_ASSERT(graph.hasResources());
+    CTEST_ASSERT(graph.resources(4) == std::vector<size_t>({ port, mem }));
+
+    // tests that fit are not held back by tests before them that don't
+    TestScheduler scheduler(graph);
+    CTEST_ASSERT(scheduler.start() == std::vector<size_t>({ 0, 1, 3 }));
+
+    std::vector<size_t> ready, skipped;
+    scheduler.finish(3, true, ready, skipped);
+    CTEST_ASSERT(ready.empty());
+    scheduler.finish(1, false, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 2 }));
+    ready.clear();
+    scheduler.finish(0, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 4 }));
+    CTEST_ASSERT(skipped.empty());
+
+    bool thrown = false;
+    try { graph.addResource(0); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(test_scheduler_exclusive)
+{
+    // 1 runs alone, 3 only after 2 passed
+    TestGraph graph(4);
+    graph.setExclusive(1);
+    graph.addDependency(3, 2);
+    CTEST_ASSERT(graph.exclusive(1));
+    CTEST_ASSERT(graph.hasResources());
+
+    TestScheduler scheduler(graph);
+    CTEST_ASSERT(scheduler.start() == std::vector<size_t>({ 0, 2 }));
+
+    std::vector<size_t> ready, skipped;
+    scheduler.finish(2, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 3 }));
+    ready.clear();
+    scheduler.finish(0, true, ready, skipped);
+    CTEST_ASSERT(ready.empty());
+    scheduler.finish(3, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 1 }));
+
+    // an exclusive test that starts first holds back every other test
+    TestGraph first(2);
+    first.setExclusive(0);
+    TestScheduler exclusive_first(first);
+    CTEST_ASSERT(exclusive_first.start() == std::vector<size_t>({ 0 }));
+    ready.clear();
+    exclusive_first.finish(0, true, ready, skipped);
+    CTEST_ASSERT(ready == std::vector<size_t>({ 1 }));
+}
+
+CTEST_DEFINE_TEST(test_graph_repeated)
+{
+    // 1 after 0, 2 uses a resource
+    TestGraph graph(3);
+    graph.addDependency(1, 0);
+    const size_t port = graph.addResource(1);
+    graph.useResource(2, port);
+    graph.setExclusive(0);
+
+    const TestGraph repeated = graph.repeated(3);
+    CTEST_ASSERT(repeated.size() == 9);
+    CTEST_ASSERT(repeated.numResources() == 1);
+    for (size_t k = 0; k < 3; k++)
+    {
+        CTEST_ASSERT(repeated.prerequisites(3 * k + 1) == std::vector<size_t>({ 3 * k }));
+        CTEST_ASSERT(repeated.resources(3 * k + 2) == std::vector<size_t>({ port }));
+        CTEST_ASSERT(repeated.exclusive(3 * k));
+    }
+    CTEST_ASSERT(graph.repeated(0).size() == 0);
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_graph_dependencies);
+    CTEST_RUN_TEST(test_graph_topological_order);
+    CTEST_RUN_TEST(test_scheduler_pass);
+    CTEST_RUN_TEST(test_scheduler_fail);
+    CTEST_RUN_TEST(test_graph_repeated);
+    CTEST_RUN_TEST(test_scheduler_resources);
+    CTEST_RUN_TEST(test_scheduler_exclusive);
+
+    return CTEST_SUCCESS;
+}
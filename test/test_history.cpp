@@ -0,0 +1,269 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest/sstest_history.h"
+
+/**
+ * This class test TestHistory functionality
+ */
+
+using namespace sstest;
+
+static const char* const history_path = "test_history.tmp.history";
+
+CTEST_DEFINE_TEST(test_history_record)
+{
+    TestHistory history;
+    CTEST_ASSERT(history.empty());
+    CTEST_ASSERT(history.find("suite::test") == nullptr);
+
+    history.recordDuration("suite::test", 100);
+    CTEST_ASSERT(history.size() == 1);
+    CTEST_ASSERT(history.find("suite::test") != nullptr);
+    CTEST_ASSERT(history.find("suite::test")->duration_us == 100);
+
+    // averaged with previous run
+    history.recordDuration("suite::test", 300);
+    CTEST_ASSERT(history.find("suite::test")->duration_us == 200);
+
+    history.clear();
+    CTEST_ASSERT(history.empty());
+}
+
+CTEST_DEFINE_TEST(test_history_save_load)
+{
+    TestHistory history;
+    history.recordDuration("suite::test", 100);
+    history.recordDuration("suite::other test ( 1, 2 )", 12345678901ULL);
+    CTEST_ASSERT(history.save(history_path));
+
+    TestHistory loaded;
+    CTEST_ASSERT(loaded.load(history_path));
+    CTEST_ASSERT(loaded.size() == 2);
+    CTEST_ASSERT(loaded.find("suite::test")->duration_us == 100);
+    CTEST_ASSERT(loaded.find("suite::other test ( 1, 2 )")->duration_us == 12345678901ULL);
+
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(test_history_load_missing)
+{
+    std::remove(history_path);
+    TestHistory history;
+    CTEST_ASSERT(!history.load(history_path));
+    CTEST_ASSERT(history.empty());
+}
+
+CTEST_DEFINE_TEST(test_history_load_malformed)
+{
+    {
+        std::ofstream file(history_path);
+        file << "# sstest history 1\n";
+        file << "100\t0\t0\t0\tsuite::good\n";
+        file << "not a number\t0\t0\t0\tsuite::bad\n";
+        file << "200\t0\t0\t0\n";
+        file << "\n";
+        file << "300\t0\t0\t0 suite::no_tab\n";
+        file << "400\tsuite::too_few_fields\n";
+    }
+    TestHistory history;
+    CTEST_ASSERT(history.load(history_path));
+    CTEST_ASSERT(history.size() == 1);
+    CTEST_ASSERT(history.find("suite::good")->duration_us == 100);
+
+    // unknown format is ignored entirely
+    {
+        std::ofstream file(history_path);
+        file << "100\tsuite::good\n";
+    }
+    TestHistory other;
+    CTEST_ASSERT(!other.load(history_path));
+    CTEST_ASSERT(other.empty());
+
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(test_history_results)
+{
+    TestHistory history;
+    history.recordDuration("suite::slow", 500);
+    history.recordResult("suite::slow", false);
+    history.recordResult("suite::fast", true);
+    CTEST_ASSERT(history.size() == 2);
+    CTEST_ASSERT(history.numFailed() == 1);
+    CTEST_ASSERT(history.find("suite::slow")->failed);
+    CTEST_ASSERT(history.find("suite::slow")->duration_us == 500);
+    CTEST_ASSERT(!history.find("suite::fast")->failed);
+    CTEST_ASSERT(history.save(history_path));
+
+    TestHistory loaded;
+    CTEST_ASSERT(loaded.load(history_path));
+    CTEST_ASSERT(loaded.size() == 2);
+    CTEST_ASSERT(loaded.numFailed() == 1);
+    CTEST_ASSERT(loaded.find("suite::slow")->failed);
+    CTEST_ASSERT(loaded.find("suite::slow")->duration_us == 500);
+
+    // the latest result replaces the previous one
+    loaded.recordResult("suite::slow", true);
+    CTEST_ASSERT(loaded.numFailed() == 0);
+
+    // a result other than 0 or 1 is malformed
+    {
+        std::ofstream file(history_path);
+        file << "# sstest history 1\n";
+        file << "100\t1\t0\t0\tsuite::good\n";
+        file << "100\t2\t0\t0\tsuite::bad\n";
+    }
+    TestHistory malformed;
+    CTEST_ASSERT(malformed.load(history_path));
+    CTEST_ASSERT(malformed.size() == 1);
+    CTEST_ASSERT(malformed.find("suite::good")->failed);
+
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(test_history_failure_rate)
+{
+    // no runs is a coin flip, and every run moves the estimate towards what happened
+    CTEST_ASSERT(TestHistory::Record().failureRate() == 0.5);
+    TestHistory history;
+    history.recordResult("suite::broken", false);
+    history.recordResult("suite::passing", true);
+    CTEST_ASSERT(history.find("suite::broken")->failureRate() > 0.5);
+    CTEST_ASSERT(history.find("suite::passing")->failureRate() < 0.5);
+    for (int i = 0; i < 100; i++)
+    {
+        history.recordResult("suite::flaky", i % 4 != 0);
+        history.recordResult("suite::passing", true);
+    }
+    // older runs are forgotten, so counts stay small
+    const TestHistory::Record* flaky = history.find("suite::flaky");
+    CTEST_ASSERT(flaky->runs <= 32 && flaky->failures <= flaky->runs);
+    CTEST_ASSERT(flaky->failureRate() > 0.1 && flaky->failureRate() < 0.5);
+    CTEST_ASSERT(history.find("suite::passing")->failureRate() < flaky->failureRate());
+    CTEST_ASSERT(history.find("suite::passing")->failures == 0);
+    CTEST_ASSERT(history.save(history_path));
+
+    TestHistory loaded;
+    CTEST_ASSERT(loaded.load(history_path));
+    CTEST_ASSERT(loaded.find("suite::flaky")->runs == flaky->runs);
+    CTEST_ASSERT(loaded.find("suite::flaky")->failures == flaky->failures);
+    CTEST_ASSERT(loaded.find("suite::broken")->runs == 1);
+    CTEST_ASSERT(loaded.find("suite::broken")->failures == 1);
+
+    // more failures than runs is malformed
+    {
+        std::ofstream file(history_path);
+        file << "# sstest history 1\n";
+        file << "100\t1\t4\t2\tsuite::good\n";
+        file << "100\t1\t2\t4\tsuite::bad\n";
+    }
+    TestHistory malformed;
+    CTEST_ASSERT(malformed.load(history_path));
+    CTEST_ASSERT(malformed.size() == 1);
+    CTEST_ASSERT(malformed.find("suite::good")->failureRate() == 0.5);
+
+    std::remove(history_path);
+}
+
+// runs of the same program save the same history file at once
+CTEST_DEFINE_TEST(test_history_concurrent_save)
+{
+    const std::string tmp_path = TestHistory::temporaryPath(history_path);
+    CTEST_ASSERT(tmp_path.compare(0, std::string(history_path).size(), history_path) == 0);
+    CTEST_ASSERT(TestHistory::temporaryPath(history_path) != tmp_path);
+
+    std::vector<char> saved(4, 1); // not vector<bool>, whose elements share bytes between threads
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < saved.size(); t++)
+    {
+        threads.emplace_back([t, &saved]() -> void
+        {
+            TestHistory history;
+            history.recordDuration("suite::test", t + 1);
+            for (int i = 0; i < 50; i++)
+            {
+                if (!history.save(history_path)) saved[t] = 0;
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    CTEST_ASSERT(saved == std::vector<char>(saved.size(), 1));
+
+    TestHistory loaded;
+    CTEST_ASSERT(loaded.load(history_path));
+    CTEST_ASSERT(loaded.size() == 1);
+    CTEST_ASSERT(loaded.find("suite::test")->duration_us <= saved.size());
+
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(test_history_replace_file)
+{
+    // an existing file is replaced whole
+    {
+        std::ofstream file(history_path);
+        file << "a much longer line than the one that replaces it\n";
+    }
+    CTEST_ASSERT(TestHistory::replaceFile(history_path, [](std::ostream& os) -> void { os << "new\n"; }));
+    {
+        std::ifstream file(history_path);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        CTEST_ASSERT(content == "new\n");
+    }
+
+    // a file that can't be written is not replaced
+    CTEST_ASSERT(!TestHistory::replaceFile("no_such_directory/test_history.tmp.history", [](std::ostream& os) -> void { os << "new\n"; }));
+
+    std::remove(history_path);
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_history_record);
+    CTEST_RUN_TEST(test_history_save_load);
+    CTEST_RUN_TEST(test_history_load_missing);
+    CTEST_RUN_TEST(test_history_load_malformed);
+    CTEST_RUN_TEST(test_history_results);
+    CTEST_RUN_TEST(test_history_failure_rate);
+    CTEST_RUN_TEST(test_history_concurrent_save);
+    CTEST_RUN_TEST(test_history_replace_file);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest/sstest_journal.h"
+
+/**
+ * This class test TestJournal functionality
+ */
+
+using namespace sstest;
+
+static const char* const journal_path = "test_journal.tmp.journal";
+
+static TestRecord makeRecord(const std::string& identifier, TestResult result)
+{
+    TestRecord record;
+    record.suite = "suite";
+    record.identifier = identifier;
+    record.result = result;
+    record.duration_us = 10;
+    record.assertions_total = 2;
+    record.assertions_ran = 2;
+    record.assertions_passed = (result == TestResult::PASS) ? 2 : 1;
+    return record;
+}
+
+static void appendText(const std::string& text)
+{
+    std::ofstream file(journal_path, std::ios::app | std::ios::binary);
+    file << text;
+}
+
+CTEST_DEFINE_TEST(test_journal_append_read)
+{
+    std::remove(journal_path);
+    std::vector<TestRecord> records;
+    CTEST_ASSERT(!TestJournal::read(journal_path, records));
+
+    TestJournal journal;
+    CTEST_ASSERT(!journal.isOpen());
+    journal.open(journal_path, false);
+    CTEST_ASSERT(journal.isOpen());
+    // an empty journal is still a journal
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.empty());
+
+    journal.append(makeRecord("suite::a", TestResult::PASS));
+    journal.append(makeRecord("suite::b", TestResult::FAIL));
+    // records are readable as soon as they are appended, before they are synced
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == 2);
+    journal.close();
+    CTEST_ASSERT(!journal.isOpen());
+
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == 2);
+    CTEST_ASSERT(records[0].identifier == "suite::a" && records[0].result == TestResult::PASS);
+    CTEST_ASSERT(records[1].identifier == "suite::b" && records[1].result == TestResult::FAIL);
+    CTEST_ASSERT(records[1].assertions_passed == 1);
+
+    // the journal is in the format of a results file
+    std::ifstream file(journal_path);
+    CTEST_ASSERT(readTestRecords(file).size() == 2);
+
+    // starting over forgets earlier records
+    journal.open(journal_path, false);
+    journal.close();
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.empty());
+
+    std::remove(journal_path);
+}
+
+CTEST_DEFINE_TEST(test_journal_resume)
+{
+    std::remove(journal_path);
+    TestJournal journal;
+    // resuming without a journal starts one
+    journal.open(journal_path, true);
+    journal.append(makeRecord("suite::a", TestResult::PASS));
+    journal.close();
+
+    // a line cut off when the process died is dropped, and appending continues after the last whole record
+    appendText("PASS\t10\t2\t");
+    std::vector<TestRecord> records;
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == 1);
+    journal.open(journal_path, true);
+    journal.append(makeRecord("suite::b", TestResult::PASS));
+    journal.close();
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == 2);
+    CTEST_ASSERT(records[1].identifier == "suite::b");
+
+    // so is anything after a line that isn't a record
+    appendText(std::string("\0\0\0\0\n", 5));
+    appendText("PASS\t10\t2\t2\t2\t0\tsuite\tsuite::c\n");
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == 2);
+
+    // a file that isn't a journal is started over
+    {
+        std::ofstream file(journal_path, std::ios::trunc);
+        file << "not a journal\n";
+    }
+    CTEST_ASSERT(!TestJournal::read(journal_path, records));
+    journal.open(journal_path, true);
+    journal.close();
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.empty());
+
+    std::remove(journal_path);
+}
+
+CTEST_DEFINE_TEST(test_journal_threads)
+{
+    std::remove(journal_path);
+    const size_t nthreads = 4;
+    const size_t nrecords = TestJournal::sync_batch_size * 2 + 1;
+    {
+        TestJournal journal;
+        journal.open(journal_path, false);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < nthreads; t++)
+        {
+            threads.emplace_back([&journal, t, nrecords]() -> void
+            {
+                for (size_t i = 0; i < nrecords; i++)
+                {
+                    journal.append(makeRecord("suite::" + std::to_string(t) + "_" + std::to_string(i), TestResult::PASS));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    } // closed by the destructor
+
+    // every line is whole
+    std::vector<TestRecord> records;
+    CTEST_ASSERT(TestJournal::read(journal_path, records));
+    CTEST_ASSERT(records.size() == nthreads * nrecords);
+
+    std::remove(journal_path);
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_journal_append_read);
+    CTEST_RUN_TEST(test_journal_resume);
+    CTEST_RUN_TEST(test_journal_threads);
+
+    return EXIT_SUCCESS;
+}
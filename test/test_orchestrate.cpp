@@ -0,0 +1,195 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "sstest/sstest_run.h"
+#include "sstest/sstest_summary.h"
+
+#include <sys/wait.h>
+
+/**
+ * This class test sstest_orchestrate, running the tests of two programs on one pool of workers
+ */
+
+using namespace sstest;
+
+static const char* const results_path = "test_orchestrate.tmp.results";
+static const char* const history_path = "test_orchestrate.tmp.history";
+
+struct OrchestrateOutput
+{
+    int code;
+    std::string output;
+};
+
+static OrchestrateOutput orchestrate(const std::string& args)
+{
+    OrchestrateOutput run;
+    run.code = -1;
+    std::FILE* pipe = ::popen((std::string(TEST_SSTEST_ORCHESTRATE) + " " + args + " 2>&1").c_str(), "r");
+    CTEST_ASSERT(pipe != nullptr);
+    char buf[4096];
+    size_t n = 0;
+    while ((n = std::fread(buf, 1, sizeof(buf), pipe)) > 0)
+    {
+        run.output.append(buf, n);
+    }
+    const int status = ::pclose(pipe);
+    if (status != -1 && WIFEXITED(status)) run.code = WEXITSTATUS(status);
+    return run;
+}
+
+static bool contains(const std::string& str, const std::string& part)
+{
+    return str.find(part) != std::string::npos;
+}
+
+static bool exists(const std::string& path)
+{
+    return std::ifstream(path).good();
+}
+
+static std::vector<TestRecord> readResults()
+{
+    std::ifstream results(results_path);
+    CTEST_ASSERT(results.good());
+    return readTestRecords(results);
+}
+
+CTEST_DEFINE_TEST(orchestrate_merge_test)
+{
+    const std::string programs = std::string(TEST_ORCHESTRATE_PASS) + " " + TEST_ORCHESTRATE_FAIL;
+    OrchestrateOutput run = orchestrate("-j 2 --history-file " + std::string(history_path) + " -o " + results_path + " " + programs);
+    if (run.code != SSTEST_FAILURE) std::printf("%s\n", run.output.c_str());
+    // one failing test fails the whole run
+    CTEST_ASSERT(run.code == SSTEST_FAILURE);
+    // the 8 tests listed by both programs, with no history each test takes an average time, so 2 workers with 4 parts each get 
+    // one test per part
+    CTEST_ASSERT(contains(run.output, "Running 8 tests of 2 programs in 8 parts on 2 workers"));
+    CTEST_ASSERT(contains(run.output, "[ FAILED ] " + std::string(TEST_ORCHESTRATE_FAIL) + ": beta::two"));
+    CTEST_ASSERT(contains(run.output, "tests: 7 passed, 1 failed, 0 not run, of 8"));
+
+    // results of every part are merged, named by their program
+    std::vector<TestRecord> records = readResults();
+    CTEST_ASSERT(records.size() == 8);
+    for (const TestRecord& record : records)
+    {
+        CTEST_ASSERT(record.identifier.compare(0, std::string(TEST_ORCHESTRATE_PASS).size() + 2, std::string(TEST_ORCHESTRATE_PASS) + ": ") == 0 || 
+            record.identifier.compare(0, std::string(TEST_ORCHESTRATE_FAIL).size() + 2, std::string(TEST_ORCHESTRATE_FAIL) + ": ") == 0);
+    }
+    const TestTotals totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_functions_total == 8);
+    CTEST_ASSERT(totals.test_functions_ran == 8);
+    CTEST_ASSERT(totals.test_functions_passed == 7);
+    CTEST_ASSERT(totals.test_suites_total == 2);
+    CTEST_ASSERT(totals.test_suites_passed == 1);
+    CTEST_ASSERT(totals.assertions_total == 8);
+    CTEST_ASSERT(totals.assertions_passed == 7);
+    CTEST_ASSERT(::testing::ExitCode(totals) == SSTEST_FAILURE);
+
+    // durations are kept by the orchestrator, never by the programs, whose parts would overwrite each other's
+    CTEST_ASSERT(exists(history_path));
+    CTEST_ASSERT(!exists(std::string(TEST_ORCHESTRATE_PASS) + ".history"));
+    CTEST_ASSERT(!exists(std::string(TEST_ORCHESTRATE_FAIL) + ".history"));
+
+    std::remove(results_path);
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(orchestrate_partition_test)
+{
+    // 1 worker with 4 parts of about 2 tests each, never mixing programs: 5 tests in 3 parts, and 3 in 2
+    OrchestrateOutput run = orchestrate("-j 1 --history-file= -o " + std::string(results_path) + " " + TEST_ORCHESTRATE_PASS + " " + TEST_ORCHESTRATE_FAIL);
+    CTEST_ASSERT(run.code == SSTEST_FAILURE);
+    CTEST_ASSERT(contains(run.output, "Running 8 tests of 2 programs in 5 parts on 1 workers"));
+    CTEST_ASSERT(readResults().size() == 8);
+
+    // a run of passing programs passes
+    run = orchestrate("-j 2 --history-file= -o " + std::string(results_path) + " " + TEST_ORCHESTRATE_PASS);
+    if (run.code != SSTEST_SUCCESS) std::printf("%s\n", run.output.c_str());
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, "Running 5 tests of 1 programs"));
+    const TestTotals totals = TestSummary(readResults()).getTotals();
+    CTEST_ASSERT(totals.test_functions_total == 5);
+    CTEST_ASSERT(totals.test_functions_passed == 5);
+    std::remove(results_path);
+}
+
+CTEST_DEFINE_TEST(orchestrate_warm_test)
+{
+    // programs kept serving each worker give the same merged results
+    OrchestrateOutput run = orchestrate("-j 2 --warm --history-file= -o " + std::string(results_path) + " " + TEST_ORCHESTRATE_PASS + " " + TEST_ORCHESTRATE_FAIL);
+    if (run.code != SSTEST_FAILURE) std::printf("%s\n", run.output.c_str());
+    CTEST_ASSERT(run.code == SSTEST_FAILURE);
+    const TestTotals totals = TestSummary(readResults()).getTotals();
+    CTEST_ASSERT(totals.test_functions_total == 8);
+    CTEST_ASSERT(totals.test_functions_passed == 7);
+    CTEST_ASSERT(!exists(std::string(TEST_ORCHESTRATE_PASS) + ".history"));
+    std::remove(results_path);
+}
+
+CTEST_DEFINE_TEST(orchestrate_list_failure_test)
+{
+    // a program that can't list its tests stops the run before any test runs
+    OrchestrateOutput run = orchestrate(std::string(TEST_ORCHESTRATE_PASS) + " test_orchestrate.missing");
+    CTEST_ASSERT(run.code == EXIT_FAILURE);
+    CTEST_ASSERT(contains(run.output, "could not list the tests of test_orchestrate.missing"));
+    CTEST_ASSERT(!contains(run.output, "Running"));
+}
+
+CTEST_DEFINE_TEST(orchestrate_bad_option_test)
+{
+    // a malformed worker count or an option missing its value is a usage error, not a program to run
+    const char* const bad_args[] = { "-j abc", "-j -2", "-j +2", "-j 0", "-j 2x", "-j 99999999999999999999999", "-j", "-o", "--history-file" };
+    for (const char* args : bad_args)
+    {
+        OrchestrateOutput run = orchestrate(std::string(TEST_ORCHESTRATE_PASS) + " " + args);
+        CTEST_ASSERT(run.code == EXIT_FAILURE);
+        CTEST_ASSERT(contains(run.output, "usage: sstest_orchestrate"));
+        CTEST_ASSERT(!contains(run.output, "Running"));
+    }
+    CTEST_ASSERT(contains(orchestrate(std::string(TEST_ORCHESTRATE_PASS) + " -j").output, "missing value for option -j"));
+}
+
+int main()
+{
+    CTEST_RUN_TEST(orchestrate_merge_test);
+    CTEST_RUN_TEST(orchestrate_partition_test);
+    CTEST_RUN_TEST(orchestrate_warm_test);
+    CTEST_RUN_TEST(orchestrate_list_failure_test);
+    CTEST_RUN_TEST(orchestrate_bad_option_test);
+
+    std::remove("test.log");
+    return EXIT_SUCCESS;
+}
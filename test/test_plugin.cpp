@@ -0,0 +1,258 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "ctest_macros.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_plugin.h"
+#include "sstest/sstest_registry.h"
+#include "sstest/sstest_run.h"
+#include "sstest/sstest_runner.h"
+
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * This class test TestPlugin functionality, and sstest_host loading plugins again when they are rebuilt
+ */
+
+using namespace sstest;
+
+// where a plugin is built to, and rebuilt to by copying another version over it
+static const char* const plugin_path = "test_plugin.tmp.so";
+static const char* const host_log_path = "test_plugin.tmp.log";
+
+// replace the plugin as a build would, with a new file moved over it
+static void build(const char* library)
+{
+    const std::string building = std::string(plugin_path) + ".new";
+    {
+        std::ifstream in(library, std::ios::binary);
+        std::ofstream out(building, std::ios::binary | std::ios::trunc);
+        out << in.rdbuf();
+    }
+    CTEST_ASSERT(std::rename(building.c_str(), plugin_path) == 0);
+}
+
+static size_t countTests(TestRegistry& registry)
+{
+    size_t count = 0;
+    for (TestSuite* suite : registry.getTestCases())
+    {
+        count += suite->size();
+    }
+    return count;
+}
+
+static bool contains(const std::string& str, const std::string& part)
+{
+    return str.find(part) != std::string::npos;
+}
+
+CTEST_DEFINE_TEST(plugin_load_test)
+{
+    TestRegistry* const program_tests = &TestRunner::getInstance().registry();
+    build(TEST_PLUGIN_V1);
+    TestPlugin plugin(plugin_path);
+    CTEST_ASSERT(plugin.path() == plugin_path);
+    CTEST_ASSERT(countTests(plugin.registry()) == 1);
+    CTEST_ASSERT(plugin.registry().getTestCase("plugin")->size() == 1);
+    CTEST_ASSERT(!plugin.changed());
+
+    // its tests are kept apart from those of the program
+    CTEST_ASSERT(&TestRunner::getInstance().registry() == program_tests);
+    CTEST_ASSERT(countTests(*program_tests) == 0);
+}
+
+CTEST_DEFINE_TEST(plugin_run_test)
+{
+    build(TEST_PLUGIN_V2);
+    TestPlugin plugin(plugin_path);
+    TestRegistry* const program_tests = &TestRunner::getInstance().registry();
+    {
+        char program[] = "test_plugin";
+        char history[] = "--history-file=";
+        char* argv[] = { program, history, nullptr };
+        ::testing::Configure(2, argv);
+        TestRunner::ScopedRegistry scope(&plugin.registry());
+        CTEST_ASSERT(&TestRunner::getInstance().registry() == &plugin.registry());
+        const TestTotals totals = TestRunner::getInstance().runAllTests().getTotals();
+        CTEST_ASSERT(totals.test_functions_total == 2);
+        CTEST_ASSERT(totals.test_functions_passed == 2);
+        CTEST_ASSERT(::testing::ExitCode(totals) == SSTEST_SUCCESS);
+    }
+    CTEST_ASSERT(&TestRunner::getInstance().registry() == program_tests);
+}
+
+CTEST_DEFINE_TEST(plugin_reload_test)
+{
+    build(TEST_PLUGIN_V1);
+    TestPlugin old_plugin(plugin_path);
+    CTEST_ASSERT(!old_plugin.changed());
+
+    build(TEST_PLUGIN_V2);
+    CTEST_ASSERT(old_plugin.changed());
+    TestPlugin new_plugin(plugin_path);
+    CTEST_ASSERT(!new_plugin.changed());
+    CTEST_ASSERT(countTests(new_plugin.registry()) == 2);
+    // the old version stays loaded, with its own tests, until it is destroyed
+    CTEST_ASSERT(countTests(old_plugin.registry()) == 1);
+
+    // a library missing, e.g. while it is being rebuilt, has not changed
+    std::remove(plugin_path);
+    CTEST_ASSERT(!new_plugin.changed());
+}
+
+CTEST_DEFINE_TEST(plugin_load_failure_test)
+{
+    TestRegistry* const program_tests = &TestRunner::getInstance().registry();
+    bool thrown = false;
+    try
+    {
+        TestPlugin plugin(TEST_PLUGIN_UNRESOLVED);
+    }
+    catch (const Exception& e)
+    {
+        thrown = contains(e.what(), "could not load test plugin");
+    }
+    CTEST_ASSERT(thrown);
+    CTEST_ASSERT(&TestRunner::getInstance().registry() == program_tests);
+
+    thrown = false;
+    try
+    {
+        TestPlugin plugin("test_plugin.missing.so");
+    }
+    catch (const Exception& e)
+    {
+        thrown = contains(e.what(), "could not find test plugin");
+    }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(plugin_duplicate_test)
+{
+    // the second of two tests with the same name fails to register while the library is loaded, after the first one did
+    TestRegistry* const program_tests = &TestRunner::getInstance().registry();
+    bool thrown = false;
+    try
+    {
+        TestPlugin plugin(TEST_PLUGIN_DUPLICATE);
+    }
+    catch (const Exception& e)
+    {
+        thrown = contains(e.what(), "could not register the tests of plugin") && contains(e.what(), "already exists");
+    }
+    CTEST_ASSERT(thrown);
+    CTEST_ASSERT(&TestRunner::getInstance().registry() == program_tests);
+    CTEST_ASSERT(countTests(*program_tests) == 0);
+
+    // and the next library registers its tests where they belong
+    build(TEST_PLUGIN_V1);
+    TestPlugin plugin(plugin_path);
+    CTEST_ASSERT(countTests(plugin.registry()) == 1);
+    CTEST_ASSERT(countTests(*program_tests) == 0);
+}
+
+#if defined(TEST_SSTEST_HOST)
+
+static std::string readHostLog()
+{
+    std::ifstream log(host_log_path);
+    std::stringstream contents;
+    contents << log.rdbuf();
+    return contents.str();
+}
+
+// wait up to 10 s for the host to write something to its output
+static bool waitForHostLog(const std::string& part)
+{
+    for (int i = 0; i < 200; i++)
+    {
+        if (contains(readHostLog(), part)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+CTEST_DEFINE_TEST(plugin_host_watch_test)
+{
+    build(TEST_PLUGIN_V1);
+    const pid_t host = ::fork();
+    CTEST_ASSERT(host >= 0);
+    if (host == 0)
+    {
+        const int log = ::open(host_log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ::dup2(log, STDOUT_FILENO);
+        ::dup2(log, STDERR_FILENO);
+        ::execl(TEST_SSTEST_HOST, TEST_SSTEST_HOST, "--watch", plugin_path, "--", "--history-file=", static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+
+    const bool watching = waitForHostLog("Watching 1 plugins for changes");
+    bool reloaded = false;
+    if (watching)
+    {
+        build(TEST_PLUGIN_V2);
+        reloaded = waitForHostLog(std::string("Reloaded ") + plugin_path) && waitForHostLog("plugin::reloaded");
+    }
+    ::kill(host, SIGTERM);
+    int status = 0;
+    ::waitpid(host, &status, 0);
+    if (!reloaded) std::printf("%s\n", readHostLog().c_str());
+    std::remove(host_log_path);
+    CTEST_ASSERT(watching);
+    CTEST_ASSERT(reloaded);
+}
+
+#endif // defined(TEST_SSTEST_HOST)
+
+int main()
+{
+    CTEST_RUN_TEST(plugin_load_test);
+    CTEST_RUN_TEST(plugin_run_test);
+    CTEST_RUN_TEST(plugin_reload_test);
+    CTEST_RUN_TEST(plugin_load_failure_test);
+    CTEST_RUN_TEST(plugin_duplicate_test);
+#if defined(TEST_SSTEST_HOST)
+    CTEST_RUN_TEST(plugin_host_watch_test);
+#endif
+
+    std::remove(plugin_path);
+    std::remove("test.log");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,405 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include "sstest/sstest_pool.h"
+#include "sstest/sstest_affinity.h"
+#include "sstest/sstest_exception.h"
+
+#if defined(__linux__)
+#include <sys/stat.h>
+#endif
+
+/**
+ * This class test WorkStealingPool functionality
+ */
+
+using namespace sstest;
+
+CTEST_DEFINE_TEST(test_pool_construct)
+{
+    WorkStealingPool pool(4);
+    CTEST_ASSERT(pool.size() == 4);
+
+    WorkStealingPool hw_pool(0);
+    CTEST_ASSERT(hw_pool.size() == WorkStealingPool::hardwareConcurrency());
+    CTEST_ASSERT(hw_pool.size() >= 1);
+}
+
+CTEST_DEFINE_TEST(test_pool_run_empty)
+{
+    WorkStealingPool pool(4);
+    pool.run();
+}
+
+CTEST_DEFINE_TEST(test_pool_run_each_once)
+{
+    const size_t ntasks = 1000;
+    std::vector<std::atomic<int>> counts(ntasks);
+    for (std::atomic<int>& count : counts) count = 0;
+
+    WorkStealingPool pool(4);
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        // all on one queue so the other workers have to steal
+        pool.submit(0, [&counts, i](size_t worker) -> void
+        {
+            CTEST_ASSERT(worker < 4);
+            counts[i]++;
+        });
+    }
+    pool.run();
+
+    for (const std::atomic<int>& count : counts)
+    {
+        CTEST_ASSERT(count == 1);
+    }
+}
+
+CTEST_DEFINE_TEST(test_pool_submit_while_running)
+{
+    std::atomic<size_t> count(0);
+    WorkStealingPool pool(3);
+    std::function<void(size_t)> spawn;
+    spawn = [&](size_t worker) -> void
+    {
+        if (++count < 100) pool.submit(worker + 1, spawn);
+    };
+    pool.submit(0, spawn);
+    pool.run();
+    CTEST_ASSERT(count == 100);
+}
+
+CTEST_DEFINE_TEST(test_pool_no_stealing)
+{
+    const size_t ntasks = 200;
+    std::vector<size_t> ran_on(ntasks, 4);
+
+    WorkStealingPool pool(4, false);
+    std::function<void(size_t)> spawn;
+    std::atomic<size_t> spawned(0);
+    spawn = [&](size_t worker) -> void
+    {
+        CTEST_ASSERT(worker == 3);
+        if (++spawned < 50) pool.submit(3, spawn);
+    };
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        // each task only runs on the worker it was given to, even while others are idle
+        pool.submit(i % 2, [&ran_on, i](size_t worker) -> void
+        {
+            ran_on[i] = worker;
+        });
+    }
+    pool.submit(3, spawn);
+    pool.run();
+
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        CTEST_ASSERT(ran_on[i] == i % 2);
+    }
+    CTEST_ASSERT(spawned == 50);
+}
+
+CTEST_DEFINE_TEST(test_pool_rethrow)
+{
+    std::atomic<size_t> count(0);
+    WorkStealingPool pool(2);
+    for (size_t i = 0; i < 10; i++)
+    {
+        pool.submit(i, [&](size_t) -> void
+        {
+            count++;
+            throw std::runtime_error("task");
+        });
+    }
+    bool caught = false;
+    try
+    {
+        pool.run();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    CTEST_ASSERT(caught);
+    CTEST_ASSERT(count == 10);
+}
+
+CTEST_DEFINE_TEST(test_pool_adapt_blocking)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    // tasks that block leave the one CPU idle, so more workers take tasks
+    std::atomic<size_t> running(0);
+    std::atomic<size_t> most_running(0);
+    WorkStealingPool pool(8);
+    pool.adaptWorkers(1);
+    for (size_t i = 0; i < 40; i++)
+    {
+        pool.submit(0, [&](size_t) -> void
+        {
+            const size_t now = ++running;
+            size_t most = most_running;
+            while (now > most && !most_running.compare_exchange_weak(most, now)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            running--;
+        });
+    }
+    pool.run();
+    CTEST_ASSERT(most_running > 1);
+    CTEST_ASSERT(pool.peakWorkers() > 1);
+    CTEST_ASSERT(pool.peakWorkers() <= pool.size());
+#endif
+}
+
+#if defined(__linux__)
+namespace
+{
+    // make the directories of a path under root and write the file
+    void writeUnder(const std::string& root, const std::string& path, const std::string& content)
+    {
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+        {
+            mkdir((root + path.substr(0, slash)).c_str(), 0755);
+        }
+        std::ofstream(root + path) << content;
+    }
+}
+#endif
+
+CTEST_DEFINE_TEST(test_pool_cgroup_limit)
+{
+#if defined(__linux__)
+    // cgroup v2, where a parent has the smaller quota of 1.5 CPUs
+    const std::string v2 = "test_pool_v2.tmp";
+    mkdir(v2.c_str(), 0755);
+    writeUnder(v2, "/proc/self/cgroup", "0::/service/tests\n");
+    writeUnder(v2, "/sys/fs/cgroup/service/tests/cpu.max", "max 100000\n");
+    writeUnder(v2, "/sys/fs/cgroup/service/cpu.max", "150000 100000\n");
+    CTEST_ASSERT(WorkStealingPool::cgroupCpuLimit(v2) == 2);
+
+    // cgroup v1 in a container, which sees its own cgroup at the root of the mount
+    const std::string v1 = "test_pool_v1.tmp";
+    mkdir(v1.c_str(), 0755);
+    writeUnder(v1, "/proc/self/cgroup", "4:memory:/docker/abc\n3:cpu,cpuacct:/docker/abc\n0::/\n");
+    writeUnder(v1, "/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "300000\n");
+    writeUnder(v1, "/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us", "100000\n");
+    CTEST_ASSERT(WorkStealingPool::cgroupCpuLimit(v1) == 3);
+
+    // no quota, or no cgroups at all
+    writeUnder(v1, "/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "-1\n");
+    CTEST_ASSERT(WorkStealingPool::cgroupCpuLimit(v1) == 0);
+    CTEST_ASSERT(WorkStealingPool::cgroupCpuLimit("test_pool_missing.tmp") == 0);
+    CTEST_ASSERT(WorkStealingPool::hardwareConcurrency() >= 1);
+
+    const char* files[] = { "test_pool_v2.tmp/proc/self/cgroup", "test_pool_v2.tmp/proc/self", "test_pool_v2.tmp/proc", 
+        "test_pool_v2.tmp/sys/fs/cgroup/service/tests/cpu.max", "test_pool_v2.tmp/sys/fs/cgroup/service/tests", 
+        "test_pool_v2.tmp/sys/fs/cgroup/service/cpu.max", "test_pool_v2.tmp/sys/fs/cgroup/service", "test_pool_v2.tmp/sys/fs/cgroup", 
+        "test_pool_v2.tmp/sys/fs", "test_pool_v2.tmp/sys", "test_pool_v2.tmp",
+        "test_pool_v1.tmp/proc/self/cgroup", "test_pool_v1.tmp/proc/self", "test_pool_v1.tmp/proc", 
+        "test_pool_v1.tmp/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "test_pool_v1.tmp/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us", 
+        "test_pool_v1.tmp/sys/fs/cgroup/cpu,cpuacct", "test_pool_v1.tmp/sys/fs/cgroup", "test_pool_v1.tmp/sys/fs", "test_pool_v1.tmp/sys", 
+        "test_pool_v1.tmp" };
+    for (const char* file : files)
+    {
+        std::remove(file);
+    }
+#endif
+}
+
+CTEST_DEFINE_TEST(test_pool_worker_exit)
+{
+    // each worker runs the exit function once, after the last task, on its own thread
+    WorkStealingPool pool(3);
+    std::atomic<size_t> ntasks(0);
+    std::vector<size_t> exits(3, 0);
+    std::vector<size_t> tasks_at_exit(3, 0);
+    for (size_t i = 0; i < 30; i++)
+    {
+        pool.submit(i, [&ntasks](size_t) -> void { ntasks++; });
+    }
+    pool.setWorkerExit([&](size_t worker) -> void
+    {
+        exits[worker]++;
+        tasks_at_exit[worker] = ntasks;
+    });
+    pool.run();
+    for (size_t worker = 0; worker < 3; worker++)
+    {
+        CTEST_ASSERT(exits[worker] == 1);
+        CTEST_ASSERT(tasks_at_exit[worker] == 30);
+    }
+}
+
+CTEST_DEFINE_TEST(test_pool_cpu_list)
+{
+    CTEST_ASSERT(CpuTopology::parseList("0-3,8\n") == CpuSet({ 0, 1, 2, 3, 8 }));
+    CTEST_ASSERT(CpuTopology::parseList("5,1-2,2") == CpuSet({ 1, 2, 5 }));
+    CTEST_ASSERT(CpuTopology::parseList("\n").empty());
+    CTEST_ASSERT(CpuTopology::formatList({ 0, 1, 2, 3, 8, 10, 11 }) == "0-3,8,10-11");
+    CTEST_ASSERT(CpuTopology::formatList({}).empty());
+
+    const char* malformed[] = { "3-1", "a", "1,,2", "1-", ",", "1-2-3", "-1", "99999999" };
+    for (const char* list : malformed)
+    {
+        bool thrown = false;
+        try
+        {
+            CpuTopology::parseList(list);
+        }
+        catch (const InvalidArgument&)
+        {
+            thrown = true;
+        }
+        CTEST_ASSERT(thrown);
+    }
+}
+
+CTEST_DEFINE_TEST(test_pool_cpu_topology)
+{
+#if defined(__linux__)
+    // two sockets of two cores, each with two hardware threads numbered like Linux does, second threads after all first ones
+    const std::string root = "test_pool_numa.tmp";
+    mkdir(root.c_str(), 0755);
+    writeUnder(root, "/sys/devices/system/node/online", "0-1\n");
+    writeUnder(root, "/sys/devices/system/node/node0/cpulist", "0-1,4-5\n");
+    writeUnder(root, "/sys/devices/system/node/node1/cpulist", "2-3,6-7\n");
+    const char* siblings[] = { "0,4", "1,5", "2,6", "3,7", "0,4", "1,5", "2,6", "3,7" };
+    for (size_t cpu = 0; cpu < 8; cpu++)
+    {
+        writeUnder(root, "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list", std::string(siblings[cpu]) + "\n");
+    }
+
+    CpuTopology topology(root);
+    CTEST_ASSERT(topology.nodes().size() == 2);
+    CTEST_ASSERT(topology.nodes()[1].id == 1);
+    CTEST_ASSERT(topology.cpus() == CpuSet({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+    CTEST_ASSERT(topology.nodeOf(6) == 1);
+
+    // alternating sockets, a core each before any second hardware thread, then wrapping around
+    const std::vector<CpuSet> per_cpu = topology.placement(10, false);
+    const size_t expected[] = { 0, 2, 1, 3, 4, 6, 5, 7, 0, 2 };
+    CTEST_ASSERT(per_cpu.size() == 10);
+    for (size_t i = 0; i < per_cpu.size(); i++)
+    {
+        CTEST_ASSERT(per_cpu[i] == CpuSet({ expected[i] }));
+    }
+    const std::vector<CpuSet> per_node = topology.placement(3, true);
+    CTEST_ASSERT(per_node.size() == 3);
+    CTEST_ASSERT(per_node[0] == CpuSet({ 0, 1, 4, 5 }));
+    CTEST_ASSERT(per_node[1] == CpuSet({ 2, 3, 6, 7 }));
+    CTEST_ASSERT(per_node[2] == per_node[0]);
+
+    // reserving the first core of each socket, then keeping only the first socket
+    topology.exclude({ 0, 2 });
+    CTEST_ASSERT(topology.placement(3, false) == std::vector<CpuSet>({ { 1 }, { 3 }, { 4 } }));
+    topology.restrict({ 0, 1, 4, 5 });
+    CTEST_ASSERT(topology.nodes().size() == 1);
+    CTEST_ASSERT(topology.cpus() == CpuSet({ 1, 4, 5 }));
+    topology.exclude({ 1, 4, 5 });
+    CTEST_ASSERT(topology.nodes().empty());
+    CTEST_ASSERT(topology.placement(2, false).empty());
+
+    // without sysfs every CPU is on node 0
+    CpuTopology flat("test_pool_missing.tmp");
+    CTEST_ASSERT(flat.nodes().size() == 1);
+    CTEST_ASSERT(flat.nodes()[0].id == 0);
+    CTEST_ASSERT(!flat.cpus().empty());
+
+    std::vector<std::string> files;
+    for (size_t cpu = 0; cpu < 8; cpu++)
+    {
+        const std::string dir = root + "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        files.push_back(dir + "/topology/thread_siblings_list");
+        files.push_back(dir + "/topology");
+        files.push_back(dir);
+    }
+    const char* others[] = { "/sys/devices/system/cpu", "/sys/devices/system/node/online", "/sys/devices/system/node/node0/cpulist", 
+        "/sys/devices/system/node/node0", "/sys/devices/system/node/node1/cpulist", "/sys/devices/system/node/node1", 
+        "/sys/devices/system/node", "/sys/devices/system", "/sys/devices", "/sys", "" };
+    for (const char* other : others)
+    {
+        files.push_back(root + other);
+    }
+    for (const std::string& file : files)
+    {
+        std::remove(file.c_str());
+    }
+#endif
+}
+
+CTEST_DEFINE_TEST(test_pool_pin_workers)
+{
+    const CpuSet cpus = CpuTopology::affinity();
+    if (!CpuTopology::supported() || cpus.empty()) return;
+
+    // worker 0 gets one CPU, worker 1 all of them, and worker 2 wraps around to the placement of worker 0
+    WorkStealingPool pool(3, false);
+    pool.pinWorkers({ { cpus.front() }, cpus });
+    std::vector<CpuSet> seen(3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        pool.submit(i, [&seen](size_t worker) -> void
+        {
+            seen[worker] = CpuTopology::affinity();
+        });
+    }
+    pool.run();
+    CTEST_ASSERT(seen[0] == CpuSet({ cpus.front() }));
+    CTEST_ASSERT(seen[1] == cpus);
+    CTEST_ASSERT(seen[2] == seen[0]);
+    CTEST_ASSERT(CpuTopology::affinity() == cpus);
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_pool_construct);
+    CTEST_RUN_TEST(test_pool_run_empty);
+    CTEST_RUN_TEST(test_pool_run_each_once);
+    CTEST_RUN_TEST(test_pool_submit_while_running);
+    CTEST_RUN_TEST(test_pool_no_stealing);
+    CTEST_RUN_TEST(test_pool_rethrow);
+    CTEST_RUN_TEST(test_pool_adapt_blocking);
+    CTEST_RUN_TEST(test_pool_cgroup_limit);
+    CTEST_RUN_TEST(test_pool_worker_exit);
+    CTEST_RUN_TEST(test_pool_cpu_list);
+    CTEST_RUN_TEST(test_pool_cpu_topology);
+    CTEST_RUN_TEST(test_pool_pin_workers);
+
+    return CTEST_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sstest/sstest_process.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#   include <signal.h>
+#   include <sys/wait.h>
+#endif
+
+/**
+ * This class test ProcessPool functionality
+ */
+
+using namespace sstest;
+
+CTEST_DEFINE_TEST(test_process_pool_finish)
+{
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    const size_t ntasks = 50;
+    std::vector<std::string> messages(ntasks);
+    size_t crashes = 0;
+
+    ProcessPool pool(4);
+    pool.run(ntasks,
+        [](size_t task) -> std::string { return std::to_string(task * task); },
+        [&](size_t task, const std::string& msg) -> void { messages[task] = msg; },
+        [&](size_t, int) -> void { crashes++; }
+    );
+
+    CTEST_ASSERT(crashes == 0);
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        CTEST_ASSERT(messages[i] == std::to_string(i * i));
+    }
+}
+
+CTEST_DEFINE_TEST(test_process_pool_crash)
+{
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    const size_t ntasks = 20;
+    std::vector<int> finished(ntasks, 0);
+    std::vector<std::string> crashed(ntasks);
+
+    // fewer workers than crashes, so workers must be replaced
+    ProcessPool pool(2);
+    pool.run(ntasks,
+        [](size_t task) -> std::string 
+        { 
+            if (task % 4 == 0) std::abort();
+            return ""; 
+        },
+        [&](size_t task, const std::string&) -> void { finished[task]++; },
+        [&](size_t task, int status) -> void { crashed[task] = ProcessPool::describeStatus(status); }
+    );
+
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        if (i % 4 == 0)
+        {
+            CTEST_ASSERT(finished[i] == 0);
+            CTEST_ASSERT(!crashed[i].empty());
+        }
+        else
+        {
+            CTEST_ASSERT(finished[i] == 1);
+            CTEST_ASSERT(crashed[i].empty());
+        }
+    }
+}
+
+CTEST_DEFINE_TEST(test_process_pool_exit_code)
+{
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    int exit_status = 0;
+    ProcessPool pool(1);
+    pool.run(1,
+        [](size_t) -> std::string { std::_Exit(42); },
+        [&](size_t, const std::string&) -> void {},
+        [&](size_t, int status) -> void { exit_status = status; }
+    );
+    CTEST_ASSERT(ProcessPool::exitedWith(exit_status, 42));
+    CTEST_ASSERT(!ProcessPool::exitedWith(exit_status, 0));
+    CTEST_ASSERT(ProcessPool::describeStatus(exit_status) == "exited with code 42");
+}
+
+CTEST_DEFINE_TEST(test_process_pool_stop)
+{
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    const size_t ntasks = 20;
+    size_t finished = 0;
+    size_t crashes = 0;
+
+    // one worker, so stopping after the first crash leaves the rest not started
+    ProcessPool pool(1);
+    pool.run(ntasks,
+        [](size_t task) -> std::string 
+        { 
+            if (task == 3) std::abort();
+            return ""; 
+        },
+        [&](size_t, const std::string&) -> void { finished++; },
+        [&](size_t, int) -> void { crashes++; pool.stop(); }
+    );
+    CTEST_ASSERT(finished == 3);
+    CTEST_ASSERT(crashes == 1);
+}
+
+CTEST_DEFINE_TEST(test_process_pool_throw)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    // a callback that throws ends the run, with SIGPIPE handled as before and every worker gone
+    ProcessPool pool(4);
+    bool thrown = false;
+    try
+    {
+        pool.run(20,
+            [](size_t task) -> std::string { return std::to_string(task); },
+            [&](size_t, const std::string&) -> void { throw std::runtime_error("finish failed"); },
+            [&](size_t, int) -> void {}
+        );
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CTEST_ASSERT(thrown);
+    struct sigaction pipe_action;
+    CTEST_ASSERT(::sigaction(SIGPIPE, nullptr, &pipe_action) == 0);
+    CTEST_ASSERT(pipe_action.sa_handler == SIG_DFL);
+    CTEST_ASSERT(::waitpid(-1, nullptr, WNOHANG) < 0 && errno == ECHILD);
+
+    // and the pool can run again
+    size_t finished = 0;
+    pool.run(8,
+        [](size_t) -> std::string { return ""; },
+        [&](size_t, const std::string&) -> void { finished++; },
+        [&](size_t, int) -> void {}
+    );
+    CTEST_ASSERT(finished == 8);
+#endif
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_process_pool_finish);
+    CTEST_RUN_TEST(test_process_pool_crash);
+    CTEST_RUN_TEST(test_process_pool_exit_code);
+    CTEST_RUN_TEST(test_process_pool_stop);
+    CTEST_RUN_TEST(test_process_pool_throw);
+
+    return CTEST_SUCCESS;
+}
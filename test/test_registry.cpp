@@ -28,15 +28,154 @@
 
 #include "ctest_macros.h" 
 
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 #include "sstest/sstest_registry.h"
+#include "sstest/sstest_registrar.h"
+#include "sstest/sstest_runner.h"
+#include "sstest/sstest_plugin.h"
+#include "sstest/sstest_exception.h"
 
 /**
  * This class test SSTestRegistrar / SSTestRegistry functions
  */
 
-// TODO
+using namespace sstest;
+
+typedef std::vector<std::pair<std::string, std::string>> Dependencies;
+
+CTEST_DEFINE_TEST(test_registry_dependency)
+{
+    TestRegistry registry;
+    CTEST_ASSERT(registry.getDependencies().empty());
+
+    registry.addDependency("suite::b", "suite::a");
+    registry.addDependency("other", "suite");
+    CTEST_ASSERT(registry.getDependencies() == Dependencies({ { "suite::b", "suite::a" }, { "other", "suite" } }));
+
+    bool thrown = false;
+    try { registry.addDependency("", "suite"); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+
+    registry.clear();
+    CTEST_ASSERT(registry.getDependencies().empty());
+}
+
+CTEST_DEFINE_TEST(test_registrar_dependency)
+{
+    // as given by stringizing the arguments of TEST_DEPENDS_ON
+    DependencyRegistrar registrar("suite :: c", "suite::a, suite ::b,other");
+    const Dependencies& dependencies = TestRunner::getInstance().registry().getDependencies();
+    CTEST_ASSERT(dependencies == Dependencies({ { "suite::c", "suite::a" }, { "suite::c", "suite::b" }, { "suite::c", "other" } }));
+}
+
+CTEST_DEFINE_TEST(test_registry_resources)
+{
+    TestRegistry registry;
+    CTEST_ASSERT(registry.getResourceTags().empty());
+    CTEST_ASSERT(registry.getResourceLimit("port") == 1);
+
+    registry.addResourceTag("suite::a", "port");
+    registry.addResourceTag("suite", "exclusive");
+    CTEST_ASSERT(registry.getResourceTags() == Dependencies({ { "suite::a", "port" }, { "suite", "exclusive" } }));
+
+    registry.setResourceLimit("port", 3);
+    CTEST_ASSERT(registry.getResourceLimit("port") == 3);
+    registry.setResourceLimits(" mem-heavy: 2, port=1,");
+    CTEST_ASSERT(registry.getResourceLimit("mem-heavy") == 2);
+    CTEST_ASSERT(registry.getResourceLimit("port") == 1);
+
+    for (const char* limits : { "mem-heavy", "mem-heavy:", "mem-heavy:0", "mem-heavy:-1", ":2", "exclusive:2" })
+    {
+        bool thrown = false;
+        try { registry.setResourceLimits(limits); }
+        catch (const std::invalid_argument&) { thrown = true; }
+        CTEST_ASSERT(thrown);
+    }
+
+    registry.clear();
+    CTEST_ASSERT(registry.getResourceTags().empty());
+    CTEST_ASSERT(registry.getResourceLimit("mem-heavy") == 1);
+}
+
+CTEST_DEFINE_TEST(test_registrar_resources)
+{
+    // as given by stringizing the arguments of TEST_RESOURCES and TEST_RESOURCE_LIMITS
+    ResourceRegistrar registrar("suite :: c", "port-8080, mem-heavy");
+    ResourceRegistrar limits("mem-heavy: 2");
+    const TestRegistry& registry = TestRunner::getInstance().registry();
+    CTEST_ASSERT(registry.getResourceTags() == Dependencies({ { "suite::c", "port-8080" }, { "suite::c", "mem-heavy" } }));
+    CTEST_ASSERT(registry.getResourceLimit("mem-heavy") == 2);
+}
+
+CTEST_DEFINE_TEST(test_registrar_inputs)
+{
+    // as given by stringizing the arguments of TEST_INPUTS
+    InputRegistrar registrar("suite :: d", "\"data/a b.txt\" , \"data/c.json\",plain.txt");
+    const TestRegistry& registry = TestRunner::getInstance().registry();
+    CTEST_ASSERT(registry.getTestInputs() == Dependencies({ { "suite::d", "data/a b.txt" }, { "suite::d", "data/c.json" }, { "suite::d", "plain.txt" } }));
+
+    bool threw = false;
+    try { InputRegistrar empty("suite::d", "\"\""); }
+    catch (const InvalidArgument&) { threw = true; }
+    CTEST_ASSERT(threw);
+}
+
+CTEST_DEFINE_TEST(test_registrar_swapped_registry)
+{
+    // e.g. while a test plugin is loaded, its tests register in a registry of their own
+    TestRegistry plugin_registry;
+    TestRunner& runner = TestRunner::getInstance();
+    TestRegistry* program_registry = runner.swapRegistry(&plugin_registry);
+    CTEST_ASSERT(&runner.registry() == &plugin_registry);
+    DependencyRegistrar registrar("plugin::b", "plugin::a");
+    CTEST_ASSERT(runner.swapRegistry(program_registry) == &plugin_registry);
+
+    CTEST_ASSERT(&runner.registry() == program_registry);
+    CTEST_ASSERT(plugin_registry.getDependencies() == Dependencies({ { "plugin::b", "plugin::a" } }));
+    for (const std::pair<std::string, std::string>& dependency : program_registry->getDependencies())
+    {
+        CTEST_ASSERT(dependency.first != "plugin::b");
+    }
+}
+
+CTEST_DEFINE_TEST(test_plugin_load_error)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    bool threw = false;
+    try { TestPlugin missing("no_such_plugin.so"); }
+    catch (const Exception&) { threw = true; }
+    CTEST_ASSERT(threw);
+
+    // not a shared library, the registry of the program is left in place
+    TestRegistry* program_registry = &TestRunner::getInstance().registry();
+    {
+        std::ofstream file("test_registry.tmp.so");
+        file << "not a library";
+    }
+    threw = false;
+    try { TestPlugin invalid("test_registry.tmp.so"); }
+    catch (const Exception&) { threw = true; }
+    CTEST_ASSERT(threw);
+    CTEST_ASSERT(&TestRunner::getInstance().registry() == program_registry);
+    std::remove("test_registry.tmp.so");
+#endif
+}
 
 int main()
 {
+    CTEST_RUN_TEST(test_registry_dependency);
+    CTEST_RUN_TEST(test_registrar_dependency);
+    CTEST_RUN_TEST(test_registry_resources);
+    CTEST_RUN_TEST(test_registrar_resources);
+    CTEST_RUN_TEST(test_registrar_inputs);
+    CTEST_RUN_TEST(test_registrar_swapped_registry);
+    CTEST_RUN_TEST(test_plugin_load_error);
+
     return CTEST_SUCCESS;
 }
\ No newline at end of file
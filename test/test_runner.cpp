@@ -0,0 +1,359 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest/sstest_affinity.h"
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_include.h"
+#include "sstest/sstest_process.h"
+#include "sstest/sstest_run.h"
+#include "sstest/sstest_runner.h"
+
+/**
+ * This class test options of the test runner, by running the tests defined here as a test program would and checking its output 
+ * and exit code
+ */
+
+using namespace sstest;
+
+namespace
+{
+    struct RunOutput
+    {
+        int code;
+        std::string output;
+        std::string errors;
+    };
+
+    // run the tests of this program with the given options, each run configured from the defaults
+    RunOutput runTests(std::vector<std::string> args)
+    {
+        args.insert(args.begin(), "test_runner");
+        std::vector<char*> argv;
+        for (std::string& arg : args)
+        {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+
+        TestRunner::getInstance().configure(&TestRunner::Configuration::default_settings);
+        std::ostringstream output;
+        std::ostringstream errors;
+        std::streambuf* const old_buf = std::cout.rdbuf(output.rdbuf());
+        std::streambuf* const old_err_buf = std::cerr.rdbuf(errors.rdbuf());
+        RunOutput run;
+        try
+        {
+            run.code = testing::RunTests(static_cast<int>(args.size()), argv.data());
+        }
+        catch (...)
+        {
+            std::cout.rdbuf(old_buf);
+            std::cerr.rdbuf(old_err_buf);
+            throw;
+        }
+        std::cout.rdbuf(old_buf);
+        std::cerr.rdbuf(old_err_buf);
+        run.output = output.str();
+        run.errors = errors.str();
+        return run;
+    }
+
+    bool contains(const std::string& output, const std::string& text)
+    {
+        return output.find(text) != std::string::npos;
+    }
+
+    std::atomic<int> flaky_runs(0);
+    std::atomic<int> resume_runs(0);
+    std::atomic<int> option_runs(0);
+    std::atomic<size_t> most_pinned_cpus(0);
+
+    const char* const journal_path = "test_runner.tmp.journal";
+    const char* const history_path = "test_runner.tmp.history";
+    const char* const results_path = "test_runner.tmp.results";
+}
+
+TEST(Retries, flaky)
+{
+    EXPECT_TRUE(++flaky_runs % 2 == 0);
+}
+
+TEST(Retries, broken)
+{
+    EXPECT_TRUE(false);
+}
+
+CTEST_DEFINE_TEST(runner_retries_test)
+{
+    // a test that passes on a retry is FLAKY, which passes the run
+    RunOutput run = runTests({ "--history-file=", "--filter", "Retries::flaky", "--retries", "2" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, "FLAKY"));
+    CTEST_ASSERT(flaky_runs == 2);
+
+    // one that fails every attempt fails the run
+    flaky_runs = 0;
+    run = runTests({ "--history-file=", "--filter", "Retries::*", "--retries", "1" });
+    CTEST_ASSERT(run.code != SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, "FLAKY"));
+    CTEST_ASSERT(contains(run.output, "FAIL"));
+
+    // without retries, the flaky test fails too
+    flaky_runs = 0;
+    run = runTests({ "--history-file=", "--filter", "Retries::flaky" });
+    CTEST_ASSERT(run.code != SSTEST_SUCCESS);
+    CTEST_ASSERT(!contains(run.output, "FLAKY"));
+    CTEST_ASSERT(flaky_runs == 1);
+}
+
+TEST(Resume, first)
+{
+    resume_runs++;
+}
+
+TEST(Resume, second)
+{
+    resume_runs++;
+}
+
+CTEST_DEFINE_TEST(runner_resume_test)
+{
+    std::remove(journal_path);
+
+    // stopped after the first test, as if interrupted, which journals its result
+    RunOutput run = runTests({ "--history-file=", "--filter", "Resume::*", "--journal", journal_path, "--max-tests", "1" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(resume_runs == 1);
+
+    // resuming reports the journaled test without running it again, and runs the other
+    run = runTests({ "--history-file=", "--filter", "Resume::*", "--journal", journal_path, "--resume" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, "(resumed)"));
+    CTEST_ASSERT(resume_runs == 2);
+
+    // both are journaled now, so there is nothing left to run
+    run = runTests({ "--history-file=", "--filter", "Resume::*", "--journal", journal_path, "--resume" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(resume_runs == 2);
+
+    std::remove(journal_path);
+}
+
+TEST(Batch, a) { EXPECT_TRUE(true); }
+TEST(Batch, b) { EXPECT_TRUE(true); }
+TEST(Batch, c) { EXPECT_TRUE(true); }
+TEST(Batch, d) { EXPECT_TRUE(true); }
+TEST(Batch, e) { EXPECT_TRUE(true); }
+TEST(Batch, f) { EXPECT_TRUE(true); }
+TEST(Batch, g) { EXPECT_TRUE(true); }
+TEST(Batch, h) { EXPECT_TRUE(true); }
+
+CTEST_DEFINE_TEST(runner_batch_test)
+{
+    std::remove(history_path);
+
+    // without history no test is known to be quick, so each is reported on its own
+    RunOutput run = runTests({ "--history-file", history_path, "--filter", "Batch::*", "--batch", "1000000" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(!contains(run.output, " tests)"));
+    CTEST_ASSERT(contains(run.output, "RUN"));
+
+    // once they are, the ones passing are reported together
+    run = runTests({ "--history-file", history_path, "--filter", "Batch::*", "--batch", "1000000" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, " tests)"));
+    CTEST_ASSERT(!contains(run.output, "RUN"));
+
+    std::remove(history_path);
+}
+
+CTEST_DEFINE_TEST(runner_limit_results_test)
+{
+    std::remove(results_path);
+
+    // tests left out at --max-tests don't fail the run, nor the merge of its results
+    RunOutput run = runTests({ "--history-file=", "--filter", "Batch::*", "--max-tests", "2", "--results-file", results_path });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    std::ifstream file(results_path);
+    const std::vector<TestRecord> records = readTestRecords(file);
+    CTEST_ASSERT(records.size() == 8);
+    const TestTotals totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_functions_ran == 2);
+    CTEST_ASSERT(totals.test_functions_skipped == 6);
+    CTEST_ASSERT(totals.test_functions_over_limit == 6);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(testing::ExitCode(totals) == SSTEST_SUCCESS);
+    file.close();
+
+    std::remove(results_path);
+}
+
+TEST(Timeout, hangs)
+{
+    std::this_thread::sleep_for(std::chrono::seconds(20));
+}
+
+TEST(Timeout, slow)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+}
+
+CTEST_DEFINE_TEST(runner_timeout_test)
+{
+    // a test that returns after its timeout is marked TIMEOUT when asked to wait for it, which is warned about
+    RunOutput run = runTests({ "--history-file=", "--filter", "Timeout::slow", "--timeout", "100", "--on-timeout", "continue" });
+    CTEST_ASSERT(run.code != SSTEST_SUCCESS);
+    CTEST_ASSERT(contains(run.output, "TIMEOUT"));
+    CTEST_ASSERT(contains(run.output, "can't be stopped without --isolate"));
+
+    if (!ProcessPool::supported()) CTEST_END_TEST();
+
+    // by default, a test that hangs aborts the run at its timeout, so it is run in a process of its own
+    const auto start = std::chrono::steady_clock::now();
+    int status = 0;
+    ProcessPool pool(1);
+    pool.run(1,
+        [](size_t) -> std::string
+        {
+            runTests({ "--history-file=", "--filter", "Timeout::hangs", "--timeout", "200" });
+            return "returned";
+        },
+        [](size_t, const std::string&) -> void {},
+        [&status](size_t, int wait_status) -> void
+        {
+            status = wait_status;
+        });
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    CTEST_ASSERT(ProcessPool::exitedWith(status, EXIT_FAILURE));
+    CTEST_ASSERT(elapsed < std::chrono::seconds(10));
+}
+
+TEST(Options, ran)
+{
+    option_runs++;
+}
+
+CTEST_DEFINE_TEST(runner_bad_option_test)
+{
+    // a malformed option is reported with the usage and fails the run without running any test
+    const char* const bad_options[][2] = { { "--jobs", "abc" }, { "--max-tests", "-1" }, { "--on-timeout", "later" }, { "--repeat", "" } };
+    for (const auto& option : bad_options)
+    {
+        const RunOutput run = runTests({ "--history-file=", "--filter", "Options::*", option[0], option[1] });
+        CTEST_ASSERT(run.code == SSTEST_FAILURE);
+        CTEST_ASSERT(contains(run.errors, option[0]));
+        CTEST_ASSERT(contains(run.errors, "usage: test_runner"));
+        CTEST_ASSERT(run.output.empty());
+    }
+    CTEST_ASSERT(option_runs == 0);
+
+    // as is an option missing its value
+    const RunOutput run = runTests({ "--history-file=", "--filter", "Options::*", "--jobs" });
+    CTEST_ASSERT(run.code == SSTEST_FAILURE);
+    CTEST_ASSERT(contains(run.errors, "missing value for option --jobs"));
+    CTEST_ASSERT(option_runs == 0);
+}
+
+TEST(Pin, affinity)
+{
+    const size_t ncpus = CpuTopology::affinity().size();
+    size_t most = most_pinned_cpus;
+    while (ncpus > most && !most_pinned_cpus.compare_exchange_weak(most, ncpus)) {}
+}
+
+CTEST_DEFINE_TEST(runner_pin_test)
+{
+    const CpuSet allowed = CpuTopology::affinity();
+    RunOutput run = runTests({ "--history-file=", "--filter", "Pin::*", "--pin", "cpu", "--jobs", "2" });
+    CTEST_ASSERT(run.code == SSTEST_SUCCESS);
+    if (CpuTopology::supported())
+    {
+        // each worker runs on the one CPU it was given, and the program may use all of its CPUs again after the run
+        CTEST_ASSERT(contains(run.output, "Pinned 2 worker threads to one CPU each"));
+        CTEST_ASSERT(most_pinned_cpus == 1);
+        CTEST_ASSERT(CpuTopology::affinity() == allowed);
+
+        // reserving every CPU is a usage error, reported before any test runs
+        most_pinned_cpus = 0;
+        run = runTests({ "--history-file=", "--filter", "Pin::*", "--reserve-cpus", CpuTopology::formatList(allowed) });
+        CTEST_ASSERT(run.code == SSTEST_FAILURE);
+        CTEST_ASSERT(contains(run.errors, "leaves no CPU to run tests on"));
+        CTEST_ASSERT(contains(run.errors, "usage: test_runner"));
+        CTEST_ASSERT(most_pinned_cpus == 0);
+        CTEST_ASSERT(CpuTopology::affinity() == allowed);
+
+        // and set from code, the run falls back to not pinning
+        TestRunner::Configuration config = TestRunner::Configuration::default_settings;
+        const std::string reserved = CpuTopology::formatList(allowed);
+        config.reserved_cpus = StringView(reserved.c_str(), reserved.size());
+        config.pin = "cpu";
+        config.history_file = "";
+        config.filter = "Pin::*";
+        TestRunner::getInstance().configure(&config);
+        std::ostringstream output;
+        std::streambuf* const old_buf = std::cout.rdbuf(output.rdbuf());
+        const TestTotals totals = TestRunner::getInstance().runAllTests().getTotals();
+        std::cout.rdbuf(old_buf);
+        CTEST_ASSERT(totals.test_functions_passed == 1);
+        CTEST_ASSERT(contains(output.str(), "running tests on any CPU without pinning"));
+        CTEST_ASSERT(CpuTopology::affinity() == allowed);
+    }
+    else
+    {
+        CTEST_ASSERT(contains(run.output, "not supported"));
+    }
+
+    run = runTests({ "--history-file=", "--filter", "Pin::*", "--pin", "socket" });
+    CTEST_ASSERT(run.code == SSTEST_FAILURE);
+    CTEST_ASSERT(contains(run.errors, "--pin"));
+}
+
+int main()
+{
+    CTEST_RUN_TEST(runner_retries_test);
+    CTEST_RUN_TEST(runner_resume_test);
+    CTEST_RUN_TEST(runner_batch_test);
+    CTEST_RUN_TEST(runner_limit_results_test);
+    CTEST_RUN_TEST(runner_timeout_test);
+    CTEST_RUN_TEST(runner_bad_option_test);
+    CTEST_RUN_TEST(runner_pin_test);
+
+    std::remove("test.log");
+    return EXIT_SUCCESS;
+}
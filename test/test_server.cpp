@@ -0,0 +1,156 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+#include "ctest_macros.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest/sstest_server.h"
+#include "sstest/sstest_exception.h"
+
+/**
+ * This class test TestServer functionality
+ */
+
+using namespace sstest;
+
+static const char* const socket_path = "test_server.tmp.sock";
+
+// writes each argument on a line, with a large output for "large", and fails with "throw"
+static int echo(const std::vector<std::string>& args, std::ostream& os)
+{
+    for (const std::string& arg : args)
+    {
+        if (arg == "throw") throw std::runtime_error("bad request");
+        if (arg == "large") os << std::string(100000, 'x');
+        os << arg << std::endl;
+    }
+    return static_cast<int>(args.size());
+}
+
+CTEST_DEFINE_TEST(test_server_request)
+{
+    CTEST_ASSERT(!TestServer::available(socket_path));
+    {
+        TestServer server(socket_path);
+        CTEST_ASSERT(TestServer::available(socket_path));
+        std::thread thread([&server]() -> void { server.serve(echo); });
+
+        std::ostringstream output;
+        CTEST_ASSERT(TestServer::request(socket_path, { "a", "b c" }, output) == 2);
+        CTEST_ASSERT(output.str() == "a\nb c\n");
+
+        // the server keeps running requests one after another
+        output.str("");
+        CTEST_ASSERT(TestServer::request(socket_path, {}, output) == 0);
+        CTEST_ASSERT(output.str().empty());
+
+        output.str("");
+        CTEST_ASSERT(TestServer::request(socket_path, { "large" }, output) == 1);
+        CTEST_ASSERT(output.str() == std::string(100000, 'x') + "large\n");
+
+        // an exception is reported to the client, and fails the run
+        output.str("");
+        CTEST_ASSERT(TestServer::request(socket_path, { "a", "throw" }, output) == EXIT_FAILURE);
+        CTEST_ASSERT(output.str() == "a\nerror: bad request\n");
+
+        TestServer::shutdown(socket_path);
+        thread.join();
+    }
+    // the socket is removed with the server
+    CTEST_ASSERT(!TestServer::available(socket_path));
+    CTEST_ASSERT(!std::ifstream(socket_path).good());
+}
+
+CTEST_DEFINE_TEST(test_server_unavailable)
+{
+    std::ostringstream output;
+    bool thrown = false;
+    try
+    {
+        TestServer::request(socket_path, { "a" }, output);
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    CTEST_ASSERT(thrown);
+
+    // only one server listens on a socket
+    {
+        TestServer server(socket_path);
+        thrown = false;
+        try
+        {
+            TestServer other(socket_path);
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        CTEST_ASSERT(thrown);
+    }
+
+    // a file that is not a socket is left alone
+    {
+        std::ofstream file(socket_path);
+        file << "not a socket";
+    }
+    thrown = false;
+    try
+    {
+        TestServer server(socket_path);
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    CTEST_ASSERT(thrown);
+    std::ifstream file(socket_path);
+    std::string contents;
+    std::getline(file, contents);
+    CTEST_ASSERT(contents == "not a socket");
+    std::remove(socket_path);
+}
+
+int main()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    std::remove(socket_path);
+    CTEST_RUN_TEST(test_server_request);
+    CTEST_RUN_TEST(test_server_unavailable);
+#endif
+
+    return EXIT_SUCCESS;
+}
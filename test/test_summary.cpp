@@ -31,7 +31,12 @@
 #include "sstest/sstest_summary.h"
 #include "sstest/sstest_assertion.h"
 #include "sstest/sstest_test.h"
+#include "sstest/sstest_runner.h"
+#include "sstest/sstest_console.h"
 #include <vector>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 
 /**
  * This class test TestSummary functionality
@@ -268,6 +273,400 @@ CTEST_DEFINE_TEST(test_summary_multi_test)
     CTEST_ASSERT(totals.validate());
 }
 
+static TestRecord makeRecord(const char* suite, const char* identifier, TestResult result, size_t assertions, size_t assertions_passed)
+{
+    TestRecord record;
+    record.suite = suite;
+    record.identifier = identifier;
+    record.result = result;
+    record.duration_us = 10;
+    record.assertions_total = assertions;
+    record.assertions_ran = assertions;
+    record.assertions_passed = assertions_passed;
+    return record;
+}
+
+CTEST_DEFINE_TEST(test_record_from_test)
+{
+    TestSuite suite(TestInfo("suite"));
+    suite.addTest(TestFunction(TestInfo("name"), LineInfo("", 0), []() {}));
+    TestInterface& test = suite.getTest("name");
+    test.run();
+
+    TestTotals assertions;
+    assertions.assertions_total = 3;
+    assertions.assertions_ran = 2;
+    assertions.assertions_passed = 1;
+    assertions.test_functions_total = 5; // ignored
+    TestRecord record(test, assertions);
+    CTEST_ASSERT(record.suite == "suite");
+    CTEST_ASSERT(record.identifier == "suite::name");
+    CTEST_ASSERT(record.result == TestResult::PASS);
+    CTEST_ASSERT(record.duration_us == test.duration());
+    CTEST_ASSERT(record.assertions_total == 3);
+    CTEST_ASSERT(record.assertions_ran == 2);
+    CTEST_ASSERT(record.assertions_passed == 1);
+}
+
+CTEST_DEFINE_TEST(test_record_write_read)
+{
+    std::vector<TestRecord> records;
+    records.push_back(makeRecord("a", "a::pass", TestResult::PASS, 2, 2));
+    records.push_back(makeRecord("a", "a::fail", TestResult::FAIL, 2, 1));
+    records.push_back(makeRecord("", "global test ( 1, 2 )", TestResult::THROW, 0, 0));
+    records.push_back(makeRecord("b", "b::crash", TestResult::CRASH, 0, 0));
+    records.push_back(makeRecord("b", "b::invalid", TestResult::INVALID, 0, 0));
+    records.push_back(makeRecord("b", "b::skipped", TestResult::SKIP, 0, 0));
+    records.push_back(makeRecord("b", "b::flaky", TestResult::FLAKY, 1, 1));
+    records.push_back(makeRecord("b", "b::cached", TestResult::CACHED, 0, 0));
+    records.push_back(makeRecord("b", "b::quarantined", TestResult::FAIL, 1, 0));
+    records.back().quarantined = true;
+    records.push_back(makeRecord("b", "b::over_limit", TestResult::SKIP, 0, 0));
+    records.back().over_limit = true;
+
+    std::stringstream ss;
+    writeTestRecords(ss, records);
+    const std::vector<TestRecord> read = readTestRecords(ss);
+    CTEST_ASSERT(read.size() == records.size());
+    for (size_t i = 0; i < read.size(); i++)
+    {
+        CTEST_ASSERT(read[i].suite == records[i].suite);
+        CTEST_ASSERT(read[i].identifier == records[i].identifier);
+        CTEST_ASSERT(read[i].result == records[i].result);
+        CTEST_ASSERT(read[i].duration_us == records[i].duration_us);
+        CTEST_ASSERT(read[i].assertions_total == records[i].assertions_total);
+        CTEST_ASSERT(read[i].assertions_ran == records[i].assertions_ran);
+        CTEST_ASSERT(read[i].assertions_passed == records[i].assertions_passed);
+        CTEST_ASSERT(read[i].quarantined == records[i].quarantined);
+        CTEST_ASSERT(read[i].over_limit == records[i].over_limit);
+    }
+
+    const char* const bad_inputs[] = {
+        "",
+        "PASS\t1\t1\t1\t1\ta\ta::b\n",
+        "# sstest results 1\nPASS\t1\t1\t1\t1\t0\t0\ta\n",
+        "# sstest results 1\nMAYBE\t1\t1\t1\t1\t0\t0\ta\ta::b\n",
+        "# sstest results 1\nPASS\tx\t1\t1\t1\t0\t0\ta\ta::b\n",
+        "# sstest results 1\nPASS\t1\t1\t1\t1\ta\ta::b\n",
+        "# sstest results 1\nPASS\t1\t1\t1\t1\tyes\t0\ta\ta::b\n",
+        "# sstest results 1\nSKIP\t1\t1\t1\t1\t0\tyes\ta\ta::b\n",
+        "# sstest results 2\nPASS\t1\t1\t1\t1\t0\t0\ta\ta::b\n",
+    };
+    for (const char* input : bad_inputs)
+    {
+        std::stringstream bad(input);
+        bool thrown = false;
+        try { readTestRecords(bad); }
+        catch (const std::invalid_argument&) { thrown = true; }
+        CTEST_ASSERT(thrown);
+    }
+}
+
+CTEST_DEFINE_TEST(test_record_merge)
+{
+    // two shards, where the first shard was run twice
+    std::vector<TestRecord> records;
+    records.push_back(makeRecord("a", "a::x", TestResult::FAIL, 1, 0));
+    records.push_back(makeRecord("b", "b::y", TestResult::PASS, 1, 1));
+    records.push_back(makeRecord("a", "a::z", TestResult::PASS, 3, 3));
+    records.push_back(makeRecord("a", "a::x", TestResult::PASS, 1, 1));
+
+    const std::vector<TestRecord> merged = mergeTestRecords(records);
+    CTEST_ASSERT(merged.size() == 3);
+    CTEST_ASSERT(merged[0].identifier == "a::x" && merged[0].result == TestResult::PASS);
+    CTEST_ASSERT(merged[1].identifier == "b::y");
+    CTEST_ASSERT(merged[2].identifier == "a::z");
+
+    TestTotals totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_suites_total == 2);
+    CTEST_ASSERT(totals.test_suites_ran == 2);
+    CTEST_ASSERT(totals.test_suites_passed == 2);
+    CTEST_ASSERT(totals.test_functions_total == 3);
+    CTEST_ASSERT(totals.test_functions_ran == 3);
+    CTEST_ASSERT(totals.test_functions_passed == 3);
+    CTEST_ASSERT(totals.assertions_total == 5);
+    CTEST_ASSERT(totals.assertions_ran == 5);
+    CTEST_ASSERT(totals.assertions_passed == 5);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(totals.allTestsPassed());
+
+    // a failed and a test that didn't run
+    records.push_back(makeRecord("b", "b::w", TestResult::CRASH, 0, 0));
+    records.push_back(makeRecord("c", "c::v", TestResult::INVALID, 0, 0));
+    totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_suites_total == 3);
+    CTEST_ASSERT(totals.test_suites_ran == 2);
+    CTEST_ASSERT(totals.test_suites_passed == 1);
+    CTEST_ASSERT(totals.test_functions_total == 5);
+    CTEST_ASSERT(totals.test_functions_ran == 4);
+    CTEST_ASSERT(totals.test_functions_passed == 3);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(!totals.allTestsPassed());
+
+    // tests a shard left out at its limit don't fail the merged run
+    records.pop_back();
+    records.pop_back();
+    records.push_back(makeRecord("c", "c::u", TestResult::SKIP, 0, 0));
+    records.back().over_limit = true;
+    totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_functions_total == 4);
+    CTEST_ASSERT(totals.test_functions_skipped == 1);
+    CTEST_ASSERT(totals.test_functions_over_limit == 1);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(totals.allTestsPassed());
+
+    // unless it ran in another shard and failed there
+    records.push_back(makeRecord("c", "c::u", TestResult::FAIL, 1, 0));
+    totals = TestSummary(records).getTotals();
+    CTEST_ASSERT(totals.test_functions_over_limit == 0);
+    CTEST_ASSERT(!totals.allTestsPassed());
+}
+
+CTEST_DEFINE_TEST(test_summary_skipped)
+{
+    TestSuite suiteA(TestInfo("A"));
+    TestSuite suiteB(TestInfo("B"));
+    suiteA.addTest(TestFunction(TestInfo("1"), LineInfo("", 0), []() {}));
+    suiteA.addTest(TestFunction(TestInfo("2"), LineInfo("", 0), []() {}));
+    suiteB.addTest(TestFunction(TestInfo("1"), LineInfo("", 0), []() {}));
+    TestSummary summary(std::vector<TestSuite*>{ &suiteA, &suiteB });
+
+    // the run stopped after the first test
+    suiteA.getTest("1").run();
+    suiteA.getTest("2").setResult(TestResult::SKIP);
+    suiteB.getTest("1").setResult(TestResult::SKIP);
+    CTEST_ASSERT(!suiteA.getTest("2").ran());
+    CTEST_ASSERT(!suiteA.getTest("2").passed());
+    suiteA.tally();
+    suiteB.tally();
+    CTEST_ASSERT(suiteA.numTestsRan() == 1);
+    CTEST_ASSERT(suiteA.numTestsSkipped() == 1);
+    CTEST_ASSERT(suiteB.numTestsRan() == 0);
+    CTEST_ASSERT(suiteB.numTestsSkipped() == 1);
+
+    summary.addTestSuiteResult(suiteA);
+    summary.addTestSuiteResult(suiteB);
+    TestTotals totals = summary.getTotals();
+    CTEST_ASSERT(totals.test_suites_total == 2);
+    CTEST_ASSERT(totals.test_suites_ran == 1);
+    CTEST_ASSERT(totals.test_suites_passed == 1);
+    CTEST_ASSERT(totals.test_functions_total == 3);
+    CTEST_ASSERT(totals.test_functions_ran == 1);
+    CTEST_ASSERT(totals.test_functions_skipped == 2);
+    CTEST_ASSERT(totals.test_functions_passed == 1);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(totals.allTestsPassed(true, true));
+    CTEST_ASSERT(!totals.allTestsPassed());
+
+    // the same counts from the records of the run
+    std::vector<TestRecord> records;
+    records.push_back(makeRecord("A", "A::1", TestResult::PASS, 0, 0));
+    records.push_back(makeRecord("A", "A::2", TestResult::SKIP, 0, 0));
+    records.push_back(makeRecord("B", "B::1", TestResult::SKIP, 0, 0));
+    CTEST_ASSERT(TestSummary(records).getTotals() == totals);
+}
+
+CTEST_DEFINE_TEST(test_summary_flaky_quarantined)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("pass"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("flaky"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("quarantined"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("quarantined_pass"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("cached"), LineInfo("", 0), []() {}));
+    TestSummary summary(std::vector<TestSuite*>{ &suite });
+
+    suite.getTest("pass").setResult(TestResult::PASS);
+    suite.getTest("flaky").setResult(TestResult::FLAKY);
+    suite.getTest("quarantined").setResult(TestResult::FAIL);
+    suite.getTest("quarantined").setQuarantined();
+    suite.getTest("quarantined_pass").setResult(TestResult::PASS);
+    suite.getTest("quarantined_pass").setQuarantined();
+    suite.getTest("cached").setResult(TestResult::CACHED, 100);
+    CTEST_ASSERT(suite.getTest("flaky").passed());
+    CTEST_ASSERT(suite.getTest("cached").passed());
+    suite.tally();
+    CTEST_ASSERT(suite.numTestsFlaky() == 1);
+    CTEST_ASSERT(suite.numTestsCached() == 1);
+    CTEST_ASSERT(suite.numTestsQuarantined() == 1);
+
+    summary.addTestSuiteResult(suite);
+    TestTotals totals = summary.getTotals();
+    CTEST_ASSERT(totals.test_functions_passed == 4);
+    CTEST_ASSERT(totals.test_functions_flaky == 1);
+    CTEST_ASSERT(totals.test_functions_cached == 1);
+    CTEST_ASSERT(totals.test_functions_quarantined == 1);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(!totals.allTestsPassed());
+    CTEST_ASSERT(totals.allTestsPassed(true, false, true));
+
+    // the same counts from the records of the run
+    std::vector<TestRecord> records;
+    for (TestInterface* test : suite.getTests())
+    {
+        records.push_back(TestRecord(*test, TestTotals()));
+    }
+    CTEST_ASSERT(TestSummary(records).getTotals() == totals);
+}
+
+CTEST_DEFINE_TEST(test_summary_over_budget)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("pass"), LineInfo("", 0), []() {}));
+    TestSummary summary(std::vector<TestSuite*>{ &suite });
+    summary.addTestsOverBudget(3);
+    suite.getTest("pass").setResult(TestResult::PASS);
+    suite.tally();
+    summary.addTestSuiteResult(suite);
+
+    // tests left out by the time budget are reported, but don't fail the run
+    TestTotals totals = summary.getTotals();
+    CTEST_ASSERT(totals.test_functions_over_budget == 3);
+    CTEST_ASSERT(totals.test_functions_total == 1);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(totals.allTestsPassed());
+    CTEST_ASSERT((summary + summary).getTotals().test_functions_over_budget == 6);
+}
+
+CTEST_DEFINE_TEST(test_summary_over_limit)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("pass"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("left"), LineInfo("", 0), []() {}));
+    TestSummary summary(std::vector<TestSuite*>{ &suite });
+    suite.getTest("pass").setResult(TestResult::PASS);
+    suite.getTest("left").setResult(TestResult::SKIP);
+    suite.tally();
+    summary.addTestSuiteResult(suite);
+
+    // a skipped test fails the run, unless it was skipped at the limit of the run
+    CTEST_ASSERT(!summary.getTotals().allTestsPassed());
+    summary.addTestsOverLimit(1);
+    TestTotals totals = summary.getTotals();
+    CTEST_ASSERT(totals.test_functions_over_limit == 1);
+    CTEST_ASSERT(totals.test_functions_skipped == 1);
+    CTEST_ASSERT(totals.validate());
+    CTEST_ASSERT(totals.allTestsPassed());
+    CTEST_ASSERT((summary + summary).getTotals().test_functions_over_limit == 2);
+}
+
+CTEST_DEFINE_TEST(test_reporter_batch)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("1"), LineInfo("", 0), []() {}));
+    suite.addTest(TestFunction(TestInfo("3"), LineInfo("", 0), []() {}));
+    suite.getTest("1").setResult(TestResult::PASS);
+    suite.getTest("3").setResult(TestResult::PASS);
+
+    std::stringstream out;
+    const TestRunner::Configuration config;
+    TestRunner::Reporter target(Logger(out), config);
+    TestRunner::Reporter buffered(target, config);
+    CTEST_ASSERT(target.empty());
+    CTEST_ASSERT(buffered.empty());
+
+    // quiet tests of a batch are reported in one line, held back until committed
+    buffered.reportTestBatch(suite.getTest("1"), suite.getTest("3"), 3);
+    CTEST_ASSERT(!buffered.empty());
+    CTEST_ASSERT(out.str().empty());
+    buffered.commit();
+    CTEST_ASSERT(buffered.empty());
+    CTEST_ASSERT(out.str().find("1 ... 3 (3 tests)") != std::string::npos);
+
+    // a batch of one is reported like any other test
+    std::stringstream single;
+    TestRunner::Reporter(Logger(single), config).reportTestBatch(suite.getTest("1"), suite.getTest("1"), 1);
+    std::stringstream expected;
+    TestRunner::Reporter(Logger(expected), config).reportTestResult(suite.getTest("1"));
+    CTEST_ASSERT(single.str() == expected.str());
+}
+
+CTEST_DEFINE_TEST(test_reporter_buffered_destroy)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("1"), LineInfo("", 0), []() {}));
+    suite.getTest("1").setResult(TestResult::PASS);
+
+    std::stringstream out;
+    const TestRunner::Configuration config;
+    TestRunner::Reporter target(Logger(out), config);
+
+    // a buffered reporter is destroyed cleanly whether or not it was committed, uncommitted output is dropped
+    // (the loggers flush on destruction, so they must go before their buffers, checked by the sanitizer build)
+    {
+        TestRunner::Reporter buffered(target, config);
+        buffered.reportTestResult(suite.getTest("1"));
+        buffered.commit();
+    }
+    {
+        TestRunner::Reporter buffered(target, config);
+        buffered.reportTestResult(suite.getTest("1"));
+    }
+    std::unique_ptr<TestRunner::Reporter> buffered(new TestRunner::Reporter(target, config));
+    buffered->reportTestResult(suite.getTest("1"));
+    buffered.reset();
+
+    std::stringstream expected;
+    TestRunner::Reporter(Logger(expected), config).reportTestResult(suite.getTest("1"));
+    CTEST_ASSERT(out.str() == expected.str());
+}
+
+CTEST_DEFINE_TEST(test_reporter_thrown_message)
+{
+    TestSuite suite(TestInfo("A"));
+    suite.addTest(TestFunction(TestInfo("std"), LineInfo("", 0), []() { throw std::runtime_error("connection refused"); }));
+    suite.addTest(TestFunction(TestInfo("other"), LineInfo("", 0), []() { throw 1; }));
+    suite.run();
+    CTEST_ASSERT(suite.getTest("std").thrownMessage() == "connection refused");
+    CTEST_ASSERT(suite.getTest("other").thrownMessage().empty());
+
+    std::stringstream out;
+    const TestRunner::Configuration config;
+    TestRunner::Reporter reporter(Logger(out), config);
+    reporter.reportTestResult(suite.getTest("std"));
+    reporter.reportTestResult(suite.getTest("other"));
+    CTEST_ASSERT(out.str().find("test body threw: connection refused") != std::string::npos);
+    CTEST_ASSERT(out.str().find("test body threw an exception") != std::string::npos);
+}
+
+CTEST_DEFINE_TEST(test_read_test_list)
+{
+    std::stringstream ss("# flaky since the network change\nnet::connect\n\n  net::send \r\nlocal\n");
+    const std::unordered_set<std::string> list = readTestList(ss);
+    CTEST_ASSERT(list == std::unordered_set<std::string>({ "net::connect", "net::send", "local" }));
+}
+
+CTEST_DEFINE_TEST(test_repeat_stats)
+{
+    RepeatStats stats;
+    CTEST_ASSERT(stats.result() == TestResult::SKIP);
+    CTEST_ASSERT(stats.percentile(0.5) == 0);
+
+    // runs finish in any order, durations 1..10 ms
+    for (size_t run = 10; run >= 1; run--)
+    {
+        TestResult result = TestResult::PASS;
+        if (run == 7) result = TestResult::CRASH;
+        if (run == 4) result = TestResult::FAIL;
+        stats.add(run, result, run * 1000);
+    }
+    stats.add(11, TestResult::SKIP, 0); // not started
+    CTEST_ASSERT(stats.runs == 10);
+    CTEST_ASSERT(stats.passed == 8);
+    CTEST_ASSERT(stats.first_failure == 4);
+    CTEST_ASSERT(stats.result() == TestResult::FAIL);
+    CTEST_ASSERT(stats.percentile(0) == 1000);
+    CTEST_ASSERT(stats.percentile(0.5) == 5000);
+    CTEST_ASSERT(stats.percentile(0.9) == 9000);
+    CTEST_ASSERT(stats.percentile(1) == 10000);
+    CTEST_ASSERT(stats.describe() == "8/10 runs passed (80.0%), first failed on run 4, min/median/p90/max 1.0/5.0/9.0/10.0 ms");
+
+    RepeatStats passing;
+    passing.add(1, TestResult::PASS, 500);
+    CTEST_ASSERT(passing.result() == TestResult::PASS);
+    CTEST_ASSERT(passing.describe() == "1/1 runs passed (100.0%), min/median/p90/max 0.5/0.5/0.5/0.5 ms");
+}
+
 int main()
 {
     CTEST_RUN_TEST(test_summary_construct_blank);
@@ -276,6 +675,18 @@ int main()
     CTEST_RUN_TEST(test_summary_empty_suite);
     CTEST_RUN_TEST(test_summary_single_test);
     CTEST_RUN_TEST(test_summary_multi_test);
+    CTEST_RUN_TEST(test_record_from_test);
+    CTEST_RUN_TEST(test_record_write_read);
+    CTEST_RUN_TEST(test_record_merge);
+    CTEST_RUN_TEST(test_summary_skipped);
+    CTEST_RUN_TEST(test_summary_flaky_quarantined);
+    CTEST_RUN_TEST(test_summary_over_budget);
+    CTEST_RUN_TEST(test_summary_over_limit);
+    CTEST_RUN_TEST(test_reporter_batch);
+    CTEST_RUN_TEST(test_reporter_buffered_destroy);
+    CTEST_RUN_TEST(test_reporter_thrown_message);
+    CTEST_RUN_TEST(test_read_test_list);
+    CTEST_RUN_TEST(test_repeat_stats);
 
     return CTEST_SUCCESS;
 }
\ No newline at end of file
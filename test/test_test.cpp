@@ -27,7 +27,14 @@
 *******************************************************************************/
 
 #include "ctest_macros.h"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "sstest/sstest_test.h"
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_include.h"
 
 
 /**
@@ -43,10 +50,593 @@ CTEST_DEFINE_TEST(construct_test)
     TestFunction test(TestInfo("name"), LineInfo(__FILE__, __LINE__), func);
 }
 
+CTEST_DEFINE_TEST(identifier_test)
+{
+    TestSuite suite(TestInfo("suite"));
+    suite.addTest(TestFunction(TestInfo("name"), LineInfo(__FILE__, __LINE__), func));
+    suite.addTest(TestFunction(TestInfo("suite::other"), LineInfo(__FILE__, __LINE__), func));
+
+    CTEST_ASSERT(suite.getTest("name").suite() == &suite);
+    CTEST_ASSERT(suite.getTest("name").identifier() == "suite::name");
+    CTEST_ASSERT(suite.getTest("suite::other").identifier() == "suite::other");
+}
+
+CTEST_DEFINE_TEST(select_shard_test)
+{
+    const size_t ntests = 100;
+    const size_t nshards = 3;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < ntests; i++) names.push_back("test_" + std::to_string(i));
+
+    TestSuite suite(TestInfo("suite"));
+    for (const std::string& name : names)
+    {
+        suite.addTest(TestFunction(TestInfo(name.c_str()), LineInfo(__FILE__, __LINE__), func));
+    }
+    const std::vector<TestInterface*> tests = suite.getTests();
+
+    // every test in exactly one shard, shards within one test of each other
+    std::set<TestInterface*> seen;
+    for (size_t shard = 0; shard < nshards; shard++)
+    {
+        const std::vector<TestInterface*> selected = selectShard(tests, shard, nshards);
+        CTEST_ASSERT(selected.size() == ntests / nshards || selected.size() == ntests / nshards + 1);
+        for (TestInterface* test : selected)
+        {
+            CTEST_ASSERT(seen.insert(test).second);
+        }
+        // same split every time
+        CTEST_ASSERT(selectShard(tests, shard, nshards) == selected);
+    }
+    CTEST_ASSERT(seen.size() == ntests);
+
+    CTEST_ASSERT(selectShard(tests, 0, 1) == tests);
+}
+
+CTEST_DEFINE_TEST(partition_by_weight_test)
+{
+    const uint64_t weights[] = { 8, 7, 6, 5, 4 };
+    std::vector<TestFunction> storage;
+    for (uint64_t weight : weights)
+    {
+        storage.push_back(TestFunction(TestInfo("name"), LineInfo(__FILE__, __LINE__), func));
+        storage.back().setWeight(weight);
+    }
+    std::vector<TestInterface*> tests;
+    for (TestFunction& test : storage) tests.push_back(&test);
+
+    // longest first onto the least loaded part: {8, 5, 4} and {7, 6}
+    const std::vector<size_t> parts = partitionByWeight(tests, 2);
+    CTEST_ASSERT(parts == std::vector<size_t>({ 0, 1, 1, 0, 0 }));
+
+    // equal weights are dealt in turn
+    for (TestInterface* test : tests) test->setWeight(0);
+    CTEST_ASSERT(partitionByWeight(tests, 2) == std::vector<size_t>({ 0, 1, 0, 1, 0 }));
+    CTEST_ASSERT(partitionByWeight(tests, 1) == std::vector<size_t>(tests.size(), 0));
+
+    bool thrown = false;
+    try { partitionByWeight(tests, 0); }
+    catch (const InvalidArgument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(select_shard_weighted_test)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 19; i++) names.push_back("test_" + std::to_string(i));
+
+    TestSuite suite(TestInfo("suite"));
+    for (const std::string& name : names)
+    {
+        suite.addTest(TestFunction(TestInfo(name.c_str()), LineInfo(__FILE__, __LINE__), func));
+    }
+    const std::vector<TestInterface*> tests = suite.getTests();
+
+    // one long test and many short ones, splits evenly by weight instead of count
+    uint64_t total = 0;
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        tests[i]->setWeight(i == 0 ? 1000 : 100);
+        total += tests[i]->weight();
+    }
+    std::set<TestInterface*> seen;
+    for (size_t shard = 0; shard < 2; shard++)
+    {
+        uint64_t load = 0;
+        for (TestInterface* test : selectShard(tests, shard, 2))
+        {
+            CTEST_ASSERT(seen.insert(test).second);
+            load += test->weight();
+        }
+        CTEST_ASSERT(load == total / 2);
+    }
+    CTEST_ASSERT(seen.size() == tests.size());
+}
+
+CTEST_DEFINE_TEST(select_shard_invalid_test)
+{
+    const std::vector<TestInterface*> tests;
+    bool thrown = false;
+    try { selectShard(tests, 0, 0); }
+    catch (const InvalidArgument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+
+    thrown = false;
+    try { selectShard(tests, 2, 2); }
+    catch (const InvalidArgument&) { thrown = true; }
+    CTEST_ASSERT(thrown);
+}
+
+CTEST_DEFINE_TEST(shuffle_tests_test)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 20; i++) names.push_back("test_" + std::to_string(i));
+
+    TestSuite suite_a(TestInfo("a"));
+    TestSuite suite_b(TestInfo("b"));
+    for (const std::string& name : names)
+    {
+        suite_a.addTest(TestFunction(TestInfo(name.c_str()), LineInfo(__FILE__, __LINE__), func));
+        suite_b.addTest(TestFunction(TestInfo(name.c_str()), LineInfo(__FILE__, __LINE__), func));
+    }
+    std::vector<TestInterface*> tests = suite_a.getTests();
+    const std::vector<TestInterface*> tests_b = suite_b.getTests();
+    tests.insert(tests.end(), tests_b.begin(), tests_b.end());
+
+    // a permutation which keeps suites together
+    const std::vector<TestInterface*> shuffled = shuffleTests(tests, 1);
+    CTEST_ASSERT(shuffled != tests);
+    CTEST_ASSERT(std::set<TestInterface*>(shuffled.begin(), shuffled.end()) == std::set<TestInterface*>(tests.begin(), tests.end()));
+    for (size_t i = 1; i < shuffled.size(); i++)
+    {
+        if (i != names.size()) CTEST_ASSERT(shuffled[i]->suite() == shuffled[i - 1]->suite());
+    }
+
+    // the same for the same seed, whatever order or subset of tests is given
+    CTEST_ASSERT(shuffleTests(shuffled, 1) == shuffled);
+    const std::vector<TestInterface*> half(tests.begin() + 5, tests.begin() + 25);
+    std::vector<TestInterface*> expected;
+    for (TestInterface* test : shuffled)
+    {
+        if (std::find(half.begin(), half.end(), test) != half.end()) expected.push_back(test);
+    }
+    CTEST_ASSERT(shuffleTests(half, 1) == expected);
+
+    CTEST_ASSERT(shuffleTests(tests, 2) != shuffled);
+}
+
+namespace
+{
+    int suite_setups = 0;
+    int suite_teardowns = 0;
+    std::vector<int> seen_values;
+
+    struct SharedFixture : public ::testing::Test<>
+    {
+        int value = 0;
+        bool fail = false;
+
+        void SetUpSuite() override
+        {
+            suite_setups++;
+            if (fail) throw std::runtime_error("setup failed");
+            value = 42;
+        }
+
+        void TearDownSuite() override
+        {
+            suite_teardowns++;
+        }
+    };
+
+    // like the class TEST(SharedFixture, name) defines
+    struct ReadShared : public SharedFixture
+    {
+        typedef SharedFixture sstest_suite_type;
+
+        void operator()() override
+        {
+            seen_values.push_back(SuiteFixture<SharedFixture>().value);
+            seen_values.push_back(value); // the test's own copy is not set up for the suite
+        }
+    };
+}
+
+CTEST_DEFINE_TEST(suite_fixture_test)
+{
+    sstest_void_function first = TestInterface::createTestInvoker(ReadShared());
+    sstest_void_function second = TestInterface::createTestInvoker(ReadShared());
+
+    // a worker sets up the suite once for all of its tests, and tears it down when done
+    {
+        SuiteFixtures fixtures;
+        SuiteFixtures::setCurrent(&fixtures);
+        first();
+        second();
+        first();
+        CTEST_ASSERT(suite_setups == 1);
+        CTEST_ASSERT(suite_teardowns == 0);
+        CTEST_ASSERT(seen_values == std::vector<int>({ 42, 0, 42, 0, 42, 0 }));
+        CTEST_ASSERT(fixtures.tearDown().empty());
+        CTEST_ASSERT(suite_teardowns == 1);
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    // without a worker, each test sets up the suite on its own
+    first();
+    CTEST_ASSERT(suite_setups == 2);
+    CTEST_ASSERT(suite_teardowns == 2);
+
+    // a failed setup fails every test of the suite on the worker, without setting up again or tearing down
+    ReadShared failing;
+    failing.fail = true;
+    sstest_void_function failing_test = TestInterface::createTestInvoker(failing);
+    SuiteFixtures fixtures;
+    SuiteFixtures::setCurrent(&fixtures);
+    for (int i = 0; i < 2; i++)
+    {
+        bool thrown = false;
+        try
+        {
+            failing_test();
+        }
+        catch (const std::runtime_error& e)
+        {
+            thrown = (std::string(e.what()) == "setup failed");
+        }
+        CTEST_ASSERT(thrown);
+    }
+    CTEST_ASSERT(suite_setups == 3);
+    CTEST_ASSERT(fixtures.tearDown().empty());
+    CTEST_ASSERT(suite_teardowns == 2);
+    SuiteFixtures::setCurrent(nullptr);
+}
+
+namespace
+{
+    int plain_constructions = 0;
+    bool read_suite = false;
+
+    // a fixture without suite hooks
+    struct PlainFixture : public ::testing::Test<>
+    {
+        int value = 7;
+
+        PlainFixture() { plain_constructions++; }
+        PlainFixture(const PlainFixture& other) : ::testing::Test<>(other), value(other.value) { plain_constructions++; }
+    };
+
+    struct ReadPlain : public SuiteTest<PlainFixture>
+    {
+        void operator()()
+        {
+            if (read_suite)
+            {
+                CTEST_ASSERT(SuiteFixture<PlainFixture>().value == 7);
+                CTEST_ASSERT(&SuiteFixture<PlainFixture>() == &SuiteFixture<PlainFixture>());
+            }
+        }
+    };
+}
+
+CTEST_DEFINE_TEST(lazy_suite_fixture_test)
+{
+    CTEST_ASSERT(overrides_suite_hooks<SharedFixture>::value);
+    CTEST_ASSERT(!overrides_suite_hooks<PlainFixture>::value);
+
+    sstest_void_function first = TestInterface::createTestInvoker(ReadPlain());
+    sstest_void_function second = TestInterface::createTestInvoker(ReadPlain());
+    SuiteFixtures fixtures;
+    SuiteFixtures::setCurrent(&fixtures);
+
+    // a suite without hooks is not set up for tests that don't read it, so each run only copies the test
+    int before = plain_constructions;
+    first();
+    second();
+    CTEST_ASSERT(plain_constructions == before + 2);
+
+    // but once per worker by the first test that does
+    read_suite = true;
+    before = plain_constructions;
+    first();
+    second();
+    CTEST_ASSERT(plain_constructions == before + 3);
+    read_suite = false;
+
+    CTEST_ASSERT(fixtures.tearDown().empty());
+    SuiteFixtures::setCurrent(nullptr);
+}
+
+namespace
+{
+    int constructions = 0;
+    int resets = 0;
+    bool leak = false;
+    bool fail_reset = false;
+    bool fail_test = false;
+    std::vector<int> seen_counts;
+
+    // a fixture that is costly to construct, without a move constructor
+    struct Counter : public ::testing::Test<>
+    {
+        int count = 0;
+
+        Counter() { constructions++; }
+        Counter(const Counter& other) : ::testing::Test<>(other), count(other.count) { constructions++; }
+        ~Counter() {}
+
+        void Reset() override
+        {
+            resets++;
+            if (!leak) count = 0;
+            if (fail_reset) throw std::logic_error("reset failed");
+        }
+
+        bool operator==(const Counter& other) const
+        {
+            return count == other.count;
+        }
+    };
+
+    // the same fixture, not reused
+    struct CopiedCounter : public Counter
+    {};
+
+    // bodies of tests of the suites, like TEST(Counter, name) defines
+    struct CountOnce : public SuiteTest<Counter>
+    {
+        void operator()()
+        {
+            seen_counts.push_back(count);
+            count++;
+            if (fail_test) throw std::runtime_error("test failed");
+        }
+    };
+
+    struct CountTwice : public SuiteTest<Counter>
+    {
+        void operator()()
+        {
+            seen_counts.push_back(count);
+            count += 2;
+        }
+    };
+
+    struct CountCopied : public SuiteTest<CopiedCounter>
+    {
+        void operator()()
+        {
+            seen_counts.push_back(count);
+            count++;
+        }
+    };
+}
+
+namespace testing
+{
+    template <>
+    struct reuse_fixture<Counter> : std::true_type
+    {};
+}
+
+CTEST_DEFINE_TEST(reuse_fixture_test)
+{
+    // without reuse, every run copies the fixture
+    {
+        sstest_void_function copied = TestInterface::createTestInvoker(CountCopied());
+        SuiteFixtures fixtures;
+        SuiteFixtures::setCurrent(&fixtures);
+        copied();
+        const int before = constructions;
+        for (int i = 0; i < 4; i++)
+        {
+            copied();
+        }
+        CTEST_ASSERT(constructions == before + 4);
+        CTEST_ASSERT(fixtures.tearDown().empty());
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    // with reuse, tests run on the objects they were registered with, reset after each run instead of copied
+    sstest_void_function once = TestInterface::createTestInvoker(CountOnce());
+    sstest_void_function twice = TestInterface::createTestInvoker(CountTwice());
+    seen_counts.clear();
+    {
+        SuiteFixtures fixtures;
+        SuiteFixtures::setCurrent(&fixtures);
+        once();
+        const int before = constructions;
+        twice();
+        once();
+        twice();
+        CTEST_ASSERT(constructions == before);
+        CTEST_ASSERT(resets == 4);
+        CTEST_ASSERT(seen_counts == std::vector<int>({ 0, 0, 0, 0 }));
+
+        // another worker running a test the first one keeps the object of copies it once
+        SuiteFixtures other_fixtures;
+        SuiteFixtures::setCurrent(&other_fixtures);
+        once();
+        once();
+        CTEST_ASSERT(constructions == before + 1);
+        CTEST_ASSERT(other_fixtures.tearDown().empty());
+        SuiteFixtures::setCurrent(&fixtures);
+        CTEST_ASSERT(fixtures.tearDown().empty());
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    // and a test not run by a worker reuses the registered object as well
+    {
+        const int before = constructions;
+        once();
+        once();
+        CTEST_ASSERT(constructions == before);
+    }
+
+    // state Reset() misses leaks into the next run, unless checked
+    seen_counts.clear();
+    leak = true;
+    {
+        sstest_void_function leaky = TestInterface::createTestInvoker(CountOnce());
+        SuiteFixtures fixtures;
+        SuiteFixtures::setCurrent(&fixtures);
+        leaky();
+        leaky();
+        CTEST_ASSERT(seen_counts == std::vector<int>({ 0, 1 }));
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    // checking fails the test that left state behind, and drops its object so the next run starts clean
+    seen_counts.clear();
+    {
+        sstest_void_function checked = TestInterface::createTestInvoker(CountOnce());
+        SuiteFixtures fixtures;
+        fixtures.setCheckReset(true);
+        SuiteFixtures::setCurrent(&fixtures);
+        bool thrown = false;
+        try
+        {
+            checked();
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        CTEST_ASSERT(thrown);
+        leak = false;
+        checked();
+        checked();
+        CTEST_ASSERT(seen_counts == std::vector<int>({ 0, 0, 0 }));
+        SuiteFixtures::setCurrent(nullptr);
+    }
+
+    // a test that throws is reported with its own exception, even if Reset() then throws too
+    {
+        sstest_void_function failing = TestInterface::createTestInvoker(CountOnce());
+        SuiteFixtures fixtures;
+        SuiteFixtures::setCurrent(&fixtures);
+        fail_test = true;
+        fail_reset = true;
+        std::string message;
+        try
+        {
+            failing();
+        }
+        catch (const std::exception& e)
+        {
+            message = e.what();
+        }
+        CTEST_ASSERT(message == "test failed");
+
+        fail_test = false;
+        message.clear();
+        try
+        {
+            failing();
+        }
+        catch (const std::exception& e)
+        {
+            message = e.what();
+        }
+        CTEST_ASSERT(message == "reset failed");
+        fail_reset = false;
+        SuiteFixtures::setCurrent(nullptr);
+    }
+}
+
+namespace
+{
+    std::vector<std::string> namespaced_runs;
+
+    struct ScopedFixture : public ::testing::Test<>
+    {
+        std::string label = "fixture";
+    };
+}
+
+namespace named_scope
+{
+    struct NamedFixture : public ::testing::Test<>
+    {
+        std::string label = "named";
+    };
+
+    TEST(NamedFixture, in_named_namespace)
+    {
+        namespaced_runs.push_back(label);
+    }
+
+    TEST(NamedSuite, plain_in_named_namespace)
+    {
+        namespaced_runs.push_back("named suite");
+    }
+}
+
+namespace
+{
+    TEST(ScopedFixture, in_anonymous_namespace)
+    {
+        namespaced_runs.push_back(label);
+    }
+}
+
+namespace
+{
+    bool zero_value_seen = false;
+
+    // members without an initializer start at zero, as the fixture of a test is value-initialized
+    struct UninitializedFixture : public ::testing::Test<>
+    {
+        int value;
+        double values[4];
+    };
+
+    TEST(UninitializedFixture, zero)
+    {
+        zero_value_seen = (value == 0);
+        for (double v : values)
+        {
+            zero_value_seen = zero_value_seen && (v == 0.0);
+        }
+    }
+}
+
+CTEST_DEFINE_TEST(value_initialized_fixture_test)
+{
+    TestSuite* tests = TestRunner::getInstance().registry().getTestCase("UninitializedFixture");
+    CTEST_ASSERT(tests->size() == 1);
+    tests->run();
+    CTEST_ASSERT(tests->numTestsPassed() == 1);
+    CTEST_ASSERT(zero_value_seen);
+}
+
+// TEST(suite, name) works in any namespace, not only the one sstest::SuiteTest is in
+CTEST_DEFINE_TEST(namespaced_test_test)
+{
+    for (const char* suite : { "NamedFixture", "NamedSuite", "ScopedFixture" })
+    {
+        TestSuite* tests = TestRunner::getInstance().registry().getTestCase(suite);
+        CTEST_ASSERT(tests->size() == 1);
+        tests->run();
+        CTEST_ASSERT(tests->numTestsPassed() == 1);
+    }
+    CTEST_ASSERT(namespaced_runs == std::vector<std::string>({ "named", "named suite", "fixture" }));
+}
 
 int main()
 {
     CTEST_RUN_TEST(construct_test);
+    CTEST_RUN_TEST(identifier_test);
+    CTEST_RUN_TEST(select_shard_test);
+    CTEST_RUN_TEST(partition_by_weight_test);
+    CTEST_RUN_TEST(select_shard_weighted_test);
+    CTEST_RUN_TEST(select_shard_invalid_test);
+    CTEST_RUN_TEST(shuffle_tests_test);
+    CTEST_RUN_TEST(suite_fixture_test);
+    CTEST_RUN_TEST(lazy_suite_fixture_test);
+    CTEST_RUN_TEST(reuse_fixture_test);
+    CTEST_RUN_TEST(namespaced_test_test);
+    CTEST_RUN_TEST(value_initialized_fixture_test);
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
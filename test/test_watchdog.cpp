@@ -0,0 +1,136 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+#include "ctest_macros.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sstest/sstest_watchdog.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#   include <unistd.h>
+#endif
+
+/**
+ * This class test Watchdog functionality
+ */
+
+using namespace sstest;
+
+CTEST_DEFINE_TEST(test_watchdog_expire)
+{
+    std::atomic<int> expired(0);
+    std::string expired_label;
+    Watchdog watchdog(2, [&](size_t slot, const std::string& label) -> void
+    {
+        CTEST_ASSERT(slot == 1);
+        expired_label = label;
+        expired++;
+    });
+    watchdog.start();
+
+    watchdog.arm(1, std::chrono::milliseconds(10), "slow");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CTEST_ASSERT(expired == 1); // only once per arm
+    CTEST_ASSERT(watchdog.disarm(1));
+    watchdog.stop();
+    CTEST_ASSERT(expired_label == "slow");
+}
+
+CTEST_DEFINE_TEST(test_watchdog_disarm)
+{
+    std::atomic<int> expired(0);
+    Watchdog watchdog(1, [&](size_t, const std::string&) -> void { expired++; });
+    watchdog.start();
+
+    for (int i = 0; i < 10; i++)
+    {
+        watchdog.arm(0, std::chrono::milliseconds(1000), "fast");
+        CTEST_ASSERT(!watchdog.disarm(0));
+    }
+    // no timeout given, never expires
+    watchdog.arm(0, std::chrono::milliseconds(0), "untimed");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CTEST_ASSERT(!watchdog.disarm(0));
+    watchdog.stop();
+    watchdog.stop();
+    CTEST_ASSERT(expired == 0);
+}
+
+CTEST_DEFINE_TEST(test_watchdog_global)
+{
+    std::atomic<int> expired(0);
+    Watchdog watchdog(1, [&](size_t slot, const std::string&) -> void 
+    { 
+        CTEST_ASSERT(slot == Watchdog::global_slot);
+        expired++; 
+    });
+    watchdog.start(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    watchdog.stop();
+    CTEST_ASSERT(expired == 1);
+}
+
+CTEST_DEFINE_TEST(test_dump_thread_stacks)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+    std::atomic<bool> done(false);
+    std::thread other([&]() -> void
+    {
+        while (!done) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    int fds[2];
+    CTEST_ASSERT(::pipe(fds) == 0);
+    dumpThreadStacks(fds[1]);
+    ::close(fds[1]);
+    std::string output;
+    char buf[4096];
+    ssize_t n = 0;
+    while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) output.append(buf, static_cast<size_t>(n));
+    ::close(fds[0]);
+
+    done = true;
+    other.join();
+    CTEST_ASSERT(!output.empty());
+#endif
+}
+
+int main()
+{
+    CTEST_RUN_TEST(test_watchdog_expire);
+    CTEST_RUN_TEST(test_watchdog_disarm);
+    CTEST_RUN_TEST(test_watchdog_global);
+    CTEST_RUN_TEST(test_dump_thread_stacks);
+
+    return CTEST_SUCCESS;
+}
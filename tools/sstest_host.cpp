@@ -0,0 +1,295 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+/**
+ * sstest_host: load tests from shared libraries into one long running program, and load them again when they are rebuilt.
+ * 
+ * Usage: sstest_host [--watch | --serve SOCKET] PLUGIN... [-- ARGS...]
+ * Each PLUGIN is a shared library of tests, built against sstest without linking it, e.g. with -shared -fPIC. The tests of each 
+ * plugin are run with ARGS as a test program at the path of the plugin would run them, so each plugin keeps its own history. By 
+ * default, the tests of every plugin run once. With --watch, the tests of a plugin run again each time it is rebuilt, until the host 
+ * is stopped. With --serve, each request sent by sstest_request runs the tests of every plugin with the options of the request after 
+ * ARGS, once plugins that were rebuilt are loaded again. POSIX only.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_plugin.h"
+#include "sstest/sstest_registry.h"
+#include "sstest/sstest_run.h"
+#include "sstest/sstest_runner.h"
+#include "sstest/sstest_server.h"
+
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#if defined(__linux__)
+#   include <sys/inotify.h>
+#endif
+
+namespace
+{
+    using namespace sstest;
+
+    // a rebuild writes a library in steps, so it is only loaded once no file has changed for this long
+    const int settle_ms = 200;
+
+    // without inotify, plugins are checked for changes this often
+    const int poll_interval_ms = 500;
+
+    void printUsage(std::ostream& os)
+    {
+        os << "usage: sstest_host [--watch | --serve SOCKET] PLUGIN... [-- ARGS...]" << std::endl;
+    }
+
+    // wakes up when a file is written to or moved into the directory of a plugin
+    class Watcher
+    {
+    public:
+        explicit Watcher(const std::vector<std::unique_ptr<TestPlugin>>& plugins)
+            : fd(-1)
+        {
+#if defined(__linux__)
+            fd = ::inotify_init1(IN_CLOEXEC);
+            for (const std::unique_ptr<TestPlugin>& plugin : plugins)
+            {
+                const std::string& path = plugin->path();
+                const size_t slash = path.find_last_of('/');
+                const std::string dir = (slash == std::string::npos) ? std::string(".") : (slash == 0) ? std::string("/") : path.substr(0, slash);
+                if (fd >= 0) ::inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+            }
+#else
+            (void)plugins;
+#endif
+        }
+
+        Watcher(const Watcher&) = delete;
+        Watcher& operator=(const Watcher&) = delete;
+
+        ~Watcher()
+        {
+            if (fd >= 0) ::close(fd);
+        }
+
+        // wait up to timeout_ms, or until a change if negative, returning true if something may have changed
+        bool wait(int timeout_ms)
+        {
+            if (fd < 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms < 0 ? poll_interval_ms : timeout_ms));
+                return timeout_ms < 0;
+            }
+            pollfd events;
+            events.fd = fd;
+            events.events = POLLIN;
+            events.revents = 0;
+            int ready = 0;
+            do
+            {
+                ready = ::poll(&events, 1, timeout_ms);
+            } while (ready < 0 && errno == EINTR);
+            if (ready <= 0) return false;
+            char buf[4096];
+            return ::read(fd, buf, sizeof(buf)) > 0;
+        }
+
+    private:
+        int fd; // inotify instance, -1 to poll instead
+    };
+
+    // run the tests of a plugin as a test program at the path of the plugin would, so each plugin keeps its own history and cache
+    int runPlugin(TestPlugin& plugin, const TestRunner::Configuration& host_config, const std::vector<std::string>& args)
+    {
+        std::vector<std::string> plugin_args(1, plugin.path());
+        plugin_args.insert(plugin_args.end(), args.begin(), args.end());
+        std::vector<char*> plugin_argv;
+        for (std::string& arg : plugin_args)
+        {
+            plugin_argv.push_back(&arg[0]);
+        }
+        plugin_argv.push_back(nullptr);
+
+        TestRunner& runner = TestRunner::getInstance();
+        runner.configure(&host_config);
+        ::testing::Configure(static_cast<int>(plugin_args.size()), plugin_argv.data());
+        TestRunner::Configuration& config = runner.configure();
+        if (!config.serve_socket.empty()) throw InvalidArgument("--serve can't be given to the tests of a plugin");
+        config.executable = StringView(plugin.path().c_str(), plugin.path().size());
+
+        TestRunner::ScopedRegistry scope(&plugin.registry());
+        int code = SSTEST_SUCCESS;
+        if (config.list_tests) runner.listAllTests(std::cout);
+        else code = ::testing::ExitCode(runner.runAllTests().getTotals());
+        return code;
+    }
+
+    int runPlugins(std::vector<std::unique_ptr<TestPlugin>>& plugins, const std::vector<bool>& selected, const TestRunner::Configuration& host_config, 
+        const std::vector<std::string>& args)
+    {
+        int code = SSTEST_SUCCESS;
+        for (size_t p = 0; p < plugins.size(); p++)
+        {
+            if (!selected[p]) continue;
+            std::cout << "Tests of " << plugins[p]->path() << std::endl;
+            const int plugin_code = runPlugin(*plugins[p], host_config, args);
+            if (code == SSTEST_SUCCESS) code = plugin_code;
+        }
+        return code;
+    }
+
+    // load plugins whose library changed again, keeping the tests of one that can't be loaded, e.g. one built wrong
+    bool reloadChanged(std::vector<std::unique_ptr<TestPlugin>>& plugins, std::vector<bool>& reloaded)
+    {
+        bool loaded = true;
+        reloaded.assign(plugins.size(), false);
+        for (size_t p = 0; p < plugins.size(); p++)
+        {
+            if (!plugins[p]->changed()) continue;
+            try
+            {
+                plugins[p].reset(new TestPlugin(plugins[p]->path()));
+                reloaded[p] = true;
+                std::cout << "Reloaded " << plugins[p]->path() << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "sstest_host: " << e.what() << std::endl;
+                loaded = false;
+            }
+        }
+        return loaded;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace sstest;
+
+    bool watch = false;
+    std::string socket;
+    std::vector<std::string> paths;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--watch")
+        {
+            watch = true;
+        }
+        else if (arg == "--serve" && i + 1 < argc)
+        {
+            socket = argv[++i];
+        }
+        else if (arg.compare(0, 8, "--serve=") == 0)
+        {
+            socket = arg.substr(8);
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage(std::cout);
+            return EXIT_SUCCESS;
+        }
+        else if (arg == "--")
+        {
+            args.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || (watch && !socket.empty()))
+    {
+        printUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector<std::unique_ptr<TestPlugin>> plugins;
+        for (const std::string& path : paths)
+        {
+            plugins.emplace_back(new TestPlugin(path));
+        }
+        const TestRunner::Configuration host_config = TestRunner::getInstance().configure();
+        const std::vector<bool> all(plugins.size(), true);
+
+        if (!socket.empty())
+        {
+            TestServer server(socket);
+            std::cout << "Serving tests of " << plugins.size() << " plugins on " << socket << std::endl;
+            server.serve([&](const std::vector<std::string>& request_args, std::ostream&) -> int
+            {
+                std::vector<bool> reloaded;
+                const bool loaded = reloadChanged(plugins, reloaded);
+                std::vector<std::string> plugin_args = args;
+                plugin_args.insert(plugin_args.end(), request_args.begin(), request_args.end());
+                const int code = runPlugins(plugins, all, host_config, plugin_args);
+                return loaded ? code : EXIT_FAILURE;
+            });
+            return EXIT_SUCCESS;
+        }
+
+        const int code = runPlugins(plugins, all, host_config, args);
+        if (!watch) return code;
+
+        Watcher watcher(plugins);
+        std::cout << "Watching " << plugins.size() << " plugins for changes" << std::endl;
+        for (;;)
+        {
+            watcher.wait(-1);
+            while (watcher.wait(settle_ms)) {}
+            std::vector<bool> reloaded;
+            reloadChanged(plugins, reloaded);
+            try
+            {
+                runPlugins(plugins, reloaded, host_config, args);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "sstest_host: " << e.what() << std::endl;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "sstest_host: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
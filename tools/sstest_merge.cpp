@@ -0,0 +1,139 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+/**
+ * sstest_merge: combine the results of multiple runs of sstest programs, such as every shard of a sharded run, 
+ * into one summary and exit code.
+ * 
+ * Usage: sstest_merge [-o OUTPUT] RESULTS...
+ * Each RESULTS file is written by a test program run with --results-file. If a test is in more than one file, its
+ * result from the last file given is used. With -o, the merged results are also written to OUTPUT.
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_summary.h"
+#include "sstest/sstest_run.h"
+
+namespace
+{
+
+    void printUsage(std::ostream& os)
+    {
+        os << "usage: sstest_merge [-o OUTPUT] RESULTS..." << std::endl;
+    }
+
+    void printCount(std::ostream& os, const char* name, size_t passed, size_t ran, size_t total)
+    {
+        os << name << ": " << passed << " passed, " << (ran - passed) << " failed, " << (total - ran) << " not run, of " << total << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace sstest;
+
+    std::string output_path;
+    std::vector<std::string> input_paths;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage(std::cout);
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            input_paths.push_back(arg);
+        }
+    }
+    if (input_paths.empty())
+    {
+        printUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<TestRecord> records;
+    for (const std::string& path : input_paths)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "sstest_merge: could not open " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        try
+        {
+            const std::vector<TestRecord> file_records = readTestRecords(file);
+            records.insert(records.end(), file_records.begin(), file_records.end());
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "sstest_merge: " << path << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    records = mergeTestRecords(records);
+
+    if (!output_path.empty())
+    {
+        std::ofstream file(output_path, std::ios::trunc);
+        writeTestRecords(file, records);
+        if (!file.flush())
+        {
+            std::cerr << "sstest_merge: could not write " << output_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (const TestRecord& record : records)
+    {
+        if (record.result == TestResult::PASS || record.result == TestResult::CACHED || record.result == TestResult::INVALID) continue;
+        const char* status = (record.result == TestResult::SKIP) ? "[ SKIPPED ] " : (record.result == TestResult::FLAKY) ? "[ FLAKY ] " : "[ FAILED ] ";
+        std::cout << status << record.identifier;
+        if (record.quarantined && record.result != TestResult::SKIP && record.result != TestResult::FLAKY) std::cout << " (quarantined)";
+        std::cout << std::endl;
+    }
+
+    const TestTotals totals = TestSummary(records).getTotals();
+    printCount(std::cout, "test suites", totals.test_suites_passed, totals.test_suites_ran, totals.test_suites_total);
+    printCount(std::cout, "tests", totals.test_functions_passed, totals.test_functions_ran, totals.test_functions_total);
+    printCount(std::cout, "assertions", totals.assertions_passed, totals.assertions_ran, totals.assertions_total);
+    return ::testing::ExitCode(totals);
+}
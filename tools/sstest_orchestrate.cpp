@@ -0,0 +1,539 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+/**
+ * sstest_orchestrate: run the tests of many sstest programs on one pool of workers, splitting each program into parts so that no 
+ * single slow program holds up the run, and combine their results into one summary and exit code.
+ * 
+ * Usage: sstest_orchestrate [-j N] [-o OUTPUT] [--history-file PATH] [--warm] PROGRAM... [-- ARGS...]
+ * Each PROGRAM is asked for its tests with --list-tests. The tests of every program are split into parts of about equal estimated 
+ * time, which are run longest first, each by running its program with --test-list, on N workers (default: one per available CPU). 
+ * ARGS are given to every run of a program. Test durations are kept in the history file (default: sstest_orchestrate.history, empty 
+ * for none) to estimate the parts of the next run. With -o, the combined results are also written to OUTPUT, with each test named 
+ * "PROGRAM: TEST". With --warm, each worker starts a program once with --serve and sends it every part of the program it runs, 
+ * instead of starting the program for each part. A part that crashes its program has the program started again for the next part. 
+ * POSIX only.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sstest/sstest_exception.h"
+#include "sstest/sstest_history.h"
+#include "sstest/sstest_pool.h"
+#include "sstest/sstest_process.h"
+#include "sstest/sstest_runner.h"
+#include "sstest/sstest_server.h"
+#include "sstest/sstest_summary.h"
+#include "sstest/sstest_run.h"
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    using namespace sstest;
+
+    // parts per worker, more parts balance the workers better but start more processes
+    const size_t parts_per_worker = 4;
+
+    // given to every run of a program to turn its own history off: parts of one program running at once would overwrite its history 
+    // file, and the durations of its tests are kept in the history of the orchestrator instead. An empty path keeps no history
+    const char* const no_program_history = "--history-file=";
+
+    // a part of the tests of one program, run by one process
+    struct Part
+    {
+        Part() : program(0), weight(0) {}
+
+        size_t program; // index into the programs
+        std::vector<std::string> tests;
+        uint64_t weight; // estimated duration in microseconds
+    };
+
+    // a program serving tests to one worker with --warm
+    struct Server
+    {
+        Server() : pid(-1) {}
+
+        pid_t pid; // -1 when not running
+        std::string socket;
+        std::string log; // output of the program outside of requests, e.g. why it could not start serving
+    };
+
+    void printUsage(std::ostream& os)
+    {
+        os << "usage: sstest_orchestrate [-j N] [-o OUTPUT] [--history-file PATH] [--warm] PROGRAM... [-- ARGS...]" << std::endl;
+    }
+
+    // parse a number of workers, at least 1, which must be the whole argument
+    bool parseJobs(const char* arg, size_t& jobs)
+    {
+        if (arg[0] < '0' || arg[0] > '9') return false; // strtoul() skips spaces and accepts a sign
+        char* end = nullptr;
+        errno = 0;
+        const unsigned long n = std::strtoul(arg, &end, 10);
+        if (*end != '\0' || errno == ERANGE || n == 0 || n > std::numeric_limits<size_t>::max()) return false;
+        jobs = static_cast<size_t>(n);
+        return true;
+    }
+
+    void printCount(std::ostream& os, const char* name, size_t passed, size_t ran, size_t total)
+    {
+        os << name << ": " << passed << " passed, " << (ran - passed) << " failed, " << (total - ran) << " not run, of " << total << std::endl;
+    }
+
+    // quote an argument for the shell
+    std::string quote(const std::string& arg)
+    {
+        std::string quoted = "'";
+        for (char c : arg)
+        {
+            if (c == '\'') quoted += "'\\''";
+            else quoted += c;
+        }
+        return quoted + "'";
+    }
+
+    // a test is known across programs by the program and its identifier
+    std::string qualify(const std::string& program, const std::string& name)
+    {
+        return program + ": " + name;
+    }
+
+    // ask a program for its tests, which come after the header line, anything before it is other output of the program
+    bool listTests(const std::string& program, std::vector<std::string>& tests)
+    {
+        std::FILE* pipe = ::popen((quote(program) + " --list-tests").c_str(), "r");
+        if (pipe == nullptr) return false;
+        std::string output;
+        char buf[4096];
+        size_t n = 0;
+        while ((n = std::fread(buf, 1, sizeof(buf), pipe)) > 0)
+        {
+            output.append(buf, n);
+        }
+        const int status = ::pclose(pipe);
+        if (status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return false;
+
+        const std::string header = std::string(TestRunner::test_list_header) + "\n";
+        const size_t start = output.find(header);
+        if (start == std::string::npos) return false;
+        size_t pos = start + header.size();
+        while (pos < output.size())
+        {
+            size_t end = output.find('\n', pos);
+            if (end == std::string::npos) end = output.size();
+            tests.push_back(output.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        return true;
+    }
+
+    bool readFile(const std::string& path, std::string& contents)
+    {
+        std::ifstream file(path);
+        if (!file) return false;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // start a program serving tests, waiting until it listens. Sets status if it exits first, e.g. built with an sstest without --serve
+    bool startServer(const std::string& program, const std::string& program_args, Server& server, int& status)
+    {
+        const std::string command = "exec " + quote(program) + " --serve " + quote(server.socket) + " " + quote(no_program_history) + program_args + 
+            " > " + quote(server.log) + " 2>&1";
+        const pid_t pid = ::fork();
+        if (pid < 0) return false;
+        if (pid == 0)
+        {
+            ::execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            ::_exit(127);
+        }
+        while (!TestServer::available(server.socket))
+        {
+            if (::waitpid(pid, &status, WNOHANG) == pid) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        server.pid = pid;
+        return true;
+    }
+
+    void stopServer(Server& server)
+    {
+        if (server.pid < 0) return;
+        try
+        {
+            TestServer::shutdown(server.socket);
+        }
+        catch (const std::exception&)
+        {
+            ::kill(server.pid, SIGKILL);
+        }
+        ::waitpid(server.pid, nullptr, 0);
+        server.pid = -1;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace sstest;
+
+    size_t jobs = 0;
+    std::string output_path;
+    std::string history_path = "sstest_orchestrate.history";
+    std::vector<std::string> programs;
+    std::string program_args;
+    bool warm = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "-j" || arg == "-o" || arg == "--history-file") && i + 1 >= argc)
+        {
+            std::cerr << "sstest_orchestrate: missing value for option " << arg << std::endl;
+            printUsage(std::cerr);
+            return EXIT_FAILURE;
+        }
+        if (arg == "-j")
+        {
+            if (!parseJobs(argv[++i], jobs))
+            {
+                std::cerr << "sstest_orchestrate: expected a number of workers for -j, got " << argv[i] << std::endl;
+                printUsage(std::cerr);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "-o")
+        {
+            output_path = argv[++i];
+        }
+        else if (arg == "--history-file")
+        {
+            history_path = argv[++i];
+        }
+        else if (arg.compare(0, 15, "--history-file=") == 0)
+        {
+            history_path = arg.substr(15);
+        }
+        else if (arg == "--warm")
+        {
+            warm = true;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage(std::cout);
+            return EXIT_SUCCESS;
+        }
+        else if (arg == "--")
+        {
+            for (i++; i < argc; i++)
+            {
+                program_args += " " + quote(argv[i]);
+            }
+        }
+        else
+        {
+            programs.push_back(arg);
+        }
+    }
+    if (programs.empty())
+    {
+        printUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+    if (jobs == 0) jobs = WorkStealingPool::hardwareConcurrency();
+
+    std::vector<std::vector<std::string>> program_tests(programs.size());
+    for (size_t p = 0; p < programs.size(); p++)
+    {
+        if (!listTests(programs[p], program_tests[p]))
+        {
+            std::cerr << "sstest_orchestrate: could not list the tests of " << programs[p] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // tests not seen before are assumed to take an average time
+    TestHistory history;
+    if (!history_path.empty()) history.load(history_path);
+    uint64_t known_weight = 0;
+    size_t nknown = 0;
+    size_t ntests = 0;
+    for (size_t p = 0; p < programs.size(); p++)
+    {
+        for (const std::string& test : program_tests[p])
+        {
+            const TestHistory::Record* record = history.find(qualify(programs[p], test));
+            if (record != nullptr)
+            {
+                known_weight += record->duration_us;
+                nknown++;
+            }
+            ntests++;
+        }
+    }
+    const uint64_t mean_weight = (nknown == 0) ? 1 : std::max<uint64_t>(known_weight / nknown, 1);
+    auto weight = [&](size_t p, const std::string& test) -> uint64_t
+    {
+        const TestHistory::Record* record = history.find(qualify(programs[p], test));
+        return (record == nullptr) ? mean_weight : std::max<uint64_t>(record->duration_us, 1);
+    };
+
+    // tests stay in the order of their program, so tests of a suite mostly run in the same process
+    uint64_t total_weight = 0;
+    for (size_t p = 0; p < programs.size(); p++)
+    {
+        for (const std::string& test : program_tests[p])
+        {
+            total_weight += weight(p, test);
+        }
+    }
+    const uint64_t part_weight = std::max<uint64_t>(total_weight / (jobs * parts_per_worker), 1);
+    std::vector<Part> parts;
+    for (size_t p = 0; p < programs.size(); p++)
+    {
+        Part part;
+        part.program = p;
+        for (const std::string& test : program_tests[p])
+        {
+            part.tests.push_back(test);
+            part.weight += weight(p, test);
+            if (part.weight < part_weight) continue;
+            parts.push_back(part);
+            part.tests.clear();
+            part.weight = 0;
+        }
+        if (!part.tests.empty()) parts.push_back(part);
+    }
+    // longest processing time first, so a long part doesn't start last and hold up the whole run
+    std::stable_sort(parts.begin(), parts.end(), [](const Part& lhs, const Part& rhs) -> bool { return lhs.weight > rhs.weight; });
+
+    const char* tmp = std::getenv("TMPDIR");
+    std::string work_dir = std::string((tmp != nullptr && *tmp != '\0') ? tmp : "/tmp") + "/sstest_orchestrate.XXXXXX";
+    if (::mkdtemp(&work_dir[0]) == nullptr)
+    {
+        std::cerr << "sstest_orchestrate: could not create a directory in " << work_dir << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Running " << ntests << " tests of " << programs.size() << " programs in " << parts.size() << " parts on " << jobs << " workers";
+    if (warm) std::cout << ", each keeping its programs running";
+    std::cout << std::endl;
+
+    // each worker takes the next part from the shared queue until none are left
+    std::vector<std::vector<TestRecord>> part_records(parts.size());
+    std::atomic<size_t> next_part(0);
+    std::atomic<uint64_t> busy_us(0);
+    std::mutex output_mutex;
+    WorkStealingPool pool(jobs);
+    for (size_t w = 0; w < pool.size(); w++)
+    {
+        pool.submit(w, [&, w](size_t) -> void
+        {
+            // with --warm, the programs this worker started, by program
+            std::vector<Server> servers(warm ? programs.size() : 0);
+            for (size_t p = 0; p < servers.size(); p++)
+            {
+                servers[p].socket = work_dir + "/" + std::to_string(w) + "." + std::to_string(p) + ".sock";
+                servers[p].log = work_dir + "/" + std::to_string(w) + "." + std::to_string(p) + ".log";
+            }
+
+            for (size_t i = next_part++; i < parts.size(); i = next_part++)
+            {
+                const Part& part = parts[i];
+                const std::string& program = programs[part.program];
+                const std::string base = work_dir + "/" + std::to_string(i);
+                {
+                    std::ofstream list(base + ".list", std::ios::trunc);
+                    for (const std::string& test : part.tests)
+                    {
+                        list << test << '\n';
+                    }
+                }
+                std::string log;
+                std::string failure; // why the part has no results
+                const auto start = std::chrono::steady_clock::now();
+                if (warm)
+                {
+                    Server& server = servers[part.program];
+                    int status = 0;
+                    if (server.pid < 0 && !startServer(program, program_args, server, status))
+                    {
+                        readFile(server.log, log);
+                        failure = "could not serve tests, " + ProcessPool::describeStatus(status);
+                    }
+                    else
+                    {
+                        std::ostringstream output;
+                        try
+                        {
+                            const int code = TestServer::request(server.socket, { "--test-list", base + ".list", "--results-file", base + ".results" }, output);
+                            failure = "run exited with code " + std::to_string(code);
+                        }
+                        catch (const Exception& e)
+                        {
+                            // the connection is only lost before the run finishes if the program died, it is started again for the next part
+                            output << e.what() << std::endl;
+                            ::waitpid(server.pid, &status, 0);
+                            server.pid = -1;
+                            failure = ProcessPool::describeStatus(status);
+                        }
+                        log = output.str();
+                    }
+                }
+                else
+                {
+                    const std::string command = quote(program) + " --test-list " + quote(base + ".list") + " --results-file " + quote(base + ".results") + 
+                        " " + quote(no_program_history) + program_args + " > " + quote(base + ".log") + " 2>&1";
+                    const int status = std::system(command.c_str());
+                    failure = ProcessPool::describeStatus(status);
+                    readFile(base + ".log", log);
+                }
+                const uint64_t elapsed_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+                busy_us += elapsed_us;
+
+                // results are only written once the program finishes, so a part that crashed has none
+                std::vector<TestRecord>& records = part_records[i];
+                std::ifstream results(base + ".results");
+                try
+                {
+                    if (results) records = readTestRecords(results);
+                }
+                catch (const std::exception&)
+                {
+                    records.clear();
+                }
+                bool crashed = records.empty();
+                if (crashed)
+                {
+                    for (const std::string& test : part.tests)
+                    {
+                        TestRecord record;
+                        record.identifier = test;
+                        const size_t sep = test.find("::");
+                        record.suite = (sep == std::string::npos) ? std::string() : test.substr(0, sep);
+                        record.result = TestResult::CRASH;
+                        records.push_back(record);
+                    }
+                }
+                const bool passed = !crashed && TestSummary(records).getTotals().allTestsPassed(true, false, true);
+                for (TestRecord& record : records)
+                {
+                    record.suite = qualify(program, record.suite);
+                    record.identifier = qualify(program, record.identifier);
+                }
+
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << (passed ? "[ PASSED ] " : "[ FAILED ] ") << program << " (" << part.tests.size() << " tests, " << (elapsed_us / 1000) << " ms";
+                if (crashed) std::cout << ", " << failure << " without results";
+                std::cout << ")" << std::endl;
+                if (!passed) std::cout << log << std::flush;
+                std::remove((base + ".list").c_str());
+                std::remove((base + ".results").c_str());
+                std::remove((base + ".log").c_str());
+            }
+
+            for (Server& server : servers)
+            {
+                // a program that crashed leaves its socket behind
+                stopServer(server);
+                std::remove(server.socket.c_str());
+                std::remove(server.log.c_str());
+            }
+        });
+    }
+    const auto start = std::chrono::steady_clock::now();
+    pool.run();
+    const uint64_t wall_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    ::rmdir(work_dir.c_str());
+
+    std::vector<TestRecord> records;
+    for (const std::vector<TestRecord>& part : part_records)
+    {
+        records.insert(records.end(), part.begin(), part.end());
+    }
+    // a test may also run as the prerequisite of a test in another part
+    records = mergeTestRecords(records);
+
+    if (!history_path.empty())
+    {
+        for (const TestRecord& record : records)
+        {
+            if (record.result == TestResult::INVALID || record.result == TestResult::SKIP) continue;
+            history.recordResult(record.identifier, record.result == TestResult::PASS || record.result == TestResult::CACHED);
+            if (record.result == TestResult::CRASH || record.result == TestResult::CACHED) continue;
+            history.recordDuration(record.identifier, record.duration_us);
+        }
+        history.save(history_path); // history only affects how tests are split, so a read only location is not an error
+    }
+
+    if (!output_path.empty())
+    {
+        std::ofstream file(output_path, std::ios::trunc);
+        writeTestRecords(file, records);
+        if (!file.flush())
+        {
+            std::cerr << "sstest_orchestrate: could not write " << output_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (const TestRecord& record : records)
+    {
+        if (record.result == TestResult::PASS || record.result == TestResult::CACHED || record.result == TestResult::INVALID) continue;
+        const char* status = (record.result == TestResult::SKIP) ? "[ SKIPPED ] " : (record.result == TestResult::FLAKY) ? "[ FLAKY ] " : "[ FAILED ] ";
+        std::cout << status << record.identifier;
+        if (record.quarantined && record.result != TestResult::SKIP && record.result != TestResult::FLAKY) std::cout << " (quarantined)";
+        std::cout << std::endl;
+    }
+
+    const TestTotals totals = TestSummary(records).getTotals();
+    printCount(std::cout, "test suites", totals.test_suites_passed, totals.test_suites_ran, totals.test_suites_total);
+    printCount(std::cout, "tests", totals.test_functions_passed, totals.test_functions_ran, totals.test_functions_total);
+    printCount(std::cout, "assertions", totals.assertions_passed, totals.assertions_ran, totals.assertions_total);
+    std::cout << "wall time: " << (wall_us / 1000) << " ms, process time: " << (busy_us.load() / 1000) << " ms on " << jobs << " workers" << std::endl;
+    return ::testing::ExitCode(totals);
+}
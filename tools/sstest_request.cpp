@@ -0,0 +1,90 @@
+/***************************************************************************//**
+* SSTest: A C++ Testing Library
+* 
+* This software is distributed free of charge, under the MIT License.
+* 
+* 
+* Copyright (c) 2022 David Lu
+* 
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal 
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+* 
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+* 
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, 
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE 
+* SOFTWARE.
+* 
+*******************************************************************************/
+
+
+/**
+ * sstest_request: run tests on a test program serving them, so each run skips starting the program and setting up its fixtures.
+ * 
+ * Usage: sstest_request SOCKET [ARGS...]
+ *        sstest_request SOCKET --shutdown
+ * SOCKET is given to a test program started with --serve SOCKET. ARGS are sstest options for the run, after the options the program 
+ * was started with, e.g. --filter to choose the tests. The output of the run is printed as the program writes it, and the exit code 
+ * is that of the run. With --shutdown, the program stops serving once any run it is doing finishes. POSIX only.
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sstest/sstest_server.h"
+
+namespace
+{
+
+    void printUsage(std::ostream& os)
+    {
+        os << "usage: sstest_request SOCKET [ARGS...]" << std::endl;
+        os << "       sstest_request SOCKET --shutdown" << std::endl;
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    using namespace sstest;
+
+    if (argc < 2)
+    {
+        printUsage(std::cerr);
+        return EXIT_FAILURE;
+    }
+    const std::string socket = argv[1];
+    if (socket == "-h" || socket == "--help")
+    {
+        printUsage(std::cout);
+        return EXIT_SUCCESS;
+    }
+    const std::vector<std::string> args(argv + 2, argv + argc);
+
+    try
+    {
+        if (args.size() == 1 && args[0] == "--shutdown")
+        {
+            TestServer::shutdown(socket);
+            return EXIT_SUCCESS;
+        }
+        return TestServer::request(socket, args, std::cout);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "sstest_request: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}